@@ -19,16 +19,31 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 #include <math.h>
 #include <ctype.h>
 
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
 #if defined(__MACH__)
 #include <stdlib.h>
 #else 
 #include <malloc.h>
 #endif
 
-#include <libxml/xmlwriter.h>
+#include <glib.h>
 #include <libxml/xmlreader.h>
 #include "aio.h"
 #include "var.h"
@@ -99,81 +114,6 @@ aio_get_next_attribute (xmlTextReader * xml, xmlChar ** name)
   return buffer;
 }
 
-/* Write the line number of a sentence object to an XML stream.
- *  input:
- *    xml - the XML stream to which to write.
- *    sd - the sentence data object that holds the information being written.
- *  output:
- *    the results of the write.
- */
-int
-aio_write_line_num (xmlTextWriter * xml, sen_data * sd)
-{
-  int ret;
-  ret = xmlTextWriterWriteFormatAttribute (xml, XML_CAST(ALT_LINE_DATA),
-					   "%i", sd->line_num);
-  if (ret < 0) XML_ERR (AEC_MEM);
-  return ret;
-}
-
-/* Write the text of a sentence object to an XML stream.
- *  input:
- *    xml - the XML stream to which to write.
- *    sd - the sentence data object that holds the information being written.
- *  output:
- *    the results of the write.
- */
-int
-aio_write_text (xmlTextWriter * xml, sen_data * sd)
-{
-  int ret;
-  ret = xmlTextWriterWriteFormatAttribute (xml, XML_CAST(ALT_TEXT_DATA),
-					   "%s", sd->text);
-  if (ret < 0) XML_ERR (-1);
-  return ret;
-}
-
-/* Write the rule of a sentence object to an XML stream.
- *  input:
- *    xml - the XML stream to which to write.
- *    sd - the sentence data object that holds the information being written.
- *  output:
- *    the results of the write.
- */
-int
-aio_write_rule (xmlTextWriter * xml, sen_data * sd)
-{
-  int ret;
-  ret = xmlTextWriterWriteFormatAttribute (xml, XML_CAST(ALT_RULE_DATA),
-					   "%i", sd->rule);
-  if (ret < 0) XML_ERR (-1);
-  return ret;
-}
-
-/* Save a goal to an XML stream.
- *  input:
- *    xml - the XML stream to which to write.
- *    text - the goal text to be written.
- *  output:
- *    the results of the write.
- */
-int
-aio_save_goal (xmlTextWriter * xml, unsigned char * text)
-{
-  int ret;
-  ret = xmlTextWriterStartElement (xml, XML_CAST(GOAL_ENTRY));
-  if (ret < 0) XML_ERR (-1);
-
-  ret = xmlTextWriterWriteFormatAttribute (xml, XML_CAST(ALT_TEXT_DATA),
-					   "%s", text);
-  if (ret < 0) XML_ERR (-1);
-
-  ret = xmlTextWriterEndElement (xml);
-  if (ret < 0) XML_ERR (-1);
-
-  return 0;
-}
-
 /* Opens a premise item from an XML stream.
  *  input:
  *    xml - the XML stream to read from.
@@ -207,13 +147,19 @@ aio_open_prem (xmlTextReader * xml)
       if (IS_TEXT(name))
 	{
 	  IF_FREE (name);
-	  text = (unsigned char *) strdup (CSTD_CAST (buffer));
+	  text = normalize_conns (buffer);
+	  CHECK_ALLOC (text, NULL);
 
 	  free (buffer);
 	  buffer = aio_get_next_attribute (xml, &name);
 
 	  continue;
 	}
+
+      // Anything else is skipped, as the streaming loader does.
+      IF_FREE (name);
+      free (buffer);
+      buffer = aio_get_next_attribute (xml, &name);
     }
 
   sd = sen_data_init (line_num, -1, text, NULL, 1, NULL,
@@ -292,8 +238,6 @@ aio_open_conc (xmlTextReader * xml)
 	  int num_refs;
 	  i = num_refs = 0;
 
-	  // strtok?
-
 	  for (; buffer[i]; i++)
 	    if (buffer[i] == ',')
 	      num_refs ++;
@@ -304,16 +248,22 @@ aio_open_conc (xmlTextReader * xml)
 
 	  char * ref_str = strdup ((const char *) buffer);
 
-	  char * tok;
-	  tok = strtok (ref_str, ",");
-	  num_refs++;
+	  // Lemmas are opened by the live checking thread as well,
+	  //  so this can't use strtok.
+	  char * tok, * next;
 	  i = 0;
 
-	  while (tok)
+	  for (tok = ref_str; tok; tok = next)
 	    {
+	      next = strchr (tok, ',');
+	      if (next)
+		*next++ = '\0';
+
+	      if (*tok == '\0')
+		continue;
+
 	      short new_ref = (short) atoi(tok);
 	      refs[i++] = new_ref;
-	      tok = strtok (NULL, ",");
 	    }
 	  refs[i] = REF_END;
 
@@ -374,7 +324,7 @@ aio_open_conc (xmlTextReader * xml)
 	  if (got_text)
 	    XML_ERR (NULL);
 
-	  text = (unsigned char *) strdup ((const char *)buffer);
+	  text = normalize_conns (buffer);
 	  CHECK_ALLOC (text, NULL);
 
 	  got_text = 1;
@@ -383,6 +333,11 @@ aio_open_conc (xmlTextReader * xml)
 	  buffer = aio_get_next_attribute (xml, &name);
 	  continue;
 	}
+
+      // Anything else is skipped, as the streaming loader does.
+      IF_FREE (name);
+      free (buffer);
+      buffer = aio_get_next_attribute (xml, &name);
     }
 
   sd = sen_data_init (line_num, rule, text, refs, 0, file, 0, sen_depth, NULL);
@@ -396,7 +351,51 @@ aio_open_conc (xmlTextReader * xml)
   return sd;
 }
 
+// The size of the buffer for saving proofs.
+#define AIO_OUT_BLOCK 65536
+
+/* Writes text to a file as an attribute value.
+ *  input:
+ *    file - the file to write to.
+ *    text - the text to write.
+ *  output:
+ *    none.
+ */
+static void
+aio_write_escaped (FILE * file, const unsigned char * text)
+{
+  const unsigned char * run;
+
+  // Write the runs between special characters in one go.
+  for (run = text; *text; text++)
+    {
+      const char * esc;
+
+      switch (*text)
+        {
+        case '&':  esc = "&amp;";  break;
+        case '<':  esc = "&lt;";   break;
+        case '>':  esc = "&gt;";   break;
+        case '\"': esc = "&quot;"; break;
+        case '\n': esc = "&#10;";  break;
+        case '\r': esc = "&#13;";  break;
+        case '\t': esc = "&#9;";   break;
+        default:   continue;
+        }
+
+      fwrite (run, 1, text - run, file);
+      fputs (esc, file);
+      run = text + 1;
+    }
+
+  fwrite (run, 1, text - run, file);
+}
+
 /* Saves a proof to a file.
+ * The file is written directly, through a large buffer, in the same
+ *  form that libxml2 writes it.  It is written to a uniquely named file
+ *  beside the old one and renamed over it, so that a crash never leaves
+ *  half a proof, and two saves of the same file never share a temporary.
  *  input:
  *    proof - the proof to save.
  *    file_name - the name of the file to save to.
@@ -406,202 +405,860 @@ aio_open_conc (xmlTextReader * xml)
 int
 aio_save (proof_t * proof, const char * file_name)
 {
-  xmlTextWriter * xml;
-  int ret;
+  FILE * file;
   item_t * itr;
+  char * tmp_name;
+  int fd;
 
-  xml = xmlNewTextWriterFilename (file_name, 0);
-  if (!xml) XML_ERR (-1);
-
-  ret = xmlTextWriterSetIndent (xml, 1);
-  if (ret < 0) XML_ERR (-1);
+  tmp_name = (char *) calloc (strlen (file_name) + 8, sizeof (char));
+  CHECK_ALLOC (tmp_name, -1);
+  sprintf (tmp_name, "%s.XXXXXX", file_name);
 
-  ret = xmlTextWriterStartDocument (xml, NULL, NULL, NULL);
-  if (ret < 0) XML_ERR (-1);
+  // Ask for the usual mode, so the saved proof isn't left private.
+  fd = g_mkstemp_full (tmp_name, O_WRONLY | O_BINARY, 0666);
+  if (fd == -1)
+    {
+      perror (tmp_name);
+      free (tmp_name);
+      return -1;
+    }
 
-  ret = xmlTextWriterStartElement (xml, XML_CAST(PROOF_TAG));
-  if (ret < 0) XML_ERR (-1);
+  file = fdopen (fd, "wb");
+  if (!file)
+    {
+      perror (tmp_name);
+      close (fd);
+      remove (tmp_name);
+      free (tmp_name);
+      return -1;
+    }
+  setvbuf (file, NULL, _IOFBF, AIO_OUT_BLOCK);
 
-  char * mode;
+  fprintf (file, "<?xml version=\"1.0\"?>\n");
+  fprintf (file, "<%s %s=\"%s\" %s=\"%1.1f\">\n", PROOF_TAG,
+           MODE_DATA, (proof->boolean) ? "boolean" : "standard",
+           VER_DATA, FILE_VER);
 
-  if (proof->boolean)
-    mode = "boolean";
+  if (proof->goals->num_stuff > 0)
+    {
+      fprintf (file, " <%s>\n", GOAL_TAG);
+      for (itr = proof->goals->head; itr != NULL; itr = itr->next)
+        {
+          fprintf (file, "  <%s %s=\"", GOAL_ENTRY, ALT_TEXT_DATA);
+          aio_write_escaped (file, itr->value);
+          fprintf (file, "\"/>\n");
+        }
+      fprintf (file, " </%s>\n", GOAL_TAG);
+    }
   else
-    mode = "standard";
+    {
+      fprintf (file, " <%s/>\n", GOAL_TAG);
+    }
+
+  fprintf (file, " <%s>\n", PREMISE_TAG);
+  for (itr = proof->everything->head; itr != NULL; itr = itr->next)
+    {
+      sen_data * sd = itr->value;
+      if (!sd->premise)
+        break;
+
+      fprintf (file, "  <%s %s=\"%i\" %s=\"", SENTENCE_ENTRY,
+               ALT_LINE_DATA, sd->line_num, ALT_TEXT_DATA);
+      aio_write_escaped (file, sd->text);
+      fprintf (file, "\"/>\n");
+    }
+  fprintf (file, " </%s>\n", PREMISE_TAG);
+
+  fprintf (file, " <%s>\n", CONCLUSION_TAG);
+  for (; itr != NULL; itr = itr->next)
+    {
+      sen_data * sd = itr->value;
+      int i;
+
+      fprintf (file, "  <%s %s=\"%i\" %s=\"%i\" %s=\"", SENTENCE_ENTRY,
+               ALT_LINE_DATA, sd->line_num, ALT_RULE_DATA, sd->rule,
+               ALT_REF_DATA);
+
+      if (sd->refs)
+        {
+          for (i = 0; sd->refs[i] != REF_END; i++)
+            fprintf (file, (i > 0) ? ",%i" : "%i", sd->refs[i]);
+        }
 
-  ret = xmlTextWriterWriteFormatAttribute (xml, XML_CAST(MODE_DATA),
-					   "%s", mode);
+      fprintf (file, "\" %s=\"%i\"", DEPTH_DATA, sd->depth);
 
-  ret = xmlTextWriterWriteFormatAttribute (xml, XML_CAST (VER_DATA),
-                                           "%1.1f", FILE_VER);
+      if (sd->file)
+        {
+          fprintf (file, " %s=\"", ALT_FILE_DATA);
+          aio_write_escaped (file, sd->file);
+          fputc ('\"', file);
+        }
 
-  ret = xmlTextWriterStartElement (xml, XML_CAST(GOAL_TAG));
-  if (ret < 0) XML_ERR (-1);
+      fprintf (file, " %s=\"", ALT_TEXT_DATA);
+      aio_write_escaped (file, sd->text);
+      fprintf (file, "\"/>\n");
+    }
+  fprintf (file, " </%s>\n", CONCLUSION_TAG);
 
-  itr = proof->goals->head;
+  fprintf (file, "</%s>\n", PROOF_TAG);
 
-  for (itr = proof->goals->head; itr != NULL; itr = itr->next)
+  if (ferror (file) | fclose (file))
     {
-      ret = aio_save_goal (xml, itr->value);
-      if (ret == -1)
-	return -1;
+      perror (tmp_name);
+      remove (tmp_name);
+      free (tmp_name);
+      return -1;
     }
 
-  // End <goals> tag.
-  ret = xmlTextWriterEndElement (xml);
-  if (ret < 0) XML_ERR (-1);
+#ifdef WIN32
+  // Windows won't rename over an existing file.
+  remove (file_name);
+#endif
+
+  if (rename (tmp_name, file_name))
+    {
+      perror (file_name);
+      remove (tmp_name);
+      free (tmp_name);
+      return -1;
+    }
 
-  // Begin <premises> tag.
-  ret = xmlTextWriterStartElement (xml, XML_CAST(PREMISE_TAG));
-  if (ret < 0) XML_ERR (-1);
+  free (tmp_name);
+  return 0;
+}
 
-  for (itr = proof->everything->head; itr != NULL; itr = itr->next)
+/* The streaming loader reads the fixed schema that aio_save writes
+ *  straight from the mapped file.  Attribute names are looked up once
+ *  in a table of the known ones, and the values of each tag are decoded
+ *  into one buffer that is reused for the next tag.  Anything it
+ *  doesn't expect, such as comments, other encodings or unknown
+ *  entities, makes it give up, and the file is read through libxml2.
+ */
+
+// The attributes of the proof schema.
+
+enum AIO_ATTR {
+  AA_LINE = 0,
+  AA_TEXT,
+  AA_RULE,
+  AA_REF,
+  AA_FILE,
+  AA_DEPTH,
+  AA_MODE,
+  AA_VER,
+  AA_NUM
+};
+
+static const struct {
+  const char * name;
+  int id;
+} aio_attrs[] = {
+  {ALT_LINE_DATA, AA_LINE}, {ALT_TEXT_DATA, AA_TEXT},
+  {ALT_RULE_DATA, AA_RULE}, {ALT_REF_DATA, AA_REF},
+  {ALT_FILE_DATA, AA_FILE}, {DEPTH_DATA, AA_DEPTH},
+  {LINE_DATA, AA_LINE}, {TEXT_DATA, AA_TEXT},
+  {RULE_DATA, AA_RULE}, {REF_DATA, AA_REF},
+  {FILE_DATA, AA_FILE}, {MODE_DATA, AA_MODE},
+  {VER_DATA, AA_VER}, {NULL, -1}
+};
+
+struct aio_stream {
+  const char * buf;     // The text of the file.
+  size_t size, pos;
+  char * vals;          // The decoded values of the current tag.
+  size_t vals_len, vals_alloc;
+  int off[AA_NUM];      // The offset of each value in vals, or -1.
+};
+
+// The results of reading part of a file with the streaming loader.
+#define AIO_STREAM_OK 0
+#define AIO_STREAM_ODD 1
+
+#define AIO_NAME_CHAR(c) (isalnum ((unsigned char) (c)) || (c) == '_' \
+                          || (c) == '-' || (c) == '.' || (c) == ':')
+
+/* Skips whitespace in a stream.
+ *  input:
+ *    st - the stream.
+ *  output:
+ *    none.
+ */
+static void
+aio_stream_skip (struct aio_stream * st)
+{
+  while (st->pos < st->size && isspace ((unsigned char) st->buf[st->pos]))
+    st->pos++;
+}
+
+/* Determines whether a stream continues with some text.
+ *  input:
+ *    st - the stream.
+ *    str - the text.
+ *  output:
+ *    1 if it does, 0 if it doesn't.
+ */
+static int
+aio_stream_at (struct aio_stream * st, const char * str)
+{
+  size_t len = strlen (str);
+
+  return (st->size - st->pos >= len && !memcmp (st->buf + st->pos, str, len));
+}
+
+/* Adds a character to the decoded values of a tag.
+ *  input:
+ *    st - the stream.
+ *    c - the character.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+aio_stream_put (struct aio_stream * st, char c)
+{
+  if (st->vals_len + 1 >= st->vals_alloc)
     {
-      // Write each of the premises.
-      sen_data * sd = itr->value;
-      if (!sd->premise)
-	break;
+      st->vals_alloc = (st->vals_alloc > 0) ? st->vals_alloc * 2 : 256;
+      st->vals = (char *) realloc (st->vals, st->vals_alloc);
+      CHECK_ALLOC (st->vals, AEC_MEM);
+    }
 
-      ret = xmlTextWriterStartElement (xml, XML_CAST(SENTENCE_ENTRY));
-      if (ret < 0) XML_ERR (-1);
+  st->vals[st->vals_len++] = c;
+  return 0;
+}
 
-      // Write the line number.
-      ret = aio_write_line_num (xml, sd);
-      if (ret == -1)
-	return -1;
+/* Finds a string within a range of a buffer.
+ *  input:
+ *    start, end - the range to search.
+ *    str - the string to find.
+ *  output:
+ *    the start of the string in the range, or NULL if it isn't there.
+ */
+static const char *
+aio_find (const char * start, const char * end, const char * str)
+{
+  size_t len = strlen (str);
 
-      ret = aio_write_text (xml, sd);
-      if (ret == -1)
-	return -1;
+  for (; end - start >= (ptrdiff_t) len; start++)
+    {
+      start = memchr (start, str[0], end - start - len + 1);
+      if (!start)
+        return NULL;
 
-      ret = xmlTextWriterEndElement (xml);
-      if (ret < 0) XML_ERR (-1);
+      if (!memcmp (start, str, len))
+        return start;
     }
 
-  ret = xmlTextWriterEndElement (xml);
-  if (ret < 0)
+  return NULL;
+}
+
+/* Decodes an entity in an attribute value.
+ *  input:
+ *    st - the stream, at the '&'.
+ *  output:
+ *    0 on success, 1 on an entity that isn't known, -1 on memory error.
+ */
+static int
+aio_stream_entity (struct aio_stream * st)
+{
+  static const struct {
+    const char * name;
+    char c;
+  } ents[] = {
+    {"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'},
+    {"&quot;", '\"'}, {"&apos;", '\''}, {NULL, 0}
+  };
+  unsigned long code = 0;
+  size_t pos;
+  char utf[4];
+  int i, len, hex, digits = 0;
+
+  for (i = 0; ents[i].name; i++)
     {
-      XML_ERR (-1);
+      if (aio_stream_at (st, ents[i].name))
+        {
+          st->pos += strlen (ents[i].name);
+          return aio_stream_put (st, ents[i].c);
+        }
     }
 
-  // Begin <conclusions> tag.
-  ret = xmlTextWriterStartElement (xml, XML_CAST(CONCLUSION_TAG));
-  if (ret < 0)
+  if (!aio_stream_at (st, "&#"))
+    return AIO_STREAM_ODD;
+
+  // The file isn't terminated, so the digits are read by hand.
+  pos = st->pos + 2;
+  hex = (pos < st->size && st->buf[pos] == 'x');
+  if (hex)
+    pos++;
+
+  for (; pos < st->size && code <= 0x10FFFF; pos++, digits++)
     {
-      XML_ERR (-1);
+      char c = st->buf[pos];
+
+      if (c >= '0' && c <= '9')
+        code = code * (hex ? 16 : 10) + (c - '0');
+      else if (hex && c >= 'a' && c <= 'f')
+        code = code * 16 + (c - 'a' + 10);
+      else if (hex && c >= 'A' && c <= 'F')
+        code = code * 16 + (c - 'A' + 10);
+      else
+        break;
     }
 
-  for (; itr != NULL; itr = itr->next)
+  if (pos >= st->size || st->buf[pos] != ';' || digits == 0
+      || code == 0 || code > 0x10FFFF)
+    return AIO_STREAM_ODD;
+  st->pos = pos + 1;
+
+  // Encode the character as UTF-8.
+  if (code < 0x80)
+    utf[0] = code, len = 1;
+  else if (code < 0x800)
+    utf[0] = 0xC0 | (code >> 6), len = 2;
+  else if (code < 0x10000)
+    utf[0] = 0xE0 | (code >> 12), len = 3;
+  else
+    utf[0] = 0xF0 | (code >> 18), len = 4;
+
+  for (i = 1; i < len; i++)
+    utf[i] = 0x80 | ((code >> (6 * (len - 1 - i))) & 0x3F);
+
+  for (i = 0; i < len; i++)
     {
-      // Wriet each of the conclusions.
-      sen_data * sd = itr->value;
-      char * refs;
-      int i = 0, num_refs = 0, ref_off = 0, max_line = 0;
+      if (aio_stream_put (st, utf[i]) < 0)
+        return AEC_MEM;
+    }
 
-      ret = xmlTextWriterStartElement (xml, XML_CAST(SENTENCE_ENTRY));
-      if (ret < 0) XML_ERR (-1);
+  return 0;
+}
 
-      ret = aio_write_line_num (xml, sd);
-      if (ret == -1)
-	return -1;
+/* Reads an opening tag and its attributes.
+ *  input:
+ *    st - the stream.
+ *    name - the name the tag must have.
+ *    empty - receives whether the tag is empty, as in '<goal/>'.
+ *  output:
+ *    0 on success, 1 if the file isn't as expected, -1 on memory error.
+ */
+static int
+aio_stream_tag (struct aio_stream * st, const char * name, int * empty)
+{
+  size_t len = strlen (name);
+  int i, ret;
 
-      ret = aio_write_rule (xml, sd);
-      if (ret == -1)
-	return -1;
+  aio_stream_skip (st);
+  if (!aio_stream_at (st, "<") || st->size - st->pos < len + 2
+      || memcmp (st->buf + st->pos + 1, name, len)
+      || AIO_NAME_CHAR (st->buf[st->pos + len + 1]))
+    return AIO_STREAM_ODD;
+  st->pos += len + 1;
 
-      if (sd->refs)
-	{
-	  while (sd->refs[i] != REF_END)
-	    {
-	      max_line = (max_line > sd->refs[i]) ? max_line : sd->refs[i];
-	      num_refs++;
-	      i++;
-	    }
-	}
-      
-      max_line = (max_line > 0) ? (int) log10 (max_line) + 1 : 0;
+  st->vals_len = 0;
+  for (i = 0; i < AA_NUM; i++)
+    st->off[i] = -1;
+
+  while (1)
+    {
+      const char * attr;
+      size_t attr_len;
+      char quote;
+      int id = -1;
+
+      aio_stream_skip (st);
+      if (aio_stream_at (st, "/>") || aio_stream_at (st, ">"))
+        break;
+
+      attr = st->buf + st->pos;
+      while (st->pos < st->size && AIO_NAME_CHAR (st->buf[st->pos]))
+        st->pos++;
+      attr_len = st->buf + st->pos - attr;
+
+      aio_stream_skip (st);
+      if (attr_len == 0 || !aio_stream_at (st, "="))
+        return AIO_STREAM_ODD;
+      st->pos++;
+
+      aio_stream_skip (st);
+      if (!aio_stream_at (st, "\"") && !aio_stream_at (st, "\'"))
+        return AIO_STREAM_ODD;
+      quote = st->buf[st->pos++];
+
+      for (i = 0; aio_attrs[i].name; i++)
+        {
+          if (strlen (aio_attrs[i].name) == attr_len
+              && !memcmp (aio_attrs[i].name, attr, attr_len))
+            {
+              id = aio_attrs[i].id;
+              break;
+            }
+        }
 
-      refs = (char *) calloc (num_refs * (max_line + 1), sizeof (char));
-      CHECK_ALLOC (refs, -1);
+      // A repeated attribute isn't well formed.
+      if (id != -1 && st->off[id] != -1)
+        return AIO_STREAM_ODD;
 
-      i = 0;
+      if (id != -1)
+        st->off[id] = st->vals_len;
 
-      if (sd->refs)
-	{
-	  while (sd->refs[i] != REF_END)
-	    {
-	      int ref_line = sd->refs[i];
-	      ref_off += sprintf (refs + ref_off, "%i", ref_line);
+      while (st->pos < st->size && st->buf[st->pos] != quote)
+        {
+          char c = st->buf[st->pos];
 
-	      if (sd->refs[i+1] != REF_END)
-		ref_off += sprintf (refs + ref_off, ",");
-	      i++;
-	    }
-	}
+          if (c == '<')
+            return AIO_STREAM_ODD;
 
-      ret = xmlTextWriterWriteAttribute (xml, XML_CAST(ALT_REF_DATA),
-					 XML_CAST(refs));
-      if (ret < 0) XML_ERR (-1);
+          if (c == '&')
+            {
+              ret = aio_stream_entity (st);
+              if (ret != 0)
+                return ret;
+              continue;
+            }
 
-      ret = xmlTextWriterWriteFormatAttribute (xml, XML_CAST(DEPTH_DATA),
-					       "%i", sd->depth);
-      if (ret < 0) XML_ERR (-1);
+          st->pos++;
 
-      // If there is a file, write it.
-      if (sd->file)
-	{
-	  ret = xmlTextWriterWriteFormatAttribute (xml, XML_CAST(ALT_FILE_DATA),
-					     "%s", sd->file);
-	  if (ret < 0) XML_ERR (-1);
-	}
+          // Line breaks and tabs in values become spaces.
+          if (c == '\r' && st->pos < st->size && st->buf[st->pos] == '\n')
+            continue;
+
+          if (c == '\n' || c == '\r' || c == '\t')
+            c = ' ';
+
+          if (aio_stream_put (st, c) < 0)
+            return AEC_MEM;
+        }
+
+      if (st->pos >= st->size)
+        return AIO_STREAM_ODD;
+      st->pos++;
+
+      if (aio_stream_put (st, '\0') < 0)
+        return AEC_MEM;
+    }
+
+  *empty = (st->buf[st->pos] == '/');
+  st->pos += (*empty) ? 2 : 1;
+
+  return 0;
+}
+
+/* Reads a closing tag, if the stream is at one.
+ *  input:
+ *    st - the stream.
+ *    name - the name of the tag.
+ *  output:
+ *    1 if the tag was read, 0 if the stream isn't at it.
+ */
+static int
+aio_stream_close (struct aio_stream * st, const char * name)
+{
+  size_t len = strlen (name), pos;
+
+  aio_stream_skip (st);
+  pos = st->pos;
+
+  if (!aio_stream_at (st, "</") || st->size - pos < len + 3
+      || memcmp (st->buf + pos + 2, name, len))
+    return 0;
+
+  pos += len + 2;
+  while (pos < st->size && isspace ((unsigned char) st->buf[pos]))
+    pos++;
+
+  if (pos >= st->size || st->buf[pos] != '>')
+    return 0;
+
+  st->pos = pos + 1;
+  return 1;
+}
+
+/* Reads an empty element, such as '<goal t="..."/>' or
+ *  '<goal t="..."></goal>'.
+ *  input:
+ *    st - the stream.
+ *    name - the name of the element.
+ *  output:
+ *    0 on success, 1 if the file isn't as expected, -1 on memory error.
+ */
+static int
+aio_stream_elem (struct aio_stream * st, const char * name)
+{
+  int ret, empty;
+
+  ret = aio_stream_tag (st, name, &empty);
+  if (ret != 0)
+    return ret;
+
+  if (!empty && !aio_stream_close (st, name))
+    return AIO_STREAM_ODD;
+
+  return 0;
+}
+
+/* Reads a whole number from the values of a tag.
+ *  input:
+ *    st - the stream.
+ *    id - the attribute holding the number.
+ *    num - receives the number, if the attribute is there.
+ *  output:
+ *    0 on success, 1 if the value isn't a number.
+ */
+static int
+aio_stream_int (struct aio_stream * st, int id, int * num)
+{
+  char * end;
 
-      ret = aio_write_text (xml, sd);
-      if (ret == -1)
-	return -1;
+  if (st->off[id] == -1)
+    return 0;
 
-      ret = xmlTextWriterEndElement (xml);
-      if (ret < 0) XML_ERR (-1);
+  *num = strtol (st->vals + st->off[id], &end, 10);
+  if (end == st->vals + st->off[id] || *end != '\0')
+    return AIO_STREAM_ODD;
+
+  return 0;
+}
+
+/* Reads the references of a line from the values of a tag.
+ *  input:
+ *    st - the stream.
+ *    refs - receives the references, terminated by REF_END.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+aio_stream_refs (struct aio_stream * st, short ** refs)
+{
+  const char * ref_str, * pos;
+  int num_refs = 1, i = 0;
+
+  *refs = NULL;
+  if (st->off[AA_REF] == -1)
+    return 0;
+
+  ref_str = st->vals + st->off[AA_REF];
+  for (pos = ref_str; *pos; pos++)
+    {
+      if (*pos == ',')
+        num_refs++;
     }
 
-  // End <conclusions> tag.
-  ret = xmlTextWriterEndElement (xml);
-  if (ret < 0) XML_ERR (-1);
+  *refs = (short *) calloc (num_refs + 1, sizeof (short));
+  CHECK_ALLOC (*refs, AEC_MEM);
 
-  // End <proof> tag.
-  ret = xmlTextWriterEndElement (xml);
-  if (ret < 0) XML_ERR (-1);
+  for (pos = ref_str; *pos; )
+    {
+      char * end;
+      long ref;
 
-  // End the document.
-  ret = xmlTextWriterEndDocument (xml);
-  if (ret < 0) XML_ERR (-1);
+      ref = strtol (pos, &end, 10);
+      if (end != pos)
+        (*refs)[i++] = (short) ref;
 
-  xmlFreeTextWriter (xml);
+      pos = strchr (end, ',');
+      if (!pos)
+        break;
+      pos++;
+    }
+  (*refs)[i] = REF_END;
 
   return 0;
 }
 
-/* Opens a proof.
+/* Reads the lines of one section of a proof.
+ *  input:
+ *    st - the stream.
+ *    tag - the tag of the section.
+ *    proof - the proof to add the lines to.
+ *    line - the number of the next line, which is advanced.
+ *  output:
+ *    0 on success, 1 if the file isn't as expected, -1 on memory error.
+ */
+static int
+aio_stream_lines (struct aio_stream * st, const char * tag, proof_t * proof,
+                  int * line)
+{
+  int premise, ret, empty;
+
+  premise = !strcmp (tag, PREMISE_TAG);
+
+  ret = aio_stream_tag (st, tag, &empty);
+  if (ret != 0 || empty)
+    return ret;
+
+  while (!aio_stream_close (st, tag))
+    {
+      unsigned char * text;
+      char * file = NULL;
+      short * refs = NULL;
+      int rule = -1, depth = 0, line_num = 0, sub = 0;
+      sen_data * sd;
+      item_t * itm;
+
+      ret = aio_stream_elem (st, SENTENCE_ENTRY);
+      if (ret != 0)
+        return ret;
+
+      if (st->off[AA_TEXT] == -1
+          || aio_stream_int (st, AA_LINE, &line_num)
+          || aio_stream_int (st, AA_RULE, &rule)
+          || aio_stream_int (st, AA_DEPTH, &depth))
+        return AIO_STREAM_ODD;
+
+      text = normalize_conns (UNS_CAST (st->vals + st->off[AA_TEXT]));
+      CHECK_ALLOC (text, AEC_MEM);
+
+      if (premise)
+        {
+          sd = sen_data_init (line_num, -1, text, NULL, 1, NULL, 0, 0, NULL);
+        }
+      else
+        {
+          if (aio_stream_refs (st, &refs) < 0)
+            return AEC_MEM;
+
+          if (st->off[AA_FILE] != -1 && st->vals[st->off[AA_FILE]] != '\0')
+            file = st->vals + st->off[AA_FILE];
+
+          if (proof->everything->tail)
+            sub = (depth > ((sen_data *) proof->everything->tail->value)->depth);
+
+          sd = sen_data_init (line_num, rule, text, refs, 0, UNS_CAST file,
+                              0, depth, NULL);
+          free (refs);
+        }
+
+      free (text);
+      if (!sd)
+        return AEC_MEM;
+
+      sd->subproof = sub;
+      sd->line_num = (*line)++;
+
+      itm = ls_push_obj (proof->everything, sd);
+      if (!itm)
+        return AEC_MEM;
+    }
+
+  return 0;
+}
+
+/* Reads a proof with the streaming loader.
+ *  input:
+ *    st - the stream, at the start of the file.
+ *    proof - the proof to read into.
+ *  output:
+ *    0 on success, 1 if the file isn't as expected, -1 on memory error.
+ */
+static int
+aio_stream_proof (struct aio_stream * st, proof_t * proof)
+{
+  int ret, empty, line = 1;
+
+  if (aio_stream_at (st, "\xEF\xBB\xBF"))
+    st->pos += 3;
+
+  aio_stream_skip (st);
+  if (aio_stream_at (st, "<?xml"))
+    {
+      const char * end, * enc;
+
+      end = memchr (st->buf + st->pos, '>', st->size - st->pos);
+      if (!end)
+        return AIO_STREAM_ODD;
+
+      // Only UTF-8 is read here.  The declaration is searched alone,
+      //  since the file has no terminator.
+      enc = aio_find (st->buf + st->pos, end, "encoding");
+      if (enc)
+        {
+          enc += strlen ("encoding");
+          while (enc < end && *enc != '\"' && *enc != '\'')
+            enc++;
+
+          if (end - enc < 6 || (strncmp (enc + 1, "UTF-8", 5)
+                                && strncmp (enc + 1, "utf-8", 5)))
+            return AIO_STREAM_ODD;
+        }
+
+      st->pos = end + 1 - st->buf;
+    }
+
+  ret = aio_stream_tag (st, PROOF_TAG, &empty);
+  if (ret != 0 || empty)
+    return (ret != 0) ? ret : AIO_STREAM_ODD;
+
+  if (st->off[AA_MODE] != -1)
+    proof->boolean = !strcmp (st->vals + st->off[AA_MODE], "boolean");
+
+  // Read the goals.
+  ret = aio_stream_tag (st, GOAL_TAG, &empty);
+  if (ret != 0)
+    return ret;
+
+  while (!empty && !aio_stream_close (st, GOAL_TAG))
+    {
+      unsigned char * goal_text;
+
+      ret = aio_stream_elem (st, GOAL_ENTRY);
+      if (ret != 0)
+        return ret;
+
+      if (st->off[AA_TEXT] == -1)
+        return AIO_STREAM_ODD;
+
+      goal_text = normalize_conns (UNS_CAST (st->vals + st->off[AA_TEXT]));
+      CHECK_ALLOC (goal_text, AEC_MEM);
+
+      if (!ls_push_obj (proof->goals, goal_text))
+        return AEC_MEM;
+    }
+
+  ret = aio_stream_lines (st, PREMISE_TAG, proof, &line);
+  if (ret != 0)
+    return ret;
+
+  ret = aio_stream_lines (st, CONCLUSION_TAG, proof, &line);
+  if (ret != 0)
+    return ret;
+
+  if (!aio_stream_close (st, PROOF_TAG))
+    return AIO_STREAM_ODD;
+
+  aio_stream_skip (st);
+  return (st->pos == st->size) ? 0 : AIO_STREAM_ODD;
+}
+
+/* Reads a proof from a buffer with the streaming loader.
+ *  input:
+ *    buf - the text of the proof.
+ *    size - the length of the text.
+ *    proof - receives the read proof.
+ *  output:
+ *    0 on success, 1 if the proof should be read through libxml2,
+ *    -1 on memory error.
+ */
+static int
+aio_read_stream (const char * buf, size_t size, proof_t ** proof)
+{
+  struct aio_stream st;
+  int ret;
+
+  memset (&st, 0, sizeof (st));
+  st.buf = buf;
+  st.size = size;
+
+  *proof = proof_init ();
+  if (!*proof)
+    return AEC_MEM;
+
+  ret = aio_stream_proof (&st, *proof);
+  free (st.vals);
+
+  if (ret != 0)
+    {
+      item_t * itm;
+
+      for (itm = (*proof)->everything->head; itm; itm = itm->next)
+        sen_data_destroy (itm->value);
+
+      proof_destroy (*proof);
+      free (*proof);
+      *proof = NULL;
+    }
+
+  return ret;
+}
+
+/* Opens a proof with the streaming loader.
  *  input:
  *    file_name - the name of the file to open.
+ *    proof - receives the opened proof.
  *  output:
- *    the opened proof, or NULL on error.
+ *    0 on success, 1 if the file should be read through libxml2,
+ *    -1 on memory error.
  */
-proof_t *
-aio_open (const char * file_name)
+static int
+aio_open_stream (const char * file_name, proof_t ** proof)
 {
-  if (file_name == NULL)
-    return NULL;
+  char * buf = NULL;
+  int ret, mapped = 0;
+  long size = 0;
+
+#ifndef WIN32
+  struct stat sbuf;
+  int fd;
+
+  fd = open (file_name, O_RDONLY);
+  if (fd < 0)
+    return AIO_STREAM_ODD;
+
+  if (fstat (fd, &sbuf) == 0 && sbuf.st_size > 0)
+    {
+      size = sbuf.st_size;
+      buf = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (buf != MAP_FAILED)
+        mapped = 1;
+      else
+        buf = NULL;
+    }
+  close (fd);
+#endif
+
+  if (!buf)
+    {
+      FILE * file;
+
+      file = fopen (file_name, "rb");
+      if (!file)
+        return AIO_STREAM_ODD;
+
+      if (fseek (file, 0, SEEK_END) || (size = ftell (file)) <= 0
+          || fseek (file, 0, SEEK_SET))
+        {
+          fclose (file);
+          return AIO_STREAM_ODD;
+        }
+
+      buf = (char *) calloc (size + 1, sizeof (char));
+      if (!buf)
+        {
+          fclose (file);
+          PERROR (NULL);
+          return AEC_MEM;
+        }
+
+      size = fread (buf, 1, size, file);
+      fclose (file);
+    }
+
+  ret = aio_read_stream (buf, size, proof);
+
+#ifndef WIN32
+  if (mapped)
+    munmap (buf, size);
+  else
+#endif
+    free (buf);
+
+  return ret;
+}
 
+/* Reads a proof through libxml2.
+ *  input:
+ *    xml - the reader for the proof, which is freed.
+ *  output:
+ *    the read proof, or NULL on error.
+ */
+static proof_t *
+aio_read_xml (xmlTextReader * xml)
+{
   proof_t * proof;
-  xmlTextReader * xml;
+
+  if (!xml) XML_ERR (NULL);
 
   proof = proof_init ();
   if (!proof)
     return NULL;
 
-  xml = xmlReaderForFile (file_name, NULL, 0);
-  if (!xml) XML_ERR (NULL);
-
   xmlChar * buffer, * name;
   int ret;
   int depth;
@@ -682,8 +1339,13 @@ aio_open (const char * file_name)
 
 	      IF_FREE (name);
 
+	      unsigned char * goal_text;
+	      goal_text = normalize_conns (buffer);
+	      CHECK_ALLOC (goal_text, NULL);
+	      free (buffer);
+
 	      item_t * ret_itm;
-	      ret_itm = ls_push_obj (proof->goals, buffer);
+	      ret_itm = ls_push_obj (proof->goals, goal_text);
 	      if (!ret_itm)
 		return NULL;
 	    }
@@ -822,3 +1484,51 @@ aio_open (const char * file_name)
 
   return proof;
 }
+
+/* Opens a proof.
+ *  input:
+ *    file_name - the name of the file to open.
+ *  output:
+ *    the opened proof, or NULL on error.
+ */
+proof_t *
+aio_open (const char * file_name)
+{
+  proof_t * proof;
+  int ret;
+
+  if (file_name == NULL)
+    return NULL;
+
+  ret = aio_open_stream (file_name, &proof);
+  if (ret == AEC_MEM)
+    return NULL;
+
+  if (ret == AIO_STREAM_ODD)
+    proof = aio_read_xml (xmlReaderForFile (file_name, NULL, 0));
+
+  return proof;
+}
+
+/* Opens a proof from the text of a proof file.
+ *  input:
+ *    buf - the text.
+ *    size - the length of the text.
+ *  output:
+ *    the opened proof, or NULL on error.
+ */
+proof_t *
+aio_open_buffer (const char * buf, size_t size)
+{
+  proof_t * proof;
+  int ret;
+
+  ret = aio_read_stream (buf, size, &proof);
+  if (ret == AEC_MEM)
+    return NULL;
+
+  if (ret == AIO_STREAM_ODD)
+    proof = aio_read_xml (xmlReaderForMemory (buf, size, NULL, NULL, 0));
+
+  return proof;
+}
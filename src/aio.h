@@ -58,5 +58,6 @@
 
 int aio_save (proof_t * proof, const char * file_name);
 proof_t * aio_open (const char * file_name);
+proof_t * aio_open_buffer (const char * buf, size_t size);
 
 #endif /* ARIS_A_IO_H */
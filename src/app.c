@@ -33,6 +33,7 @@
 #include "sen-parent.h"
 #include "menu.h"
 #include "conf-file.h"
+#include "autosave.h"
 
 #include "and-conn.xpm"
 #include "or-conn.xpm"
@@ -110,12 +111,17 @@ init_app (int boolean, int verbose)
 
   the_app_init_conn_pixbufs (app);
 
+  app->conn_cache = init_list ();
+  if (!app->conn_cache)
+    return NULL;
+
   app->rt = rules_table_init (boolean);
   gtk_window_set_icon (GTK_WINDOW (app->rt->window), app->icon);
 
   app->rt->boolean = boolean;
   app->boolean = boolean;
   app->verbose = verbose;
+  app->undo_budget = UNDO_BUDGET;
 
   app->working_dir = (char *) calloc (1024, sizeof (char));
   app->help_file = (char *) calloc (1024, sizeof (char));
@@ -156,6 +162,50 @@ the_app_init_conn_pixbufs (aris_app * app)
   return 0;
 }
 
+/* Gets the connective pixbufs scaled to a font size, scaling them
+ *  the first time that size is asked for.
+ * The pixbufs are shared by every sentence parent, and are kept for
+ *  as long as the application runs.
+ *  input:
+ *    size - the font size, in points.
+ *  output:
+ *    the scaled pixbufs, in the order of the_app->conn_pixbufs,
+ *    or NULL on memory error.
+ */
+GdkPixbuf **
+the_app_get_scaled_conns (int size)
+{
+  struct conn_pixbuf_set * set;
+  item_t * itm;
+  int i;
+
+  for (itm = the_app->conn_cache->head; itm; itm = itm->next)
+    {
+      set = itm->value;
+      if (set->size == size)
+        return set->pixbufs;
+    }
+
+  set = (struct conn_pixbuf_set *) calloc (1, sizeof (struct conn_pixbuf_set));
+  CHECK_ALLOC (set, NULL);
+
+  set->size = size;
+  for (i = 0; i < NUM_CONNS; i++)
+    {
+      set->pixbufs[i] = gdk_pixbuf_scale_simple (the_app->conn_pixbufs[i],
+                                                 size, size,
+                                                 GDK_INTERP_BILINEAR);
+      g_object_set_data (G_OBJECT (set->pixbufs[i]),
+                         _("conn"), (gpointer) conn_list[i]);
+    }
+
+  itm = ls_push_obj (the_app->conn_cache, set);
+  if (!itm)
+    return NULL;
+
+  return set->pixbufs;
+}
+
 /* Gets a connective from the application by the connective type.
  *  input:
  *    type - the type of the connective to get.
@@ -477,6 +527,9 @@ the_app_add_gui (aris_proof * ap)
   if (!itm)
     return AEC_MEM;
 
+  if (autosave_start () == AEC_MEM)
+    return AEC_MEM;
+
   gtk_window_set_icon (GTK_WINDOW (SEN_PARENT (ap)->window), the_app->icon);
   gtk_window_set_icon (GTK_WINDOW (SEN_PARENT (ap->goal)->window), the_app->icon);
 
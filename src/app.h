@@ -61,6 +61,8 @@ struct aris_app {
 
   GdkPixbuf * conn_pixbufs[NUM_CONNS];   /* Holds the default
                                      connective pixbufs. */
+  list_t * conn_cache;   /* Holds the connective pixbufs scaled
+                            for each font size in use. */
 
   GdkPixbuf * icon;      // The icon of the application.
   list_t * guis;         // The list of guis in the application
@@ -72,11 +74,20 @@ struct aris_app {
   char * ip_addr;        // The IP Address of the grade server.
   char * grade_pass;     // The password to the grade server.
   char * grade_dir;      // The directory in the ftp server to cd to.
+  size_t undo_budget;    // The memory each proof's undo history may use.
 
   int boolean : 1;  // Whether boolean mode was specified.
   int verbose : 1;  // Whether verbose was specified.
 };
 
+// A set of connective pixbufs scaled to one font size, shared by
+//  every sentence parent that uses that size.
+
+struct conn_pixbuf_set {
+  int size;                         // The font size, in points.
+  GdkPixbuf * pixbufs[NUM_CONNS];   // The scaled pixbufs.
+};
+
 // The structure for submission entries.
 // Might not need this anymore.
 
@@ -100,6 +111,7 @@ int the_app_submit (const char * user_email, const char * instr_email,
 
 GdkPixbuf * the_app_get_conn_by_type (char * type);
 int the_app_init_conn_pixbufs (aris_app * app);
+GdkPixbuf ** the_app_get_scaled_conns (int size);
 int the_app_get_color_by_type (aris_app * app, char * type);
 char * the_app_get_color_by_index (aris_app * app, int index);
 int the_app_get_font_by_name (aris_app * app, char * name);
@@ -30,6 +30,7 @@
 #include "app.h"
 #include "menu.h"
 #include "proof.h"
+#include "proof-edit.h"
 #include "sen-data.h"
 #include "var.h"
 #include "goal.h"
@@ -41,6 +42,9 @@
 #include "aio.h"
 #include "vec.h"
 #include "undo.h"
+#include "live-check.h"
+#include "autosave.h"
+#include "session-log.h"
 
 #include "sentence-screen-keyboard.h"
 
@@ -104,7 +108,7 @@ aris_proof_init ()
   if (!ap->selected)
     return NULL;
 
-  ap->undo_stack = init_vec (sizeof (undo_info));
+  ap->undo_stack = undo_ring_init ();
   if (!ap->undo_stack)
     return NULL;
   ap->undo_pt = -1;
@@ -167,31 +171,23 @@ int
 aris_proof_post_init (aris_proof * ap)
 {
   sen_data * sd;
-  sentence * sen;
 
-  // Initialize the separator
+  // Initialize the separator, which is placed by the layout.
   SEN_PARENT (ap)->separator = gtk_separator_new (GTK_ORIENTATION_HORIZONTAL);
+  gtk_widget_set_no_show_all (SEN_PARENT (ap)->separator, TRUE);
+  gtk_grid_attach (GTK_GRID (SEN_PARENT (ap)->container),
+                   SEN_PARENT (ap)->separator, 0, 0, 1, 1);
 
   sd = SEN_DATA_DEFAULT (1, 0, 0);
   if (!sd)
     return AEC_MEM;
 
-  sen = sentence_init (sd, (sen_parent *) ap, NULL);
-  if (!sen)
-    return AEC_MEM;
-
-  gtk_grid_attach_next_to (GTK_GRID (SEN_PARENT (ap)->container),
-                           sen->panel, NULL, GTK_POS_BOTTOM, 1, 1);
-
-  item_t * itm = ls_push_obj (SEN_PARENT (ap)->everything, sen);
+  item_t * itm = sen_parent_splice_sentence (SEN_PARENT (ap), sd, NULL);
   if (!itm)
     return AEC_MEM;
 
   ap->fin_prem = SEN_PARENT (ap)->focused = SEN_PARENT (ap)->everything->head;
 
-  gtk_grid_attach_next_to (GTK_GRID (SEN_PARENT (ap)->container),
-                           SEN_PARENT (ap)->separator, NULL, GTK_POS_BOTTOM, 1, 1);
-
   // Clear the undo stack.
   ap->undo_pt = -1;
   while (ap->undo_stack->num_stuff > ap->undo_pt + 1)
@@ -252,7 +248,7 @@ aris_proof_init_from_proof (proof_t * proof)
   g_signal_connect (G_OBJECT (SEN_PARENT (ap)->window), "focus-in-event",
                     G_CALLBACK (window_focus_in), (gpointer) ap);
 
-  ap->undo_stack = init_vec (sizeof (undo_info));
+  ap->undo_stack = undo_ring_init ();
   if (!ap->undo_stack)
     return NULL;
   ap->undo_pt = -1;
@@ -271,6 +267,9 @@ aris_proof_init_from_proof (proof_t * proof)
       if (first == 1)
         {
           SEN_PARENT (ap)->separator = gtk_separator_new (GTK_ORIENTATION_HORIZONTAL);
+          gtk_widget_set_no_show_all (SEN_PARENT (ap)->separator, TRUE);
+          gtk_grid_attach (GTK_GRID (SEN_PARENT (ap)->container),
+                           SEN_PARENT (ap)->separator, 0, 0, 1, 1);
           item_t * itm;
 
           itm = sen_parent_ins_sentence ((sen_parent *) ap, sd, NULL, 0);
@@ -278,9 +277,6 @@ aris_proof_init_from_proof (proof_t * proof)
             return NULL;
 
           ap->fin_prem = SEN_PARENT (ap)->focused = SEN_PARENT (ap)->everything->head;
-          gtk_grid_attach_next_to (GTK_GRID (SEN_PARENT (ap)->container),
-                                   SEN_PARENT (ap)->separator, NULL, GTK_POS_BOTTOM,
-                                   1, 1);
 
           first = 0;
         }
@@ -297,7 +293,7 @@ aris_proof_init_from_proof (proof_t * proof)
     return NULL;
 
   gtk_widget_show_all (SEN_PARENT (ap)->window);
-  gtk_widget_grab_focus (((sentence *) SEN_PARENT (ap)->everything->head->value)->entry);
+  sentence_grab_focus (SEN_PARENT (ap)->everything->head->value);
    
   init_sentence_screen_keyboard(&(ap->sp)); // Initialize the screen keyboard for logic operations
 
@@ -330,6 +326,16 @@ aris_proof_destroy (aris_proof * ap)
   ap->fin_prem = NULL;
   ap->sb_text = NULL;
 
+  if (ap->live_timer)
+    g_source_remove (ap->live_timer);
+  ap->live_timer = 0;
+
+  autosave_forget (ap);
+
+  if (ap->undo_stack)
+    undo_ring_destroy (ap->undo_stack);
+  ap->undo_stack = NULL;
+
   goal_destroy (ap->goal);
   if (ap->selected)
     {
@@ -372,6 +378,7 @@ aris_proof_create_menu (sen_parent * ap)
       main_menu_conf[CONF_MENU_ADD_CONC],
       main_menu_conf[CONF_MENU_ADD_SUB],
       main_menu_conf[CONF_MENU_END_SUB],
+      main_menu_conf[CONF_MENU_FOLD],
       menu_separator,
       main_menu_conf[CONF_MENU_UNDO],
       main_menu_conf[CONF_MENU_REDO],
@@ -386,6 +393,7 @@ aris_proof_create_menu (sen_parent * ap)
       menu_separator,
       main_menu_conf[CONF_MENU_GOAL],
       main_menu_conf[CONF_MENU_BOOLEAN],
+      main_menu_conf[CONF_MENU_LIVE],
       main_menu_conf[CONF_MENU_IMPORT]
     },
     (conf_obj[]) {
@@ -439,6 +447,9 @@ aris_proof_set_changed (aris_proof * ap, int changed, undo_info ui)
   new_title = (char *) calloc (strlen (title) + 4, sizeof (char));
   CHECK_ALLOC (new_title, AEC_MEM);
   pos = sprintf (new_title, "%s", title);
+  if (changed)
+    ap->changes++;
+
   if (changed && !ap->edited)
     {
       // The data has been modified, so add an asterisk to the title.
@@ -460,51 +471,115 @@ aris_proof_set_changed (aris_proof * ap, int changed, undo_info ui)
   return 0;
 }
 
-/* Adjusts the line number of each sentence in an aris proof.
+/* Moves the line numbers in the labels of the lemma menu items.
  *  input:
- *    ap - the aris proof to adjust the line numbers of.
- *    itm - the iterator in ap->everything to begin at.
- *    mod - modifier for each sentence, either 1 or -1.
+ *    ap - the aris proof whose lemmas moved.
+ *    lines - the sorted line numbers at which lines were inserted or
+ *            removed.
+ *    num - the number of entries in lines.
+ *    mod - the amount that each entry in lines moves the lines from it on.
  *  output:
- *    0 on success, -1 on error.
+ *    0 on success, -1 on memory error.
  */
-int
-aris_proof_adjust_lines (aris_proof * ap, item_t * itm, int mod)
+static int
+aris_proof_adjust_lemmas (aris_proof * ap, const int * lines, int num, int mod)
 {
-  int line_mod = 1;
-  line_mod *= mod;
+  GtkWidget * menu, * submenu;
+  GList * gl, * gl_itr;
 
-  int cur_line = sentence_get_line_no ((sentence *) itm->value);
-  item_t * ev_itr;
+  gl = gtk_container_get_children (GTK_CONTAINER (SEN_PARENT (ap)->menubar));
+  menu = g_list_nth_data (gl, RULES_MENU);
+  g_list_free (gl);
+  submenu = gtk_menu_item_get_submenu (GTK_MENU_ITEM (menu));
 
-  for (ev_itr = itm->next; ev_itr; ev_itr = ev_itr->next)
+  gl = gtk_container_get_children (GTK_CONTAINER (submenu));
+  for (gl_itr = gl; gl_itr; gl_itr = gl_itr->next)
     {
-      int new_line_no, ret, old_ln;
-      sentence * ev_sen;
+      const char * label;
+      char * file_name, * new_label;
+      int chk, line_num, new_line, lbl_len;
 
-      ev_sen = ev_itr->value;
-      if (!ev_sen)
-        exit (EXIT_FAILURE);
+      if (GTK_IS_SEPARATOR_MENU_ITEM (gl_itr->data))
+        continue;
 
-      old_ln = sentence_get_line_no (ev_sen);
-      new_line_no = old_ln + line_mod;
-      ret = sentence_update_line_no (ev_sen, new_line_no);
-      if (ret == AEC_MEM)
-        return AEC_MEM;
+      label = gtk_menu_item_get_label (GTK_MENU_ITEM (gl_itr->data));
+      lbl_len = strlen (label);
 
-      int i;
+      file_name = (char *) calloc (lbl_len, sizeof (char));
+      CHECK_ALLOC (file_name, AEC_MEM);
 
-      for (i = 0; i < SEN_DEPTH(ev_sen); i++)
+      chk = sscanf (label, "%i - %s", &line_num, file_name);
+      if (chk == 2)
+        new_line = proof_move_line (lines, num, mod, line_num);
+
+      if (chk != 2 || new_line == line_num)
         {
-          // Update all of the indices that are greater than the removed/inserted line.
-          if (SEN_IND(ev_sen,i) >= cur_line)
-            sentence_set_index (ev_sen, i, SEN_IND(ev_sen,i) + line_mod);
+          free (file_name);
+          continue;
         }
+
+      new_label = (char *) calloc (lbl_len + 16, sizeof (char));
+      CHECK_ALLOC (new_label, AEC_MEM);
+
+      sprintf (new_label, "%i - %s", new_line, file_name);
+      free (file_name);
+
+      gtk_menu_item_set_label (GTK_MENU_ITEM (gl_itr->data), new_label);
+      free (new_label);
     }
 
+  g_list_free (gl);
   return 0;
 }
 
+/* Renumbers the sentences of an aris proof, after lines have been
+ *  inserted or removed.
+ * A sentence's line number is its place in the proof's tree, so nothing
+ *  is stored per line; only the labels of the sentences in view, and the
+ *  lemma menu, need to be changed.  The rest are labeled once shown.
+ *  input:
+ *    ap - the aris proof to renumber.
+ *    lines - the sorted line numbers at which lines were inserted or
+ *            removed.
+ *    num - the number of entries in lines.
+ *    mod - the amount that each entry in lines moves the lines from it on.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+aris_proof_renumber (aris_proof * ap, const int * lines, int num, int mod)
+{
+  item_t * itm;
+
+  for (itm = SEN_PARENT (ap)->realized->head; itm; itm = itm->next)
+    {
+      sentence * sen = itm->value;
+      int ret;
+
+      ret = sentence_update_line_no (sen, sentence_get_line_no (sen));
+      if (ret == AEC_MEM)
+        return AEC_MEM;
+    }
+
+  return aris_proof_adjust_lemmas (ap, lines, num, mod);
+}
+
+/* Adjusts the line number of each sentence in an aris proof.
+ *  input:
+ *    ap - the aris proof to adjust the line numbers of.
+ *    itm - the iterator in ap->everything to begin at.
+ *    mod - modifier for each sentence, either 1 or -1.
+ *  output:
+ *    0 on success, -1 on error.
+ */
+int
+aris_proof_adjust_lines (aris_proof * ap, item_t * itm, int mod)
+{
+  int cur_line = sentence_get_line_no ((sentence *) itm->value);
+
+  return aris_proof_renumber (ap, &cur_line, 1, mod);
+}
+
 /* Copies an aris proof into a data proof.
  *  input:
  *    ap - the aris proof to copy in.
@@ -550,24 +625,54 @@ aris_proof_to_proof (aris_proof * ap)
   return proof;
 }
 
-/* Creates a sentence for an aris proof.
+/* Adds an item for a lemma to the rules menu of an aris proof.
  *  input:
- *    ap - the aris proof to create a sentence for.
- *    sd - the sentence data to initialize the new sentence from.
- *    undo - whether or not to create undo information
+ *    ap - the aris proof to which the lemma belongs.
+ *    file - the file that the lemma comes from.
+ *    ln - the line number of the lemma.
  *  output:
- *    the newly created sentence, or NULL on error.
+ *    0 on success, -1 on memory error.
  */
-sentence *
-aris_proof_create_sentence (aris_proof * ap, sen_data * sd, int undo)
+static int
+aris_proof_add_lemma (aris_proof * ap, const char * file, int ln)
 {
-  sentence * sen;
-  item_t * itm, * fcs;
-  item_t * foc_1, * foc_2;
+  int file_len, alloc_size;
+  GtkWidget * menu_item, * menu, * submenu;
+  GList * gl;
+  char * label;
+
+  file_len = strlen (file);
+  alloc_size = file_len + 4 + 1 + (int) log10 (ln);
+  label = (char *) calloc (alloc_size, sizeof (char));
+  CHECK_ALLOC (label, AEC_MEM);
+
+  sprintf (label, "%i - %s", ln, file);
+  menu_item = gtk_menu_item_new_with_label (label);
+  free (label);
+
+  gl = gtk_container_get_children (GTK_CONTAINER (SEN_PARENT (ap)->menubar));
+  menu = g_list_nth_data (gl, RULES_MENU);
+  g_list_free (gl);
+  submenu = gtk_menu_item_get_submenu (GTK_MENU_ITEM (menu));
+  gtk_menu_shell_append (GTK_MENU_SHELL (submenu), menu_item);
+  gtk_widget_show (menu_item);
+
+  return 0;
+}
 
-  // Is the new sentence a premise?
+/* Determines the item after which a sentence is to be inserted.
+ *  input:
+ *    ap - the aris proof into which the sentence is being inserted.
+ *    premise - whether or not the sentence is a premise.
+ *  output:
+ *    the item after which to insert the sentence.
+ */
+static item_t *
+aris_proof_insertion_point (aris_proof * ap, int premise)
+{
+  item_t * foc_1, * foc_2, * fcs;
 
-  if (sd->premise)
+  if (premise)
     {
       foc_1 = SEN_PARENT (ap)->focused;
       foc_2 = ap->fin_prem;
@@ -586,6 +691,25 @@ aris_proof_create_sentence (aris_proof * ap, sen_data * sd, int undo)
       exit (EXIT_FAILURE);
     }
 
+  return fcs;
+}
+
+/* Creates a sentence for an aris proof.
+ *  input:
+ *    ap - the aris proof to create a sentence for.
+ *    sd - the sentence data to initialize the new sentence from.
+ *    undo - whether or not to create undo information
+ *  output:
+ *    the newly created sentence, or NULL on error.
+ */
+sentence *
+aris_proof_create_sentence (aris_proof * ap, sen_data * sd, int undo)
+{
+  sentence * sen;
+  item_t * itm, * fcs;
+
+  fcs = aris_proof_insertion_point (ap, sd->premise);
+
   if (sd->depth == -1)
     {
       sd->depth = SEN_DEPTH(fcs->value) - 1;
@@ -609,7 +733,14 @@ aris_proof_create_sentence (aris_proof * ap, sen_data * sd, int undo)
   if (ret < 0)
     return NULL;
 
+  aris_proof_refold (ap);
+
+  if (gtk_widget_get_mapped (SEN_PARENT (ap)->window))
+    sen_parent_set_focus (SEN_PARENT (ap), itm);
+
   sen = itm->value;
+  session_log (SLO_INS, sentence_get_line_no (sen), "%i %i %i",
+               sd->premise, sd->subproof, sd->depth);
 
   //fprintf (stderr, "create_sentence: sen->line_num == %i\n", sentence_get_line_no (sen));
 
@@ -624,28 +755,121 @@ aris_proof_create_sentence (aris_proof * ap, sen_data * sd, int undo)
 
   if (sd->rule == RULE_LM && sd->file)
     {
-      int file_len, alloc_size, ln;
-      GtkWidget * menu_item, * menu, * submenu;
-      GList * gl;
-      char * label;
+      ret = aris_proof_add_lemma (ap, sd->file, sentence_get_line_no (sen));
+      if (ret < 0)
+        return NULL;
+    }
+  
+  return sen;
+}
 
-      ln = sentence_get_line_no (sen);
-      file_len = strlen (sd->file);
-      alloc_size = file_len + 4 + 1 + (int) log10 (ln);
-      label = (char *) calloc (alloc_size, sizeof (char));
-      CHECK_ALLOC (label, NULL);
+/* Inserts several sentences into an aris proof at once.
+ * The sentences are spliced in after one another, the labels in view
+ *  are renumbered once, and a single undo record is made.
+ *  Only the last of them is focused; the rest are given widgets once
+ *  they are scrolled into view.
+ *  input:
+ *    ap - the aris proof into which to insert the sentences.
+ *    sds - the sentence data from which to initialize the sentences.
+ *    fcs - the item after which to insert the sentences.
+ *    undo - whether or not to create undo information.
+ *  output:
+ *    the item of the last new sentence, or NULL on error.
+ */
+item_t *
+aris_proof_insert_sentences (aris_proof * ap, list_t * sds, item_t * fcs,
+                             int undo)
+{
+  sen_parent * sp = SEN_PARENT (ap);
+  item_t * sd_itr, * itm, * prev;
+  int first_line, ret;
 
-      sprintf (label, "%i - %s", ln, sd->file);
-      menu_item = gtk_menu_item_new_with_label (label);
+  if (!sds->head)
+    return fcs;
 
-      gl = gtk_container_get_children (GTK_CONTAINER (SEN_PARENT (ap)->menubar));
-      menu = g_list_nth_data (gl, RULES_MENU);
-      submenu = gtk_menu_item_get_submenu (GTK_MENU_ITEM (menu));
-      gtk_menu_shell_append (GTK_MENU_SHELL (submenu), menu_item);
-      gtk_widget_show (menu_item);
+  first_line = sentence_get_line_no (fcs->value) + 1;
+
+  itm = fcs;
+  for (sd_itr = sds->head; sd_itr; sd_itr = sd_itr->next)
+    {
+      sen_data * sd = sd_itr->value;
+
+      if (sd->depth == -1)
+        {
+          sd->depth = SEN_DEPTH(itm->value) - 1;
+        }
+      else if (sd->depth == DEPTH_DEFAULT)
+        {
+          sd->depth = SEN_DEPTH(itm->value);
+          if (sd->subproof)
+            sd->depth++;
+        }
+
+      prev = itm;
+      itm = sen_parent_splice_sentence (sp, sd, prev);
+      if (!itm)
+        return NULL;
+
+      if (sd->premise && prev == ap->fin_prem)
+        ap->fin_prem = itm;
     }
-  
-  return sen;
+
+  ret = aris_proof_renumber (ap, &first_line, 1, sds->num_stuff);
+  if (ret < 0)
+    return NULL;
+
+  list_t * ls = NULL;
+  undo_info ui = { 0 };
+  ui.type = -1;
+
+  if (undo)
+    {
+      ls = init_list ();
+      if (!ls)
+        return NULL;
+    }
+
+  for (sd_itr = sds->head, prev = fcs->next; sd_itr;
+       sd_itr = sd_itr->next, prev = prev->next)
+    {
+      sen_data * sd = sd_itr->value;
+
+      if (sd->rule == RULE_LM && sd->file)
+        {
+          ret = aris_proof_add_lemma (ap, sd->file,
+                                      sentence_get_line_no (prev->value));
+          if (ret < 0)
+            return NULL;
+        }
+
+      if (ls)
+        {
+          sen_data * undo_sd;
+
+          undo_sd = sentence_copy_to_data (prev->value);
+          if (!undo_sd || !ls_push_obj (ls, undo_sd))
+            return NULL;
+        }
+    }
+
+  if (ls)
+    {
+      ui = undo_info_init (ap, ls, UIT_ADD_SEN);
+      if (ui.type == -1)
+        return NULL;
+    }
+
+  ret = aris_proof_set_changed (ap, 1, ui);
+  if (ret < 0)
+    return NULL;
+
+  sp->focused = itm;
+  aris_proof_refold (ap);
+  if (gtk_widget_get_mapped (sp->window))
+    sentence_grab_focus (itm->value);
+  sen_parent_queue_view (sp);
+
+  return itm;
 }
 
 /* Convenience function to create a new premise for an aris proof.
@@ -758,6 +982,118 @@ aris_proof_end_sub (aris_proof * ap)
   return sen;
 }
 
+/* Compares two line numbers, for qsort.
+ *  input:
+ *    a, b - the line numbers to compare.
+ *  output:
+ *    less than, equal to, or greater than zero as a is before, at,
+ *    or after b.
+ */
+static int
+aris_proof_cmp_lines (const void * a, const void * b)
+{
+  return *(const int *) a - *(const int *) b;
+}
+
+/* Compares two sentence data by line number, for qsort.
+ *  input:
+ *    a, b - pointers to the sentence data to compare.
+ *  output:
+ *    less than, equal to, or greater than zero as a is before, at,
+ *    or after b.
+ */
+static int
+aris_proof_cmp_data (const void * a, const void * b)
+{
+  return (*(sen_data * const *) a)->line_num
+    - (*(sen_data * const *) b)->line_num;
+}
+
+/* Removes several sentences from an aris proof at once.
+ * The sentences are unlinked together, and the labels in view are
+ *  renumbered once, after all of them are gone.
+ *  input:
+ *    ap - the aris proof from which to remove the sentences.
+ *    sens - the sentences to remove.
+ *  output:
+ *    0 on success, -1 on error, 1 if one of them is the first line.
+ */
+int
+aris_proof_remove_sentences (aris_proof * ap, list_t * sens)
+{
+  sen_parent * sp = SEN_PARENT (ap);
+  item_t * sen_itr;
+  list_t * rem;
+  int * lines, num = 0, i, ret, fin_ln;
+
+  if (!sens->head)
+    return 0;
+
+  lines = (int *) calloc (sens->num_stuff, sizeof (int));
+  CHECK_ALLOC (lines, AEC_MEM);
+
+  for (sen_itr = sens->head; sen_itr; sen_itr = sen_itr->next)
+    {
+      int ln = sentence_get_line_no (sen_itr->value);
+      if (ln == 1)
+        {
+          free (lines);
+          return 1;
+        }
+      lines[num++] = ln;
+    }
+
+  qsort (lines, num, sizeof (int), aris_proof_cmp_lines);
+
+  // A sentence may have been given more than once.
+  for (i = 1, ret = 1; i < num; i++)
+    {
+      if (lines[i] != lines[ret - 1])
+        lines[ret++] = lines[i];
+    }
+  num = ret;
+
+  // Each line is removed once, however often it was given.
+  rem = init_list ();
+  if (!rem)
+    {
+      free (lines);
+      return AEC_MEM;
+    }
+
+  for (i = 0; i < num; i++)
+    {
+      if (!ls_push_obj (rem, sen_parent_nth_line (sp, lines[i])))
+        {
+          destroy_list (rem);
+          free (lines);
+          return AEC_MEM;
+        }
+    }
+
+  // The last premise moves back past any premises removed from the end.
+  if (ap->fin_prem)
+    {
+      fin_ln = sentence_get_line_no (ap->fin_prem->value);
+      for (i = num - 1; i >= 0 && lines[i] > fin_ln; i--);
+      for (; i >= 0 && lines[i] == fin_ln; i--, fin_ln--)
+        ap->fin_prem = ap->fin_prem->prev;
+    }
+
+  sen_parent_rem_sentences (sp, rem);
+  destroy_list (rem);
+
+  ret = aris_proof_renumber (ap, lines, num, -1);
+  free (lines);
+  if (ret < 0)
+    return AEC_MEM;
+
+  aris_proof_refold (ap);
+  sen_parent_queue_view (sp);
+
+  return 0;
+}
+
 /* Removes a sentence from an aris proof.
  *  input:
  *    ap - the aris proof from which to remove a sentence.
@@ -768,23 +1104,21 @@ aris_proof_end_sub (aris_proof * ap)
 int
 aris_proof_remove_sentence (aris_proof * ap, sentence * sen)
 {
-  if (sentence_get_line_no (sen) == 1)
-    return 1;
-
-  int have_fin_prem = (ap->fin_prem->value == sen) ? 1 : 0;
+  list_t * ls;
+  int ret;
 
-  item_t * target = sen_parent_rem_sentence ((sen_parent *) ap, sen);
-  if (!target)
+  ls = init_list ();
+  if (!ls)
     return AEC_MEM;
 
-  if (have_fin_prem)
-    ap->fin_prem = SEN_PARENT (ap)->focused;
-
-  int ret = aris_proof_adjust_lines (ap, target, -1);
-  if (ret < 0)
+  if (!ls_push_obj (ls, sen))
     return AEC_MEM;
 
-  return 0;
+  session_log (SLO_REM, sentence_get_line_no (sen), NULL);
+  ret = aris_proof_remove_sentences (ap, ls);
+  destroy_list (ls);
+
+  return ret;
 }
 
 /* Sets the font of an aris proof.
@@ -920,7 +1254,7 @@ aris_proof_copy (aris_proof * ap)
       sen_depth = SEN_DEPTH(sen);
 
       item_t * ev_itr;
-      ev_itr = ls_find (SEN_PARENT(ap)->everything, sen);
+      ev_itr = sen->itm;
       for (ev_itr = ev_itr->next; ev_itr; ev_itr = ev_itr->next)
         {
           sentence * ev_sen;
@@ -1023,6 +1357,47 @@ aris_proof_copy (aris_proof * ap)
   return 0;
 }
 
+/* Copies sentences of an aris proof into sentence data, in the order
+ *  that they appear in the proof.
+ *  input:
+ *    sens - the sentences to copy.
+ *  output:
+ *    a list of the copies, or NULL on memory error.
+ */
+static list_t *
+aris_proof_sentences_to_data (list_t * sens)
+{
+  list_t * ls;
+  sen_data ** sds;
+  item_t * itm;
+  int i, num = 0;
+
+  sds = (sen_data **) calloc (sens->num_stuff + 1, sizeof (sen_data *));
+  CHECK_ALLOC (sds, NULL);
+
+  for (itm = sens->head; itm; itm = itm->next)
+    {
+      sds[num] = sentence_copy_to_data (itm->value);
+      if (!sds[num++])
+        return NULL;
+    }
+
+  qsort (sds, num, sizeof (sen_data *), aris_proof_cmp_data);
+
+  ls = init_list ();
+  if (!ls)
+    return NULL;
+
+  for (i = 0; i < num; i++)
+    {
+      if (!ls_push_obj (ls, sds[i]))
+        return NULL;
+    }
+
+  free (sds);
+  return ls;
+}
+
 /* Kills the selected line(s) from an aris proof.
  *  input:
  *    ap - The aris proof from which sentences are being copied.
@@ -1037,61 +1412,64 @@ aris_proof_kill (aris_proof * ap)
   if (ret_chk == AEC_MEM)
     return AEC_MEM;
   
+  session_log_lines (SLO_KILL, 0, ap->yanked);
+
   item_t * sel_itr = ap->yanked->head;
 
   undo_info ui;
   list_t * ls, * sen_ls;
-  ls = init_list ();
-  if (!ls)
-    return AEC_MEM;
-
-  sen_ls = init_list ();
-  if (!sen_ls)
-    return AEC_MEM;
-
-  item_t * push_chk;
+  int * lines, num = 0, i;
 
-  /* Since refs will be changing, set up undo information and
-   *  the list of sentences before removing anything.
-   */
+  lines = (int *) calloc (ap->yanked->num_stuff, sizeof (int));
+  CHECK_ALLOC (lines, AEC_MEM);
 
   for (; sel_itr; sel_itr = sel_itr->next)
-    {
-      sen_data * sd = sel_itr->value;
+    lines[num++] = ((sen_data *) sel_itr->value)->line_num;
 
-      // This is really inefficient.
-      item_t * ev_itr = ls_nth (SEN_PARENT (ap)->everything, sd->line_num - 1);
+  qsort (lines, num, sizeof (int), aris_proof_cmp_lines);
 
-      sentence * sen;
-      sen = ev_itr->value;
-      sen_data * undo_sd;
+  sen_ls = init_list ();
+  if (!sen_ls)
+    {
+      free (lines);
+      return AEC_MEM;
+    }
 
-      // This will fix the differences with depth and refs imposed by copy.
-      undo_sd = sentence_copy_to_data (sen);
-      push_chk = ls_push_obj (ls, undo_sd);
-      if (!push_chk)
-        return AEC_MEM;
+  for (i = 0; i < num; i++)
+    {
+      // A line within a selected subproof may also have been selected.
+      if (i > 0 && lines[i] == lines[i - 1])
+        continue;
 
-      push_chk = ls_push_obj (sen_ls, sen);
-      if (!push_chk)
-        return AEC_MEM;
+      if (!ls_push_obj (sen_ls, sen_parent_nth_line (SEN_PARENT (ap),
+                                                     lines[i])))
+        {
+          free (lines);
+          return AEC_MEM;
+        }
     }
+  free (lines);
 
-  item_t * n_itr;
+  /* Since refs will be changing, set up undo information
+   *  before removing anything.
+   * This will fix the differences with depth and refs imposed by copy.
+   */
 
-  for (sel_itr = sen_ls->head; sel_itr;)
+  ls = aris_proof_sentences_to_data (sen_ls);
+  if (!ls)
+    return AEC_MEM;
+
+  ret_chk = aris_proof_remove_sentences (ap, sen_ls);
+  destroy_list (sen_ls);
+  if (ret_chk == AEC_MEM)
+    return AEC_MEM;
+  if (ret_chk == 1)
     {
-      sentence * sen = sel_itr->value;
-      ret_chk = aris_proof_remove_sentence (ap, sen);
-      if (ret_chk == AEC_MEM)
-        return AEC_MEM;
-      if (ret_chk == 1)
-        return 1;
-      n_itr = sel_itr->next;
-      free (sel_itr);
-      sel_itr = n_itr;
+      for (sel_itr = ls->head; sel_itr; sel_itr = sel_itr->next)
+        sen_data_destroy (sel_itr->value);
+      destroy_list (ls);
+      return 1;
     }
-  free (sen_ls);
 
   ui = undo_info_init (ap, ls, UIT_REM_SEN);
   if (ui.type == -1)
@@ -1114,23 +1492,34 @@ aris_proof_kill (aris_proof * ap)
 int
 aris_proof_yank (aris_proof * ap)
 {
-  if (!ap->yanked)
+  if (!ap->yanked || !ap->yanked->head)
     return 0;
 
-  list_t * ls;
+  list_t * ls, * run;
+  item_t * yank_itr, * itm;
+  int ret, line_num, premise;
+
   ls = init_list ();
   if (!ls)
     return AEC_MEM;
 
-  item_t * yank_itr;
-  int ret, line_num;
+  /* Work from copies, so that the yanked lines stay relative
+   *  and can be yanked again.
+   */
+
   line_num = sentence_get_line_no ((sentence *)SEN_PARENT(ap)->focused->value);
+  session_log (SLO_YANK, line_num, NULL);
   for (yank_itr = ap->yanked->head; yank_itr; yank_itr = yank_itr->next)
     {
-      line_num++;
-      sentence * sen;
       sen_data * sd;
-      sd = yank_itr->value;
+
+      line_num++;
+      sd = (sen_data *) calloc (1, sizeof (sen_data));
+      CHECK_ALLOC (sd, AEC_MEM);
+
+      ret = sen_data_copy (yank_itr->value, sd);
+      if (ret == AEC_MEM)
+        return AEC_MEM;
 
       if (sd->refs)
         {
@@ -1143,12 +1532,64 @@ aris_proof_yank (aris_proof * ap)
             }
         }
 
-      sen = aris_proof_create_sentence (ap, sd, 0);
-      if (!sen)
+      if (!ls_push_obj (ls, sd))
         return AEC_MEM;
-      ls_push_obj (ls, sentence_copy_to_data (sen));
     }
 
+  /* Premises and other lines go in different places, so insert each
+   *  run of them separately, but keep one undo record for the lot.
+   */
+
+  run = init_list ();
+  if (!run)
+    return AEC_MEM;
+
+  list_t * new_sens;
+  new_sens = init_list ();
+  if (!new_sens)
+    return AEC_MEM;
+
+  for (yank_itr = ls->head; yank_itr;)
+    {
+      item_t * fcs, * new_itr;
+
+      premise = ((sen_data *) yank_itr->value)->premise;
+      for (; yank_itr && ((sen_data *) yank_itr->value)->premise == premise;
+           yank_itr = yank_itr->next)
+        {
+          if (!ls_push_obj (run, yank_itr->value))
+            return AEC_MEM;
+        }
+
+      fcs = aris_proof_insertion_point (ap, premise);
+      itm = aris_proof_insert_sentences (ap, run, fcs, 0);
+      if (!itm)
+        return AEC_MEM;
+
+      for (new_itr = fcs->next; ; new_itr = new_itr->next)
+        {
+          if (!ls_push_obj (new_sens, new_itr->value))
+            return AEC_MEM;
+
+          if (new_itr == itm)
+            break;
+        }
+
+      ls_clear (run);
+    }
+
+  free (run);
+
+  for (yank_itr = ls->head; yank_itr; yank_itr = yank_itr->next)
+    sen_data_destroy (yank_itr->value);
+  destroy_list (ls);
+
+  // Record the new lines in order, now that their numbers are settled.
+  ls = aris_proof_sentences_to_data (new_sens);
+  destroy_list (new_sens);
+  if (!ls)
+    return AEC_MEM;
+
   undo_info ui;
   ui = undo_info_init (ap, ls, UIT_ADD_SEN);
   if (ui.type == -1)
@@ -1276,6 +1717,196 @@ aris_proof_toggle_boolean_mode (aris_proof * ap)
   return 0;
 }
 
+/* Toggles checking the lines of an aris proof as they are edited.
+ *  input:
+ *    ap - the aris proof for which live checking is being toggled.
+ *  output:
+ *    0 on success.
+ */
+int
+aris_proof_toggle_live_mode (aris_proof * ap)
+{
+  item_t * ev_itr;
+
+  ap->live = (ap->live) ? 0 : 1;
+
+  if (!ap->live)
+    {
+      if (ap->live_timer)
+        g_source_remove (ap->live_timer);
+      ap->live_timer = 0;
+
+      aris_proof_set_sb (ap, _("Live checking disabled."));
+      return 0;
+    }
+
+  // Start off with the whole proof checked.
+  for (ev_itr = SEN_PARENT (ap)->everything->head; ev_itr;
+       ev_itr = ev_itr->next)
+    live_check_mark (ev_itr->value);
+
+  aris_proof_set_sb (ap, _("Live checking enabled."));
+  return 0;
+}
+
+/* Hides the bodies of the folded subproofs of an aris proof, and shows
+ *  the rest of its lines.
+ * The assumption and the last line of a folded subproof stay shown.
+ *  A fold that would hide the focused line is undone.
+ *  input:
+ *    ap - the aris proof to refold.
+ *  output:
+ *    none.
+ */
+void
+aris_proof_refold (aris_proof * ap)
+{
+  sen_parent * sp = SEN_PARENT (ap);
+  item_t * ev_itr, * last;
+  sentence * fold_sen;
+  int fold_depth;
+
+  if (!ap->folded)
+    return;
+
+ refold:
+  ap->folded = 0;
+  fold_depth = -1;
+  fold_sen = NULL;
+  last = NULL;
+
+  for (ev_itr = sp->everything->head; ev_itr; ev_itr = ev_itr->next)
+    {
+      sentence * sen = ev_itr->value;
+      int depth = SEN_DEPTH (sen);
+
+      if (SEN_SUB (sen) && sen->folded)
+        ap->folded++;
+
+      // The line before this one ends the folded subproof.
+      if (fold_depth >= 0
+          && (depth < fold_depth || (SEN_SUB (sen) && depth == fold_depth)))
+        {
+          sentence_set_hidden (last->value, 0);
+          fold_depth = -1;
+        }
+
+      if (fold_depth >= 0)
+        {
+          if (ev_itr == sp->focused)
+            {
+              sentence_set_folded (fold_sen, 0);
+              goto refold;
+            }
+
+          sentence_set_hidden (sen, 1);
+        }
+      else
+        {
+          sentence_set_hidden (sen, 0);
+          if (SEN_SUB (sen) && sen->folded)
+            {
+              fold_depth = depth;
+              fold_sen = sen;
+            }
+        }
+
+      last = ev_itr;
+    }
+
+  if (fold_depth >= 0)
+    sentence_set_hidden (last->value, 0);
+}
+
+/* Folds or unfolds the subproof containing the focused line of an
+ *  aris proof.
+ *  input:
+ *    ap - the aris proof in which to fold a subproof.
+ *  output:
+ *    0 on success, 1 if the focused line is not in a subproof.
+ */
+int
+aris_proof_toggle_fold (aris_proof * ap)
+{
+  sen_parent * sp = SEN_PARENT (ap);
+  item_t * itm = sp->focused;
+  sentence * sen = itm->value;
+  int depth = SEN_DEPTH (sen);
+
+  if (depth == 0)
+    {
+      aris_proof_set_sb (ap, _("The current line is not in a subproof."));
+      return 1;
+    }
+
+  // Find the assumption of the innermost subproof holding the line.
+  for (; itm; itm = itm->prev)
+    {
+      sen = itm->value;
+      if (SEN_SUB (sen) && SEN_DEPTH (sen) == depth)
+        break;
+    }
+
+  if (!itm)
+    return 1;
+
+  sentence_set_folded (sen, !sen->folded);
+  if (sen->folded)
+    {
+      sen_parent_set_focus (sp, itm);
+      aris_proof_set_sb (ap, _("Subproof folded."));
+    }
+  else
+    {
+      aris_proof_set_sb (ap, _("Subproof unfolded."));
+    }
+
+  // Make sure that the proof is refolded, even if this was the last fold.
+  ap->folded++;
+  aris_proof_refold (ap);
+  sen_parent_queue_view (sp);
+
+  return 0;
+}
+
+/* Unfolds the subproofs that hide a line of an aris proof.
+ *  input:
+ *    ap - the aris proof containing the line.
+ *    sen - the line to show.
+ *  output:
+ *    none.
+ */
+void
+aris_proof_reveal (aris_proof * ap, sentence * sen)
+{
+  item_t * itm;
+  int depth = SEN_DEPTH (sen);
+
+  itm = sen->itm;
+
+  // An assumption is held by the subproof one level up.
+  if (SEN_SUB (sen))
+    depth--;
+
+  // Each subproof holding the line starts before it, one level up
+  //  from the last.
+  for (itm = itm->prev; itm && depth > 0; itm = itm->prev)
+    {
+      sentence * ev_sen = itm->value;
+
+      if (!SEN_SUB (ev_sen) || SEN_DEPTH (ev_sen) != depth)
+        continue;
+
+      if (ev_sen->folded)
+        sentence_set_folded (ev_sen, 0);
+      depth--;
+    }
+
+  ap->folded++;
+  aris_proof_refold (ap);
+  sen_parent_queue_view (SEN_PARENT (ap));
+}
+
 /* Imports a proof into the current proof.
  *  input:
  *    ap - The current proof.
@@ -1320,13 +1951,29 @@ aris_proof_import_proof (aris_proof * ap)
   if (!proof)
     return AEC_MEM;
 
-  item_t * ev_itr, * pf_itr, * ev_conc = NULL;
-  int ref_num = 0;
+  item_t * ev_itr, * pf_itr, * ev_conc = NULL, * fcs, * itm;
+  list_t * new_prems, * new_lemmas, * new_sens;
+  int ref_num = 0, prem_line;
   short * refs;
 
   refs = (short *) calloc (proof->everything->num_stuff, sizeof (int));
   CHECK_ALLOC (refs, AEC_MEM);
 
+  new_prems = init_list ();
+  if (!new_prems)
+    return AEC_MEM;
+
+  new_lemmas = init_list ();
+  if (!new_lemmas)
+    return AEC_MEM;
+
+  new_sens = init_list ();
+  if (!new_sens)
+    return AEC_MEM;
+
+  // Any premises that are missing will follow the last premise.
+  prem_line = sentence_get_line_no (ap->fin_prem->value);
+
   for (pf_itr = proof->everything->head; pf_itr;
        pf_itr = pf_itr->next)
     {
@@ -1365,19 +2012,46 @@ aris_proof_import_proof (aris_proof * ap)
 
       if (!ev_itr || !SEN_PREM(ev_itr->value))
         {
-          sentence * sen_chk;
-          int ln;
+          item_t * np_itr;
+          int ln = prem_line;
+
+          // The same premise may appear twice in the imported proof.
+          for (np_itr = new_prems->head; np_itr; np_itr = np_itr->next)
+            {
+              ln++;
+              if (!strcmp (((sen_data *) np_itr->value)->text, pf_text))
+                break;
+            }
+
+          if (!np_itr)
+            {
+              if (!ls_push_obj (new_prems, sd))
+                return AEC_MEM;
+              ln++;
+            }
 
-          sen_chk = aris_proof_create_sentence (ap, sd, 1);
-          if (!sen_chk)
-            return AEC_MEM;
-          ln = sentence_get_line_no (sen_chk);
           refs[ref_num++] = (short) ln;
         }
     }
 
   refs[ref_num] = REF_END;
 
+  if (new_prems->head)
+    {
+      itm = aris_proof_insert_sentences (ap, new_prems, ap->fin_prem, 0);
+      if (!itm)
+        return AEC_MEM;
+
+      // These are put in order once they are recorded.
+      for (fcs = itm; ; fcs = fcs->prev)
+        {
+          if (!ls_push_obj (new_sens, fcs->value))
+            return AEC_MEM;
+          if (new_sens->num_stuff == new_prems->num_stuff)
+            break;
+        }
+    }
+
   if (!ev_conc)
     {
       for (ev_itr = SEN_PARENT(ap)->everything->head; ev_itr;
@@ -1414,19 +2088,58 @@ aris_proof_import_proof (aris_proof * ap)
       if (!ev_itr)
         {
           sen_data * sd;
-          sentence * sen_chk;
 
           sd = sen_data_init (-1, RULE_LM, pf_text, refs,
                               0, filename, 0, DEPTH_DEFAULT, NULL);
           if (!sd)
             return AEC_MEM;
 
-          sen_chk = aris_proof_create_sentence (ap, sd, 1);
-          if (!sen_chk)
+          if (!ls_push_obj (new_lemmas, sd))
             return AEC_MEM;
         }
     }
 
+  if (new_lemmas->head)
+    {
+      fcs = aris_proof_insertion_point (ap, 0);
+      itm = aris_proof_insert_sentences (ap, new_lemmas, fcs, 0);
+      if (!itm)
+        return AEC_MEM;
+
+      for (fcs = fcs->next; ; fcs = fcs->next)
+        {
+          if (!ls_push_obj (new_sens, fcs->value))
+            return AEC_MEM;
+          if (fcs == itm)
+            break;
+        }
+    }
+
+  // The whole import is undone at once.
+  if (new_sens->head)
+    {
+      list_t * ls;
+      undo_info ui;
+
+      ls = aris_proof_sentences_to_data (new_sens);
+      if (!ls)
+        return AEC_MEM;
+
+      ui = undo_info_init (ap, ls, UIT_ADD_SEN);
+      if (ui.type == -1)
+        return AEC_MEM;
+
+      ret = aris_proof_set_changed (ap, 1, ui);
+      if (ret < 0)
+        return AEC_MEM;
+    }
+
+  for (pf_itr = new_lemmas->head; pf_itr; pf_itr = pf_itr->next)
+    sen_data_destroy (pf_itr->value);
+  destroy_list (new_lemmas);
+  destroy_list (new_prems);
+  destroy_list (new_sens);
+
   free (refs);
   proof_destroy (proof);
   return 0;
@@ -1442,40 +2155,8 @@ aris_proof_import_proof (aris_proof * ap)
 int
 aris_proof_undo_stack_push (aris_proof * ap, undo_info ui)
 {
-  if (ui.type == -1)
-    return 1;
-
-  if (ui.type == UIT_MOD_TEXT
-      && ap->undo_stack->num_stuff > 0
-      && ap->undo_pt >= 0)
-    {
-      undo_info * last;
-      last = vec_nth (ap->undo_stack, ap->undo_pt);
-      if (last->type == UIT_MOD_TEXT)
-        {
-          sen_data * lsd = (sen_data *) last->ls->head->value;
-          sen_data * usd = (sen_data *) ui.ls->head->value;
-          if (ui.stamp - last->stamp <= UNDO_INT
-              && lsd->line_num == usd->line_num)
-            {
-              last->stamp = ui.stamp;
-              undo_info_destroy (ui);
-              return 0;
-            }
-        }
-    }
-
-  int rc;
-  while (ap->undo_stack->num_stuff > ap->undo_pt + 1)
-    rc = aris_proof_undo_stack_pop (ap);
-
-  rc = vec_add_obj (ap->undo_stack, &ui);
-  if (rc == AEC_MEM)
-    return AEC_MEM;
-
-  ap->undo_pt++;
-
-  return 0;
+  return undo_ring_record (ap->undo_stack, &ap->undo_pt, ui,
+                           the_app->undo_budget);
 }
 
 /* Pop an object off of an undo stack.
@@ -1487,16 +2168,7 @@ aris_proof_undo_stack_push (aris_proof * ap, undo_info ui)
 int
 aris_proof_undo_stack_pop (aris_proof * ap)
 {
-  if (ap->undo_stack->num_stuff == 0)
-    return 0;
-
-  undo_info * ui;
-  ui = vec_nth (ap->undo_stack, ap->undo_stack->num_stuff - 1);
-
-  undo_info_destroy (*ui);
-
-  vec_pop_obj (ap->undo_stack);
-
+  undo_ring_pop (ap->undo_stack);
   return 0;
 }
 
@@ -1530,7 +2202,7 @@ aris_proof_undo (aris_proof * ap, int undo)
       pt = ap->undo_pt + 1;
     }
 
-  ui = vec_nth (ap->undo_stack, pt);
+  ui = undo_ring_nth (ap->undo_stack, pt);
 
   ap->undo_pt += (undo) ? -1 : 1;
 
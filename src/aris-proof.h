@@ -45,8 +45,18 @@ struct aris_proof {
   char * sb_text;	// The statusbar text - may not be needed.
   int boolean : 1;	// Whether or not the proof is in boolean mode.
 
-  vec_t * undo_stack;	// The stack of previous actions to undo.
+  undo_ring * undo_stack;	// The stack of previous actions to undo.
   int undo_pt;		// The position within the undo stack.
+
+  int live : 1;		// Whether or not lines are checked as they are edited.
+  guint live_timer;	// The source of the pending live check.
+
+  int folded;		// The number of folded subproofs.
+
+  unsigned int changes;		// The number of changes made to the proof.
+  unsigned int saved_changes;	// The change count when last autosaved.
+  autosave_job * autosave;	// The pending autosave of this proof.
+  GHashTable * saved;	// The lines of the last autosave, by sentence.
 };
 
 aris_proof * aris_proof_init ();
@@ -62,12 +72,15 @@ int aris_proof_adjust_lines (aris_proof * ap, item_t * itm, int mod);
 proof_t * aris_proof_to_proof (aris_proof * ap);
 
 sentence * aris_proof_create_sentence (aris_proof * ap, sen_data * sd, int ui);
+item_t * aris_proof_insert_sentences (aris_proof * ap, list_t * sds,
+                                      item_t * fcs, int undo);
 sentence * aris_proof_create_new_prem (aris_proof * ap);
 sentence * aris_proof_create_new_conc (aris_proof * ap);
 sentence * aris_proof_create_new_sub (aris_proof * ap);
 sentence * aris_proof_end_sub (aris_proof * ap);
 
 int aris_proof_remove_sentence (aris_proof * ap, sentence * sen);
+int aris_proof_remove_sentences (aris_proof * ap, list_t * sens);
 
 void aris_proof_set_font (aris_proof * ap, int font);
 void aris_proof_set_sb (aris_proof * ap, char * sb_text);
@@ -82,6 +95,11 @@ int aris_proof_select_sentence (aris_proof * ap, sentence * sen);
 int aris_proof_deselect_sentence (aris_proof * ap, sentence * sen);
 
 int aris_proof_toggle_boolean_mode (aris_proof * ap);
+int aris_proof_toggle_live_mode (aris_proof * ap);
+
+void aris_proof_refold (aris_proof * ap);
+int aris_proof_toggle_fold (aris_proof * ap);
+void aris_proof_reveal (aris_proof * ap, sentence * sen);
 
 int aris_proof_submit (aris_proof * ap, const char * hw,
 		       const char * user_email,
@@ -20,6 +20,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <getopt.h>
+#include <glib.h>
+#include <libxml/parser.h>
 
 #include "process.h"
 #include "vec.h"
@@ -30,8 +32,13 @@
 #include "aio.h"
 #include "rules.h"
 #include "config.h"
-#include "interop-isar.h"
+#include "corpus.h"
+#include "report.h"
+#include "thy-cache.h"
+#include "thy-import.h"
+#include "rule-template.h"
 #include "menu.h"
+#include "session-log.h"
 
 #ifdef ARIS_GUI
 #include <gtk/gtk.h>
@@ -60,6 +67,16 @@ static struct option const long_opts[] =
     {"latex", required_argument, NULL, 'x'},
     {"version", no_argument, NULL, 0},
     {"help", no_argument, NULL, 'h'},
+    {"templates", required_argument, NULL, 'T'},
+    {"undo-limit", required_argument, NULL, 'u'},
+    {"record", required_argument, NULL, 'R'},
+    {"replay", required_argument, NULL, 'P'},
+    {"import-thy", required_argument, NULL, 'I'},
+    {"jobs", required_argument, NULL, 'j'},
+    {"corpus", required_argument, NULL, 'C'},
+    {"corpus-pack", required_argument, NULL, 'K'},
+    {"results", required_argument, NULL, 'o'},
+    {"report", required_argument, NULL, 'F'},
     {NULL, 0, NULL, 0}
   };
 
@@ -79,13 +96,22 @@ enum ARG_FLAGS {
 
 struct arg_items {
   char flags;
-  char * file_name[256];
-  char * latex_name[256];
+  vec_t * file_names;
+  vec_t * latex_names;
   char * conclusion;
   vec_t * prems;
   char rule[3];
   char * rule_file;
   vec_t * vars;
+  long undo_limit;
+  char * record_name;
+  char * replay_name;
+  char * import_dir;
+  int jobs;
+  char * corpus_name;
+  char * pack_name;
+  char * results_name;
+  char * report_format;
 };
 
 /* Lists the rules.
@@ -184,16 +210,32 @@ usage (int status)
 to designate it as arbitrary.\n");
   printf ("  -b, --boolean                  Run Aris in boolean mode.\n");
   printf ("  -c, --conclusion=CONCLUSION    Set CONCLUSION as the conclusion.\n");
+  printf ("  -C, --corpus=CORPUS            Grade every proof in CORPUS.\n");
   printf ("  -e, --evaluate                 Run Aris in evaluation mode.\n");
   printf ("  -f, --file=FILE                Evaluate FILE.\n");
+  printf ("  -F, --report=FORMAT            Grade each file, writing a report in FORMAT,\n");
+  printf ("                                  'json' or 'csv', as each one is graded.\n");
   printf ("  -g, --grade                    Grade files specified in the file flag.\n");
+  printf ("  -I, --import-thy=DIR           Translate every theory under DIR to a proof file.\n");
+  printf ("  -j, --jobs=N                   Translate or convert up to N files at once.\n");
+  printf ("  -K, --corpus-pack=CORPUS       Pack the files specified in the file flag into CORPUS.\n");
+  printf ("                                  Without a file flag, the names are read from standard input.\n");
+  printf ("                                  CORPUS is compressed if its name ends in '.gz'.\n");
   printf ("  -l, --list                     List the available rules.\n");
+  printf ("  -o, --results=FILE             Write the grades or the report to FILE.\n");
   printf ("  -p, --premise PREMISE          Use PREMISE as a premise.\n");
+  printf ("  -P, --replay=LOG               Replay the editing session in LOG on the first file\n");
+  printf ("                                  and print the latency of each kind of operation\n");
+  printf ("                                  in the editing model, without the GUI.\n");
   printf ("  -r, --rule RULE                Set RULE as the rule.\n");
   printf ("                                  Use 'lm:/path/to/file' to designate a file.\n");
+  printf ("  -R, --record=LOG               Record the editing session to LOG.\n");
   printf ("  -t, --text TEXT                Simply check the correctness of TEXT.\n");
+  printf ("  -T, --templates=FILE           Load the rule templates in FILE.\n");
+  printf ("  -u, --undo-limit=KB            Limit the undo history of each proof to KB kilobytes.\n");
   printf ("  -v, --verbose                  Print status and error messages.\n");
   printf ("  -x, --latex=FILE               Convert FILE to a LaTeX proof file.\n");
+  printf ("                                  May be given any number of times.\n");
   printf ("  -h, --help                     Print this help and exit.\n");
   printf ("      --version                  Print the version and exit.\n");
   printf ("\n");
@@ -336,6 +378,305 @@ grade_file (proof_t * c_file)
   return grade;
 }
 
+/* Reads file names, one per line, until the end of a file.
+ *  input:
+ *    in - the file from which to read.
+ *    names - the vector to which the names are added.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+read_file_names (FILE * in, vec_t * names)
+{
+  char * line;
+  int len = 0, alloc = 256, ret = 0, more = 1;
+
+  line = (char *) calloc (alloc, sizeof (char));
+  CHECK_ALLOC (line, AEC_MEM);
+
+  while (ret == 0 && more)
+    {
+      more = (fgets (line + len, alloc - len, in) != NULL);
+      len += (more) ? strlen (line + len) : 0;
+
+      if (more && len > 0 && line[len - 1] != '\n')
+        {
+          char * tmp;
+
+          // The line did not fit, so read the rest of it.
+          alloc *= 2;
+          tmp = (char *) realloc (line, alloc);
+          if (!tmp)
+            {
+              PERROR (NULL);
+              ret = AEC_MEM;
+              break;
+            }
+          line = tmp;
+          continue;
+        }
+
+      while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+        line[--len] = '\0';
+
+      if (len > 0)
+        ret = vec_str_add_obj (names, (unsigned char *) line);
+      len = 0;
+    }
+
+  free (line);
+  return ret;
+}
+
+/* Grades every proof in a corpus.
+ * Each proof is read and graded as it comes off the corpus, so only
+ *  one is held at a time.
+ *  input:
+ *    corpus_name - the name of the corpus.
+ *    results_name - the file to write the grades to, or NULL for stdout.
+ *    report_format - the format of the report to write, or NULL to
+ *                    write a line of grades for each entry.
+ *    verbose - whether or not to print the entry being graded.
+ *  output:
+ *    0 on success, -1 on memory error, -2 on i/o error.
+ */
+int
+grade_corpus (const char * corpus_name, const char * results_name,
+              const char * report_format, int verbose)
+{
+  corpus_reader * cr;
+  corpus_entry ce;
+  FILE * results = NULL;
+  report * rp = NULL;
+  int ret, ret_chk = 0;
+
+  cr = corpus_open (corpus_name);
+  if (!cr)
+    return AEC_IO;
+
+  if (report_format)
+    {
+      rp = report_open (report_format, results_name);
+      if (!rp)
+        {
+          corpus_close (cr);
+          return AEC_IO;
+        }
+    }
+  else
+    {
+      results = stdout;
+      if (results_name)
+        {
+          results = fopen (results_name, "w");
+          if (!results)
+            {
+              perror (results_name);
+              corpus_close (cr);
+              return AEC_IO;
+            }
+        }
+    }
+
+  while ((ret = corpus_next (cr, &ce)) == 1)
+    {
+      proof_t * proof;
+      const char * grade;
+
+      if (verbose)
+        fprintf ((rp) ? stderr : stdout, "Grading entry: '%s'\n", ce.id);
+
+      proof = aio_open_buffer (ce.data, ce.size);
+      if (rp)
+        {
+          if (proof)
+            ret_chk = report_file (rp, ce.id, proof);
+          else
+            ret_chk = report_unreadable (rp, ce.id);
+        }
+      else if (!proof)
+        {
+          grade = "unreadable";
+        }
+      else
+        {
+          ret_chk = grade_file (proof);
+          if (ret_chk >= 0)
+            {
+              grade = (ret_chk == 1) ? "passed" : "failed";
+              printf ("\n");
+            }
+        }
+
+      if (proof)
+        {
+          proof_destroy (proof);
+          free (proof);
+        }
+
+      if (ret_chk < 0)
+        {
+          corpus_entry_clear (&ce);
+          break;
+        }
+
+      if (results)
+        fprintf (results, "%s\t%s\t%s\t%s\n",
+                 ce.id, ce.student, ce.assignment, grade);
+      corpus_entry_clear (&ce);
+    }
+
+  corpus_close (cr);
+  if (rp && report_close (rp) < 0)
+    {
+      perror (results_name);
+      return AEC_IO;
+    }
+
+  if (results && results != stdout && fclose (results) != 0)
+    {
+      perror (results_name);
+      return AEC_IO;
+    }
+
+  if (ret_chk < 0)
+    return ret_chk;
+
+  return (ret < 0) ? ret : 0;
+}
+
+// A proof file being converted to LaTeX.
+
+struct latex_job {
+  const char * name;    // The name of the proof file.
+  char * tex_name;      // The name of the LaTeX file.
+  int ret;              // 0 on success, -1 on memory error, -2 on i/o error.
+};
+
+/* Converts one proof file to LaTeX.  Runs on a worker thread.
+ *  input:
+ *    data - the job to run.
+ *    user_data - unused.
+ *  output:
+ *    none.
+ */
+static void
+export_latex_run (gpointer data, gpointer user_data)
+{
+  struct latex_job * job = data;
+  proof_t * proof;
+
+  proof = aio_open (job->name);
+  if (!proof)
+    {
+      job->ret = AEC_IO;
+      return;
+    }
+
+  job->ret = convert_proof_latex (proof, job->tex_name);
+
+  proof_destroy (proof);
+  free (proof);
+}
+
+/* Converts proof files to LaTeX files beside them, on up to jobs
+ *  threads at once.  A file that can't be converted doesn't stop
+ *  the others.
+ *  input:
+ *    names - the names of the proof files.
+ *    jobs - the most files to convert at once.
+ *    verbose - whether or not to print each file that is converted.
+ *  output:
+ *    0 if every file was converted, -1 on memory error,
+ *    -2 if any file couldn't be converted.
+ */
+int
+export_latex (vec_t * names, int jobs, int verbose)
+{
+  struct latex_job * lj;
+  GThreadPool * pool;
+  int i, failed = 0, ret = 0;
+
+  lj = (struct latex_job *) calloc (names->num_stuff, sizeof (struct latex_job));
+  CHECK_ALLOC (lj, AEC_MEM);
+
+  for (i = 0; i < names->num_stuff; i++)
+    {
+      const char * name;
+      int n_len;
+
+      name = (const char *) vec_str_nth (names, i);
+      n_len = strlen (name);
+
+      lj[i].name = name;
+      lj[i].tex_name = (char *) calloc (n_len + 5, sizeof (char));
+      if (!lj[i].tex_name)
+        {
+          PERROR (NULL);
+          ret = AEC_MEM;
+          goto out;
+        }
+
+      // Replace the extension of a .tle file, and add one otherwise.
+      if (n_len > 4 && !strcmp (name + n_len - 4, ".tle"))
+        n_len -= 4;
+      strncpy (lj[i].tex_name, name, n_len);
+      strcpy (lj[i].tex_name + n_len, ".tex");
+    }
+
+  // libxml2 sets itself up lazily, which isn't safe once the workers
+  //  start parsing at the same time.
+  xmlInitParser ();
+
+  pool = g_thread_pool_new (export_latex_run, NULL, jobs, FALSE, NULL);
+  if (!pool)
+    {
+      ret = AEC_MEM;
+      goto out;
+    }
+
+  for (i = 0; i < names->num_stuff; i++)
+    g_thread_pool_push (pool, &lj[i], NULL);
+
+  // Wait for every file to be converted.
+  g_thread_pool_free (pool, FALSE, TRUE);
+
+  for (i = 0; i < names->num_stuff; i++)
+    {
+      if (lj[i].ret == AEC_MEM)
+        {
+          ret = AEC_MEM;
+          goto out;
+        }
+
+      if (lj[i].ret < 0)
+        {
+          fprintf (stderr, "LaTeX Error - unable to convert '%s'.\n",
+                   lj[i].name);
+          failed++;
+        }
+      else if (verbose)
+        {
+          printf ("Converted '%s' to '%s'.\n", lj[i].name, lj[i].tex_name);
+        }
+    }
+
+  if (failed)
+    {
+      fprintf (stderr, "%i of %i files could not be converted.\n",
+               failed, names->num_stuff);
+      ret = AEC_IO;
+    }
+
+ out:
+  // The names that were never allocated are still NULL.
+  for (i = 0; i < names->num_stuff; i++)
+    free (lj[i].tex_name);
+  free (lj);
+
+  return ret;
+}
+
 /* Parses the supplied arguments.
  *  input:
  *   argc, argv - should be self-explanatory.
@@ -348,20 +689,23 @@ parse_args (int argc, char * argv[], struct arg_items * ai)
 {
   int c;
 
-  int cur_file, cur_grade, cur_latex;
+  int cur_grade;
   int opt_len;
   int c_ret;
 
-  cur_file = cur_grade = cur_latex = 0;
+  cur_grade = 0;
   ai->flags = '\0';
   ai->rule_file = NULL;
-  for (c = 0; c < 256; c++)
-    {
-      ai->file_name[c] = NULL;
-      ai->latex_name[c] = NULL;
-    }
-
+  ai->undo_limit = -1;
+  ai->record_name = ai->replay_name = NULL;
+  ai->import_dir = NULL;
+  ai->jobs = 1;
+  ai->corpus_name = ai->pack_name = ai->results_name = NULL;
+  ai->report_format = NULL;
+
+  ai->file_names = init_vec (sizeof (char*));
   ai->prems = init_vec (sizeof (char*));
+  ai->latex_names = init_vec (sizeof (char*));
   ai->vars = init_vec (sizeof (variable));
   memset ((char *) ai->rule, 0, sizeof (char) * 3);
 
@@ -369,13 +713,18 @@ parse_args (int argc, char * argv[], struct arg_items * ai)
   //int got_conc = false, got_rule = false;
   int got_conc = 0, got_rule = 0;
 
+  // Every sentence is normalized to the single byte connectives
+  //  as it is read, so these are the only ones the engine sees.
   main_conns = cli_conns;
 
+  if (rule_template_init () == AEC_MEM)
+    exit (EXIT_FAILURE);
+
   while (1)
     {
       int opt_idx = 0;
 
-      c = getopt_long (argc, argv, "ep:c:r:t:a:f:gi:s:x:lbvh",
+      c = getopt_long (argc, argv, "ep:c:r:t:a:f:gi:s:x:lbvhT:u:R:P:I:j:C:K:o:F:",
                        long_opts, &opt_idx);
 
       if (c == -1)
@@ -391,15 +740,20 @@ parse_args (int argc, char * argv[], struct arg_items * ai)
           if (optarg)
             {
               unsigned char * sexpr_prem;
-              unsigned char * tmp_str;
+              unsigned char * tmp_str, * arg_text;
 
-              c_ret = check_arg_text (optarg);
+              arg_text = normalize_conns (optarg);
+              if (!arg_text)
+                exit (EXIT_FAILURE);
+
+              c_ret = check_arg_text (arg_text);
               if (c_ret == -1 || c_ret == 0)
                 exit (EXIT_FAILURE);
 
-              tmp_str = format_string (optarg);
+              tmp_str = format_string (arg_text);
               if (!tmp_str)
                 exit (EXIT_FAILURE);
+              free (arg_text);
 
               sexpr_prem = convert_sexpr (tmp_str);
               if (!sexpr_prem)
@@ -431,14 +785,19 @@ conclusion must be specified, ignoring conclusion \"%s\".\n", optarg);
                   break;
                 }
 
-              c_ret = check_arg_text (optarg);
+              unsigned char * tmp_str, * arg_text;
+              arg_text = normalize_conns (optarg);
+              if (!arg_text)
+                exit (EXIT_FAILURE);
+
+              c_ret = check_arg_text (arg_text);
               if (c_ret == -1 || c_ret == 0)
                 exit (EXIT_FAILURE);
 
-              unsigned char * tmp_str;
-              tmp_str = format_string (optarg);
+              tmp_str = format_string (arg_text);
               if (!tmp_str)
                 exit (EXIT_FAILURE);
+              free (arg_text);
 
               ai->conclusion = convert_sexpr (tmp_str);
               if (!ai->conclusion)
@@ -458,7 +817,12 @@ requires an argument, ignoring flag.\n");
         case 't':
           if (optarg)
             {
-              c_ret = check_arg_text (optarg);
+              unsigned char * arg_text;
+              arg_text = normalize_conns (optarg);
+              if (!arg_text)
+                exit (EXIT_FAILURE);
+
+              c_ret = check_arg_text (arg_text);
               if (c_ret == -1)
                 exit (EXIT_FAILURE);
               printf ("Correct!\n");
@@ -552,25 +916,10 @@ variable flag requires an argument, ignoring flag.\n");
 
           if (optarg)
             {
-              if (ai->file_name[255])
-                {
-                  fprintf (stderr, "Argument Warning - \
-a maximum of 256 filenames can be specified, ignoring file \"%s\".\n", optarg);
-                  break;
-                }
-
-              int arg_len = strlen (optarg);
-
-              ai->file_name[cur_file] = (char *) calloc (arg_len + 1,
-                                                         sizeof (char));
-              if (!ai->file_name[cur_file])
-                {
-                  PERROR (NULL);
-                  exit (EXIT_FAILURE);
-                }
-
-              strcpy (ai->file_name[cur_file], optarg);
-              cur_file++;
+              c_ret = vec_str_add_obj (ai->file_names,
+                                       (unsigned char *) optarg);
+              if (c_ret == AEC_MEM)
+                exit (EXIT_FAILURE);
             }
           else
             {
@@ -593,18 +942,19 @@ requires a filename, ignoring flag.\n");
               if (!proof)
                 exit (EXIT_FAILURE);
 
-              main_conns = cli_conns;
-              parse_thy (optarg, proof);
+              thy_cache_parse (optarg, proof);
               exit (EXIT_SUCCESS);
             }
 
         case 's':
           if (optarg)
             {
-              main_conns = cli_conns;
+              unsigned char * no_spaces, * sexpr_str, * arg_text;
+              arg_text = normalize_conns (optarg);
+              if (!arg_text)
+                exit (EXIT_FAILURE);
 
-              unsigned char * no_spaces, * sexpr_str;
-              no_spaces = format_string (optarg);
+              no_spaces = format_string (arg_text);
               sexpr_str = convert_sexpr (no_spaces);
               printf ("%s\n", sexpr_str);
               exit (EXIT_SUCCESS);
@@ -625,33 +975,89 @@ requires a filename, ignoring flag.\n");
         case 'x':
           if (optarg)
             {
-              if (ai->latex_name[255])
+              c_ret = vec_str_add_obj (ai->latex_names,
+                                       (unsigned char *) optarg);
+              if (c_ret == AEC_MEM)
+                exit (EXIT_FAILURE);
+            }
+          else
+            {
+              fprintf (stderr, "Argument Warning - \
+latex flag requires a filename, ignoring flag.\n");
+            }
+          break;
+
+        case 'T':
+          if (optarg)
+            {
+              if (rule_template_load (optarg) < 0)
+                exit (EXIT_FAILURE);
+            }
+          break;
+
+        case 'u':
+          if (optarg)
+            {
+              char * end;
+              ai->undo_limit = strtol (optarg, &end, 10);
+              if (*end != '\0' || ai->undo_limit < 0)
                 {
                   fprintf (stderr, "Argument Warning - \
-a maximum of 256 filenames can be specified, ignoring file \"%s\".\n", optarg);
-                  break;
+undo limit must be a number of kilobytes, ignoring flag.\n");
+                  ai->undo_limit = -1;
                 }
+            }
+          break;
 
-              int arg_len = strlen (optarg);
+        case 'R':
+          if (optarg)
+            ai->record_name = optarg;
+          break;
 
-              ai->latex_name[cur_latex] = (char *) calloc (arg_len + 1,
-                                                           sizeof (char));
-              if (!ai->latex_name[cur_latex])
-                {
-                  PERROR (NULL);
-                  exit (EXIT_FAILURE);
-                }
+        case 'P':
+          if (optarg)
+            ai->replay_name = optarg;
+          break;
 
-              strcpy (ai->latex_name[cur_latex], optarg);
-              cur_latex++;
-            }
-          else
+        case 'I':
+          if (optarg)
+            ai->import_dir = optarg;
+          break;
+
+        case 'j':
+          if (optarg)
             {
-              fprintf (stderr, "Argument Warning - \
-grade flag requires a filename, ignoring flag.\n");
+              char * end;
+              ai->jobs = strtol (optarg, &end, 10);
+              if (*end != '\0' || ai->jobs < 1)
+                {
+                  fprintf (stderr, "Argument Warning - \
+jobs must be a positive number, ignoring flag.\n");
+                  ai->jobs = 1;
+                }
             }
           break;
 
+        case 'C':
+          if (optarg)
+            ai->corpus_name = optarg;
+          break;
+
+        case 'K':
+          if (optarg)
+            ai->pack_name = optarg;
+          break;
+
+        case 'o':
+          if (optarg)
+            ai->results_name = optarg;
+          break;
+
+        case 'F':
+          if (optarg)
+            ai->report_format = optarg;
+          break;
+
         case 0:
           if (opt_idx == 14)
             version ();
@@ -683,7 +1089,7 @@ main (int argc, char *argv[])
   unsigned char * conc = NULL;
   char * rule;
   vec_t * vars;
-  char ** file_name, ** latex_name;
+  vec_t * file_names;
   proof_t ** proof;
   int cur_file, cur_latex, grade;
   char * rule_file = NULL;
@@ -699,27 +1105,37 @@ main (int argc, char *argv[])
   verbose = AF_VERBOSE (args.flags);
   evaluate_mode = AF_EVALUATE (args.flags);
   boolean = AF_BOOLEAN (args.flags);
-  file_name = (char **) args.file_name;
-  latex_name = (char **) args.latex_name;
+  file_names = args.file_names;
   grade = AF_GRADE (args.flags);
   rule = args.rule;
   rule_file = args.rule_file;
 
-  cur_file = cur_latex = -1;
+  cur_latex = args.latex_names->num_stuff;
 
-  for (c = 0; c < 256; c++)
+  if (args.pack_name)
     {
-      if (cur_file != -1 && cur_latex != -1)
-        break;
+      // Without any file flags, the names are read from standard input.
+      if (file_names->num_stuff == 0)
+        {
+          c_ret = read_file_names (stdin, file_names);
+          if (c_ret < 0)
+            exit (EXIT_FAILURE);
+        }
 
-      if (cur_file == -1 && !file_name[c])
-        cur_file = c;
+      c_ret = corpus_pack (args.pack_name, file_names);
+      exit ((c_ret == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
 
-      if (cur_latex == -1 && !latex_name[c])
-        cur_latex = c;
+  if (args.corpus_name)
+    {
+      c_ret = grade_corpus (args.corpus_name, args.results_name,
+                            args.report_format, verbose);
+      exit ((c_ret == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
     }
 
-  if (conc == NULL && evaluate_mode && !file_name[0] && !latex_name[0])
+  cur_file = file_names->num_stuff;
+
+  if (conc == NULL && evaluate_mode && cur_file == 0 && cur_latex == 0)
     {
       fprintf (stderr, "Argument Error - \
 a conclusion must be specified in evaluation mode.\n");
@@ -728,34 +1144,46 @@ a conclusion must be specified in evaluation mode.\n");
 
   if (cur_latex > 0)
     {
-      proof = (proof_t **) calloc (cur_latex, sizeof (proof_t *));
-      CHECK_ALLOC (proof, EXIT_FAILURE);
+      c_ret = export_latex (args.latex_names, args.jobs, verbose);
+      exit ((c_ret == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
 
-      for (c = 0; c < cur_latex; c++)
-        {
-          proof[c] = aio_open (latex_name[c]);
-          if (!proof[c])
-            exit (EXIT_FAILURE);
+  if (args.report_format)
+    {
+      report * rp;
+
+      rp = report_open (args.report_format, args.results_name);
+      if (!rp)
+        exit (EXIT_FAILURE);
 
-          char * fname;
-          int n_len;
+      // Each file is read only once the one before it is reported.
+      for (c = 0; c < cur_file; c++)
+        {
+          proof_t * graded;
+          char * name;
 
-          n_len = strlen (latex_name[c]);
-          fname = (char *) calloc (n_len + 1, sizeof (char));
-          CHECK_ALLOC (fname, EXIT_FAILURE);
+          name = (char *) vec_str_nth (file_names, c);
+          if (verbose)
+            fprintf (stderr, "Grading file: '%s'\n", name);
 
-          strncpy (fname, latex_name[c], n_len - 3);
-          sprintf (fname + n_len - 3, "tex");
+          graded = aio_open (name);
+          if (graded)
+            {
+              c_ret = report_file (rp, name, graded);
+              proof_destroy (graded);
+              free (graded);
+            }
+          else
+            {
+              c_ret = report_unreadable (rp, name);
+            }
 
-          c_ret = convert_proof_latex (proof[c], fname);
-          if (c_ret == -1)
+          if (c_ret < 0)
             exit (EXIT_FAILURE);
-
-          proof_destroy (proof[c]);
-          free (proof[c]);
         }
 
-      exit (EXIT_SUCCESS);
+      c_ret = report_close (rp);
+      exit ((c_ret == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
     }
 
   if (cur_file > 0)
@@ -769,16 +1197,35 @@ a conclusion must be specified in evaluation mode.\n");
 
       for (c = 0; c < cur_file; c++)
         {
-          proof[c] = aio_open (file_name[c]);
+          proof[c] = aio_open ((char *) vec_str_nth (file_names, c));
           if (!proof[c])
             exit (EXIT_FAILURE);
         }
     }
 
-  if (evaluate_mode)
+  if (args.import_dir)
     {
-      main_conns = cli_conns;
+      c_ret = thy_import_dir (args.import_dir, args.jobs);
+      exit ((c_ret == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+  if (args.replay_name)
+    {
+      proof_t * replayed;
+
+      replayed = (cur_file > 0) ? proof[0] : proof_init ();
+      if (!replayed)
+        exit (EXIT_FAILURE);
+
+      c_ret = session_replay (replayed, args.replay_name);
+      if (c_ret < 0)
+        exit (EXIT_FAILURE);
 
+      exit (EXIT_SUCCESS);
+    }
+
+  if (evaluate_mode)
+    {
       if (cur_file > 0)
         {
           if (grade)
@@ -787,7 +1234,8 @@ a conclusion must be specified in evaluation mode.\n");
               for (c = 0; c < cur_file; c++)
                 {
                   if (verbose)
-                    printf ("Grading file: '%s'\n", file_name[c]);
+                    printf ("Grading file: '%s'\n",
+                            (char *) vec_str_nth (file_names, c));
                   g = grade_file (proof[c]);
                   if (g == -1)
                     exit (EXIT_FAILURE);
@@ -822,21 +1270,19 @@ a conclusion must be specified in evaluation mode.\n");
                   if (!proof)
                     exit (EXIT_FAILURE);
 
-                  ret_chk = parse_thy (rule_file, proof);
+                  ret_chk = thy_cache_parse (rule_file, proof);
                   if (ret_chk == -1)
                     exit (EXIT_FAILURE);
                 }
               else
                 {
-                  main_conns = gui_conns;
                   proof = aio_open (rule_file);
                   if (!proof)
                     exit (EXIT_FAILURE);
-                  main_conns = cli_conns;
                 }
             }
 
-          p_ret = process (conc, prems, rule, vars, proof);
+          p_ret = process (conc, prems, rule, vars, proof, NULL);
           if (!p_ret)
             exit (EXIT_FAILURE);
 
@@ -853,11 +1299,14 @@ evaluate flag not specified in non-gui mode.\n");
       exit (EXIT_FAILURE);
 #else
 
-      main_conns = cli_conns;
-
       gtk_init (&argc, &argv);
 
       the_app = init_app (boolean, verbose);
+      if (args.undo_limit >= 0)
+        the_app->undo_budget = (size_t) args.undo_limit * 1024;
+
+      if (args.record_name && session_log_open (args.record_name) < 0)
+        exit (EXIT_FAILURE);
 
       // Get the current working directory from arg0,
       // then determine the help file.
@@ -883,9 +1332,9 @@ evaluate flag not specified in non-gui mode.\n");
               if (!new_gui)
                 exit (EXIT_FAILURE);
 
-              aris_proof_set_filename (new_gui, file_name[c]);
+              aris_proof_set_filename (new_gui,
+                                       (char *) vec_str_nth (file_names, c));
               new_gui->edited = 0;
-              free (file_name[c]);
 
               ret = the_app_add_gui (new_gui);
               if (ret < 0)
@@ -0,0 +1,461 @@
+/* Background saving of proofs.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Every AUTOSAVE_INTERVAL seconds, each edited proof with a file is
+ *  snapshotted on the main loop and handed to a worker thread, which
+ *  writes it beside the proof's file with aio_save.  The proof's own
+ *  file is only written when the user saves it.
+ * The snapshot is copy on write: the copy of a sentence's data made
+ *  for the last snapshot is kept, and is shared by the next one unless
+ *  the sentence has changed since, so a snapshot of a large proof with
+ *  a few edits copies only those few lines.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib/gstdio.h>
+#include "autosave.h"
+#include "aris-proof.h"
+#include "app.h"
+#include "aio.h"
+#include "goal.h"
+#include "list.h"
+#include "proof.h"
+#include "sen-data.h"
+#include "sen-parent.h"
+#include "sentence.h"
+#include "undo.h"
+
+// The copy of a sentence's data, shared between snapshots.
+
+struct autosave_line {
+  sen_data * sd;        // The copy.
+  volatile gint refs;   // The number of snapshots and tables holding it.
+};
+
+// The snapshots are written one at a time, in the order taken.
+static GThreadPool * autosave_pool = NULL;
+
+// Held while a snapshot is written, so a save can wait one out.
+static GMutex autosave_write_lock;
+
+static guint autosave_timer = 0;
+
+/* Drops a hold on a shared line, freeing it once nothing holds it.
+ *  input:
+ *    data - the line.
+ *  output:
+ *    none.
+ */
+static void
+autosave_line_unref (gpointer data)
+{
+  autosave_line * line = data;
+
+  if (!g_atomic_int_dec_and_test (&line->refs))
+    return;
+
+  sen_data_destroy (line->sd);
+  free (line);
+}
+
+/* Determines whether the copy of a sentence's data is still current.
+ *  input:
+ *    old_sd - the copy.
+ *    sd - the data of the sentence.
+ *  output:
+ *    1 if they are the same, 0 otherwise.
+ */
+static int
+autosave_same (sen_data * old_sd, sen_data * sd)
+{
+  int i;
+
+  if (old_sd->line_num != sd->line_num || old_sd->rule != sd->rule
+      || old_sd->premise != sd->premise || old_sd->depth != sd->depth
+      || old_sd->subproof != sd->subproof)
+    return 0;
+
+  if (strcmp ((char *) old_sd->text, (char *) sd->text))
+    return 0;
+
+  if ((old_sd->file == NULL) != (sd->file == NULL)
+      || (sd->file && strcmp ((char *) old_sd->file, (char *) sd->file)))
+    return 0;
+
+  for (i = 0; sd->refs[i] != REF_END; i++)
+    {
+      if (old_sd->refs[i] != sd->refs[i])
+        return 0;
+    }
+
+  return (old_sd->refs[i] == REF_END);
+}
+
+/* Destroys an autosave job.
+ *  input:
+ *    job - the job to destroy.
+ *  output:
+ *    none.
+ */
+static void
+autosave_job_destroy (autosave_job * job)
+{
+  int i;
+
+  // This frees only the items of the lines, which belong to the copies.
+  if (job->proof)
+    {
+      proof_destroy (job->proof);
+      free (job->proof);
+    }
+
+  for (i = 0; i < job->num_lines; i++)
+    autosave_line_unref (job->lines[i]);
+
+  if (job->lines)
+    free (job->lines);
+  if (job->file_name)
+    free (job->file_name);
+  free (job);
+}
+
+/* Hands the result of a job back to its proof.  Runs on the main loop.
+ *  input:
+ *    data - the finished job.
+ *  output:
+ *    FALSE, so that the idle source is removed.
+ */
+static gboolean
+autosave_done (gpointer data)
+{
+  autosave_job * job = data;
+  aris_proof * ap = job->ap;
+
+  if (ap && ap->autosave == job)
+    {
+      ap->autosave = NULL;
+
+      if (job->ret == 0 && !g_atomic_int_get (&job->cancelled)
+          && ap->changes == job->changes)
+        aris_proof_set_sb (ap, _("Autosaved"));
+    }
+
+  autosave_job_destroy (job);
+  return FALSE;
+}
+
+/* Writes a snapshot.  Runs on the worker thread.
+ *  input:
+ *    data - the job to write.
+ *    user_data - unused.
+ *  output:
+ *    none.
+ */
+static void
+autosave_run (gpointer data, gpointer user_data)
+{
+  autosave_job * job = data;
+
+  g_mutex_lock (&autosave_write_lock);
+  if (!g_atomic_int_get (&job->cancelled))
+    job->ret = aio_save (job->proof, job->file_name);
+  g_mutex_unlock (&autosave_write_lock);
+
+  g_idle_add (autosave_done, job);
+}
+
+/* Takes a snapshot of a proof and queues it to be written.
+ * On error the proof's table of copies is left as it was.
+ *  input:
+ *    ap - the proof to snapshot.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+autosave_queue (aris_proof * ap)
+{
+  autosave_job * job;
+  GHashTable * saved = NULL;
+  item_t * ev_itr;
+  int i;
+
+  job = (autosave_job *) calloc (1, sizeof (autosave_job));
+  if (!job)
+    return AEC_MEM;
+
+  job->file_name = autosave_name (ap->cur_file);
+  if (!job->file_name)
+    goto mem_err;
+
+  job->proof = proof_init ();
+  if (!job->proof)
+    goto mem_err;
+  job->proof->boolean = ap->boolean;
+
+  job->lines = (autosave_line **)
+    calloc (SEN_PARENT (ap)->everything->num_stuff, sizeof (autosave_line *));
+  if (!job->lines && SEN_PARENT (ap)->everything->num_stuff > 0)
+    goto mem_err;
+
+  for (ev_itr = SEN_PARENT (ap->goal)->everything->head; ev_itr;
+       ev_itr = ev_itr->next)
+    {
+      unsigned char * goal;
+
+      goal = (unsigned char *) strdup ((char *) sentence_get_text (ev_itr->value));
+      if (!goal)
+        goto mem_err;
+
+      if (!ls_push_obj (job->proof->goals, goal))
+        {
+          free (goal);
+          goto mem_err;
+        }
+    }
+
+  // The table only keeps the lines of this snapshot, so the copies of
+  //  sentences that are gone are dropped along with the old table.
+  saved = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                                 autosave_line_unref);
+
+  for (i = 0, ev_itr = SEN_PARENT (ap)->everything->head; ev_itr;
+       i++, ev_itr = ev_itr->next)
+    {
+      sentence * sen = ev_itr->value;
+      autosave_line * line = NULL;
+
+      if (sentence_refresh_refs (sen) == AEC_MEM)
+        goto mem_err;
+
+      // The line number in the data is only brought up to date on demand.
+      sentence_get_line_no (sen);
+
+      if (ap->saved)
+        line = g_hash_table_lookup (ap->saved, sen);
+
+      if (line && autosave_same (line->sd, SD(sen)))
+        {
+          g_atomic_int_inc (&line->refs);
+        }
+      else
+        {
+          line = (autosave_line *) calloc (1, sizeof (autosave_line));
+          if (!line)
+            goto mem_err;
+
+          line->sd = sentence_copy_to_data (sen);
+          if (!line->sd)
+            {
+              free (line);
+              goto mem_err;
+            }
+          line->refs = 1;
+        }
+
+      // One hold for the table, and one for the job.
+      g_hash_table_insert (saved, sen, line);
+
+      g_atomic_int_inc (&line->refs);
+      job->lines[i] = line;
+      job->num_lines++;
+
+      if (!ls_push_obj (job->proof->everything, line->sd))
+        goto mem_err;
+    }
+
+  if (ap->saved)
+    g_hash_table_destroy (ap->saved);
+  ap->saved = saved;
+
+  job->ap = ap;
+  job->changes = ap->changes;
+  ap->autosave = job;
+
+  g_thread_pool_push (autosave_pool, job, NULL);
+  return 0;
+
+ mem_err:
+  if (saved)
+    g_hash_table_destroy (saved);
+  autosave_job_destroy (job);
+  return AEC_MEM;
+}
+
+/* Snapshots each edited proof that isn't already being written.
+ *  input:
+ *    data - unused.
+ *  output:
+ *    TRUE, so that the timeout stays.
+ */
+static gboolean
+autosave_timeout (gpointer data)
+{
+  item_t * itm;
+
+  for (itm = the_app->guis->head; itm; itm = itm->next)
+    {
+      aris_proof * ap = itm->value;
+
+      if (!ap->edited || !ap->cur_file || ap->autosave)
+        continue;
+
+      if (ap->saved_changes == ap->changes)
+        continue;
+
+      if (autosave_queue (ap) == AEC_MEM)
+        break;
+
+      ap->saved_changes = ap->changes;
+    }
+
+  return TRUE;
+}
+
+/* Starts autosaving, if it hasn't been started.
+ *  input:
+ *    none.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+autosave_start ()
+{
+  if (autosave_timer)
+    return 0;
+
+  autosave_pool = g_thread_pool_new (autosave_run, NULL, 1, FALSE, NULL);
+  if (!autosave_pool)
+    return AEC_MEM;
+
+  autosave_timer = g_timeout_add_seconds (AUTOSAVE_INTERVAL,
+                                          autosave_timeout, NULL);
+  return 0;
+}
+
+/* Gets the name of the file that a proof's autosaves are written to.
+ *  input:
+ *    file_name - the name of the proof's file.
+ *  output:
+ *    the name of the autosave file, or NULL on memory error.
+ */
+char *
+autosave_name (const char * file_name)
+{
+  char * name;
+
+  name = (char *) calloc (strlen (file_name) + strlen (AUTOSAVE_SUFFIX) + 1,
+                          sizeof (char));
+  CHECK_ALLOC (name, NULL);
+
+  sprintf (name, "%s%s", file_name, AUTOSAVE_SUFFIX);
+  return name;
+}
+
+/* Finds an autosave of a proof that is newer than its file, as left
+ *  by a session that ended without saving.
+ *  input:
+ *    file_name - the name of the proof's file.
+ *  output:
+ *    the name of the autosave file, or NULL if there is none.
+ */
+char *
+autosave_recoverable (const char * file_name)
+{
+  GStatBuf st, a_st;
+  char * name;
+
+  name = autosave_name (file_name);
+  if (!name)
+    return NULL;
+
+  if (g_stat (name, &a_st) != 0
+      || (g_stat (file_name, &st) == 0 && st.st_mtime > a_st.st_mtime))
+    {
+      free (name);
+      return NULL;
+    }
+
+  return name;
+}
+
+/* Keeps a pending autosave of a proof from being written, waiting
+ *  for it if it is being written now.
+ *  input:
+ *    ap - the proof.
+ *  output:
+ *    none.
+ */
+void
+autosave_cancel (aris_proof * ap)
+{
+  if (!ap->autosave)
+    return;
+
+  g_atomic_int_set (&ap->autosave->cancelled, 1);
+  g_mutex_lock (&autosave_write_lock);
+  g_mutex_unlock (&autosave_write_lock);
+}
+
+/* Removes the autosave of a proof, once the proof has been saved.
+ *  input:
+ *    ap - the proof.
+ *  output:
+ *    none.
+ */
+void
+autosave_discard (aris_proof * ap)
+{
+  char * name;
+
+  autosave_cancel (ap);
+  ap->saved_changes = ap->changes;
+
+  if (!ap->cur_file)
+    return;
+
+  name = autosave_name (ap->cur_file);
+  if (!name)
+    return;
+
+  g_remove (name);
+  free (name);
+}
+
+/* Drops the autosave state of a proof that is being destroyed.
+ *  input:
+ *    ap - the proof being destroyed.
+ *  output:
+ *    none.
+ */
+void
+autosave_forget (aris_proof * ap)
+{
+  autosave_discard (ap);
+
+  if (ap->autosave)
+    {
+      ap->autosave->ap = NULL;
+      ap->autosave = NULL;
+    }
+
+  if (ap->saved)
+    g_hash_table_destroy (ap->saved);
+  ap->saved = NULL;
+}
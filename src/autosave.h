@@ -0,0 +1,51 @@
+/* Background saving of proofs.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_AUTOSAVE_H
+#define ARIS_AUTOSAVE_H
+
+#include <gtk/gtk.h>
+#include "typedef.h"
+
+// The time between autosaves, in seconds.
+#define AUTOSAVE_INTERVAL 5
+
+// The suffix of the file that an autosave is written to.
+#define AUTOSAVE_SUFFIX ".autosave"
+
+// A snapshot of a proof, written away from the main loop.
+
+struct autosave_job {
+  aris_proof * ap;      // The proof, or NULL once it is gone.
+  char * file_name;     // The file to write the snapshot to.
+  proof_t * proof;      // The snapshot, whose lines are shared.
+  autosave_line ** lines;  // The shared lines of the snapshot.
+  int num_lines;        // The number of lines.
+  unsigned int changes; // The change count of the proof when taken.
+  volatile gint cancelled;  // Set once the snapshot mustn't be written.
+  int ret;              // The result of writing the snapshot.
+};
+
+int autosave_start ();
+char * autosave_name (const char * file_name);
+char * autosave_recoverable (const char * file_name);
+void autosave_cancel (aris_proof * ap);
+void autosave_discard (aris_proof * ap);
+void autosave_forget (aris_proof * ap);
+
+#endif  /*  ARIS_AUTOSAVE_H  */
@@ -28,6 +28,7 @@
 #include "aris-proof.h"
 #include "menu.h"
 #include "aio.h"
+#include "autosave.h"
 #include "sen-data.h"
 #include "process.h"
 #include "sexpr-process.h"
@@ -41,6 +42,7 @@
 #include "interop-isar.h"
 #include "proof.h"
 #include "conf-file.h"
+#include "session-log.h"
 
 /* Check gtk+ documentation for more information about signals. */
 
@@ -241,6 +243,28 @@ sentence_mapped (GtkWidget * widget, GdkRectangle * rect, gpointer data)
 
   gtk_widget_grab_focus (sen->entry);
   g_signal_handler_disconnect (sen->entry, sen->sig_id);
+  sen->sig_id = 0;
+}
+
+/* Updates which sentences are shown after a sentence parent scrolls.
+ *  input:
+ *    data - the sentence parent being scrolled.
+ */
+G_MODULE_EXPORT void
+sen_parent_scrolled (GtkAdjustment * adj, gpointer data)
+{
+  sen_parent_queue_view (SEN_PARENT (data));
+}
+
+/* Updates which sentences are shown after a sentence parent's
+ *  container changes size.
+ *  input:
+ *    data - the sentence parent being resized.
+ */
+G_MODULE_EXPORT void
+sen_parent_allocated (GtkWidget * widget, GdkRectangle * rect, gpointer data)
+{
+  sen_parent_queue_view (SEN_PARENT (data));
 }
 
 /* Processes the goal's menu being activated; uses the goal of the focused gui.
@@ -550,7 +574,34 @@ gui_open (GtkWidget * window)
 
       filename = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (file_chooser));
 
-      proof = aio_open (filename);
+      // Offer the changes that a session left unsaved.
+      char * recover_name;
+      int recovered = 0;
+
+      recover_name = autosave_recoverable (filename);
+      if (recover_name)
+        {
+          GtkWidget * recover_prompt;
+          int result;
+
+          recover_prompt =
+            gtk_message_dialog_new_with_markup (GTK_WINDOW (window),
+                                                GTK_DIALOG_MODAL
+                                                | GTK_DIALOG_DESTROY_WITH_PARENT,
+                                                GTK_MESSAGE_QUESTION,
+                                                GTK_BUTTONS_YES_NO,
+                                                "<b>Unsaved Changes</b>");
+
+          gtk_message_dialog_format_secondary_markup (GTK_MESSAGE_DIALOG (recover_prompt),
+                                                      _("This proof has changes that were never saved.\nDo you want to recover them?"));
+
+          result = gtk_dialog_run (GTK_DIALOG (recover_prompt));
+          gtk_widget_destroy (recover_prompt);
+          recovered = (result == GTK_RESPONSE_YES);
+        }
+
+      proof = aio_open ((recovered) ? recover_name : filename);
+      free (recover_name);
       if (!proof)
         {
           gtk_widget_destroy (file_chooser);
@@ -578,8 +629,23 @@ gui_open (GtkWidget * window)
           return -1;
         }
 
-      gui_save (new_ap, 0);
-      new_ap->edited = 0;
+      if (recovered)
+        {
+          undo_info ui = { 0 };
+          ui.type = -1;
+
+          ret = aris_proof_set_changed (new_ap, 1, ui);
+          if (ret < 0)
+            {
+              gtk_widget_destroy (file_chooser);
+              return -1;
+            }
+        }
+      else
+        {
+          gui_save (new_ap, 0);
+          new_ap->edited = 0;
+        }
 
       if (have_blank_proof)
         gui_destroy (cur_ap);
@@ -673,6 +739,9 @@ gui_save (aris_proof * ap, int save_as)
           return AEC_MEM;
         }
 
+      // The autosave is kept under the name it was taken for.
+      autosave_discard (ap);
+
       ret = aris_proof_set_filename (ap, fname);
       if (ret < 0)
         {
@@ -775,6 +844,15 @@ evaluate_proof (aris_proof * ap)
   for (ev_itr = SEN_PARENT (ap)->everything->head; ev_itr; ev_itr = ev_itr->next)
     {
       sen = ev_itr->value;
+
+      // A folded line keeps its verdict until a line it cites changes,
+      //  or its references do.  A quantifier step also depends on the
+      //  variables of every earlier line, so it is always checked again.
+      if (sen->hidden && sen->value_type != VALUE_TYPE_BLANK
+          && sentence_get_rule (sen) != RULE_UG
+          && sentence_get_rule (sen) != RULE_EI)
+        continue;
+
       ret = evaluate_line (ap, sen);
       if (ret == AEC_MEM)
         return AEC_MEM;
@@ -1476,6 +1554,7 @@ menu_activated (aris_proof * ap, int menu_id)
       if (ret < 0)
         return AEC_MEM;
 
+      session_log_lines (SLO_COPY, 0, ap->yanked);
       aris_proof_set_sb (ap, _("Sentence Copied."));
       break;
 
@@ -1496,13 +1575,21 @@ menu_activated (aris_proof * ap, int menu_id)
       break;
 
     case CONF_MENU_EVAL_LINE:
+      session_log (SLO_EVAL,
+                   sentence_get_line_no (SEN_PARENT (ap)->focused->value),
+                   NULL);
       evaluate_line (ap, SENTENCE (SEN_PARENT (ap)->focused->value));
       break;
 
     case CONF_MENU_EVAL_PROOF:
+      session_log (SLO_EVAL, 0, NULL);
       ret = evaluate_proof (ap);
       break;
 
+    case CONF_MENU_FOLD:
+      aris_proof_toggle_fold (ap);
+      break;
+
     case CONF_MENU_GOAL:
       gui_goal_check (ap);
       break;
@@ -1511,6 +1598,10 @@ menu_activated (aris_proof * ap, int menu_id)
       aris_proof_toggle_boolean_mode (ap);
       break;
 
+    case CONF_MENU_LIVE:
+      aris_proof_toggle_live_mode (ap);
+      break;
+
     case CONF_MENU_IMPORT:
       aris_proof_import_proof (ap);
       break;
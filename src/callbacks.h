@@ -70,6 +70,11 @@ G_MODULE_EXPORT void sentence_changed (GtkTextView * edit, gpointer data);
 G_MODULE_EXPORT void sentence_mapped (GtkWidget * widget,
 				      GdkRectangle * rect,
 				      gpointer data);
+G_MODULE_EXPORT void sen_parent_scrolled (GtkAdjustment * adj,
+					  gpointer data);
+G_MODULE_EXPORT void sen_parent_allocated (GtkWidget * widget,
+					   GdkRectangle * rect,
+					   gpointer data);
 					  
 
 G_MODULE_EXPORT void goal_menu_activate (GtkMenuItem * item, gpointer data);
@@ -46,6 +46,7 @@ enum CONF_MENU_ID {
   CONF_MENU_ADD_CONC,
   CONF_MENU_ADD_SUB,
   CONF_MENU_END_SUB,
+  CONF_MENU_FOLD,
   CONF_MENU_UNDO,
   CONF_MENU_REDO,
   CONF_MENU_COPY,
@@ -55,6 +56,7 @@ enum CONF_MENU_ID {
   CONF_MENU_EVAL_PROOF,
   CONF_MENU_GOAL,
   CONF_MENU_BOOLEAN,
+  CONF_MENU_LIVE,
   CONF_MENU_IMPORT,
   CONF_MENU_TOGGLE_RULES,
   CONF_MENU_SMALL,
@@ -145,6 +147,10 @@ static conf_obj main_menu_conf[NUM_CONF_MENUS] = {
    CONF_OBJ_MENU, CONF_MENU_END_SUB, conf_menu_value,
    "media-skip-backward", "c+d"},
 
+  {N_("Fold Subproof"),
+   N_("Fold or unfold the subproof containing the current line."), NULL,
+   CONF_OBJ_MENU, CONF_MENU_FOLD, conf_menu_value, NULL, "c+h"},
+
   {N_("Undo"), N_("Undo the last command."), NULL,
    CONF_OBJ_MENU, CONF_MENU_UNDO, conf_menu_value, "edit-undo", "c+z"},
 
@@ -178,6 +184,10 @@ static conf_obj main_menu_conf[NUM_CONF_MENUS] = {
    N_("Toggle Boolean mode for the current proof."), NULL,
    CONF_OBJ_MENU, CONF_MENU_BOOLEAN, conf_menu_value, NULL, "c+m"},
 
+  {N_("Toggle Live Checking"),
+   N_("Check the lines of the current proof as they are edited."), NULL,
+   CONF_OBJ_MENU, CONF_MENU_LIVE, conf_menu_value, NULL, NULL},
+
   {N_("Import Proof..."),
    N_("Import the premises and conclusions of a proof."), NULL,
    CONF_OBJ_MENU, CONF_MENU_IMPORT, conf_menu_value, "drive-harddisk", NULL},
@@ -322,8 +332,8 @@ enum MENU_ORDER {
 
 enum MENU_SIZE {
   FILE_MENU_SIZE = 9,
-  EDIT_MENU_SIZE = 11,
-  PROOF_MENU_SIZE = 6,
+  EDIT_MENU_SIZE = 12,
+  PROOF_MENU_SIZE = 7,
   RULES_MENU_SIZE = 2,
   FONT_MENU_SIZE = 4,
   HELP_MENU_SIZE = 2
@@ -0,0 +1,518 @@
+/* Functions for packing and reading proof corpora.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* A corpus holds many proof files in one stream:
+ *
+ *    aris-corpus 1
+ *    e <size> <id> <student> <assignment>
+ *    <size bytes of the proof file>
+ *    ...
+ *    i <number of entries>
+ *    <offset of the entry's 'e' line> <id>
+ *    ...
+ *
+ *  In the fields of a header, '%', spaces and line breaks are written
+ *  as %XX, and an empty field as '-'.  The index at the end lets a tool
+ *  seek to an entry of an uncompressed corpus; reading a corpus from
+ *  the start never needs it.
+ * A corpus whose name ends in '.gz' is compressed with gzip as it is
+ *  written, and a compressed corpus is recognized when read, whatever
+ *  its name.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gio/gio.h>
+#include "corpus.h"
+#include "vec.h"
+
+struct corpus_reader {
+  GDataInputStream * data;
+  int num;              // The number of entries read so far.
+  goffset left;         // The bytes left to read, or -1 if it isn't known.
+};
+
+/* Escapes a field of an entry header.
+ *  input:
+ *    field - the field.
+ *  output:
+ *    the escaped field, to be freed with g_free.
+ */
+static char *
+corpus_escape (const char * field)
+{
+  GString * esc;
+
+  if (field[0] == '\0')
+    return g_strdup ("-");
+
+  esc = g_string_sized_new (strlen (field) + 8);
+  for (; *field; field++)
+    {
+      if (*field == '%' || *field == ' ' || *field == '\n'
+          || *field == '\r' || *field == '\t')
+        g_string_append_printf (esc, "%%%02X", (unsigned char) *field);
+      else
+        g_string_append_c (esc, *field);
+    }
+
+  return g_string_free (esc, FALSE);
+}
+
+/* Undoes the escapes of a field of an entry header.
+ *  input:
+ *    field - the field.
+ *    len - the length of the field.
+ *  output:
+ *    the field, or NULL on memory error.
+ */
+static char *
+corpus_unescape (const char * field, size_t len)
+{
+  char * ret;
+  size_t i, j;
+
+  ret = (char *) calloc (len + 1, sizeof (char));
+  CHECK_ALLOC (ret, NULL);
+
+  if (len == 1 && field[0] == '-')
+    return ret;
+
+  for (i = j = 0; i < len; i++, j++)
+    {
+      unsigned int c;
+
+      if (field[i] == '%' && i + 2 < len
+          && sscanf (field + i + 1, "%2X", &c) == 1)
+        {
+          ret[j] = (char) c;
+          i += 2;
+        }
+      else
+        {
+          ret[j] = field[i];
+        }
+    }
+  ret[j] = '\0';
+
+  return ret;
+}
+
+/* Writes a string to a corpus.
+ *  input:
+ *    out - the stream of the corpus.
+ *    str - the string.
+ *    len - the length of the string.
+ *    pos - the offset in the corpus, which is advanced.
+ *  output:
+ *    0 on success, -2 on i/o error.
+ */
+static int
+corpus_write (GOutputStream * out, const char * str, gsize len, gsize * pos)
+{
+  GError * err = NULL;
+
+  if (!g_output_stream_write_all (out, str, len, NULL, NULL, &err))
+    {
+      fprintf (stderr, "%s\n", err->message);
+      g_error_free (err);
+      return AEC_IO;
+    }
+
+  *pos += len;
+  return 0;
+}
+
+/* Packs proof files into a corpus.
+ * Each entry is named by its file, and is taken to be the submission
+ *  of the student named by its directory, for the assignment named by
+ *  the file without its extension.
+ *  input:
+ *    corpus_name - the name of the corpus to write.
+ *    file_names - the names of the proof files.
+ *  output:
+ *    0 on success, -1 on memory error, -2 on i/o error.
+ */
+int
+corpus_pack (const char * corpus_name, vec_t * file_names)
+{
+  GFile * file;
+  GFileOutputStream * file_out;
+  GOutputStream * out, * tmp;
+  GError * err = NULL;
+  gsize pos = 0, * offsets;
+  char * line;
+  int i, ret = 0, len, num;
+
+  num = file_names->num_stuff;
+  offsets = (gsize *) calloc (num + 1, sizeof (gsize));
+  CHECK_ALLOC (offsets, AEC_MEM);
+
+  file = g_file_new_for_path (corpus_name);
+  file_out = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_NONE, NULL,
+                             &err);
+  g_object_unref (file);
+  if (!file_out)
+    {
+      fprintf (stderr, "%s\n", err->message);
+      g_error_free (err);
+      free (offsets);
+      return AEC_IO;
+    }
+  out = G_OUTPUT_STREAM (file_out);
+
+  len = strlen (corpus_name);
+  if (len > 3 && !strcmp (corpus_name + len - 3, ".gz"))
+    {
+      GZlibCompressor * gz;
+
+      gz = g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1);
+      tmp = g_converter_output_stream_new (out, G_CONVERTER (gz));
+      g_object_unref (gz);
+      g_object_unref (out);
+      out = tmp;
+    }
+
+  tmp = g_buffered_output_stream_new (out);
+  g_object_unref (out);
+  out = tmp;
+
+  ret = corpus_write (out, CORPUS_MAGIC "\n", strlen (CORPUS_MAGIC) + 1, &pos);
+
+  for (i = 0; i < num && ret == 0; i++)
+    {
+      char * name, * contents, * dir, * student, * assignment, * dot;
+      char * e_id, * e_student, * e_assignment;
+      gsize size;
+
+      name = (char *) vec_str_nth (file_names, i);
+      if (!g_file_get_contents (name, &contents, &size, &err))
+        {
+          fprintf (stderr, "%s\n", err->message);
+          g_error_free (err);
+          ret = AEC_IO;
+          break;
+        }
+
+      if (size > CORPUS_MAX_ENTRY)
+        {
+          fprintf (stderr, "Corpus Error - %s is too large to pack.\n", name);
+          g_free (contents);
+          ret = AEC_IO;
+          break;
+        }
+
+      dir = g_path_get_dirname (name);
+      student = g_path_get_basename (dir);
+      if (!strcmp (student, ".") || !strcmp (student, G_DIR_SEPARATOR_S))
+        student[0] = '\0';
+
+      assignment = g_path_get_basename (name);
+      dot = strrchr (assignment, '.');
+      if (dot)
+        *dot = '\0';
+
+      e_id = corpus_escape (name);
+      e_student = corpus_escape (student);
+      e_assignment = corpus_escape (assignment);
+
+      line = g_strdup_printf ("e %" G_GSIZE_FORMAT " %s %s %s\n", size,
+                              e_id, e_student, e_assignment);
+
+      offsets[i] = pos;
+      ret = corpus_write (out, line, strlen (line), &pos);
+      if (ret == 0)
+        ret = corpus_write (out, contents, size, &pos);
+      if (ret == 0)
+        ret = corpus_write (out, "\n", 1, &pos);
+
+      g_free (line);
+      g_free (e_id);
+      g_free (e_student);
+      g_free (e_assignment);
+      g_free (assignment);
+      g_free (student);
+      g_free (dir);
+      g_free (contents);
+    }
+
+  // Write the index.
+  if (ret == 0)
+    {
+      line = g_strdup_printf ("i %i\n", num);
+      ret = corpus_write (out, line, strlen (line), &pos);
+      g_free (line);
+    }
+
+  for (i = 0; i < num && ret == 0; i++)
+    {
+      char * e_id;
+
+      e_id = corpus_escape ((char *) vec_str_nth (file_names, i));
+      line = g_strdup_printf ("%" G_GSIZE_FORMAT " %s\n", offsets[i], e_id);
+      ret = corpus_write (out, line, strlen (line), &pos);
+      g_free (line);
+      g_free (e_id);
+    }
+
+  if (!g_output_stream_close (out, NULL, &err))
+    {
+      fprintf (stderr, "%s\n", err->message);
+      g_error_free (err);
+      ret = AEC_IO;
+    }
+
+  g_object_unref (out);
+  free (offsets);
+
+  return ret;
+}
+
+/* Opens a corpus to be read from the start.
+ *  input:
+ *    corpus_name - the name of the corpus.
+ *  output:
+ *    the reader, or NULL on error.
+ */
+corpus_reader *
+corpus_open (const char * corpus_name)
+{
+  corpus_reader * cr;
+  GFile * file;
+  GFileInputStream * file_in;
+  GInputStream * in, * tmp;
+  GFileInfo * info;
+  GError * err = NULL;
+  const unsigned char * head;
+  gsize head_len, len;
+  goffset left = -1;
+  char * line;
+
+  file = g_file_new_for_path (corpus_name);
+  file_in = g_file_read (file, NULL, &err);
+  g_object_unref (file);
+  if (!file_in)
+    {
+      fprintf (stderr, "%s\n", err->message);
+      g_error_free (err);
+      return NULL;
+    }
+
+  // The size of an uncompressed corpus bounds the size of its entries.
+  info = g_file_input_stream_query_info (file_in,
+                                         G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                                         NULL, NULL);
+  if (info)
+    {
+      left = g_file_info_get_size (info);
+      g_object_unref (info);
+    }
+
+  in = g_buffered_input_stream_new (G_INPUT_STREAM (file_in));
+  g_object_unref (file_in);
+
+  // A compressed corpus starts with the gzip magic number.
+  g_buffered_input_stream_fill (G_BUFFERED_INPUT_STREAM (in), 2, NULL, NULL);
+  head = g_buffered_input_stream_peek_buffer (G_BUFFERED_INPUT_STREAM (in),
+                                              &head_len);
+  if (head_len >= 2 && head[0] == 0x1f && head[1] == 0x8b)
+    {
+      GZlibDecompressor * gz;
+
+      gz = g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP);
+      tmp = g_converter_input_stream_new (in, G_CONVERTER (gz));
+      g_object_unref (gz);
+      g_object_unref (in);
+      in = tmp;
+      left = -1;
+    }
+
+  cr = (corpus_reader *) calloc (1, sizeof (corpus_reader));
+  if (!cr)
+    {
+      PERROR (NULL);
+      g_object_unref (in);
+      return NULL;
+    }
+
+  cr->data = g_data_input_stream_new (in);
+  g_object_unref (in);
+  g_data_input_stream_set_newline_type (cr->data,
+                                        G_DATA_STREAM_NEWLINE_TYPE_LF);
+
+  line = g_data_input_stream_read_line (cr->data, &len, NULL, NULL);
+  if (!line || strcmp (line, CORPUS_MAGIC))
+    {
+      fprintf (stderr, "%s: not a proof corpus.\n", corpus_name);
+      g_free (line);
+      corpus_close (cr);
+      return NULL;
+    }
+  g_free (line);
+
+  cr->left = (left < 0) ? -1 : left - (goffset) len - 1;
+
+  return cr;
+}
+
+/* Reads the next entry of a corpus.
+ *  input:
+ *    cr - the reader.
+ *    ce - receives the entry, which should be cleared once it is used.
+ *  output:
+ *    1 if an entry was read, 0 at the end of the corpus,
+ *    -1 on memory error, -2 on i/o error or a damaged corpus.
+ */
+int
+corpus_next (corpus_reader * cr, corpus_entry * ce)
+{
+  GError * err = NULL;
+  char * line, * fields[3], * pos;
+  gsize size, got, len;
+  guint64 val;
+  char nl;
+  int i;
+
+  memset (ce, 0, sizeof (corpus_entry));
+
+  line = g_data_input_stream_read_line (cr->data, &len, NULL, &err);
+  if (!line)
+    {
+      if (!err)
+        return 0;
+
+      fprintf (stderr, "%s\n", err->message);
+      g_error_free (err);
+      return AEC_IO;
+    }
+
+  if (line[0] == 'i')
+    {
+      g_free (line);
+      return 0;
+    }
+
+  if (cr->left >= 0)
+    cr->left -= (goffset) len + 1;
+
+  // The size comes from the file, so it must be no larger than an entry
+  //  may be, or than what is left of the corpus.
+  if (strncmp (line, "e ", 2) || !g_ascii_isdigit (line[2]))
+    goto damaged;
+
+  val = g_ascii_strtoull (line + 2, &pos, 10);
+  if ((*pos != ' ' && *pos != '\0') || val > CORPUS_MAX_ENTRY
+      || (cr->left >= 0 && (goffset) val >= cr->left))
+    goto damaged;
+  size = (gsize) val;
+
+  // Split the id, student and assignment.
+  for (i = 0; i < 3; i++)
+    {
+      while (*pos == ' ')
+        pos++;
+
+      fields[i] = pos;
+      if (*pos == '\0')
+        goto damaged;
+
+      while (*pos && *pos != ' ')
+        pos++;
+
+      if (*pos)
+        *pos++ = '\0';
+    }
+
+  ce->id = corpus_unescape (fields[0], strlen (fields[0]));
+  ce->student = corpus_unescape (fields[1], strlen (fields[1]));
+  ce->assignment = corpus_unescape (fields[2], strlen (fields[2]));
+  ce->data = (char *) calloc (size + 1, sizeof (char));
+  g_free (line);
+
+  if (!ce->id || !ce->student || !ce->assignment || !ce->data)
+    {
+      corpus_entry_clear (ce);
+      return AEC_MEM;
+    }
+  ce->size = size;
+
+  if (!g_input_stream_read_all (G_INPUT_STREAM (cr->data), ce->data, size,
+                                &got, NULL, &err)
+      || got != size
+      || !g_input_stream_read_all (G_INPUT_STREAM (cr->data), &nl, 1,
+                                   &got, NULL, &err)
+      || got != 1 || nl != '\n')
+    {
+      if (err)
+        {
+          fprintf (stderr, "%s\n", err->message);
+          g_error_free (err);
+        }
+      else
+        {
+          fprintf (stderr, "Corpus Error - entry %i is cut short.\n",
+                   cr->num + 1);
+        }
+
+      corpus_entry_clear (ce);
+      return AEC_IO;
+    }
+
+  if (cr->left >= 0)
+    cr->left -= (goffset) size + 1;
+
+  cr->num++;
+  return 1;
+
+ damaged:
+  fprintf (stderr, "Corpus Error - the header of entry %i is damaged.\n",
+           cr->num + 1);
+  g_free (line);
+  return AEC_IO;
+}
+
+/* Frees the contents of a corpus entry.
+ *  input:
+ *    ce - the entry.
+ *  output:
+ *    none.
+ */
+void
+corpus_entry_clear (corpus_entry * ce)
+{
+  free (ce->id);
+  free (ce->student);
+  free (ce->assignment);
+  free (ce->data);
+  memset (ce, 0, sizeof (corpus_entry));
+}
+
+/* Closes a corpus.
+ *  input:
+ *    cr - the reader.
+ *  output:
+ *    none.
+ */
+void
+corpus_close (corpus_reader * cr)
+{
+  g_input_stream_close (G_INPUT_STREAM (cr->data), NULL, NULL);
+  g_object_unref (cr->data);
+  free (cr);
+}
@@ -0,0 +1,47 @@
+/* Proof corpora.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_CORPUS_H
+#define ARIS_CORPUS_H
+
+#include <stddef.h>
+#include "typedef.h"
+
+#define CORPUS_MAGIC "aris-corpus 1"
+
+// The largest proof file that a corpus may hold.
+#define CORPUS_MAX_ENTRY (64 * 1024 * 1024)
+
+// A proof in a corpus.
+
+struct corpus_entry {
+  char * id;            // The name of the entry, unique in the corpus.
+  char * student;       // The student that submitted it.
+  char * assignment;    // The assignment it was submitted for.
+  char * data;          // The text of the proof file.
+  size_t size;          // The length of the text.
+};
+
+int corpus_pack (const char * corpus_name, vec_t * file_names);
+
+corpus_reader * corpus_open (const char * corpus_name);
+int corpus_next (corpus_reader * cr, corpus_entry * ce);
+void corpus_entry_clear (corpus_entry * ce);
+void corpus_close (corpus_reader * cr);
+
+#endif  /*  ARIS_CORPUS_H  */
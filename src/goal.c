@@ -206,14 +206,12 @@ goal_check_line (goal_t * goal, sentence * sen)
 
 	  if (is_valid)
 	    {
-	      gtk_widget_override_background_color (ev_sen->eventbox, GTK_STATE_NORMAL,
-				    the_app->bg_colors[BG_COLOR_GOOD]);
+	      sentence_set_line_bg (ev_sen, BG_COLOR_GOOD);
 	      sentence_set_value (sen, VALUE_TYPE_TRUE);
 	    }
 	  else
 	    {
-	      gtk_widget_override_background_color (ev_sen->eventbox, GTK_STATE_NORMAL,
-				    the_app->bg_colors[BG_COLOR_BAD]);
+	      sentence_set_line_bg (ev_sen, BG_COLOR_BAD);
 	      sentence_set_value (sen, VALUE_TYPE_REF);
 	    }
 
@@ -288,20 +286,14 @@ goal_check_all (goal_t * goal)
 int
 goal_add_line (goal_t * goal, sen_data * sd)
 {
-  sentence * sen;
-  sen = sentence_init (sd, (sen_parent *) goal,
-		       SEN_PARENT (goal)->everything->tail);
-  if (!sen)
-    return AEC_MEM;
-
   item_t * itm;
-  itm = ls_push_obj (SEN_PARENT (goal)->everything, sen);
+  itm = sen_parent_splice_sentence (SEN_PARENT (goal), sd,
+				    SEN_PARENT (goal)->everything->tail);
   if (!itm)
     return AEC_MEM;
 
-  gtk_grid_attach_next_to (GTK_GRID (SEN_PARENT (goal)->container), sen->panel,
-			   NULL, GTK_POS_BOTTOM, 1, 1);
-  gtk_widget_show_all (sen->panel);
+  if (gtk_widget_get_mapped (SEN_PARENT (goal)->window))
+    sen_parent_set_focus (SEN_PARENT (goal), itm);
 
   undo_info ui = { 0 };
   ui.type = -1;
@@ -332,7 +324,7 @@ goal_rem_line (goal_t * goal)
       item_t * itm;
       itm = ls_nth (SEN_PARENT (goal->parent)->everything, line_num - 1);
       sen = (sentence *) itm->value;
-      gtk_widget_override_background_color (sen->eventbox, GTK_STATE_NORMAL, NULL);
+      sentence_set_line_bg (sen, -1);
     }
 
   undo_info ui = { 0 };
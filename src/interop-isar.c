@@ -10,18 +10,7 @@
 #include "list.h"
 #include "proof.h"
 #include "sen-data.h"
-
-static const char * greek_syms[] = {
-  "\\<alpha>", "\\<beta>", "\\<gamma>",
-  "\\<delta>", "\\<epsilon>", "\\<zeta>",
-  "\\<eta>", "\\<theta>", "\\<iota>", "\\<kappa>",
-  "\\<mu>", "\\<nu>", "\\<xi>", "\\<pi>", "\\<rho>",
-  "\\<sigma>", "\\<tau>", "\\<upsilon>", "\\<phi>",
-  "\\<chi>", "\\<psi>", "\\<omega>", "\\<Gamma>",
-  "\\<Delta>", "\\<Theta>", "\\<Lambda>", "\\<Xi>",
-  "\\<Pi>", "\\<Sigma>", "\\<Upsilon>", "\\<Phi>",
-  "\\<Psi>", "\\<Omega>", NULL
-};
+#include "isar-lex.h"
 
 static char * latin_regexp = "[a-zA-Z]";
 static char * digit_regexp = "[0-9]";
@@ -32,73 +21,6 @@ static char * letter_regexp, * greek_regexp, * nat_regexp,
   * ql_regexp, * float_regexp, * ident_regexp, * lident_regexp,
   * symident_regexp, * var_regexp;
 
-#define ISABELLE_PATH "define-me"
-#define ISABELLE_EXEC "define-me"
-
-static const char * is_args[3] = {ISABELLE_EXEC,
-				  "-I",
-				  NULL};
-
-int
-isar_run_cmds (unsigned char ** inputs, unsigned char ** output)
-{
-  GPid new_pid;
-  int sout, sin;
-  GError * g_err;
-
-  g_spawn_async_with_pipes (ISABELLE_PATH,
-			    (gchar **) is_args,
-			    NULL,
-			    0,
-			    NULL, NULL,
-			    &new_pid,
-			    &sin, &sout, NULL,
-			    &g_err);
-
-  FILE * in_stream, * out_stream;
-  in_stream = fdopen (sin, "w");
-  int i;
-  for (i = 0; inputs[i]; i++)
-    {
-      fprintf (in_stream, "%s;\r\n", inputs[i]);
-    }
-  fclose (in_stream);
-
-  out_stream = fdopen (sout, "r");
-  char c;
-  vec_t * c_vec;
-  c_vec = init_vec (sizeof(char));
-  if (!c_vec)
-    return -1;
-
-  while ((c = fgetc(out_stream)) != EOF)
-    {
-      char tmp_c = c;
-      int v_ret;
-      v_ret = vec_add_obj (c_vec, &tmp_c);
-      if (v_ret == -1)
-	return -1;
-    }
-  fclose (out_stream);
-
-  *output = (unsigned char *) calloc (c_vec->num_stuff + 1, sizeof (char));
-  CHECK_ALLOC ((*output), -1);
-
-  for (i = 0; i < c_vec->num_stuff; i++)
-    {
-      char * tmp_c = vec_nth (c_vec, i);
-      (*output)[i] = (unsigned char) *tmp_c;
-    }
-
-  (*output)[i] = '\0';
-  destroy_vec (c_vec);
-
-  g_spawn_close_pid (new_pid);
-
-  return 0;
-}
-
-
 int
 isar_prep_regexps ()
 {
@@ -159,14 +81,14 @@ is_latin (char * input)
 int
 is_greek (char * input)
 {
-  int i;
-  for (i = 0; greek_syms[i]; i++)
-    {
-      if (!strcmp (input, greek_syms[i]))
-	break;
-    }
+  int len, id;
 
-  return (greek_syms[i] != NULL);
+  len = isar_escape_len (input, strlen (input));
+  if (len == 0 || input[len] != '\0')
+    return 0;
+
+  id = isar_symbol (input + 2, len - 3);
+  return (id >= ISY_ALPHA && id <= ISY_CAP_OMEGA);
 }
 
 int
@@ -197,18 +119,23 @@ is_nat (char * input)
 int
 is_float (char * input)
 {
-  char * chk;
+  char * chk, * dot;
   int chk_0, chk_1;
   // nat.nat | -nat.nat
-  chk = strtok (input, ".");
+  chk = input;
   if (chk[0] == '-')
     chk += 1;
 
+  dot = strchr (chk, '.');
+  if (!dot)
+    return 0;
+  *dot = '\0';
+
   chk_0 = is_nat (chk);
   if (!chk_0)
     return 0;
 
-  chk = strtok (NULL, ".");
+  chk = dot + 1;
   chk_1 = is_nat (chk);
 
   return chk_1;
@@ -632,15 +559,6 @@ isar_parse_abbreviation (char * input_str)
 // Defined sequences.
 vec_t * seqs;
 
-// List of null keys.
-static const char * null_keys[] = {
-  "text",
-  "text_raw",
-  "subsection",
-  "subsubsection",
-  NULL
-};
-
 static char * conn_prec[4] = {
   "%",
   "$",
@@ -670,12 +588,23 @@ static char * conn_prec[4] = {
  *    abbreviation
  */
 
+/* Initializes the standard sequences, unless they already are.
+ * Each theory adds its own sequences to the same table, so a batch of
+ *  theories translated by forked processes shares the standard ones.
+ *  input:
+ *    none.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
 int
 get_std_seqs ()
 {
   int chk;
   in_type seq_n, seq_s;
 
+  if (seqs)
+    return 0;
+
   seqs = init_vec (sizeof (in_type));
   if (!seqs)
     return -1;
@@ -687,7 +616,7 @@ get_std_seqs ()
     return -1;
 
   seq_s.type = "set";
-  seq_n.seq = "s";
+  seq_s.seq = "s";
   chk = vec_add_obj (seqs, &seq_s);
   if (chk < 0)
     return -1;
@@ -1170,23 +1099,6 @@ parse_connectives (char * in_str, int cur_conn, char ** out_str)
   return 0;
 }
 
-int
-isar_parse_null (char * in_str)
-{
-  // Find '{' character, then find matching '}'.
-  // Return offset.
-  // Should be able to use modified 'parse_parens'.
-
-  printf ("Got null\n");
-
-  int pos = 0;
-
-  while (strncmp (in_str + pos, "*}", 2))
-    pos++;
-
-  return pos;
-}
-
 char *
 isar_mod_fun (char * in_str, char * fun_name)
 {
@@ -1901,36 +1813,87 @@ isar_to_aris (char * isar)
 
   for (i = 0, j = 0; i < is_len; i++)
     {
-      if (isar[i] == '\"')
-	continue;
+      char * conn = NULL, * quant = NULL;
+      int size = 0, conn_len = CL;
 
-      if (!strncmp (isar + i, "-->", 3) || !strncmp (isar + i, "==>", 3))
-	{
-	  strcpy (aris + j, CON);
-	  j += CL;
-	  i += 2;
-	  continue;
-	}
+      // Determine the connective or quantifier that starts here, if any.
 
-      if (!strncmp (isar + i, "\\<longrightarrow>", 17))
+      switch (isar[i])
 	{
-	  strcpy (aris + j, CON);
-	  j += CL;
-	  i += 16;
+	case '\"':
 	  continue;
-	}
 
-      if (isar[i] == '&')
-	{
-	  strcpy (aris + j, AND);
-	  j += CL;
-	  continue;
+	case '-':
+	  if (!strncmp (isar + i, "-->", 3))
+	    conn = CON, size = 3;
+	  break;
+
+	case '=':
+	  if (!strncmp (isar + i, "==>", 3))
+	    conn = CON, size = 3;
+	  break;
+
+	case '<':
+	  if (!strncmp (isar + i, "<->", 3))
+	    conn = BIC, size = 3;
+	  break;
+
+	case '&':
+	  conn = AND, size = 1;
+	  break;
+
+	case '|':
+	  conn = OR, size = 1;
+	  break;
+
+	case '~':
+	  conn = NOT, size = 1, conn_len = NL;
+	  break;
+
+	case '!':
+	  if (!strncmp (isar + i, "!!", 2))
+	    quant = UNV, size = 2;
+	  break;
+
+	case 'A':
+	  if (!strncmp (isar + i, "ALL", 3))
+	    quant = UNV, size = 3;
+	  break;
+
+	case 'E':
+	  if (!strncmp (isar + i, "EX", 2))
+	    quant = EXL, size = 2;
+	  break;
+
+	case '\\':
+	  size = isar_escape_len (isar + i, is_len - i);
+	  switch (isar_symbol (isar + i + 2, size - 3))
+	    {
+	    case ISY_LONGRIGHTARROW:
+	      conn = CON;
+	      break;
+	    case ISY_LONGLEFTRIGHTARROW:
+	      conn = BIC;
+	      break;
+	    case ISY_NOT:
+	      conn = NOT, conn_len = NL;
+	      break;
+	    case ISY_EXISTS:
+	      quant = EXL;
+	      break;
+	    case ISY_FORALL:
+	    case ISY_BIG_AND:
+	      quant = UNV;
+	      break;
+	    }
+	  break;
 	}
 
-      if (isar[i] == '|')
+      if (conn)
 	{
-	  strcpy (aris + j, OR);
-	  j += CL;
+	  strcpy (aris + j, conn);
+	  j += conn_len;
+	  i += size - 1;
 	  continue;
 	}
 
@@ -1940,54 +1903,14 @@ isar_to_aris (char * isar)
       //3.  and make a note of this somehow,
       //      so the processor knows how to handle it later.
 
-      if (!strncmp (isar + i, "EX", 2)
-	  || !strncmp (isar + i, "\\<exists>", 9))
-	{
-	  if (j != 0 && aris[j - 1] == '(')
-	    j--;
-
-	  int size = 0;
-
-	  if (!strncmp (isar + i, "EX", 2))
-	    size = 2;
-	  if (!strncmp (isar + i, "\\<exists>", 9))
-	    size = 9;
-
-	  int new_pos;
-	  char * new_str;
-	  new_pos = parse_quant (isar + i, size, EXL, &new_str);
-	  if (new_pos == -1)
-	    return NULL;
-
-	  strcpy (aris + j, new_str);
-	  j += strlen (new_str);
-	  free (new_str);
-	  i += new_pos;
-	  continue;
-
-	}
-
-      if (!strncmp (isar + i, "!!", 2)
-	  || !strncmp (isar + i, "\\<And>", 6)
-	  || !strncmp (isar + i, "ALL", 3)
-	  || !strncmp (isar + i, "\\<forall>", 9))
+      if (quant)
 	{
 	  if (j != 0 && aris[j - 1] == '(')
 	    j--;
 
-	  int size = 0;
-	  if (!strncmp (isar + i, "!!", 2))
-	    size = 2;
-	  if (!strncmp (isar + i, "\\<And>", 6))
-	    size = 6;
-	  if (!strncmp (isar + i, "ALL", 3))
-	    size = 3;
-	  if (!strncmp (isar + i, "\\<forall>", 9))
-	    size = 9;
-
 	  int new_pos;
 	  char * new_str;
-	  new_pos = parse_quant (isar + i, size, UNV, &new_str);
+	  new_pos = parse_quant (isar + i, size, (unsigned char *) quant, &new_str);
 	  if (new_pos == -1)
 	    return NULL;
 
@@ -1998,37 +1921,6 @@ isar_to_aris (char * isar)
 	  continue;
 	}
 
-      if (!strncmp (isar + i, "<->", 3))
-	{
-	  strcpy (aris + j, BIC);
-	  j += CL;
-	  i += 2;
-	  continue;
-	}
-
-      if (!strncmp (isar + i, "\\<longleftrightarrow>", 21))
-	{
-	  strcpy (aris + j, BIC);
-	  j += CL;
-	  i += 20;
-	  continue;
-	}
-
-      if (!strncmp (isar + i, "\\<not>", 6))
-	{
-	  strcpy (aris + j, NOT);
-	  j += NL;
-	  i += 5;
-	  continue;
-	}
-
-      if (isar[i] == '~')
-	{
-	  strcpy (aris + j, NOT);
-	  j += NL;
-	  continue;
-	}
-
       if (isalpha (isar[i]))
 	{
 	  int new_pos, mod = 1;
@@ -2053,50 +1945,43 @@ isar_to_aris (char * isar)
   return aris;
 }
 
-int
-parse_thy (char * filename, proof_t * proof)
+/* Skips to a keyword in a theory.
+ *  input:
+ *    lx - the lexer.
+ *    tok - receives the keyword.
+ *    key - the keyword to skip to.
+ *  output:
+ *    0 if the keyword was found, -2 if it wasn't.
+ */
+static int
+isar_skip_to (isar_lexer * lx, isar_token * tok, int key)
 {
-  FILE * file;
-
-  file = fopen (filename, "r");
-  CHECK_ALLOC (file, -1);
-
-  int chk;
-  long file_size;
-  chk = fseek (file, 0, SEEK_END);
-  if (chk)
+  while (isar_lex_next (lx, tok) != ITT_EOF)
     {
-      fclose (file);
-      PERROR (NULL);
-      return -1;
+      if (tok->type == ITT_KEYWORD && tok->id == key)
+	return 0;
     }
 
-  file_size = ftell (file);
-
-  chk = fseek (file, 0, SEEK_SET);
-  if (chk)
-    {
-      fclose (file);
-      PERROR (NULL);
-      return -1;
-    }
-
-  char * buffer;
+  return -2;
+}
 
-  buffer = (char *) calloc (file_size, sizeof (char));
-  CHECK_ALLOC (buffer, -1);
+int
+parse_thy (char * filename, proof_t * proof)
+{
+  isar_lexer lx;
+  isar_token tok;
+  int chk;
 
-  fread (buffer, 1, file_size, file);
-  fclose (file);
-  // Read in the file buffer to buffer.
+  chk = isar_lex_open (filename, &lx);
+  if (chk < 0)
+    return -1;
 
   // Determine the main start of the file.
-  char * ret_chk_str;
-  ret_chk_str = strstr (buffer, "theory");
-  if (!ret_chk_str)
+  chk = isar_skip_to (&lx, &tok, IKW_THEORY);
+  if (chk == -2)
     {
       // Invalid .thy file, return an error.
-      free (buffer);
+      isar_lex_close (&lx);
       return -2;
     }
 
@@ -2112,7 +1997,6 @@ parse_thy (char * filename, proof_t * proof)
 
   vec_t * refs, * lms;
 
-  char * buf_pos = ret_chk_str;
   //TODO: Parse the imports.
   // Will need to keep track of which files have already been parsed.
   // A chart of predefined files and their imports is shown here:
@@ -2127,142 +2011,149 @@ parse_thy (char * filename, proof_t * proof)
   chk = get_std_seqs ();
   if (chk == -1)
     {
-      free (buffer);
+      isar_lex_close (&lx);
       return -1;
     }
 
   refs = init_vec (sizeof (char *));
   if (!refs)
     {
-      free (buffer);
+      isar_lex_close (&lx);
       return -1;
     }
 
   lms = init_vec (sizeof (char *));
   if (!lms)
     {
-      free (buffer);
+      isar_lex_close (&lx);
       destroy_vec (refs);
       return -1;
     }
 
-  // After this, buf_pos will point to the position of 'begin'.
-  buf_pos = strstr (buffer, "begin");
-
-  if (strncmp (buf_pos, "begin", 5))
+  // After this, the lexer will be just past 'begin'.
+  chk = isar_skip_to (&lx, &tok, IKW_BEGIN);
+  if (chk == -2)
     {
       // Error stuff.
-      free (buffer);
+      isar_lex_close (&lx);
       destroy_vec (refs);
       destroy_vec (lms);
       return -2;
     }
 
-  buf_pos += 5;
-
-  while (isspace (*buf_pos))
-    buf_pos++;
+  isar_lex_next (&lx, &tok);
 
-  while (1)
+  while (tok.type != ITT_EOF)
     {
-      char * tmp_str, * cur_key;
-      // Determine how to handle the current keyword.
+      char * tmp_str, * cmd;
+      const char * start;
+      int key, len;
 
-      int pos = 0;
-      while (isalnum (buf_pos[pos]) || buf_pos[pos] == '_')
-	pos++;
+      // Anything before a command, such as a comment, is skipped.
+      if (tok.type != ITT_KEYWORD)
+	{
+	  isar_lex_next (&lx, &tok);
+	  continue;
+	}
+
+      key = tok.id;
+      if (key == IKW_END)
+	break;
 
-      cur_key = (char *) calloc (pos + 1, sizeof (char));
-      CHECK_ALLOC (cur_key, -1);
-      strncpy (cur_key, buf_pos, pos);
-      cur_key[pos] = '\0';
+      // The command runs up to the next keyword.
+      start = tok.text;
+      do
+	isar_lex_next (&lx, &tok);
+      while (tok.type != ITT_KEYWORD && tok.type != ITT_EOF);
 
-      // Determine the keyword.
+      // Markup, such as 'text' and 'section', is skipped without being copied.
+      if (key != IKW_TYPE_SYNONYM && key != IKW_FUN && key != IKW_PRIMREC
+	  && key != IKW_DEFINITION && key != IKW_LEMMA && key != IKW_THEOREM
+	  && key != IKW_DATATYPE)
+	continue;
 
-      if (!strcmp (cur_key, "end"))
+      len = tok.text - start;
+      while (len > 0 && isspace (start[len - 1]))
+	len--;
+
+      cmd = (char *) calloc (len + 1, sizeof (char));
+      if (!cmd)
 	{
-	  free (cur_key);
-	  break;
+	  PERROR (NULL);
+	  isar_lex_close (&lx);
+	  return -1;
 	}
 
-      pos = 0;
-      tmp_str = NULL;
+      strncpy (cmd, start, len);
+      cmd[len] = '\0';
 
-      for (i = 0; i < KF_NUM_FUNCS; i++)
+      tmp_str = NULL;
+      switch (key)
 	{
-	  if (!strcmp (cur_key, kfs[i].key))
-	    {
-	      pos = kfs[i].func (buf_pos, &tmp_str);
-	      if (pos == -1)
-		return -1;
-	      break;
-	    }
+	case IKW_TYPE_SYNONYM:
+	  chk = kfs[KF_SYN].func (cmd, &tmp_str);
+	  break;
+	case IKW_FUN:
+	  chk = kfs[KF_FUN].func (cmd, &tmp_str);
+	  break;
+	case IKW_PRIMREC:
+	  chk = kfs[KF_PRIMREC].func (cmd, &tmp_str);
+	  break;
+	case IKW_DEFINITION:
+	  chk = kfs[KF_DEF].func (cmd, &tmp_str);
+	  break;
+	case IKW_LEMMA:
+	  chk = kfs[KF_LEMMA].func (cmd, &tmp_str);
+	  break;
+	case IKW_THEOREM:
+	  chk = kfs[KF_THEOREM].func (cmd, &tmp_str);
+	  break;
+	case IKW_DATATYPE:
+	  chk = isar_parse_datatype (cmd, refs);
+	  break;
 	}
 
-      // Might need to parse brackets in the event of 'text', 'section', etc.
-
-      for (i = 0; null_keys[i]; i++)
+      free (cmd);
+      if (chk == -1)
 	{
-	  if (!strcmp (cur_key, null_keys[i]))
-	    {
-	      pos = isar_parse_null (buf_pos);
-	      if (pos == -1)
-		return -1;
-	      break;
-	    }
+	  isar_lex_close (&lx);
+	  return -1;
 	}
 
-      if (!null_keys[i])
+      if (key == IKW_LEMMA || key == IKW_THEOREM)
 	{
-	  if (!strcmp (cur_key, "datatype"))
-	    {
-	      pos = isar_parse_datatype (buf_pos, refs);
-	      if (pos == -1)
-		return -1;
-	    }
-	  else if (!strcmp (cur_key, "lemma") || !strcmp (cur_key, "theorem"))
-	    {
-	      char * mod_str, * tmp_mod_str;
-	      tmp_mod_str = die_spaces_die (tmp_str);
-	      if (!tmp_mod_str)
-		return -1;
+	  char * mod_str, * tmp_mod_str;
 
-	      chk = parse_connectives (tmp_mod_str, 0, &mod_str);
-	      if (chk == -1)
-		return -1;
-	      free (tmp_mod_str);
+	  if (!tmp_str)
+	    continue;
 
-	      printf ("lemma = '%s'\n", mod_str);
-	      chk = vec_str_add_obj (lms, mod_str);
-	      if (chk < 0)
-		return -1;
-	      free (mod_str);
-	    }
-	  else if (tmp_str)
-	    {
-	      chk = vec_str_add_obj (refs, tmp_str);
-	      if (chk < 0)
-		return -1;
-	    }
-	}
+	  tmp_mod_str = die_spaces_die (tmp_str);
+	  if (!tmp_mod_str)
+	    return -1;
+
+	  chk = parse_connectives (tmp_mod_str, 0, &mod_str);
+	  if (chk == -1)
+	    return -1;
+	  free (tmp_mod_str);
 
-      if (pos == 0)
+	  printf ("lemma = '%s'\n", mod_str);
+	  chk = vec_str_add_obj (lms, mod_str);
+	  if (chk < 0)
+	    return -1;
+	  free (mod_str);
+	}
+      else if (tmp_str)
 	{
-	  // Not a recognized keyword.
+	  chk = vec_str_add_obj (refs, tmp_str);
+	  if (chk < 0)
+	    return -1;
 	}
 
-      while (strncmp (buf_pos + pos, "\n\n", 2))
-	buf_pos++;
-
-      // Find the next non-whitespace character.
-      while (isspace(buf_pos[pos]))
-	pos++;
-
-      buf_pos += pos;
       free (tmp_str);
-      free (cur_key);
     }
 
+  isar_lex_close (&lx);
+
   // Construct the proof.
 
   for (i = 0; i < refs->num_stuff; i++)
@@ -2298,7 +2189,6 @@ parse_thy (char * filename, proof_t * proof)
 
   //destroy_str_vec (refs);
   //destroy_str_vec (lms);
-  free (buffer);
 
   //destroy_vec (seqs);
   return 0;
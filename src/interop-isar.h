@@ -43,11 +43,10 @@ enum KEY_FUNCS {
   KF_NUM_FUNCS,
 };
 
-int isar_run_cmds (unsigned char ** inputs, unsigned char ** output);
-
 unsigned char * correct_conditionals (unsigned char * in_str);
 unsigned char * isar_to_aris (char * isar);
 int parse_thy (char * filename, proof_t * proof);
+int get_std_seqs ();
 int parse_connectives (char * in_str, int cur_conn, char ** out_str);
 int parse_pred_func (char * in_str, char ** out_str);
 
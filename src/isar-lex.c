@@ -0,0 +1,533 @@
+/* Functions for lexing Isar theories.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* The lexer makes one pass over the theory, which is mapped rather
+ *  than read in where that is possible.  Keywords and symbol names are
+ *  looked up in perfect hash tables, so each is a single comparison.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "isar-lex.h"
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+struct isar_name {
+  const char * name;
+  int id;
+};
+
+/* The hash used for both tables.  The constants were chosen so that no
+ *  two names in a table collide; adding a name means choosing them again.
+ */
+#define ISAR_HASH(s,l,a,b,m)                                            \
+  (((l) * (a) + (unsigned char) (s)[0] * (b)                            \
+    + (unsigned char) (s)[(l) - 1] + (unsigned char) (s)[(l) / 2]) % (m))
+
+#define KW_HASH_A 11
+#define KW_HASH_B 37
+#define KW_TABLE_SIZE 57
+
+static const struct isar_name kw_table[KW_TABLE_SIZE] = {
+  [1] = {"corollary", IKW_COROLLARY},
+  [3] = {"abbreviation", IKW_ABBREVIATION},
+  [6] = {"subsubsection", IKW_SUBSUBSECTION},
+  [11] = {"lemmas", IKW_LEMMAS},
+  [12] = {"text", IKW_TEXT},
+  [13] = {"value", IKW_VALUE},
+  [14] = {"subsection", IKW_SUBSECTION},
+  [15] = {"datatype", IKW_DATATYPE},
+  [18] = {"begin", IKW_BEGIN},
+  [23] = {"inductive", IKW_INDUCTIVE},
+  [24] = {"header", IKW_HEADER},
+  [25] = {"axiomatization", IKW_AXIOMATIZATION},
+  [27] = {"imports", IKW_IMPORTS},
+  [29] = {"theorem", IKW_THEOREM},
+  [30] = {"theory", IKW_THEORY},
+  [33] = {"chapter", IKW_CHAPTER},
+  [34] = {"text_raw", IKW_TEXT_RAW},
+  [35] = {"definition", IKW_DEFINITION},
+  [37] = {"type_synonym", IKW_TYPE_SYNONYM},
+  [39] = {"lemma", IKW_LEMMA},
+  [40] = {"primrec", IKW_PRIMREC},
+  [41] = {"function", IKW_FUNCTION},
+  [42] = {"locale", IKW_LOCALE},
+  [44] = {"fun", IKW_FUN},
+  [47] = {"end", IKW_END},
+  [49] = {"record", IKW_RECORD},
+  [52] = {"notation", IKW_NOTATION},
+  [53] = {"declare", IKW_DECLARE},
+  [55] = {"section", IKW_SECTION},
+};
+
+#define SYM_HASH_A 12
+#define SYM_HASH_B 34
+#define SYM_TABLE_SIZE 84
+
+static const struct isar_name sym_table[SYM_TABLE_SIZE] = {
+  [0] = {"omega", ISY_OMEGA},
+  [1] = {"open", ISY_OPEN},
+  [2] = {"theta", ISY_THETA},
+  [4] = {"Omega", ISY_CAP_OMEGA},
+  [6] = {"Theta", ISY_CAP_THETA},
+  [10] = {"pi", ISY_PI},
+  [11] = {"rho", ISY_RHO},
+  [14] = {"Pi", ISY_CAP_PI},
+  [16] = {"mu", ISY_MU},
+  [20] = {"And", ISY_BIG_AND},
+  [21] = {"phi", ISY_PHI},
+  [25] = {"Phi", ISY_CAP_PHI},
+  [26] = {"close", ISY_CLOSE},
+  [30] = {"xi", ISY_XI},
+  [31] = {"longrightarrow", ISY_LONGRIGHTARROW},
+  [32] = {"psi", ISY_PSI},
+  [34] = {"Xi", ISY_CAP_XI},
+  [36] = {"Psi", ISY_CAP_PSI},
+  [37] = {"epsilon", ISY_EPSILON},
+  [39] = {"alpha", ISY_ALPHA},
+  [40] = {"exists", ISY_EXISTS},
+  [41] = {"zeta", ISY_ZETA},
+  [43] = {"kappa", ISY_KAPPA},
+  [49] = {"forall", ISY_FORALL},
+  [50] = {"nu", ISY_NU},
+  [51] = {"iota", ISY_IOTA},
+  [53] = {"delta", ISY_DELTA},
+  [54] = {"sigma", ISY_SIGMA},
+  [55] = {"not", ISY_NOT},
+  [57] = {"Delta", ISY_CAP_DELTA},
+  [58] = {"Sigma", ISY_CAP_SIGMA},
+  [65] = {"beta", ISY_BETA},
+  [71] = {"eta", ISY_ETA},
+  [72] = {"gamma", ISY_GAMMA},
+  [76] = {"Gamma", ISY_CAP_GAMMA},
+  [77] = {"upsilon", ISY_UPSILON},
+  [78] = {"tau", ISY_TAU},
+  [79] = {"Lambda", ISY_CAP_LAMBDA},
+  [80] = {"longleftrightarrow", ISY_LONGLEFTRIGHTARROW},
+  [81] = {"Upsilon", ISY_CAP_UPSILON},
+  [83] = {"chi", ISY_CHI},
+};
+
+static const char * sym_chars = "!#$%&*+-/<=>?@^_|~";
+
+/* Looks up a name in one of the perfect hash tables.
+ *  input:
+ *    table - the table.
+ *    h - the hash of the name.
+ *    str - the name, which need not be terminated.
+ *    len - the length of the name.
+ *  output:
+ *    the id of the name, or -1 if it isn't in the table.
+ */
+static int
+isar_lookup (const struct isar_name * table, int h, const char * str, int len)
+{
+  const char * name = table[h].name;
+
+  if (!name || strncmp (name, str, len) || name[len] != '\0')
+    return -1;
+
+  return table[h].id;
+}
+
+/* Determines which theory level keyword a word is.
+ *  input:
+ *    str - the word, which need not be terminated.
+ *    len - the length of the word.
+ *  output:
+ *    the ISAR_KEYWORD of the word, or -1 if it isn't a keyword.
+ */
+int
+isar_keyword (const char * str, int len)
+{
+  if (len < 1)
+    return -1;
+
+  return isar_lookup (kw_table,
+                      ISAR_HASH (str, len, KW_HASH_A, KW_HASH_B,
+                                 KW_TABLE_SIZE),
+                      str, len);
+}
+
+/* Determines which named symbol a name is.
+ *  input:
+ *    str - the name between '\<' and '>', which need not be terminated.
+ *    len - the length of the name.
+ *  output:
+ *    the ISAR_SYMBOL of the name, or -1 if it isn't known.
+ */
+int
+isar_symbol (const char * str, int len)
+{
+  if (len < 1)
+    return -1;
+
+  return isar_lookup (sym_table,
+                      ISAR_HASH (str, len, SYM_HASH_A, SYM_HASH_B,
+                                 SYM_TABLE_SIZE),
+                      str, len);
+}
+
+/* Determines the length of a symbol such as '\<forall>'.
+ *  input:
+ *    str - the text that may start with a symbol.
+ *    size - the most characters that may be read from str.
+ *  output:
+ *    the length of the symbol, including '\<' and '>', or 0 if str
+ *    doesn't start with one.
+ */
+int
+isar_escape_len (const char * str, size_t size)
+{
+  size_t i;
+
+  if (size < 3 || str[0] != '\\' || str[1] != '<')
+    return 0;
+
+  for (i = 2; i < size; i++)
+    {
+      if (str[i] == '>')
+        return (i > 2) ? i + 1 : 0;
+
+      if (!isalnum ((unsigned char) str[i]) && str[i] != '^' && str[i] != '_')
+        return 0;
+    }
+
+  return 0;
+}
+
+/* Opens a theory for lexing.
+ *  input:
+ *    file_name - the name of the theory file.
+ *    lx - the lexer to open it in.
+ *  output:
+ *    0 on success, -1 on memory error, -2 on i/o error.
+ */
+int
+isar_lex_open (const char * file_name, isar_lexer * lx)
+{
+  FILE * file;
+  long file_size;
+
+  lx->buf = NULL;
+  lx->size = lx->pos = 0;
+  lx->mapped = 0;
+
+#ifndef WIN32
+  struct stat st;
+  int fd;
+
+  fd = open (file_name, O_RDONLY);
+  if (fd < 0)
+    {
+      perror (file_name);
+      return AEC_IO;
+    }
+
+  if (fstat (fd, &st) < 0)
+    {
+      perror (file_name);
+      close (fd);
+      return AEC_IO;
+    }
+
+  lx->size = st.st_size;
+  if (lx->size > 0)
+    {
+      lx->buf = mmap (NULL, lx->size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (lx->buf != MAP_FAILED)
+        {
+          lx->mapped = 1;
+          close (fd);
+          return 0;
+        }
+      lx->buf = NULL;
+    }
+  close (fd);
+#endif
+
+  // Otherwise, read the file in.
+  file = fopen (file_name, "rb");
+  if (!file)
+    {
+      perror (file_name);
+      return AEC_IO;
+    }
+
+  if (fseek (file, 0, SEEK_END) || (file_size = ftell (file)) < 0
+      || fseek (file, 0, SEEK_SET))
+    {
+      perror (file_name);
+      fclose (file);
+      return AEC_IO;
+    }
+
+  lx->buf = (char *) calloc (file_size + 1, sizeof (char));
+  if (!lx->buf)
+    {
+      fclose (file);
+      PERROR (NULL);
+      return AEC_MEM;
+    }
+
+  lx->size = fread (lx->buf, 1, file_size, file);
+  fclose (file);
+
+  return 0;
+}
+
+/* Closes a theory opened for lexing.
+ *  input:
+ *    lx - the lexer.
+ *  output:
+ *    none.
+ */
+void
+isar_lex_close (isar_lexer * lx)
+{
+#ifndef WIN32
+  if (lx->mapped)
+    munmap (lx->buf, lx->size);
+  else
+#endif
+    free (lx->buf);
+
+  lx->buf = NULL;
+  lx->size = lx->pos = 0;
+  lx->mapped = 0;
+}
+
+/* Finds the end of a nested block, such as a comment or cartouche.
+ *  input:
+ *    lx - the lexer, just past the opening delimiter.
+ *    open, close - the delimiters.
+ *  output:
+ *    the position just past the matching closing delimiter, or the end
+ *    of the theory if there is none.
+ */
+static size_t
+isar_lex_nested (isar_lexer * lx, const char * open, const char * close)
+{
+  size_t pos = lx->pos, o_len = strlen (open), c_len = strlen (close);
+  int depth = 1;
+
+  while (pos < lx->size)
+    {
+      if (pos + c_len <= lx->size && !strncmp (lx->buf + pos, close, c_len))
+        {
+          pos += c_len;
+          if (--depth == 0)
+            return pos;
+          continue;
+        }
+
+      if (pos + o_len <= lx->size && !strncmp (lx->buf + pos, open, o_len))
+        {
+          pos += o_len;
+          depth++;
+          continue;
+        }
+
+      pos++;
+    }
+
+  return pos;
+}
+
+/* Reads the next token of a theory.
+ * Tokens point into the text of the theory, so they last until the
+ *  lexer is closed.
+ *  input:
+ *    lx - the lexer.
+ *    tok - receives the token.
+ *  output:
+ *    the type of the token, which is ITT_EOF at the end of the theory.
+ */
+int
+isar_lex_next (isar_lexer * lx, isar_token * tok)
+{
+  const char * buf = lx->buf;
+  size_t size = lx->size, start, pos;
+  int esc;
+
+  while (lx->pos < size && isspace ((unsigned char) buf[lx->pos]))
+    lx->pos++;
+
+  start = pos = lx->pos;
+  tok->text = buf + start;
+  tok->id = -1;
+
+  if (pos >= size)
+    {
+      tok->type = ITT_EOF;
+      tok->len = 0;
+      return ITT_EOF;
+    }
+
+  if (buf[pos] == '(' && pos + 1 < size && buf[pos + 1] == '*')
+    {
+      lx->pos += 2;
+      tok->type = ITT_COMMENT;
+      pos = isar_lex_nested (lx, "(*", "*)");
+    }
+  else if (buf[pos] == '{' && pos + 1 < size && buf[pos + 1] == '*')
+    {
+      tok->type = ITT_VERBATIM;
+      for (pos += 2; pos < size; pos++)
+        {
+          if (buf[pos] == '*' && pos + 1 < size && buf[pos + 1] == '}')
+            {
+              pos += 2;
+              break;
+            }
+        }
+    }
+  else if (buf[pos] == '"' || buf[pos] == '`')
+    {
+      char quote = buf[pos];
+
+      tok->type = ITT_STRING;
+      for (pos++; pos < size && buf[pos] != quote; pos++)
+        {
+          if (buf[pos] == '\\')
+            pos++;
+        }
+
+      if (pos < size)
+        pos++;
+    }
+  else if ((esc = isar_escape_len (buf + pos, size - pos)) > 0)
+    {
+      tok->id = isar_symbol (buf + pos + 2, esc - 3);
+      lx->pos += esc;
+      if (tok->id == ISY_OPEN)
+        {
+          tok->type = ITT_CARTOUCHE;
+          pos = isar_lex_nested (lx, "\\<open>", "\\<close>");
+        }
+      else
+        {
+          tok->type = ITT_ESCAPE;
+          pos = lx->pos;
+        }
+    }
+  else if (pos + 3 <= size && !strncmp (buf + pos, "\xe2\x80\xb9", 3))
+    {
+      // The cartouche quotes, as UTF-8.
+      lx->pos += 3;
+      tok->type = ITT_CARTOUCHE;
+      pos = isar_lex_nested (lx, "\xe2\x80\xb9", "\xe2\x80\xba");
+    }
+  else if (isalpha ((unsigned char) buf[pos]))
+    {
+      for (pos++; pos < size; pos++)
+        {
+          unsigned char c = buf[pos];
+          if (!isalnum (c) && c != '_' && c != '\'' && c != '.')
+            break;
+        }
+
+      tok->id = isar_keyword (buf + start, pos - start);
+      tok->type = (tok->id == -1) ? ITT_IDENT : ITT_KEYWORD;
+    }
+  else if (isdigit ((unsigned char) buf[pos]))
+    {
+      tok->type = ITT_NAT;
+      while (pos < size && isdigit ((unsigned char) buf[pos]))
+        pos++;
+    }
+  else if (buf[pos] != '\0' && strchr (sym_chars, buf[pos]))
+    {
+      tok->type = ITT_SYM;
+      while (pos < size && buf[pos] != '\0' && strchr (sym_chars, buf[pos]))
+        pos++;
+    }
+  else
+    {
+      tok->type = ITT_SYM;
+      pos++;
+    }
+
+  lx->pos = pos;
+  tok->len = pos - start;
+
+  return tok->type;
+}
+
+/* Skips to the imports of a theory.
+ *  input:
+ *    lx - the lexer, before the header of the theory.
+ *  output:
+ *    0 if the lexer is now just past 'imports', -1 if the theory
+ *    doesn't import anything.
+ */
+int
+isar_lex_imports (isar_lexer * lx)
+{
+  isar_token tok;
+
+  while (isar_lex_next (lx, &tok) != ITT_EOF)
+    {
+      if (tok.type != ITT_KEYWORD)
+        continue;
+
+      if (tok.id == IKW_IMPORTS)
+        return 0;
+
+      if (tok.id == IKW_BEGIN)
+        break;
+    }
+
+  return -1;
+}
+
+/* Reads the next import of a theory.
+ *  input:
+ *    lx - the lexer, just past 'imports' or the previous import.
+ *    name - receives the name of the theory imported, without quotes.
+ *    len - receives the length of the name.
+ *  output:
+ *    1 if an import was read, 0 if there are no more.
+ */
+int
+isar_lex_import (isar_lexer * lx, const char ** name, int * len)
+{
+  isar_token tok;
+
+  isar_lex_next (lx, &tok);
+  if (tok.type != ITT_IDENT && tok.type != ITT_STRING)
+    return 0;
+
+  *name = tok.text;
+  *len = tok.len;
+
+  if (tok.type == ITT_STRING)
+    {
+      (*name)++;
+      *len -= (*len > 1) ? 2 : 1;
+    }
+
+  return 1;
+}
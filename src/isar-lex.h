@@ -0,0 +1,151 @@
+/* The Isar theory lexer.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_ISAR_LEX_H
+#define ARIS_ISAR_LEX_H
+
+#include <stddef.h>
+#include "typedef.h"
+
+// The types of Isar tokens.
+
+enum ISAR_TOKEN_TYPE {
+  ITT_EOF = 0,    // The end of the theory.
+  ITT_IDENT,      // An identifier that isn't a keyword.
+  ITT_KEYWORD,    // A theory level keyword.
+  ITT_NAT,        // A natural number.
+  ITT_SYM,        // A run of symbol characters, or a single delimiter.
+  ITT_ESCAPE,     // A symbol such as \<forall>.
+  ITT_STRING,     // A "string" or `alternative string`.
+  ITT_CARTOUCHE,  // Text between \<open> and \<close>.
+  ITT_VERBATIM,   // Text between {* and *}.
+  ITT_COMMENT     // Text between (* and *).
+};
+
+// The theory level keywords.
+
+enum ISAR_KEYWORD {
+  IKW_THEORY = 0,
+  IKW_IMPORTS,
+  IKW_BEGIN,
+  IKW_END,
+  IKW_TYPE_SYNONYM,
+  IKW_FUN,
+  IKW_FUNCTION,
+  IKW_PRIMREC,
+  IKW_DEFINITION,
+  IKW_ABBREVIATION,
+  IKW_LEMMA,
+  IKW_LEMMAS,
+  IKW_THEOREM,
+  IKW_COROLLARY,
+  IKW_DATATYPE,
+  IKW_TEXT,
+  IKW_TEXT_RAW,
+  IKW_SECTION,
+  IKW_SUBSECTION,
+  IKW_SUBSUBSECTION,
+  IKW_CHAPTER,
+  IKW_HEADER,
+  IKW_AXIOMATIZATION,
+  IKW_LOCALE,
+  IKW_INDUCTIVE,
+  IKW_RECORD,
+  IKW_VALUE,
+  IKW_DECLARE,
+  IKW_NOTATION,
+  IKW_NUM
+};
+
+// The named symbols.  The greek letters run from ISY_ALPHA to
+//  ISY_CAP_OMEGA.
+
+enum ISAR_SYMBOL {
+  ISY_LONGRIGHTARROW = 0,
+  ISY_LONGLEFTRIGHTARROW,
+  ISY_NOT,
+  ISY_EXISTS,
+  ISY_FORALL,
+  ISY_BIG_AND,
+  ISY_OPEN,
+  ISY_CLOSE,
+  ISY_ALPHA,
+  ISY_BETA,
+  ISY_GAMMA,
+  ISY_DELTA,
+  ISY_EPSILON,
+  ISY_ZETA,
+  ISY_ETA,
+  ISY_THETA,
+  ISY_IOTA,
+  ISY_KAPPA,
+  ISY_MU,
+  ISY_NU,
+  ISY_XI,
+  ISY_PI,
+  ISY_RHO,
+  ISY_SIGMA,
+  ISY_TAU,
+  ISY_UPSILON,
+  ISY_PHI,
+  ISY_CHI,
+  ISY_PSI,
+  ISY_OMEGA,
+  ISY_CAP_GAMMA,
+  ISY_CAP_DELTA,
+  ISY_CAP_THETA,
+  ISY_CAP_LAMBDA,
+  ISY_CAP_XI,
+  ISY_CAP_PI,
+  ISY_CAP_SIGMA,
+  ISY_CAP_UPSILON,
+  ISY_CAP_PHI,
+  ISY_CAP_PSI,
+  ISY_CAP_OMEGA,
+  ISY_NUM
+};
+
+// A token of an Isar theory.
+
+struct isar_token {
+  int type;            // The type of the token.
+  int id;              // The keyword or symbol, or -1.
+  const char * text;   // The start of the token, within the theory.
+  int len;             // The length of the token.
+};
+
+// A theory being lexed.
+
+struct isar_lexer {
+  char * buf;     // The text of the theory.
+  size_t size;    // The length of the text.
+  size_t pos;     // The position of the next token.
+  int mapped;     // Whether buf is mapped, rather than allocated.
+};
+
+int isar_lex_open (const char * file_name, isar_lexer * lx);
+void isar_lex_close (isar_lexer * lx);
+int isar_lex_next (isar_lexer * lx, isar_token * tok);
+int isar_lex_imports (isar_lexer * lx);
+int isar_lex_import (isar_lexer * lx, const char ** name, int * len);
+
+int isar_keyword (const char * str, int len);
+int isar_symbol (const char * str, int len);
+int isar_escape_len (const char * str, size_t size);
+
+#endif  /*  ARIS_ISAR_LEX_H  */
@@ -0,0 +1,415 @@
+/* Functions for keeping a pool of Isabelle processes.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Each process in the pool stays running between requests.  A request
+ *  is written as its commands followed by ISAR_POOL_END_CMD, and its
+ *  response is everything the prover prints before the line holding
+ *  the matching ISAR_POOL_MARK.  The prover must therefore not echo
+ *  its input.
+ * When there are several requests, each idle process is given one, and
+ *  the responses are read in blocks as they arrive from any of them.
+ * Aris doesn't call on Isabelle yet; the pool is what a prover check
+ *  would go through once there is one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <glib.h>
+#include "isar-pool.h"
+
+#define ISABELLE_PATH "define-me"
+#define ISABELLE_EXEC "define-me"
+
+// The size of each read from a prover.
+#define ISAR_POOL_BLOCK 4096
+
+struct isar_proc {
+  GPid pid;
+  int in_fd, out_fd;    // The pipes to the prover, or -1 if not running.
+  char * buf;           // Output read but not yet returned.
+  size_t len, alloc;
+  int req;              // The request being answered, or -1 if idle.
+  char mark[32];        // The mark that will end the response.
+};
+
+static struct isar_proc * pool = NULL;
+static int pool_size = 0;
+static unsigned int pool_serial = 0;
+
+/* Starts the prover for a process of the pool.
+ *  input:
+ *    ip - the process.
+ *  output:
+ *    0 on success, -2 if the prover couldn't be started.
+ */
+static int
+isar_proc_spawn (struct isar_proc * ip)
+{
+  const char * exec;
+  gchar * args[3];
+  GError * g_err = NULL;
+  gboolean ok;
+
+  exec = getenv (ISAR_POOL_ENV);
+
+  args[0] = (gchar *) (exec ? exec : ISABELLE_EXEC);
+  args[1] = "-I";
+  args[2] = NULL;
+
+  ok = g_spawn_async_with_pipes (exec ? NULL : ISABELLE_PATH,
+                                 args, NULL,
+                                 G_SPAWN_SEARCH_PATH,
+                                 NULL, NULL,
+                                 &ip->pid,
+                                 &ip->in_fd, &ip->out_fd, NULL,
+                                 &g_err);
+  if (!ok)
+    {
+      fprintf (stderr, "%s: %s\n", args[0], g_err->message);
+      g_error_free (g_err);
+      ip->in_fd = ip->out_fd = -1;
+      return AEC_IO;
+    }
+
+  ip->len = 0;
+  ip->req = -1;
+  return 0;
+}
+
+/* Stops the prover for a process of the pool.
+ *  input:
+ *    ip - the process.
+ *  output:
+ *    none.
+ */
+static void
+isar_proc_close (struct isar_proc * ip)
+{
+  if (ip->in_fd != -1)
+    {
+      // Closing its input lets the prover finish on its own.
+      close (ip->in_fd);
+      close (ip->out_fd);
+      g_spawn_close_pid (ip->pid);
+    }
+
+  ip->in_fd = ip->out_fd = -1;
+  ip->len = 0;
+  ip->req = -1;
+}
+
+/* Writes all of a buffer to a pipe.
+ *  input:
+ *    fd - the pipe.
+ *    buf - the buffer.
+ *    len - the length of the buffer.
+ *  output:
+ *    0 on success, -2 on i/o error.
+ */
+static int
+isar_write_all (int fd, const char * buf, size_t len)
+{
+  while (len > 0)
+    {
+      ssize_t n;
+
+      n = write (fd, buf, len);
+      if (n < 0)
+        {
+          if (errno == EINTR)
+            continue;
+
+          perror (NULL);
+          return AEC_IO;
+        }
+
+      buf += n;
+      len -= n;
+    }
+
+  return 0;
+}
+
+/* Sends a request to a process of the pool.
+ *  input:
+ *    ip - the process, which must be idle.
+ *    inputs - the commands of the request, terminated by NULL.
+ *    req - the index of the request.
+ *  output:
+ *    0 on success, -1 on memory error, -2 on i/o error.
+ */
+static int
+isar_proc_send (struct isar_proc * ip, unsigned char ** inputs, int req)
+{
+  char * cmds, * pos;
+  size_t alloc_size;
+  int i, ret;
+
+  sprintf (ip->mark, ISAR_POOL_MARK, ++pool_serial);
+
+  alloc_size = strlen (ISAR_POOL_END_CMD) + 16;
+  for (i = 0; inputs[i]; i++)
+    alloc_size += strlen ((char *) inputs[i]) + 3;
+
+  cmds = (char *) calloc (alloc_size, sizeof (char));
+  CHECK_ALLOC (cmds, AEC_MEM);
+
+  pos = cmds;
+  for (i = 0; inputs[i]; i++)
+    pos += sprintf (pos, "%s;\r\n", inputs[i]);
+  pos += sprintf (pos, ISAR_POOL_END_CMD, pool_serial);
+
+  ret = isar_write_all (ip->in_fd, cmds, pos - cmds);
+  free (cmds);
+  if (ret < 0)
+    return ret;
+
+  ip->req = req;
+  return 0;
+}
+
+/* Reads a block of a response from a process of the pool.
+ *  input:
+ *    ip - the process.
+ *    output - receives the response, once all of it has been read.
+ *  output:
+ *    1 if the response is complete, 0 if more is to come,
+ *    -1 on memory error, -2 if the prover stopped.
+ */
+static int
+isar_proc_read (struct isar_proc * ip, unsigned char ** output)
+{
+  char * mark, * rest;
+  size_t start, end, mark_len;
+  ssize_t n;
+
+  if (ip->alloc - ip->len < ISAR_POOL_BLOCK + 1)
+    {
+      size_t new_alloc;
+
+      new_alloc = (ip->alloc > 0) ? ip->alloc * 2 : ISAR_POOL_BLOCK * 2;
+      ip->buf = (char *) realloc (ip->buf, new_alloc);
+      CHECK_ALLOC (ip->buf, AEC_MEM);
+      ip->alloc = new_alloc;
+    }
+
+  n = read (ip->out_fd, ip->buf + ip->len, ISAR_POOL_BLOCK);
+  if (n < 0 && errno == EINTR)
+    return 0;
+
+  if (n <= 0)
+    return AEC_IO;
+
+  // Only the new text, and enough before it to hold part of the mark,
+  //  needs to be searched.
+  mark_len = strlen (ip->mark);
+  start = (ip->len > mark_len) ? ip->len - mark_len : 0;
+  ip->len += n;
+  ip->buf[ip->len] = '\0';
+
+  mark = strstr (ip->buf + start, ip->mark);
+  if (!mark)
+    return 0;
+
+  end = mark - ip->buf;
+  while (end > 0 && ip->buf[end - 1] != '\n')
+    end--;
+
+  *output = (unsigned char *) calloc (end + 1, sizeof (char));
+  CHECK_ALLOC (*output, AEC_MEM);
+  memcpy (*output, ip->buf, end);
+
+  // Keep anything that follows the line of the mark.
+  rest = strchr (mark, '\n');
+  rest = rest ? rest + 1 : ip->buf + ip->len;
+  ip->len -= rest - ip->buf;
+  memmove (ip->buf, rest, ip->len);
+
+  ip->req = -1;
+  return 1;
+}
+
+/* Starts a pool of provers, stopping any that was running.
+ *  input:
+ *    size - the number of provers.
+ *  output:
+ *    0 on success, -1 on memory error, -2 if a prover couldn't be
+ *    started.
+ */
+int
+isar_pool_start (int size)
+{
+  int i, ret;
+
+  isar_pool_stop ();
+
+  pool = (struct isar_proc *) calloc (size, sizeof (struct isar_proc));
+  CHECK_ALLOC (pool, AEC_MEM);
+  pool_size = size;
+
+  for (i = 0; i < size; i++)
+    {
+      pool[i].in_fd = pool[i].out_fd = -1;
+      pool[i].req = -1;
+    }
+
+  for (i = 0; i < size; i++)
+    {
+      ret = isar_proc_spawn (pool + i);
+      if (ret < 0)
+        {
+          isar_pool_stop ();
+          return ret;
+        }
+    }
+
+  return 0;
+}
+
+/* Stops the pool of provers.
+ *  input:
+ *    none.
+ *  output:
+ *    none.
+ */
+void
+isar_pool_stop ()
+{
+  int i;
+
+  if (!pool)
+    return;
+
+  for (i = 0; i < pool_size; i++)
+    {
+      isar_proc_close (pool + i);
+      free (pool[i].buf);
+    }
+
+  free (pool);
+  pool = NULL;
+  pool_size = 0;
+}
+
+/* Runs requests on the pool of provers, starting a single prover if
+ *  no pool is running.
+ *  input:
+ *    inputs - the requests, each a list of commands terminated by NULL.
+ *    num - the number of requests.
+ *    outputs - receives the response to each request.
+ *  output:
+ *    0 on success, -1 on memory error, -2 on i/o error.  On error,
+ *    no responses are returned, and the provers that were answering
+ *    are restarted on the next request.
+ */
+int
+isar_pool_run (unsigned char *** inputs, int num, unsigned char ** outputs)
+{
+  GPollFD * fds;
+  int i, ret, next = 0, done = 0;
+
+  if (!pool)
+    {
+      ret = isar_pool_start (1);
+      if (ret < 0)
+        return ret;
+    }
+
+  for (i = 0; i < num; i++)
+    outputs[i] = NULL;
+
+  fds = (GPollFD *) calloc (pool_size, sizeof (GPollFD));
+  CHECK_ALLOC (fds, AEC_MEM);
+
+  while (done < num)
+    {
+      // Hand waiting requests to the idle provers.
+      for (i = 0; i < pool_size && next < num; i++)
+        {
+          if (pool[i].req != -1)
+            continue;
+
+          if (pool[i].in_fd == -1)
+            {
+              ret = isar_proc_spawn (pool + i);
+              if (ret < 0)
+                goto run_fail;
+            }
+
+          ret = isar_proc_send (pool + i, inputs[next], next);
+          if (ret < 0)
+            {
+              isar_proc_close (pool + i);
+              goto run_fail;
+            }
+          next++;
+        }
+
+      for (i = 0; i < pool_size; i++)
+        {
+          fds[i].fd = (pool[i].req != -1) ? pool[i].out_fd : -1;
+          fds[i].events = G_IO_IN | G_IO_HUP | G_IO_ERR;
+          fds[i].revents = 0;
+        }
+
+      if (g_poll (fds, pool_size, -1) < 0)
+        {
+          if (errno == EINTR)
+            continue;
+
+          perror (NULL);
+          ret = AEC_IO;
+          goto run_fail;
+        }
+
+      for (i = 0; i < pool_size; i++)
+        {
+          if (pool[i].req == -1 || !fds[i].revents)
+            continue;
+
+          ret = isar_proc_read (pool + i, outputs + pool[i].req);
+          if (ret < 0)
+            goto run_fail;
+
+          done += ret;
+        }
+    }
+
+  free (fds);
+  return 0;
+
+ run_fail:
+  free (fds);
+
+  for (i = 0; i < pool_size; i++)
+    {
+      if (pool[i].req != -1)
+        isar_proc_close (pool + i);
+    }
+
+  for (i = 0; i < num; i++)
+    {
+      free (outputs[i]);
+      outputs[i] = NULL;
+    }
+
+  return ret;
+}
@@ -0,0 +1,39 @@
+/* A pool of Isabelle processes.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_ISAR_POOL_H
+#define ARIS_ISAR_POOL_H
+
+#include "typedef.h"
+
+// The mark that ends each response, with the serial number of its
+//  request, and the command that asks the prover to print it.
+
+#define ISAR_POOL_MARK "<<aris-end %u>>"
+#define ISAR_POOL_END_CMD "writeln \"" ISAR_POOL_MARK "\";\r\n"
+
+// The environment variable that names the prover to run instead of
+//  Isabelle, such as a scripted stand-in.
+
+#define ISAR_POOL_ENV "ARIS_ISABELLE"
+
+int isar_pool_start (int size);
+void isar_pool_stop ();
+int isar_pool_run (unsigned char *** inputs, int num, unsigned char ** outputs);
+
+#endif  /*  ARIS_ISAR_POOL_H  */
@@ -0,0 +1,339 @@
+/* Functions for caching the proofs used as lemmas.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Before a proof is evaluated, every lemma file that it cites is
+ *  handed to a pool of loader threads, so that the files are read
+ *  while the first lines are checked.  A line that cites a lemma
+ *  waits only if its file is still being loaded.
+ * Each loaded proof is kept, keyed by file name, until its file
+ *  changes.  A proof is only ever read once it is ready, so it is
+ *  shared between threads, and is freed once the cache and every
+ *  holder have let go of it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include "lemma-cache.h"
+#include "aio.h"
+#include "list.h"
+#include "proof.h"
+#include "sen-data.h"
+#include "thy-cache.h"
+
+// Guards the table and the state of each lemma.
+static GMutex lemma_lock;
+static GCond lemma_cond;
+
+// Translating a theory may use the prover, so only one is done at a time.
+static GMutex lemma_thy_lock;
+
+static GHashTable * lemmas = NULL;
+static GThreadPool * lemma_pool = NULL;
+
+/* Loads the proof from a lemma file.
+ *  input:
+ *    file_name - the name of the lemma file.
+ *  output:
+ *    the proof, or NULL on error.
+ */
+static proof_t *
+lemma_load (const char * file_name)
+{
+  proof_t * proof;
+  int f_len, ret;
+
+  f_len = strlen (file_name);
+  if (f_len < 4 || strcmp (file_name + f_len - 4, ".thy"))
+    return aio_open (file_name);
+
+  proof = proof_init ();
+  if (!proof)
+    return NULL;
+
+  g_mutex_lock (&lemma_thy_lock);
+  ret = thy_cache_parse ((char *) file_name, proof);
+  g_mutex_unlock (&lemma_thy_lock);
+
+  if (ret < 0)
+    {
+      proof_destroy (proof);
+      free (proof);
+      return NULL;
+    }
+
+  return proof;
+}
+
+/* Drops a hold on a lemma, freeing it once nothing holds it.
+ * The lock must be held.
+ *  input:
+ *    lm - the lemma.
+ *  output:
+ *    none.
+ */
+static void
+lemma_unref (lemma * lm)
+{
+  lm->refs--;
+  if (lm->refs > 0)
+    return;
+
+  if (lm->proof)
+    {
+      proof_destroy (lm->proof);
+      free (lm->proof);
+    }
+
+  free (lm->file);
+  free (lm);
+}
+
+/* Adds a lemma to the table, replacing any stale one.
+ * The lock must be held.
+ *  input:
+ *    file_name - the name of the lemma file.
+ *    mtime - the modification time of the file.
+ *  output:
+ *    the new lemma, held only by the table, or NULL on memory error.
+ */
+static lemma *
+lemma_new (const char * file_name, time_t mtime)
+{
+  lemma * lm, * old;
+
+  lm = (lemma *) calloc (1, sizeof (lemma));
+  CHECK_ALLOC (lm, NULL);
+
+  lm->file = strdup (file_name);
+  if (!lm->file)
+    {
+      PERROR (NULL);
+      free (lm);
+      return NULL;
+    }
+
+  lm->mtime = mtime;
+  lm->state = LEMMA_LOADING;
+  lm->refs = 1;
+
+  old = g_hash_table_lookup (lemmas, file_name);
+  if (old)
+    {
+      g_hash_table_remove (lemmas, file_name);
+      lemma_unref (old);
+    }
+
+  g_hash_table_insert (lemmas, lm->file, lm);
+  return lm;
+}
+
+/* Loads a lemma.  Runs on a loader thread.
+ *  input:
+ *    data - the lemma to load.
+ *    user_data - unused.
+ *  output:
+ *    none.
+ */
+static void
+lemma_load_run (gpointer data, gpointer user_data)
+{
+  lemma * lm = data;
+  proof_t * proof;
+
+  proof = lemma_load (lm->file);
+
+  g_mutex_lock (&lemma_lock);
+  lm->proof = proof;
+  lm->state = (proof) ? LEMMA_READY : LEMMA_MISSING;
+  lemma_unref (lm);
+  g_cond_broadcast (&lemma_cond);
+  g_mutex_unlock (&lemma_lock);
+}
+
+/* Creates the table and the loader threads, if need be.
+ * The lock must be held.
+ *  input:
+ *    none.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+lemma_cache_init ()
+{
+  if (!lemmas)
+    {
+      lemmas = g_hash_table_new (g_str_hash, g_str_equal);
+      if (!lemmas)
+        return AEC_MEM;
+    }
+
+  if (!lemma_pool)
+    {
+      lemma_pool = g_thread_pool_new (lemma_load_run, NULL,
+                                      LEMMA_CACHE_THREADS, FALSE, NULL);
+      if (!lemma_pool)
+        return AEC_MEM;
+    }
+
+  return 0;
+}
+
+/* Starts loading each lemma file that a proof cites.
+ * Files that can't be found are reported now, rather than once
+ *  evaluation reaches the lines that cite them.
+ *  input:
+ *    everything - the sentences of the proof.
+ *  output:
+ *    the number of missing lemma files, or -1 on memory error.
+ */
+int
+lemma_cache_prefetch (list_t * everything)
+{
+  GHashTable * seen;
+  item_t * ev_itr;
+  int missing = 0;
+
+  seen = g_hash_table_new (g_str_hash, g_str_equal);
+  if (!seen)
+    return AEC_MEM;
+
+  g_mutex_lock (&lemma_lock);
+  if (lemma_cache_init () == AEC_MEM)
+    {
+      g_mutex_unlock (&lemma_lock);
+      g_hash_table_destroy (seen);
+      return AEC_MEM;
+    }
+
+  for (ev_itr = everything->head; ev_itr; ev_itr = ev_itr->next)
+    {
+      sen_data * sd = ev_itr->value;
+      GStatBuf st;
+      lemma * lm;
+
+      if (!sd->file || g_hash_table_lookup (seen, sd->file))
+        continue;
+      g_hash_table_insert (seen, sd->file, sd->file);
+
+      if (g_stat ((char *) sd->file, &st) != 0)
+        {
+          fprintf (stderr, "Lemma Error - unable to open lemma file '%s'.\n",
+                   (char *) sd->file);
+          missing++;
+          continue;
+        }
+
+      lm = g_hash_table_lookup (lemmas, sd->file);
+      if (lm && lm->mtime == st.st_mtime && lm->state != LEMMA_MISSING)
+        continue;
+
+      lm = lemma_new ((char *) sd->file, st.st_mtime);
+      if (!lm)
+        {
+          missing = AEC_MEM;
+          break;
+        }
+
+      // The loader holds the lemma until it is done.
+      lm->refs++;
+      g_thread_pool_push (lemma_pool, lm, NULL);
+    }
+
+  g_mutex_unlock (&lemma_lock);
+  g_hash_table_destroy (seen);
+
+  return missing;
+}
+
+/* Gets the proof of a lemma file, waiting for it if it is being
+ *  loaded, and loading it here if it wasn't prefetched.
+ *  input:
+ *    file_name - the name of the lemma file.
+ *  output:
+ *    the lemma, which must be released once its proof is used,
+ *    or NULL if the file couldn't be read.
+ */
+lemma *
+lemma_cache_get (const char * file_name)
+{
+  GStatBuf st;
+  lemma * lm;
+  proof_t * proof;
+
+  if (g_stat (file_name, &st) != 0)
+    return NULL;
+
+  g_mutex_lock (&lemma_lock);
+  if (lemma_cache_init () == AEC_MEM)
+    {
+      g_mutex_unlock (&lemma_lock);
+      return NULL;
+    }
+
+  lm = g_hash_table_lookup (lemmas, file_name);
+  if (lm && lm->mtime == st.st_mtime && lm->state != LEMMA_MISSING)
+    {
+      lm->refs++;
+      while (lm->state == LEMMA_LOADING)
+        g_cond_wait (&lemma_cond, &lemma_lock);
+    }
+  else
+    {
+      lm = lemma_new (file_name, st.st_mtime);
+      if (!lm)
+        {
+          g_mutex_unlock (&lemma_lock);
+          return NULL;
+        }
+      lm->refs++;
+      g_mutex_unlock (&lemma_lock);
+
+      proof = lemma_load (file_name);
+
+      g_mutex_lock (&lemma_lock);
+      lm->proof = proof;
+      lm->state = (proof) ? LEMMA_READY : LEMMA_MISSING;
+      g_cond_broadcast (&lemma_cond);
+    }
+
+  if (lm->state == LEMMA_MISSING)
+    {
+      lemma_unref (lm);
+      lm = NULL;
+    }
+
+  g_mutex_unlock (&lemma_lock);
+  return lm;
+}
+
+/* Lets go of a lemma that was gotten from the cache.
+ *  input:
+ *    lm - the lemma.
+ *  output:
+ *    none.
+ */
+void
+lemma_cache_release (lemma * lm)
+{
+  g_mutex_lock (&lemma_lock);
+  lemma_unref (lm);
+  g_mutex_unlock (&lemma_lock);
+}
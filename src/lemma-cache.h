@@ -0,0 +1,48 @@
+/* Functions for caching the proofs used as lemmas.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_LEMMA_CACHE_H
+#define ARIS_LEMMA_CACHE_H
+
+#include <time.h>
+#include "typedef.h"
+
+// The most lemma files that are loaded at once.
+#define LEMMA_CACHE_THREADS 4
+
+enum LEMMA_STATE {
+  LEMMA_LOADING = 0,
+  LEMMA_READY,
+  LEMMA_MISSING
+};
+
+// A lemma file, and the proof loaded from it.
+
+struct lemma {
+  char * file;          // The name of the lemma file.
+  proof_t * proof;      // The proof, once it is ready.
+  time_t mtime;         // The modification time of the file when read.
+  int state;            // One of LEMMA_STATE.
+  int refs;             // The number of holders, counting the cache.
+};
+
+int lemma_cache_prefetch (list_t * everything);
+lemma * lemma_cache_get (const char * file_name);
+void lemma_cache_release (lemma * lm);
+
+#endif  /*  ARIS_LEMMA_CACHE_H  */
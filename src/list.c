@@ -222,6 +222,7 @@ ls_clear (list_t * ls)
     }
 
   ls->head = ls->tail = NULL;
+  ls->num_stuff = 0;
 }
 
 /* Obtains an item in a list by the item's index.
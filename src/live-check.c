@@ -0,0 +1,354 @@
+/* Functions for checking proofs as they are edited.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Edited sentences are only marked, and once the proof has been left
+ *  alone for LIVE_CHECK_DELAY milliseconds, the lines of the proof are
+ *  copied once, and each marked sentence and the sentences citing it
+ *  are handed to a worker thread along with the shared copies.
+ * The worker only ever sees the copies, and the verdicts are handed
+ *  back to the main loop, which drops those of jobs that have since
+ *  been replaced or whose sentence is gone.
+ */
+
+#include <stdlib.h>
+#include "live-check.h"
+#include "aris-proof.h"
+#include "sen-parent.h"
+#include "sentence.h"
+#include "sen-data.h"
+#include "sexpr-process.h"
+#include "rules.h"
+#include "list.h"
+
+// The jobs are run one at a time, in the order that they were queued.
+static GThreadPool * live_pool = NULL;
+
+/* Copies the data of every line of a proof.  Runs on the main loop.
+ *  input:
+ *    sp - the proof to copy.
+ *  output:
+ *    the snapshot, with one reference, or NULL on memory error.
+ */
+live_snapshot *
+live_snapshot_take (sen_parent * sp)
+{
+  live_snapshot * snap;
+  item_t * ev_itr;
+
+  snap = (live_snapshot *) calloc (1, sizeof (live_snapshot));
+  CHECK_ALLOC (snap, NULL);
+
+  snap->refs = 1;
+  snap->lines = init_list ();
+  if (!snap->lines)
+    {
+      free (snap);
+      return NULL;
+    }
+
+  for (ev_itr = sp->everything->head; ev_itr; ev_itr = ev_itr->next)
+    {
+      sen_data * sd;
+
+      sd = sentence_copy_to_data (ev_itr->value);
+      if (!sd || !ls_push_obj (snap->lines, sd))
+        {
+          if (sd)
+            sen_data_destroy (sd);
+          live_snapshot_unref (snap);
+          return NULL;
+        }
+    }
+
+  return snap;
+}
+
+/* Releases a reference to a snapshot, destroying it with the last one.
+ *  input:
+ *    snap - the snapshot to release.
+ *  output:
+ *    none.
+ */
+void
+live_snapshot_unref (live_snapshot * snap)
+{
+  item_t * itm, * n_itm;
+
+  if (!g_atomic_int_dec_and_test (&snap->refs))
+    return;
+
+  for (itm = snap->lines->head; itm; itm = n_itm)
+    {
+      n_itm = itm->next;
+      sen_data_destroy (itm->value);
+      free (itm);
+    }
+  free (snap->lines);
+  free (snap);
+}
+
+/* Destroys a live checking job.
+ *  input:
+ *    job - the job to destroy.
+ *  output:
+ *    none.
+ */
+static void
+live_job_destroy (live_job * job)
+{
+  if (job->sd)
+    sen_data_destroy (job->sd);
+
+  if (job->snap)
+    live_snapshot_unref (job->snap);
+
+  free (job);
+}
+
+/* Hands the verdict of a job to its sentence.  Runs on the main loop.
+ *  input:
+ *    data - the finished job.
+ *  output:
+ *    FALSE, so that the idle source is removed.
+ */
+static gboolean
+live_check_done (gpointer data)
+{
+  live_job * job = data;
+  sentence * sen = job->sen;
+
+  if (sen && sen->live == job)
+    {
+      sen->live = NULL;
+
+      if (job->ret_str && !g_atomic_int_get (&job->cancelled))
+        {
+          sen_parent * sp = sen->parent;
+
+          sentence_set_value (sen, job->ret);
+          if (sp->focused && sp->focused->value == sen)
+            aris_proof_set_sb (ARIS_PROOF (sp), job->ret_str);
+        }
+    }
+
+  live_job_destroy (job);
+  return FALSE;
+}
+
+/* Evaluates a job.  Runs on the worker thread.
+ *  input:
+ *    data - the job to evaluate.
+ *    user_data - unused.
+ *  output:
+ *    none.
+ */
+static void
+live_check_run (gpointer data, gpointer user_data)
+{
+  live_job * job = data;
+  list_t * vars, * lines;
+  item_t * itm;
+  int ret;
+
+  if (g_atomic_int_get (&job->cancelled))
+    goto done;
+
+  vars = init_list ();
+  if (!vars)
+    goto done;
+
+  lines = init_list ();
+  if (!lines)
+    {
+      destroy_list (vars);
+      goto done;
+    }
+
+  // Take the same lines that evaluate_line would.  The snapshot is
+  //  only ever touched by this thread, so the sexprs are kept in it
+  //  for the jobs that follow.
+  for (itm = job->snap->lines->head; itm; itm = itm->next)
+    {
+      sen_data * sd = itm->value;
+      int var_mode = -1;
+
+      if (sd->line_num == job->sd->line_num)
+        break;
+
+      if (!ls_push_obj (lines, sd))
+        goto mem_err;
+
+      ret = sd_convert_sexpr (sd);
+      if (ret == AEC_MEM)
+        goto mem_err;
+
+      if (sen_data_can_select_as_ref (job->sd, sd) == sd->line_num)
+        var_mode = (sd->premise || sd->subproof
+                    || sd->rule == RULE_EI || sd->rule == RULE_SQ) ? 0 : 1;
+
+      if (ret == 0 && var_mode != -1)
+        {
+          ret = sexpr_collect_vars_to_proof (vars, sd->sexpr, var_mode);
+          if (ret == AEC_MEM)
+            goto mem_err;
+        }
+    }
+
+  job->ret_str = sen_data_evaluate (job->sd, &job->ret, vars, lines);
+
+ mem_err:
+  destroy_list (lines);
+  destroy_list (vars);
+
+ done:
+  g_idle_add (live_check_done, job);
+}
+
+/* Queues a check of a sentence, replacing any that is still pending.
+ *  input:
+ *    sen - the sentence to check.
+ *    snap - the lines of its proof, taken by live_snapshot_take.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+live_check_queue (sentence * sen, live_snapshot * snap)
+{
+  live_job * job;
+
+  if (!live_pool)
+    {
+      live_pool = g_thread_pool_new (live_check_run, NULL, 1, FALSE, NULL);
+      if (!live_pool)
+        return AEC_MEM;
+    }
+
+  job = (live_job *) calloc (1, sizeof (live_job));
+  CHECK_ALLOC (job, AEC_MEM);
+
+  job->sd = sentence_copy_to_data (sen);
+  if (!job->sd)
+    {
+      live_job_destroy (job);
+      return AEC_MEM;
+    }
+
+  g_atomic_int_inc (&snap->refs);
+  job->snap = snap;
+
+  if (sen->live)
+    {
+      g_atomic_int_set (&sen->live->cancelled, 1);
+      sen->live->sen = NULL;
+    }
+
+  job->sen = sen;
+  sen->live = job;
+
+  g_thread_pool_push (live_pool, job, NULL);
+  return 0;
+}
+
+/* Checks the marked sentences of a proof once it has been left alone.
+ *  input:
+ *    data - the aris proof to check.
+ *  output:
+ *    FALSE, so that the timeout is removed.
+ */
+static gboolean
+live_check_timeout (gpointer data)
+{
+  aris_proof * ap = data;
+  live_snapshot * snap;
+  item_t * ev_itr, * c_itr;
+
+  ap->live_timer = 0;
+
+  snap = live_snapshot_take (SEN_PARENT (ap));
+  if (!snap)
+    return FALSE;
+
+  for (ev_itr = SEN_PARENT (ap)->everything->head; ev_itr;
+       ev_itr = ev_itr->next)
+    {
+      sentence * sen = ev_itr->value;
+
+      if (!sen->live_dirty)
+        continue;
+
+      sen->live_dirty = 0;
+      if (live_check_queue (sen, snap) == AEC_MEM)
+        break;
+
+      for (c_itr = sen->cited_by->head; c_itr; c_itr = c_itr->next)
+        {
+          if (live_check_queue (c_itr->value, snap) == AEC_MEM)
+            break;
+        }
+      if (c_itr)
+        break;
+    }
+
+  // Each job holds its own reference.
+  live_snapshot_unref (snap);
+  return FALSE;
+}
+
+/* Marks a sentence as needing a check, and restarts the wait before
+ *  its proof is checked.  Does nothing unless live checking is on.
+ *  input:
+ *    sen - the sentence that was modified.
+ *  output:
+ *    none.
+ */
+void
+live_check_mark (sentence * sen)
+{
+  aris_proof * ap;
+
+  if (!sen->parent || sen->parent->type != SEN_PARENT_TYPE_PROOF)
+    return;
+
+  ap = ARIS_PROOF (sen->parent);
+  if (!ap->live)
+    return;
+
+  sen->live_dirty = 1;
+
+  if (ap->live_timer)
+    g_source_remove (ap->live_timer);
+  ap->live_timer = g_timeout_add (LIVE_CHECK_DELAY, live_check_timeout,
+                                  (gpointer) ap);
+}
+
+/* Drops the pending check of a sentence that is being destroyed.
+ *  input:
+ *    sen - the sentence being destroyed.
+ *  output:
+ *    none.
+ */
+void
+live_check_forget (sentence * sen)
+{
+  if (!sen->live)
+    return;
+
+  g_atomic_int_set (&sen->live->cancelled, 1);
+  sen->live->sen = NULL;
+  sen->live = NULL;
+}
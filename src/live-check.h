@@ -0,0 +1,54 @@
+/* Live checking of proofs.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_LIVE_CHECK_H
+#define ARIS_LIVE_CHECK_H
+
+#include <gtk/gtk.h>
+#include "typedef.h"
+
+// The time to wait after the last edit before checking, in milliseconds.
+#define LIVE_CHECK_DELAY 400
+
+// Copies of the data of every line of a proof, taken once and shared
+//  by each job queued from the same check.
+
+struct live_snapshot {
+  list_t * lines;       // The copies, in the order of the proof.
+  volatile gint refs;   // The number of jobs using the snapshot.
+};
+
+// A sentence to be evaluated away from the main loop against the
+//  lines of a snapshot that come before it.
+
+struct live_job {
+  sentence * sen;       // The sentence, or NULL once it is gone.
+  sen_data * sd;        // The copy of the sentence's data.
+  live_snapshot * snap; // The lines of the proof.
+  volatile gint cancelled;  // Set once a newer job replaces this one.
+  char * ret_str;       // The message from the evaluation.
+  int ret;              // The value type from the evaluation.
+};
+
+void live_check_mark (sentence * sen);
+live_snapshot * live_snapshot_take (sen_parent * sp);
+void live_snapshot_unref (live_snapshot * snap);
+int live_check_queue (sentence * sen, live_snapshot * snap);
+void live_check_forget (sentence * sen);
+
+#endif  /*  ARIS_LIVE_CHECK_H  */
@@ -18,16 +18,22 @@
 
 #include "process.h"
 #include "vec.h"
+#include "sexpr-sig.h"
 
 char *
 process (unsigned char * conc, vec_t * prems, const char * rule, vec_t * vars,
-	 proof_t * proof)
+	 proof_t * proof, vec_t * sigs)
 {
   unsigned char * conclusion;
 
   conclusion = conc;
 
-  char * infer, * equiv, * quant, * misc, * bool;
+  char * infer, * equiv, * quant, * misc, * bool, * sig;
+
+  // Reject lines that cannot follow by the rule before doing any work.
+  sig = sexpr_sig_check (conclusion, prems, sigs, rule);
+  if (sig)
+    return sig;
 
   infer = process_inference (conclusion, prems, rule);
   if (!infer)
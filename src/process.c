@@ -22,6 +22,7 @@
 #include "list.h"
 #include "sen-data.h"
 #include "rules.h"
+#include "tokenize.h"
 
 #include <ctype.h>
 #include <math.h>
@@ -160,6 +161,53 @@ format_string (unsigned char * in_str)
   return ret_str;
 }
 
+/* Converts the connectives of a string to the internal encoding.
+ *  input:
+ *    in_str - the string to convert, which may contain both the
+ *      single byte and the UTF-8 connectives.
+ *  output:
+ *    a newly allocated string with only single byte connectives,
+ *    or NULL on memory error.
+ */
+unsigned char *
+normalize_conns (const unsigned char * in_str)
+{
+  unsigned char * ret_str;
+  int i, j, k;
+
+  ret_str = (unsigned char *) calloc (strlen ((const char *) in_str) + 1,
+				      sizeof (char));
+  CHECK_ALLOC (ret_str, NULL);
+
+  i = j = 0;
+  while (in_str[i] != '\0')
+    {
+      // Every UTF-8 connective begins with a non-ASCII byte.
+      if (in_str[i] & 0x80)
+	{
+	  for (k = 0; k < NUM_CONNS; k++)
+	    {
+	      int len = strlen (conn_list_back[k]);
+	      if (!strncmp ((const char *) in_str + i, conn_list_back[k], len))
+		{
+		  ret_str[j++] = conn_list[k][0];
+		  i += len;
+		  break;
+		}
+	    }
+
+	  if (k < NUM_CONNS)
+	    continue;
+	}
+
+      ret_str[j++] = in_str[i++];
+    }
+
+  ret_str[j] = '\0';
+
+  return ret_str;
+}
+
 /* Finds a difference between two strings.
  *  input:
  *    sen_0 - the first string.
@@ -457,82 +505,118 @@ check_parens (const unsigned char *chk_str)
   return 0;
 }
 
+/* Determines whether a token may begin an operand.
+ *  input:
+ *    chk_str - the string that was tokenized.
+ *    tok - the token to check.
+ *  output:
+ *    1 if the token is a quantifier, negation, parenthesis,
+ *    boolean constant, null symbol or predicate, 0 otherwise.
+ */
+static int
+tok_is_good (const unsigned char * chk_str, const token_t * tok)
+{
+  if (tok->type == TOK_OPAREN)
+    return 1;
+
+  if (tok->type == TOK_CONN)
+    return (tok->conn == UNV_CONN || tok->conn == EXL_CONN
+	    || tok->conn == NOT_CONN || tok->conn == CTR_CONN
+	    || tok->conn == NIL_CONN || tok->conn == TAU_CONN);
+
+  return (tok->type != TOK_END && isupper (chk_str[tok->pos]));
+}
+
 /* Checks that each connective is not beside another connective.
  *  input:
  *    chk_str - the string to check.
- *    init_pos - the position of a connective.
+ *    toks - the tokens of chk_str.
+ *    tok_num - the index of a connective in toks.
  *  output:
  *    1 if the connective checks out, 0 otherwise.
  */
 int
-check_sides (const unsigned char * chk_str, const unsigned int init_pos)
+check_sides (const unsigned char * chk_str, const token_t * toks,
+	     const int tok_num)
 {
+  const token_t * prev, * next;
 
   //Confirm that the connective is not at the beginning of
   //the original string.
-  if (init_pos == 0)
+  if (tok_num == 0)
     return 0;
 
-  if (!isalnum (chk_str[init_pos - 1]) && chk_str[init_pos - 1] != ')'
-      && (init_pos < CL || (strncmp (chk_str + init_pos - CL, NIL, CL)
-			    && strncmp (chk_str + init_pos - CL, CTR, CL)
-			    && strncmp (chk_str + init_pos - CL, TAU, CL))))
+  prev = toks + tok_num - 1;
+  if (!isalnum (chk_str[toks[tok_num].pos - 1]) && prev->type != TOK_CPAREN
+      && !TOK_IS_CONN (prev, NIL_CONN) && !TOK_IS_CONN (prev, CTR_CONN)
+      && !TOK_IS_CONN (prev, TAU_CONN))
     return 0;
 
-  //This connective must not be the last character.
-  if (chk_str[init_pos + CL] == '\0')
+  //This connective must not be the last token.
+  next = toks + tok_num + 1;
+  if (next->type == TOK_END)
     return 0;
 
-  if (!ISGOOD (chk_str + init_pos + CL) && !isalnum (chk_str[init_pos + CL]))
+  if (!tok_is_good (chk_str, next) && !isalnum (chk_str[next->pos]))
     return 0;
 
   return 1;
 }
 
-/* Checks each position in the input string for a connective,
+/* Checks each connective in the input string,
  *  then runs check_sides on it.
  *  input:
  *    chk_str - the string to check.
  *  output:
- *    1 if every connective checks out, 0 otherwise.
+ *    1 if every connective checks out, 0 if not, -1 on memory error.
  */
 int
 check_conns (const unsigned char * chk_str)
 {
-  //Length of chk_str.
-  int chk_len;
+  token_t * toks;
+  int num_toks, i, ret;
 
-  //Get the length of chk_str.
-  chk_len = strlen ((const char *) chk_str);
-
-  int chk_sides, j;
+  num_toks = tokenize (chk_str, &main_conns, &toks);
+  if (num_toks < 0)
+    return AEC_MEM;
 
-  for (j = 0; j < chk_len - CL + 1; j++)
+  ret = 1;
+  for (i = 0; i < num_toks; i++)
     {
-      if (IS_BIN_CONN (chk_str + j))
-	{
-	  chk_sides = check_sides (chk_str, j);
+      const token_t * tok = toks + i;
 
-	  if (!chk_sides)
-	    return 0;
+      if (TOK_IS_BIN_CONN (tok))
+	{
+	  if (!check_sides (chk_str, toks, i))
+	    {
+	      ret = 0;
+	      break;
+	    }
 	}
 
-      if (!strncmp (chk_str + j, NOT, NL))
+      if (TOK_IS_CONN (tok, NOT_CONN))
 	{
 	  // Left side.
-	  if (!(j == 0
-		|| chk_str[j-1] == '('
-		|| (j >= NL && !strncmp (chk_str + j - NL, NOT, NL))
-		|| (j >= CL && IS_BIN_CONN (chk_str + j - CL))))
-	    return 0;
+	  if (!(i == 0
+		|| toks[i - 1].type == TOK_OPAREN
+		|| TOK_IS_CONN (toks + i - 1, NOT_CONN)
+		|| TOK_IS_BIN_CONN (toks + i - 1)))
+	    {
+	      ret = 0;
+	      break;
+	    }
 
 	  // Right side
-	  if (j == chk_len - NL)
-	    return 0;
+	  if (toks[i + 1].type == TOK_END)
+	    {
+	      ret = 0;
+	      break;
+	    }
 	}
     }
 
-  return 1;
+  free (toks);
+  return ret;
 }
 
 /* Gets a variable from a quantifier.
@@ -589,7 +673,7 @@ check_sides_quant (const unsigned char * chk_str, const unsigned int init_pos)
 
   //If this is not at the beginning of the string,
   //then process the connective (if there is one) before it.
-  if (init_pos >= 0)
+  if (init_pos >= (unsigned int) CL)
     {
       //Copy enough memory for a connective.
       strncpy (tmp_str, chk_str - CL, CL);
@@ -676,6 +760,12 @@ check_quants (const unsigned char * chk_str)
           if (chk_sides == AEC_MEM)
             return AEC_MEM;
 
+          if (chk_sides < 0)
+            {
+              destroy_str_vec (var_vec);
+              return 0;
+            }
+
           chk_sides = vec_str_add_obj (var_vec, tmp_var);
           if (chk_sides < 0)
             return AEC_MEM;
@@ -744,54 +834,103 @@ get_gen (unsigned char * in_str, int in_pos, unsigned char ** out_str)
   return i;
 }
 
-/* Gets the generalities of a string with a given connective.
+/* Finds the next binary connective outside of parentheses.
  *  input:
- *    chk_str - string to get the generalities from.
- *    conn - the connective to use, or if none given, takes the connective found.
- *    vec - receives the generalities.
+ *    toks - the tokens to search.
+ *    start - the token at which to begin searching.
+ *    end - the token at which to stop searching.
  *  output:
- *    on success - the number of generalities.
- *    on error - -3
- *    if wrong connective given - -2
- *    memory error - -1
+ *    the index of the connective, or end if there is none.
  */
-int
-get_generalities (unsigned char * chk_str, unsigned char * conn, vec_t * vec)
+static int
+tok_next_gen (const token_t * toks, int start, int end)
 {
-  int ret;
+  int i;
 
-  unsigned char * lsen;
+  for (i = start; i < end; i++)
+    {
+      if (toks[i].type == TOK_OPAREN)
+	{
+	  if (toks[i].match < 0 || toks[i].match >= end)
+	    return end;
 
-  int conn_pos, pos;
-  unsigned int c_len;
+	  i = toks[i].match;
+	  continue;
+	}
 
-  c_len = strlen (chk_str);
-  lsen = NULL;
+      if (TOK_IS_BIN_CONN (toks + i))
+	break;
+    }
 
-  conn_pos = 0;
-  pos = get_gen (chk_str, conn_pos, &lsen);
-  if (pos == AEC_MEM)
-    return AEC_MEM;
+  return i;
+}
+
+/* Copies a range of tokens out of a string.
+ *  input:
+ *    str - the string that was tokenized.
+ *    toks - the tokens of str.
+ *    start - the first token to copy.
+ *    end - the token after the last token to copy.
+ *  output:
+ *    the newly allocated string, or NULL on error.
+ */
+static unsigned char *
+tok_substr (const unsigned char * str, const token_t * toks,
+	    int start, int end)
+{
+  unsigned char * ret;
+  int len;
+
+  len = toks[end].pos - toks[start].pos;
+  ret = (unsigned char *) calloc (len + 1, sizeof (char));
+  CHECK_ALLOC (ret, NULL);
+
+  strncpy (ret, str + toks[start].pos, len);
+  ret[len] = '\0';
+
+  return ret;
+}
+
+/* Gets the generalities of a range of tokens with a given connective.
+ *  input:
+ *    chk_str - the string that was tokenized.
+ *    toks - the tokens of chk_str.
+ *    start - the first token of the range.
+ *    end - the token after the last token of the range.
+ *    conn - the connective to use, or if none given, takes the connective found.
+ *    vec - receives the generalities.
+ *  output:
+ *    the same as get_generalities.
+ */
+static int
+tok_generalities (const unsigned char * chk_str, const token_t * toks,
+		  int start, int end, unsigned char * conn, vec_t * vec)
+{
+  unsigned char * gen;
+  int ret, pos, conn_len;
+
+  pos = tok_next_gen (toks, start, end);
 
   // Confirm that the first part wasn't the entire sentence.
 
-  if (pos >= c_len - 1)
-    {
-      free (lsen);
-      return -3;
-    }
+  if (pos == end || toks[pos].pos >= toks[end].pos - 1)
+    return -3;
 
   // Check for the connective.
 
-  int conn_len;
-
   if (conn[0] != '\0')
     {
       conn_len = strlen (conn);
 
-      if (strncmp (chk_str + pos, conn, conn_len))
+      if (toks[pos].len != conn_len
+	  || strncmp (chk_str + toks[pos].pos, conn, conn_len))
 	{
-	  ret = vec_str_add_obj (vec, chk_str);
+	  gen = tok_substr (chk_str, toks, start, end);
+	  if (!gen)
+	    return AEC_MEM;
+
+	  ret = vec_str_add_obj (vec, gen);
+	  free (gen);
 	  if (ret < 0)
 	    return AEC_MEM;
 
@@ -801,49 +940,65 @@ get_generalities (unsigned char * chk_str, unsigned char * conn, vec_t * vec)
   else
     {
       // Set conn to be the connective.
-      strncpy (conn, chk_str + pos, CL);
-      conn[CL] = '\0';
-
-      conn_len = strlen (conn);
+      conn_len = toks[pos].len;
+      strncpy (conn, chk_str + toks[pos].pos, conn_len);
+      conn[conn_len] = '\0';
     }
 
-  // Add the first sentence.
-
-  ret = vec_str_add_obj (vec, lsen);
-  if (ret < 0)
-    return AEC_MEM;
-  free (lsen);
-  lsen = NULL;
-
-  // While the string has more parts, continue to get them.
+  // Add each part, confirming that every connective is the same.
 
-  unsigned char * rsen = NULL;
-  while (chk_str[pos] != '\0')
+  while (1)
     {
-      if (rsen)
-	free (rsen);
-      rsen = NULL;
-
-      if (strncmp (chk_str + pos, conn, conn_len))
-	{
-	  destroy_str_vec (vec);
-	  return -2;
-	}
-
-      conn_pos = pos + conn_len;
-
-      pos = get_gen (chk_str, conn_pos, &rsen);
-      if (pos == AEC_MEM)
+      gen = tok_substr (chk_str, toks, start, pos);
+      if (!gen)
 	return AEC_MEM;
 
-      ret = vec_str_add_obj (vec, rsen);
+      ret = vec_str_add_obj (vec, gen);
+      free (gen);
       if (ret < 0)
 	return AEC_MEM;
+
+      if (pos == end)
+	break;
+
+      if (toks[pos].len != conn_len
+	  || strncmp (chk_str + toks[pos].pos, conn, conn_len))
+	return -2;
+
+      start = pos + 1;
+      pos = tok_next_gen (toks, start, end);
     }
 
   return (int) vec->num_stuff;
 }
 
+/* Gets the generalities of a string with a given connective.
+ *  input:
+ *    chk_str - string to get the generalities from.
+ *    conn - the connective to use, or if none given, takes the connective found.
+ *    vec - receives the generalities.
+ *  output:
+ *    on success - the number of generalities.
+ *    on error - -3
+ *    if wrong connective given - -2
+ *    memory error - -1
+ */
+int
+get_generalities (unsigned char * chk_str, unsigned char * conn, vec_t * vec)
+{
+  token_t * toks;
+  int num_toks, ret;
+
+  num_toks = tokenize (chk_str, &main_conns, &toks);
+  if (num_toks < 0)
+    return AEC_MEM;
+
+  ret = tok_generalities (chk_str, toks, 0, num_toks, conn, vec);
+  free (toks);
+
+  return ret;
+}
+
 /* Runs text checking on a string to confirm that it follows FOL syntax.
  *  input:
  *    text - the string to check.
@@ -872,6 +1027,12 @@ check_text (unsigned char * text)
     }
 
   conn_check = check_conns (eval_text);
+  if (conn_check == AEC_MEM)
+    {
+      free (eval_text);
+      return AEC_MEM;
+    }
+
   if (!conn_check)
     {
       free (eval_text);
@@ -896,44 +1057,47 @@ check_text (unsigned char * text)
   return 0;
 }
 
-/* Checks the generalities of a string.
+/* Checks the generalities of a range of tokens.
  *  input:
- *    text - the string to check, and recursively check generalities of.
+ *    text - the string that was tokenized.
+ *    toks - the tokens of text.
+ *    start - the first token of the range.
+ *    end - the token after the last token of the range.
  *  output:
- *    0  - Success
- *    -1 - Memory Error
- *    -2 - Parenthesis Error
- *    -3 - Connective Error
- *    -4 - Quantifier Error
- *    -5 - Construction Error
+ *    the same as check_generalities.
  */
-int
-check_generalities (unsigned char * text)
+static int
+tok_check_generalities (unsigned char * text, const token_t * toks,
+			int start, int end)
 {
-  // 1. Check for negation, or quantifier, and move until a parentheses is found.
-  // 1a. If no opening parentheses is found, confirm that the string is alnum, and return success.
-  // 2. Parse the parenthesis, and check their scope.
-  // 2a. If the new string is empty, return an error.
-  // 3. Run get_generalities on the new string.
-  // 4. If get_generalities returns an error, return an error.
-  // 5. Check the connective get_generalities returned, and confirm that it fits.
-  // 6. Run check_text() on all generalities, returning an error if one arises.
-
-  int pos = 0;
-
   unsigned char * tmp_str;
-  int tmp_pos, ret_chk;
+  int i, ret_chk;
 
-  if (text[0] == '\0')
+  if (start >= end)
     return -5;
 
-  if (!ISGOOD (text)
-      && !(strstr (text, AND) || strstr (text, OR)
-	   || strstr (text, CON) || strstr (text, BIC)))
+  for (i = start; i < end; i++)
+    if (TOK_IS_BIN_CONN (toks + i))
+      break;
+
+  if (!tok_is_good (text, toks + start) && i == end)
     {
-      if (strstr (text, ELM) || strchr (text, '=') || strchr (text, '<'))
+      for (i = start; i < end; i++)
+	{
+	  if (TOK_IS_CONN (toks + i, ELM_CONN)
+	      || (toks[i].type == TOK_SEP
+		  && (text[toks[i].pos] == '=' || text[toks[i].pos] == '<')))
+	    break;
+	}
+
+      if (i < end)
 	{
-	  ret_chk = check_infix (text, 1);
+	  tmp_str = tok_substr (text, toks, start, end);
+	  if (!tmp_str)
+	    return AEC_MEM;
+
+	  ret_chk = check_infix (tmp_str, 1);
+	  free (tmp_str);
 	  if (ret_chk == AEC_MEM)
 	    return AEC_MEM;
 
@@ -944,85 +1108,60 @@ check_generalities (unsigned char * text)
       return -5;
     }
 
-  tmp_pos = get_gen (text, 0, &tmp_str);
-  if (tmp_pos == AEC_MEM)
-    return AEC_MEM;
-
-  if (!strcmp (tmp_str, text))
+  if (tok_next_gen (toks, start, end) == end)
     {
       // This is the entire scope, so strip away the preceding symbol,
       //  if one exists.
 
-      if (!strncmp (text, NOT, NL))
+      if (TOK_IS_CONN (toks + start, NOT_CONN))
 	{
-	  if (text[NL] == '\0')
+	  if (start + 1 == end)
 	    return -3;
 
-	  return check_generalities (text + NL);
+	  return tok_check_generalities (text, toks, start + 1, end);
 	}
 
-      if (!strncmp (text, UNV, CL) || !strncmp (text, EXL, CL))
+      if (TOK_IS_CONN (toks + start, UNV_CONN)
+	  || TOK_IS_CONN (toks + start, EXL_CONN))
 	{
-	  pos = CL;
-	  while ((islower(text[pos]) || isdigit(text[pos]))
-		 && text[pos] != '\0')
-	    pos++;
-	  if (text[pos] == '\0')
-	    return -4;
+	  i = start + 1;
+	  if (i < end && toks[i].type == TOK_IDENT)
+	    {
+	      int j;
 
-	  if (strncmp (text + pos, UNV, CL) && strncmp (text + pos, EXL, CL)
-	      && strncmp (text + pos, NOT, NL) && text[pos] != '(')
-	    return -4;
+	      for (j = 0; j < toks[i].len; j++)
+		if (!islower (text[toks[i].pos + j])
+		    && !isdigit (text[toks[i].pos + j]))
+		  return -4;
+	      i++;
+	    }
 
-	  return check_generalities (text + pos);
-	}
+	  if (i == end)
+	    return -4;
 
-      if (text[0] == '(')
-	{
-	  tmp_str = elim_par (text);
-	  if (!tmp_str)
-	    return AEC_MEM;
+	  if (!TOK_IS_CONN (toks + i, UNV_CONN)
+	      && !TOK_IS_CONN (toks + i, EXL_CONN)
+	      && !TOK_IS_CONN (toks + i, NOT_CONN)
+	      && toks[i].type != TOK_OPAREN)
+	    return -4;
 
-	  ret_chk = check_generalities (tmp_str);
-	  if (ret_chk == AEC_MEM)
-	    return AEC_MEM;
-	  free (tmp_str);
-	  return ret_chk;
+	  return tok_check_generalities (text, toks, i, end);
 	}
 
-      if (text[0] != '(')
+      if (toks[start].type == TOK_OPAREN)
 	{
-	  ret_chk = check_symbols (text, 1);
-	  if (ret_chk == AEC_MEM)
-	    return AEC_MEM;
-
-	  if (ret_chk == -2)
+	  if (start + 1 == end || toks[end - 1].type != TOK_CPAREN)
 	    return -5;
 
-	  return 0;
+	  return tok_check_generalities (text, toks, start + 1, end - 1);
 	}
-    }
-
-  // Get generalities across the parenthesis construct.
-
-  int gg;
-  unsigned char conn[CL + 1];
-  vec_t * gens;
-
-  gens = init_vec (sizeof (char *));
-  if (!gens)
-    return AEC_MEM;
-
-  conn[0] = '\0';
-  gg = get_generalities (text, conn, gens);
-  if (gg == AEC_MEM)
-    return AEC_MEM;
 
-  if (gens->num_stuff == 1 || gens->num_stuff == 0)
-    {
-      destroy_str_vec (gens);
+      tmp_str = tok_substr (text, toks, start, end);
+      if (!tmp_str)
+	return AEC_MEM;
 
-      int ret_chk = check_symbols (text, 1);
+      ret_chk = check_symbols (tmp_str, 1);
+      free (tmp_str);
       if (ret_chk == AEC_MEM)
 	return AEC_MEM;
 
@@ -1032,43 +1171,95 @@ check_generalities (unsigned char * text)
       return 0;
     }
 
-  if (gg == -2)
-    {
-      // Connective Error.
-      return -3;
-    }
+  // Get generalities across the parenthesis construct.
+
+  int num_gens, conn;
+  int * gen_ends;
 
-  if (gens->num_stuff >= 3)
+  gen_ends = (int *) calloc (end - start + 1, sizeof (int));
+  CHECK_ALLOC (gen_ends, AEC_MEM);
+
+  num_gens = 0;
+  conn = -1;
+  i = start - 1;
+  do
     {
-      if (!strcmp (conn, CON) || !strcmp (conn, BIC))
+      i = tok_next_gen (toks, i + 1, end);
+      gen_ends[num_gens++] = i;
+
+      if (i < end)
 	{
-	  // Connective Error.
-	  destroy_str_vec (gens);
-	  return -3;
+	  if (conn != -1 && toks[i].conn != conn)
+	    {
+	      // Connective Error.
+	      free (gen_ends);
+	      return -3;
+	    }
+	  conn = toks[i].conn;
 	}
     }
+  while (i < end);
 
-  int i;
-  unsigned char * cur_gen;
-  for (i = 0; i < gens->num_stuff; i++)
+  if (num_gens >= 3 && (conn == CON_CONN || conn == BIC_CONN))
     {
-      cur_gen = vec_str_nth (gens, i);
-      ret_chk = check_generalities (cur_gen);
-      if (ret_chk == AEC_MEM)
-	return AEC_MEM;
+      // Connective Error.
+      free (gen_ends);
+      return -3;
+    }
 
+  for (i = 0; i < num_gens; i++)
+    {
+      ret_chk = tok_check_generalities (text, toks,
+					(i == 0) ? start : gen_ends[i - 1] + 1,
+					gen_ends[i]);
       if (ret_chk != 0)
 	{
-	  destroy_str_vec (gens);
+	  free (gen_ends);
 	  return ret_chk;
 	}
     }
 
-  destroy_str_vec (gens);
+  free (gen_ends);
 
   return 0;
 }
 
+/* Checks the generalities of a string.
+ *  input:
+ *    text - the string to check, and recursively check generalities of.
+ *  output:
+ *    0  - Success
+ *    -1 - Memory Error
+ *    -2 - Parenthesis Error
+ *    -3 - Connective Error
+ *    -4 - Quantifier Error
+ *    -5 - Construction Error
+ */
+int
+check_generalities (unsigned char * text)
+{
+  // 1. Check for negation, or quantifier, and move until a parentheses is found.
+  // 1a. If no opening parentheses is found, confirm that the string is alnum, and return success.
+  // 2. Parse the parenthesis, and check their scope.
+  // 2a. If the new string is empty, return an error.
+  // 3. Split the string at its top-level connectives.
+  // 4. If the connectives differ, return an error.
+  // 5. Check the connective, and confirm that it fits.
+  // 6. Check the generalities of each part, returning an error if one arises.
+
+  token_t * toks;
+  int num_toks, ret;
+
+  num_toks = tokenize (text, &main_conns, &toks);
+  if (num_toks < 0)
+    return AEC_MEM;
+
+  ret = tok_check_generalities (text, toks, 0, num_toks);
+  free (toks);
+
+  return ret;
+}
+
 /* Checks a predicate / function symbol.
  *  input:
  *    in_str - the string to check.
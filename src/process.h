@@ -206,6 +206,7 @@ extern struct connectives_list main_conns;
 #define CORRECT _("Correct!")
 #define NO_DIFFERENCE _("No difference was found in the reference and conclusion.")
 #define SAME_LENGTH _("The reference and conclusion must not be the same length")
+#define MISMATCHED_PARENS _("The sentence has mismatched parenthesis.")
 
 // Sentence ids.
 
@@ -225,7 +226,9 @@ enum SEN_IDS {
   SEN_ID_LT = -11,
   SEN_ID_ELM = -12,
   SEN_ID_NIL = -13,
-  SEN_ID_END = -14
+  SEN_ID_TAU = -14,
+  SEN_ID_CTR = -15,
+  SEN_ID_END = -16
 };
 
 // Sentence id structure.
@@ -254,8 +257,9 @@ int parse_tags (const unsigned char * in_str,
 
 int check_parens (const unsigned char * chk_str);
 
-int check_sides_conn (const unsigned char * chk_str,
-		       const unsigned int init_pos);
+int check_sides (const unsigned char * chk_str,
+		 const token_t * toks,
+		 const int tok_num);
 
 int check_conns (const unsigned char * chk_str);
 
@@ -277,6 +281,7 @@ int check_infix (unsigned char * in_str, int pred);
 unsigned char * die_spaces_die (unsigned char * in_str);
 unsigned char * remove_comment (unsigned char * in_str);
 unsigned char * format_string (unsigned char * in_str);
+unsigned char * normalize_conns (const unsigned char * in_str);
 
 int find_difference (unsigned char * sen_0, unsigned char * sen_1);
 
@@ -298,7 +303,8 @@ char * process (unsigned char * conc,
 		vec_t * prems,
 		const char * rule,
 		vec_t * vars,
-		proof_t * proof);
+		proof_t * proof,
+		vec_t * sigs);
 
 
 char * process_inference (unsigned char * conc,
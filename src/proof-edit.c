@@ -0,0 +1,870 @@
+/* Functions for editing data proofs, apart from the GUI.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* The editor works on the lines of a proof_t, whose references are
+ *  line numbers, so that proofs can be edited by scripts and timed
+ *  without a display.
+ * Its history is an undo ring of the same undo information objects that
+ *  an aris proof keeps, recorded and trimmed the same way, so only the
+ *  line store differs between the two.  As in the GUI, the first line
+ *  can't be removed, removing a line drops the references to it, and
+ *  undoing the removal doesn't bring those references back.  Nor are
+ *  changes of rule or references kept in the history.
+ * The editor is only for proofs without a display.  An aris proof still
+ *  inserts, removes and undoes on its sentences itself, since those
+ *  carry widgets and references to one another that the data lines
+ *  don't; the two share the undo information objects, not the code.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "proof-edit.h"
+#include "proof.h"
+#include "undo.h"
+#include "sen-data.h"
+#include "list.h"
+#include "vec.h"
+
+/* Determines where a line number moves to after lines are inserted
+ *  or removed.
+ *  input:
+ *    lines - the sorted line numbers at which lines were inserted or
+ *            removed.
+ *    num - the number of entries in lines.
+ *    mod - the amount that each entry in lines moves the lines from it on.
+ *    ln - the line number to move.
+ *  output:
+ *    the new line number.
+ */
+int
+proof_move_line (const int * lines, int num, int mod, int ln)
+{
+  int lo = 0, hi = num;
+
+  // Count the entries at or before ln.
+  while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+      if (lines[mid] <= ln)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return ln + lo * mod;
+}
+
+/* Determines whether a line number is among a set of them.
+ *  input:
+ *    lines - the sorted line numbers.
+ *    num - the number of entries in lines.
+ *    ln - the line number to look for.
+ *  output:
+ *    1 if ln is in lines, 0 if not.
+ */
+static int
+proof_has_line (const int * lines, int num, int ln)
+{
+  int lo = 0, hi = num;
+
+  while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+      if (lines[mid] == ln)
+        return 1;
+
+      if (lines[mid] < ln)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return 0;
+}
+
+/* Copies a line of a proof.
+ *  input:
+ *    sd - the line to copy.
+ *  output:
+ *    the copy, or NULL on memory error.
+ */
+static sen_data *
+proof_copy_line (sen_data * sd)
+{
+  sen_data * ret;
+  int rc;
+
+  ret = (sen_data *) calloc (1, sizeof (sen_data));
+  CHECK_ALLOC (ret, NULL);
+
+  rc = sen_data_copy (sd, ret);
+  if (rc == AEC_MEM)
+    return NULL;
+
+  return ret;
+}
+
+/* Destroys a list of lines, along with the lines themselves.
+ *  input:
+ *    sds - the list to destroy.
+ *  output:
+ *    none.
+ */
+static void
+proof_destroy_lines (list_t * sds)
+{
+  item_t * itm;
+
+  for (itm = sds->head; itm; itm = itm->next)
+    sen_data_destroy (itm->value);
+  destroy_list (sds);
+}
+
+/* Puts lines into a proof after a line, and moves the lines and
+ *  references after them.
+ *  input:
+ *    proof - the proof into which to put the lines.
+ *    after - the line after which to put them, or 0 if the proof is empty.
+ *    sds - the lines to put in, which the proof takes.
+ *  output:
+ *    0 on success, -1 on memory error, 1 if after is out of range.
+ */
+static int
+proof_splice_lines (proof_t * proof, int after, list_t * sds)
+{
+  item_t * fcs, * itm, * sd_itr;
+  int first = after + 1, num = sds->num_stuff, ln = after;
+
+  if (after == 0)
+    {
+      if (proof->everything->head)
+        return 1;
+      fcs = NULL;
+    }
+  else
+    {
+      fcs = ls_nth (proof->everything, after - 1);
+      if (!fcs)
+        return 1;
+    }
+
+  for (sd_itr = sds->head; sd_itr; sd_itr = sd_itr->next)
+    {
+      sen_data * sd = sd_itr->value;
+
+      sd->line_num = ++ln;
+      fcs = ls_ins_obj (proof->everything, sd, fcs);
+      if (!fcs)
+        return AEC_MEM;
+    }
+
+  // Only the lines after these can refer to the ones that moved.
+  for (itm = fcs->next; itm; itm = itm->next)
+    {
+      sen_data * sd = itm->value;
+      int i;
+
+      sd->line_num = proof_move_line (&first, 1, num, sd->line_num);
+
+      if (!sd->refs)
+        continue;
+
+      for (i = 0; sd->refs[i] != REF_END; i++)
+        sd->refs[i] = proof_move_line (&first, 1, num, sd->refs[i]);
+    }
+
+  return 0;
+}
+
+/* Takes lines out of a proof, and moves the lines and references
+ *  after them.
+ *  input:
+ *    proof - the proof from which to take the lines.
+ *    lines - the sorted line numbers to take out, none of which is 1.
+ *    num - the number of entries in lines.
+ *  output:
+ *    the lines that were taken out, or NULL on memory error.
+ */
+static list_t *
+proof_cut_lines (proof_t * proof, const int * lines, int num)
+{
+  list_t * ret;
+  item_t * itm, * n_itm;
+  int j = 0;
+
+  ret = init_list ();
+  if (!ret)
+    return NULL;
+
+  itm = ls_nth (proof->everything, lines[0] - 1);
+  for (; itm; itm = n_itm)
+    {
+      sen_data * sd = itm->value;
+      int i, k;
+
+      n_itm = itm->next;
+
+      if (j < num && sd->line_num == lines[j])
+        {
+          ls_rem_obj (proof->everything, itm);
+          free (itm);
+          if (!ls_push_obj (ret, sd))
+            return NULL;
+          j++;
+          continue;
+        }
+
+      sd->line_num = proof_move_line (lines, num, -1, sd->line_num);
+
+      if (!sd->refs)
+        continue;
+
+      // Drop the references to the lines that are gone.
+      for (i = k = 0; sd->refs[i] != REF_END; i++)
+        {
+          if (proof_has_line (lines, num, sd->refs[i]))
+            continue;
+          sd->refs[k++] = proof_move_line (lines, num, -1, sd->refs[i]);
+        }
+      sd->refs[k] = REF_END;
+    }
+
+  return ret;
+}
+
+/* Puts copies of the lines of a change into a proof, each at its own
+ *  line number.
+ *  input:
+ *    proof - the proof into which to put the lines.
+ *    sds - the lines, in order.
+ *  output:
+ *    0 on success, -1 on memory error, 1 if a line is out of range.
+ */
+static int
+proof_put_change (proof_t * proof, list_t * sds)
+{
+  item_t * sd_itr;
+  list_t * run;
+  int rc;
+
+  // Each run of consecutive lines goes in at once.
+  for (sd_itr = sds->head; sd_itr;)
+    {
+      int first, ln;
+
+      run = init_list ();
+      if (!run)
+        return AEC_MEM;
+
+      first = ln = ((sen_data *) sd_itr->value)->line_num;
+      for (; sd_itr && ((sen_data *) sd_itr->value)->line_num == ln;
+           sd_itr = sd_itr->next, ln++)
+        {
+          sen_data * sd;
+
+          sd = proof_copy_line (sd_itr->value);
+          if (!sd || !ls_push_obj (run, sd))
+            return AEC_MEM;
+        }
+
+      rc = proof_splice_lines (proof, first - 1, run);
+      if (rc != 0)
+        {
+          if (rc == 1)
+            proof_destroy_lines (run);
+          return rc;
+        }
+
+      // The proof has the lines now.
+      destroy_list (run);
+    }
+
+  return 0;
+}
+
+/* Takes the lines of a change out of a proof.
+ *  input:
+ *    proof - the proof from which to take the lines.
+ *    sds - the lines, in order.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+proof_take_change (proof_t * proof, list_t * sds)
+{
+  item_t * sd_itr;
+  list_t * cut;
+  int * lines, num = 0;
+
+  if (!sds->head)
+    return 0;
+
+  lines = (int *) calloc (sds->num_stuff, sizeof (int));
+  CHECK_ALLOC (lines, AEC_MEM);
+
+  for (sd_itr = sds->head; sd_itr; sd_itr = sd_itr->next)
+    lines[num++] = ((sen_data *) sd_itr->value)->line_num;
+
+  cut = proof_cut_lines (proof, lines, num);
+  free (lines);
+  if (!cut)
+    return AEC_MEM;
+
+  proof_destroy_lines (cut);
+  return 0;
+}
+
+/* Gets a line of the proof of an editor.
+ *  input:
+ *    ed - the editor.
+ *    ln - the line number.
+ *  output:
+ *    the line, or NULL if ln is out of range.
+ */
+static sen_data *
+proof_editor_line (proof_editor * ed, int ln)
+{
+  item_t * itm;
+
+  if (ln < 1)
+    return NULL;
+
+  itm = ls_nth (ed->proof->everything, ln - 1);
+  return itm ? itm->value : NULL;
+}
+
+/* Sets the text of a line of a proof.
+ *  input:
+ *    sd - the line.
+ *    text - the new text, which the line takes.
+ *  output:
+ *    none.
+ */
+static void
+proof_set_line_text (sen_data * sd, unsigned char * text)
+{
+  free (sd->text);
+  sd->text = text;
+
+  // The old sexpr no longer matches.
+  sd_clear_sexpr (sd);
+}
+
+/* Applies a change to the proof of an editor, or takes it back.
+ *  input:
+ *    ed - the editor.
+ *    ui - the change.
+ *    undo - 1 to take the change back, 0 to apply it.
+ *  output:
+ *    0 on success, -1 on memory error, 1 if the change doesn't fit.
+ */
+static int
+proof_editor_apply (proof_editor * ed, undo_info * ui, int undo)
+{
+  unsigned char * new_text;
+  sen_data * sd;
+  int rc;
+
+  switch (ui->type)
+    {
+    case UIT_ADD_SEN:
+      return undo ? proof_take_change (ed->proof, ui->ls)
+        : proof_put_change (ed->proof, ui->ls);
+    case UIT_REM_SEN:
+      return undo ? proof_put_change (ed->proof, ui->ls)
+        : proof_take_change (ed->proof, ui->ls);
+    case UIT_MOD_TEXT:
+      // The same object serves for both undo and redo.
+      sd = proof_editor_line (ed, ui->line_num);
+      if (!sd)
+        return 1;
+
+      rc = undo_info_revert_text (ui, sd->text, &new_text);
+      if (rc != 0)
+        return rc;
+
+      proof_set_line_text (sd, new_text);
+      return 0;
+    }
+
+  return 1;
+}
+
+/* Applies insertions or removals of lines to the proof of an editor,
+ *  and records them in its history.
+ *  input:
+ *    ed - the editor.
+ *    type - UIT_ADD_SEN or UIT_REM_SEN.
+ *    sds - the lines that are inserted or removed, which the history takes.
+ *  output:
+ *    0 on success, -1 on memory error, 1 if the change doesn't fit.
+ */
+static int
+proof_editor_push (proof_editor * ed, int type, list_t * sds)
+{
+  undo_info ui;
+  int rc;
+
+  rc = (type == UIT_ADD_SEN) ? proof_put_change (ed->proof, sds)
+    : proof_take_change (ed->proof, sds);
+  if (rc != 0)
+    {
+      proof_destroy_lines (sds);
+      return rc;
+    }
+
+  ui = undo_info_init (NULL, sds, type);
+  if (ui.type == -1)
+    return AEC_MEM;
+
+  rc = undo_ring_record (ed->history, &ed->pt, ui, UNDO_BUDGET);
+  if (rc == AEC_MEM)
+    return AEC_MEM;
+
+  // The line numbers have moved under the selection.
+  return vec_clear (ed->selected);
+}
+
+/* Initializes an editor over a data proof.
+ *  input:
+ *    proof - the proof to edit, which stays with the caller.
+ *  output:
+ *    the new editor, or NULL on memory error.
+ */
+proof_editor *
+proof_editor_init (proof_t * proof)
+{
+  proof_editor * ed;
+  item_t * ev_itr;
+  int ln = 0;
+
+  ed = (proof_editor *) calloc (1, sizeof (proof_editor));
+  CHECK_ALLOC (ed, NULL);
+
+  ed->proof = proof;
+  ed->pt = -1;
+
+  // The editor finds lines by their position.
+  for (ev_itr = proof->everything->head; ev_itr; ev_itr = ev_itr->next)
+    ((sen_data *) ev_itr->value)->line_num = ++ln;
+
+  ed->history = undo_ring_init ();
+  if (!ed->history)
+    return NULL;
+
+  ed->selected = init_vec (sizeof (int));
+  if (!ed->selected)
+    return NULL;
+
+  return ed;
+}
+
+/* Destroys an editor, but not the proof that it edits.
+ *  input:
+ *    ed - the editor to destroy.
+ *  output:
+ *    none.
+ */
+void
+proof_editor_destroy (proof_editor * ed)
+{
+  undo_ring_destroy (ed->history);
+  destroy_vec (ed->selected);
+  free (ed);
+}
+
+/* Inserts lines into the proof of an editor.
+ * The references of the new lines are taken as they are, and those of
+ *  the lines after them are moved.
+ *  input:
+ *    ed - the editor.
+ *    after - the line after which to insert, or 0 if the proof is empty.
+ *    sds - the lines to insert, which are copied.
+ *  output:
+ *    0 on success, -1 on memory error, 1 if after is out of range.
+ */
+int
+proof_editor_insert (proof_editor * ed, int after, list_t * sds)
+{
+  list_t * copies;
+  item_t * sd_itr;
+  int ln = after;
+
+  if (!sds->head)
+    return 0;
+
+  copies = init_list ();
+  if (!copies)
+    return AEC_MEM;
+
+  for (sd_itr = sds->head; sd_itr; sd_itr = sd_itr->next)
+    {
+      sen_data * sd;
+
+      sd = proof_copy_line (sd_itr->value);
+      if (!sd || !ls_push_obj (copies, sd))
+        return AEC_MEM;
+      sd->line_num = ++ln;
+    }
+
+  return proof_editor_push (ed, UIT_ADD_SEN, copies);
+}
+
+/* Removes lines from the proof of an editor.
+ *  input:
+ *    ed - the editor.
+ *    lines - the line numbers to remove, in any order.
+ *    num - the number of entries in lines.
+ *  output:
+ *    0 on success, -1 on memory error, 1 if a line is out of range
+ *    or is the first line.
+ */
+int
+proof_editor_remove (proof_editor * ed, const int * lines, int num)
+{
+  list_t * copies;
+  item_t * ev_itr;
+  int * sorted, i, j, n;
+
+  if (num == 0)
+    return 0;
+
+  sorted = (int *) calloc (num, sizeof (int));
+  CHECK_ALLOC (sorted, AEC_MEM);
+
+  // A simple insertion sort, leaving out repeats.
+  for (i = n = 0; i < num; i++)
+    {
+      if (lines[i] <= 1 || lines[i] > (int) ed->proof->everything->num_stuff)
+        {
+          free (sorted);
+          return 1;
+        }
+
+      for (j = n; j > 0 && sorted[j - 1] > lines[i]; j--)
+        sorted[j] = sorted[j - 1];
+
+      if (j > 0 && sorted[j - 1] == lines[i])
+        {
+          memmove (sorted + j, sorted + j + 1, (n - j) * sizeof (int));
+          continue;
+        }
+
+      sorted[j] = lines[i];
+      n++;
+    }
+
+  copies = init_list ();
+  if (!copies)
+    return AEC_MEM;
+
+  ev_itr = ls_nth (ed->proof->everything, sorted[0] - 1);
+  for (i = 0; ev_itr && i < n; ev_itr = ev_itr->next)
+    {
+      sen_data * sd = ev_itr->value, * cp;
+
+      if (sd->line_num != sorted[i])
+        continue;
+
+      cp = proof_copy_line (sd);
+      if (!cp || !ls_push_obj (copies, cp))
+        return AEC_MEM;
+      i++;
+    }
+
+  free (sorted);
+  return proof_editor_push (ed, UIT_REM_SEN, copies);
+}
+
+/* Sets the text of a line in the proof of an editor.
+ * Typing in one line is kept as a single change, as in the GUI.
+ *  input:
+ *    ed - the editor.
+ *    ln - the line number.
+ *    text - the new text.
+ *  output:
+ *    0 on success, -1 on memory error, 1 if ln is out of range.
+ */
+int
+proof_editor_set_text (proof_editor * ed, int ln, const unsigned char * text)
+{
+  unsigned char * new_text;
+  sen_data * sd;
+  undo_info ui;
+  int rc;
+
+  sd = proof_editor_line (ed, ln);
+  if (!sd)
+    return 1;
+
+  new_text = (unsigned char *) strdup ((const char *) text);
+  CHECK_ALLOC (new_text, AEC_MEM);
+
+  ui = undo_info_init_diff (ln, sd->text, new_text);
+  if (ui.type == -1)
+    {
+      free (new_text);
+      return AEC_MEM;
+    }
+
+  rc = undo_ring_record (ed->history, &ed->pt, ui, UNDO_BUDGET);
+  if (rc == AEC_MEM)
+    {
+      free (new_text);
+      return AEC_MEM;
+    }
+
+  proof_set_line_text (sd, new_text);
+  return 0;
+}
+
+/* Sets the rule of a line in the proof of an editor.
+ *  input:
+ *    ed - the editor.
+ *    ln - the line number.
+ *    rule - the new rule.
+ *  output:
+ *    0 on success, 1 if ln is out of range.
+ */
+int
+proof_editor_set_rule (proof_editor * ed, int ln, int rule)
+{
+  sen_data * sd;
+
+  sd = proof_editor_line (ed, ln);
+  if (!sd)
+    return 1;
+
+  sd->rule = rule;
+  return 0;
+}
+
+/* Sets the references of a line in the proof of an editor.
+ *  input:
+ *    ed - the editor.
+ *    ln - the line number.
+ *    refs - the new references, ending with REF_END.  Each must be
+ *           before ln.
+ *  output:
+ *    0 on success, -1 on memory error, 1 if ln or a reference is
+ *    out of range.
+ */
+int
+proof_editor_set_refs (proof_editor * ed, int ln, const short * refs)
+{
+  sen_data * sd;
+  short * new_refs;
+  int len;
+
+  sd = proof_editor_line (ed, ln);
+  if (!sd)
+    return 1;
+
+  for (len = 0; refs[len] != REF_END; len++)
+    {
+      if (refs[len] < 1 || refs[len] >= ln)
+        return 1;
+    }
+
+  new_refs = (short *) calloc (len + 1, sizeof (short));
+  CHECK_ALLOC (new_refs, AEC_MEM);
+  memcpy (new_refs, refs, (len + 1) * sizeof (short));
+
+  if (sd->refs)
+    free (sd->refs);
+  sd->refs = new_refs;
+
+  return 0;
+}
+
+/* Selects or deselects a line of the proof of an editor.
+ *  input:
+ *    ed - the editor.
+ *    ln - the line number.
+ *    select - 1 to select the line, 0 to deselect it.
+ *  output:
+ *    0 on success, -1 on memory error, 1 if ln is out of range.
+ */
+int
+proof_editor_select (proof_editor * ed, int ln, int select)
+{
+  int i, * lines;
+
+  if (ln < 1 || ln > (int) ed->proof->everything->num_stuff)
+    return 1;
+
+  lines = ed->selected->stuff;
+  for (i = 0; i < (int) ed->selected->num_stuff && lines[i] < ln; i++)
+    ;
+
+  if (i < (int) ed->selected->num_stuff && lines[i] == ln)
+    {
+      if (!select)
+        {
+          memmove (lines + i, lines + i + 1,
+                   (ed->selected->num_stuff - i - 1) * sizeof (int));
+          vec_pop_obj (ed->selected);
+        }
+      return 0;
+    }
+
+  if (!select)
+    return 0;
+
+  // Make room at the end, then move the later lines up.
+  if (vec_add_obj (ed->selected, &ln) < 0)
+    return AEC_MEM;
+
+  lines = ed->selected->stuff;
+  memmove (lines + i + 1, lines + i,
+           (ed->selected->num_stuff - i - 1) * sizeof (int));
+  lines[i] = ln;
+
+  return 0;
+}
+
+/* Removes the selected lines from the proof of an editor, along with
+ *  the lines of any selected subproofs.
+ *  input:
+ *    ed - the editor.
+ *  output:
+ *    0 on success, -1 on memory error, 1 if the first line is selected.
+ */
+int
+proof_editor_kill (proof_editor * ed)
+{
+  vec_t * lines;
+  item_t * ev_itr;
+  int i, rc;
+
+  if (ed->selected->num_stuff == 0)
+    return 0;
+
+  lines = init_vec (sizeof (int));
+  if (!lines)
+    return AEC_MEM;
+
+  for (i = 0; i < (int) ed->selected->num_stuff; i++)
+    {
+      int ln = *((int *) vec_nth (ed->selected, i));
+      sen_data * sd;
+
+      ev_itr = ls_nth (ed->proof->everything, ln - 1);
+      sd = ev_itr->value;
+
+      if (vec_add_obj (lines, &ln) < 0)
+        return AEC_MEM;
+
+      if (!sd->subproof)
+        continue;
+
+      // Take the rest of the subproof as well.
+      for (ev_itr = ev_itr->next; ev_itr; ev_itr = ev_itr->next)
+        {
+          sen_data * ev_sd = ev_itr->value;
+
+          if (ev_sd->depth < sd->depth)
+            break;
+
+          if (vec_add_obj (lines, &ev_sd->line_num) < 0)
+            return AEC_MEM;
+        }
+    }
+
+  rc = proof_editor_remove (ed, lines->stuff, lines->num_stuff);
+  destroy_vec (lines);
+
+  return rc;
+}
+
+/* Adds a goal to the proof of an editor.
+ * Goals aren't kept in the history.
+ *  input:
+ *    ed - the editor.
+ *    text - the text of the goal.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+proof_editor_add_goal (proof_editor * ed, const unsigned char * text)
+{
+  unsigned char * goal;
+
+  goal = (unsigned char *) strdup ((const char *) text);
+  CHECK_ALLOC (goal, AEC_MEM);
+
+  if (!ls_push_obj (ed->proof->goals, goal))
+    return AEC_MEM;
+
+  return 0;
+}
+
+/* Removes a goal from the proof of an editor.
+ *  input:
+ *    ed - the editor.
+ *    n - the index of the goal.
+ *  output:
+ *    0 on success, 1 if n is out of range.
+ */
+int
+proof_editor_rem_goal (proof_editor * ed, int n)
+{
+  item_t * itm;
+
+  itm = ls_nth (ed->proof->goals, n);
+  if (!itm)
+    return 1;
+
+  ls_rem_obj (ed->proof->goals, itm);
+  free (itm->value);
+  free (itm);
+
+  return 0;
+}
+
+/* Undoes or redoes a change to the proof of an editor.
+ *  input:
+ *    ed - the editor.
+ *    undo - 1 to undo the last change, 0 to redo the next one.
+ *  output:
+ *    0 on success, -1 on memory error, 1 if there is nothing to do.
+ */
+int
+proof_editor_undo (proof_editor * ed, int undo)
+{
+  undo_info * ui;
+  int pt, rc;
+
+  pt = undo ? ed->pt : ed->pt + 1;
+  ui = undo_ring_nth (ed->history, pt);
+  if (!ui)
+    return 1;
+
+  rc = proof_editor_apply (ed, ui, undo);
+  if (rc != 0)
+    return rc;
+
+  ed->pt += undo ? -1 : 1;
+
+  // Only insertions and removals move the lines under the selection.
+  if (ui->type == UIT_MOD_TEXT)
+    return 0;
+
+  return vec_clear (ed->selected);
+}
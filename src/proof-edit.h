@@ -0,0 +1,54 @@
+/* Editing of data proofs, apart from the GUI.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_PROOF_EDIT_H
+#define ARIS_PROOF_EDIT_H
+
+#include "typedef.h"
+
+// An editor over a data proof, keeping the selection and history.
+//  It is used without a display; an aris proof edits its own sentences.
+
+struct proof_editor {
+  proof_t * proof;         // The proof being edited.
+  undo_ring * history;     // The changes that have been made.
+  int pt;                  // The index of the last change in effect, or -1.
+  vec_t * selected;        // The selected line numbers, in order.
+};
+
+int proof_move_line (const int * lines, int num, int mod, int ln);
+
+proof_editor * proof_editor_init (proof_t * proof);
+void proof_editor_destroy (proof_editor * ed);
+
+int proof_editor_insert (proof_editor * ed, int after, list_t * sds);
+int proof_editor_remove (proof_editor * ed, const int * lines, int num);
+int proof_editor_set_text (proof_editor * ed, int ln,
+                           const unsigned char * text);
+int proof_editor_set_rule (proof_editor * ed, int ln, int rule);
+int proof_editor_set_refs (proof_editor * ed, int ln, const short * refs);
+
+int proof_editor_select (proof_editor * ed, int ln, int select);
+int proof_editor_kill (proof_editor * ed);
+
+int proof_editor_add_goal (proof_editor * ed, const unsigned char * text);
+int proof_editor_rem_goal (proof_editor * ed, int n);
+
+int proof_editor_undo (proof_editor * ed, int undo);
+
+#endif  /*  ARIS_PROOF_EDIT_H  */
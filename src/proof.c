@@ -27,6 +27,25 @@
 #include "rules.h"
 #include "process.h"
 #include "sexpr-process.h"
+#include "lemma-cache.h"
+
+// The start of each LaTeX proof, up to the table of lines.
+#define LATEX_PREAMBLE \
+  "\\documentclass{article}\n" \
+  "\\usepackage{amsmath}\n" \
+  "\\usepackage{amsfonts}\n" \
+  "\\usepackage{longtable}\n" \
+  "\\usepackage[cm]{fullpage}\n" \
+  "\\begin{document}\n" \
+  "\\newcommand{\\eline}{--------}\n" \
+  "\\newcommand{\\prmline}[2]{#1.&$#2$&}\n" \
+  "\\newcommand{\\stdline}[3]{#1.&$#2$&\\texttt{#3 }}\n" \
+  "\\newcommand{\\pquad}{| \\;}\n" \
+  "\\newcommand{\\spquad}{\\text{ } \\quad}\n" \
+  "\n"
+
+// A guess at the length of a line of a LaTeX proof.
+#define LATEX_LINE_SIZE 64
 
 /* Initializes a proof.
  *  input:
@@ -117,6 +136,23 @@ proof_eval (proof_t * proof, vec_t * rets, int verbose)
  */
 int
 eval_proof (list_t * everything, vec_t * rets, int verbose)
+{
+  return eval_proof_lines (everything, rets, NULL, verbose);
+}
+
+/* Evaluates a list of sentences, recording the result of each.
+ *  input:
+ *    everything - the list of sentences to evaluate.
+ *    rets - a vector in which to store the return values, or NULL.
+ *    results - an array with an entry for each sentence, in which to
+ *              store the verdict and evaluation time, or NULL.
+ *    verbose - a flag denoting verbosity (1 if verbose).
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+eval_proof_lines (list_t * everything, vec_t * rets, line_result * results,
+                  int verbose)
 {
   item_t * sen_itr;
   int got_prems, cur_line;
@@ -135,6 +171,11 @@ eval_proof (list_t * everything, vec_t * rets, int verbose)
   if (!sexpr_text)
     return AEC_MEM;
 
+  // Start reading the lemma files while the first lines are checked.
+  ret = lemma_cache_prefetch (everything);
+  if (ret == AEC_MEM)
+    return AEC_MEM;
+
   for (sen_itr = everything->head; sen_itr; sen_itr = sen_itr->next)
     {
       sen_data * sd;
@@ -159,12 +200,22 @@ eval_proof (list_t * everything, vec_t * rets, int verbose)
 
       char * ret_chk;
       int ret_val;
+      gint64 start;
+
+      start = g_get_monotonic_time ();
       ret_chk = sen_data_evaluate (sd, &ret_val, pf_vars,
 				   everything);
 
       if (!ret_chk)
 	return AEC_MEM;
 
+      if (results)
+	{
+	  results[cur_line - 1].value = ret_val;
+	  results[cur_line - 1].msg = ret_chk;
+	  results[cur_line - 1].usecs = g_get_monotonic_time () - start;
+	}
+
       if (verbose)
 	{
 	  if (sd->premise)
@@ -220,42 +271,26 @@ eval_proof (list_t * everything, vec_t * rets, int verbose)
 }
 
 /* Converts a proof into a LaTeX file.
+ * The document is built in memory and written at once.
  *  input:
  *   proof - the proof to convert.
  *   file - the file to write to.
  *  output:
- *   0 on success, -1 on error.
+ *   0 on success, -2 on i/o error.
  */
 int
 convert_proof_latex (proof_t * proof, const char * filename)
 {
+  GString * doc;
   FILE * file;
+  item_t * ev_itr;
+  int i, ret = 0;
 
-  file = fopen (filename, "w");
-  if (!file)
-    {
-      PERROR (NULL);
-      exit (EXIT_FAILURE);
-    }
-
-  fprintf (file, "\\documentclass{article}\n");
-  fprintf (file, "\\usepackage{amsmath}\n");
-  fprintf (file, "\\usepackage{amsfonts}\n");
-  fprintf (file, "\\usepackage{longtable}\n");
-  fprintf (file, "\\usepackage[cm]{fullpage}\n");
-  fprintf (file, "\\begin{document}\n");
-  fprintf (file, "\\newcommand{\\eline}{--------}\n");
-  fprintf (file, "\\newcommand{\\prmline}[2]{#1.&$#2$&}\n");
-  fprintf (file, "\\newcommand{\\stdline}[3]{#1.&$#2$&\\texttt{#3 }}\n");
-  fprintf (file, "\\newcommand{\\pquad}{| \\;}\n");
-  fprintf (file, "\\newcommand{\\spquad}{\\text{ } \\quad}\n");
-  fprintf (file, "\n");
-
-  fprintf (file, "\\begin{longtable}{r|p{14.5cm}|l}\n");
+  doc = g_string_sized_new (sizeof (LATEX_PREAMBLE)
+                            + LATEX_LINE_SIZE * proof->everything->num_stuff);
 
-  item_t * ev_itr;
-  char * text;
-  int i;
+  g_string_append (doc, LATEX_PREAMBLE);
+  g_string_append (doc, "\\begin{longtable}{r|p{14.5cm}|l}\n");
 
   for (ev_itr = proof->everything->head; ev_itr; ev_itr = ev_itr->next)
     {
@@ -265,61 +300,61 @@ convert_proof_latex (proof_t * proof, const char * filename)
       if (!sd->premise)
 	break;
 
-      text = convert_sd_latex (sd);
-      if (!text)
-	return AEC_MEM;
-
-      fprintf (file, "\t\\prmline{%i}{%s}\\\\\n", sd->line_num, text);
-      free (text);
+      g_string_append_printf (doc, "\t\\prmline{%i}{", sd->line_num);
+      sen_data_latex (sd, doc);
+      g_string_append (doc, "}\\\\\n");
     }
 
-  fprintf (file, "\t\\hline\n");
+  g_string_append (doc, "\t\\hline\n");
 
   for (; ev_itr; ev_itr = ev_itr->next)
     {
       sen_data * sd;
       sd = ev_itr->value;
 
-      text = convert_sd_latex (sd);
-      if (!text)
-	return AEC_MEM;
-
       const char * rule = sd->subproof ? "assume" : rules_list[sd->rule];
 
-      fprintf (file, "\t\\stdline{%i}{%s}{%s} ", sd->line_num,
-	       text, rule);
+      g_string_append_printf (doc, "\t\\stdline{%i}{", sd->line_num);
+      sen_data_latex (sd, doc);
+      g_string_append_printf (doc, "}{%s} ", rule);
 
       if (!(sd->rule == RULE_EX || sd->rule == RULE_II
 	    || sd->rule == RULE_SQ || sd->subproof))
 	{
-	  fprintf (file, "(");
+	  g_string_append_c (doc, '(');
 	  for (i = 0; sd->refs[i] != REF_END; i++)
-	    {
-	      fprintf (file, "%i", sd->refs[i]);
-	      if (sd->refs[i + 1] != REF_END)
-		fprintf (file, ",");
-	    }
-
-	  fprintf (file, ")");
+	    g_string_append_printf (doc, (i > 0) ? ",%i" : "%i", sd->refs[i]);
+	  g_string_append_c (doc, ')');
 	}
 
-      fprintf (file, "\\\\\n");
-      free (text);
+      g_string_append (doc, "\\\\\n");
 
       if (sd->subproof)
 	{
-	  fprintf (file, "&$");
+	  g_string_append (doc, "&$");
 	  for (i = 0; i < sd->depth; i++)
-	    fprintf (file, "\\pquad ");
-	  fprintf (file, "\\eline&\\\\\n");
+	    g_string_append (doc, "\\pquad ");
+	  g_string_append (doc, "\\eline&\\\\\n");
 	}
     }
 
-  fprintf (file, "\\end{longtable}\n");
+  g_string_append (doc, "\\end{longtable}\n");
+  g_string_append (doc, "\\end{document}\n");
 
-  fprintf (file, "\\end{document}\n");
+  file = fopen (filename, "w");
+  if (!file)
+    {
+      perror (filename);
+      g_string_free (doc, TRUE);
+      return AEC_IO;
+    }
 
-  fclose (file);
+  if ((fwrite (doc->str, 1, doc->len, file) != doc->len) | fclose (file))
+    {
+      perror (filename);
+      ret = AEC_IO;
+    }
 
-  return 0;
+  g_string_free (doc, TRUE);
+  return ret;
 }
@@ -29,10 +29,20 @@ struct proof {
   int boolean : 1;      // Whether or not this is a boolean mode proof.
 };
 
+// The result of evaluating one sentence of a proof.
+
+struct line_result {
+  int value;            // The value type of the sentence.
+  const char * msg;     // The message from the evaluation.
+  long long usecs;      // The time the evaluation took, in microseconds.
+};
+
 proof_t * proof_init ();
 void proof_destroy (proof_t * proof);
 int proof_eval (proof_t * proof, vec_t * rets, int verbose);
 int eval_proof (list_t * everything, vec_t * rets, int verbose);
+int eval_proof_lines (list_t * everything, vec_t * rets, line_result * results,
+                      int verbose);
 
 int convert_proof_latex (proof_t * proof, const char * filename);
 
@@ -0,0 +1,236 @@
+/*  Functions to handle the order statistic tree.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* The tree is a treap without keys: the nodes are ordered as the sequence
+ *  is, and each one counts the nodes under it.  The random priorities keep
+ *  its depth logarithmic, so inserting a node, removing one, or finding
+ *  its place in the sequence only follows one path from it to the root.
+ */
+
+#include <stdlib.h>
+
+#include "rank-tree.h"
+
+#define RANK_SIZE(n) ((n) ? (n)->size : 0)
+
+/* Generates the priority of a new node.
+ *  input:
+ *    none.
+ *  output:
+ *    a pseudo-random number.
+ */
+static unsigned int
+rank_random ()
+{
+  static unsigned int state = 2463534242u;
+
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+
+  return state;
+}
+
+/* Rotates a node above its parent.
+ *  input:
+ *    rt - the tree containing the node.
+ *    node - the node, which must have a parent.
+ *  output:
+ *    none.
+ */
+static void
+rank_rotate_up (rank_tree * rt, rank_node * node)
+{
+  rank_node * par, * grand;
+
+  par = node->parent;
+  grand = par->parent;
+
+  if (par->left == node)
+    {
+      par->left = node->right;
+      if (node->right)
+        node->right->parent = par;
+      node->right = par;
+    }
+  else
+    {
+      par->right = node->left;
+      if (node->left)
+        node->left->parent = par;
+      node->left = par;
+    }
+
+  par->parent = node;
+  node->parent = grand;
+
+  if (!grand)
+    rt->root = node;
+  else if (grand->left == par)
+    grand->left = node;
+  else
+    grand->right = node;
+
+  // The nodes under the grandparent are the same as before.
+  par->size = RANK_SIZE (par->left) + RANK_SIZE (par->right) + 1;
+  node->size = RANK_SIZE (node->left) + RANK_SIZE (node->right) + 1;
+}
+
+/* Inserts a node into a tree.
+ *  input:
+ *    rt - the tree into which to insert the node.
+ *    prev - the node after which to insert it, or NULL to make it first.
+ *    node - the node to insert, which must not be in a tree.
+ *  output:
+ *    none.
+ */
+void
+rank_tree_insert (rank_tree * rt, rank_node * prev, rank_node * node)
+{
+  rank_node * par, * itr;
+
+  node->left = node->right = NULL;
+  node->size = 1;
+  node->priority = rank_random ();
+
+  if (!rt->root)
+    {
+      node->parent = NULL;
+      rt->root = node;
+      return;
+    }
+
+  // The node goes just after prev: as its right child if it has none,
+  //  or else as the left child of whatever comes after it.
+  if (prev && !prev->right)
+    {
+      par = prev;
+      par->right = node;
+    }
+  else
+    {
+      par = (prev) ? prev->right : rt->root;
+      while (par->left)
+        par = par->left;
+      par->left = node;
+    }
+
+  node->parent = par;
+  for (itr = par; itr; itr = itr->parent)
+    itr->size++;
+
+  while (node->parent && node->parent->priority < node->priority)
+    rank_rotate_up (rt, node);
+}
+
+/* Removes a node from a tree.
+ *  input:
+ *    rt - the tree from which to remove the node.
+ *    node - the node to remove.
+ *  output:
+ *    none.
+ */
+void
+rank_tree_remove (rank_tree * rt, rank_node * node)
+{
+  rank_node * par, * itr;
+
+  // Rotate the node down until it is a leaf.
+  while (node->left || node->right)
+    {
+      rank_node * child;
+
+      if (!node->left)
+        child = node->right;
+      else if (!node->right)
+        child = node->left;
+      else
+        child = (node->left->priority > node->right->priority)
+          ? node->left : node->right;
+
+      rank_rotate_up (rt, child);
+    }
+
+  par = node->parent;
+  if (!par)
+    rt->root = NULL;
+  else if (par->left == node)
+    par->left = NULL;
+  else
+    par->right = NULL;
+
+  for (itr = par; itr; itr = itr->parent)
+    itr->size--;
+
+  node->parent = NULL;
+  node->size = 0;
+}
+
+/* Finds the place of a node in its sequence.
+ *  input:
+ *    node - the node, which must be in a tree.
+ *  output:
+ *    the position of the node, counting from one.
+ */
+int
+rank_node_rank (const rank_node * node)
+{
+  int rank;
+
+  rank = RANK_SIZE (node->left) + 1;
+  for (; node->parent; node = node->parent)
+    {
+      if (node->parent->right == node)
+        rank += RANK_SIZE (node->parent->left) + 1;
+    }
+
+  return rank;
+}
+
+/* Finds the node at a place in a tree's sequence.
+ *  input:
+ *    rt - the tree to search.
+ *    rank - the position of the node, counting from one.
+ *  output:
+ *    the node, or NULL if the tree has fewer nodes.
+ */
+rank_node *
+rank_tree_nth (const rank_tree * rt, int rank)
+{
+  rank_node * itr = rt->root;
+
+  while (itr)
+    {
+      int here = RANK_SIZE (itr->left) + 1;
+
+      if (rank == here)
+        return itr;
+
+      if (rank < here)
+        {
+          itr = itr->left;
+        }
+      else
+        {
+          rank -= here;
+          itr = itr->right;
+        }
+    }
+
+  return NULL;
+}
@@ -0,0 +1,49 @@
+/*  The order statistic tree, which numbers a sequence.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_RANK_TREE_H
+#define ARIS_RANK_TREE_H
+
+#include "typedef.h"
+
+// A node of the tree, kept inside whatever it numbers.
+
+struct rank_node
+{
+  struct rank_node * parent;
+  struct rank_node * left, * right;
+
+  unsigned int size;      // The number of nodes under this one, with it.
+  unsigned int priority;  // Keeps the tree balanced.
+};
+
+// The tree itself.  Its nodes are in the order of the sequence.
+
+struct rank_tree
+{
+  rank_node * root;
+};
+
+#define RANK_NODE_LINKED(n) ((n)->size > 0)
+
+void rank_tree_insert (rank_tree * rt, rank_node * prev, rank_node * node);
+void rank_tree_remove (rank_tree * rt, rank_node * node);
+int rank_node_rank (const rank_node * node);
+rank_node * rank_tree_nth (const rank_tree * rt, int rank);
+
+#endif /* ARIS_RANK_TREE_H */
@@ -0,0 +1,690 @@
+/* Machine readable grading reports.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* A report holds a record for each graded file, written and flushed
+ *  as soon as the file is graded, so that a long run can be read while
+ *  it goes.
+ * In JSON, each file is one object on a line of its own:
+ *
+ *    {"file":..., "passed":..., "usecs":..., "lines":[...], "goals":[...]}
+ *
+ * In CSV, each file has a row for each of its lines and goals, then a
+ *  row for the file itself, distinguished by the 'record' column.
+ * A message id is a hash of the untranslated message, so that rows
+ *  with the same message can be grouped without comparing the text, in
+ *  any locale.  The span of an error is a byte range of the sentence's
+ *  text, or null if the error isn't in the text, as with a bad
+ *  reference or a missing rule.  A text error is narrowed to the stray
+ *  parenthesis or the innermost parenthesized part that fails the same
+ *  check, and a misapplied rule to the part of the sentence that
+ *  differs from its closest reference.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef WIN32
+#include <locale.h>
+#endif
+#include "report.h"
+#include "list.h"
+#include "process.h"
+#include "proof.h"
+#include "rules.h"
+#include "sen-data.h"
+
+// The name of each value type, as a verdict.
+static const char * report_verdicts[] = {
+  "blank", "correct", "incorrect", "error", "reference-error", "rule-missing"
+};
+
+/* Opens a report.
+ *  input:
+ *    format - the name of the format, 'json' or 'csv'.
+ *    file_name - the file to write the report to, or NULL for stdout.
+ *  output:
+ *    the report, or NULL on error.
+ */
+report *
+report_open (const char * format, const char * file_name)
+{
+  report * rp;
+
+  rp = (report *) calloc (1, sizeof (report));
+  CHECK_ALLOC (rp, NULL);
+
+  if (!strcmp (format, "json"))
+    {
+      rp->format = REPORT_JSON;
+    }
+  else if (!strcmp (format, "csv"))
+    {
+      rp->format = REPORT_CSV;
+    }
+  else
+    {
+      fprintf (stderr, "Argument Error - \
+unknown report format '%s'.\n", format);
+      free (rp);
+      return NULL;
+    }
+
+  rp->out = stdout;
+  if (file_name)
+    {
+      rp->out = fopen (file_name, "w");
+      if (!rp->out)
+        {
+          perror (file_name);
+          free (rp);
+          return NULL;
+        }
+    }
+
+  if (rp->format == REPORT_CSV)
+    fprintf (rp->out, "file,record,line,verdict,rule,msg_id,message,\
+span_start,span_end,usecs\n");
+
+  return rp;
+}
+
+/* Writes a string to a report, quoted and escaped for its format.
+ *  input:
+ *    rp - the report.
+ *    str - the string.
+ *  output:
+ *    none.
+ */
+static void
+report_string (report * rp, const char * str)
+{
+  const char * run;
+
+  fputc ('\"', rp->out);
+
+  for (run = str; *str; str++)
+    {
+      unsigned char c = *str;
+
+      if (rp->format == REPORT_CSV)
+        {
+          if (c != '\"')
+            continue;
+
+          fwrite (run, 1, str - run + 1, rp->out);
+          fputc ('\"', rp->out);
+          run = str + 1;
+          continue;
+        }
+
+      if (c != '\"' && c != '\\' && c >= 0x20)
+        continue;
+
+      fwrite (run, 1, str - run, rp->out);
+      if (c == '\"' || c == '\\')
+        fprintf (rp->out, "\\%c", c);
+      else
+        fprintf (rp->out, "\\u%04x", c);
+      run = str + 1;
+    }
+
+  fwrite (run, 1, str - run, rp->out);
+  fputc ('\"', rp->out);
+}
+
+/* Gets the id of a message.
+ *  input:
+ *    msg - the message.
+ *  output:
+ *    the 32 bit FNV-1a hash of the message.
+ */
+static unsigned int
+report_msg_id (const char * msg)
+{
+  unsigned int hash = 2166136261u;
+
+  for (; *msg; msg++)
+    {
+      hash ^= (unsigned char) *msg;
+      hash *= 16777619u;
+    }
+
+  return hash;
+}
+
+/* Finds the stray parenthesis in a sentence.
+ *  input:
+ *    text - the text of the sentence.
+ *    start, end - receive the span of the parenthesis, if one is found.
+ *  output:
+ *    none.
+ */
+static void
+report_paren_span (const unsigned char * text, int * start, int * end)
+{
+  int i, depth, open;
+
+  depth = 0;
+  open = -1;
+  for (i = 0; text[i]; i++)
+    {
+      if (text[i] == '(')
+        {
+          if (depth == 0)
+            open = i;
+          depth++;
+        }
+      else if (text[i] == ')')
+        {
+          if (depth == 0)
+            {
+              *start = i;
+              *end = i + 1;
+              return;
+            }
+          depth--;
+        }
+    }
+
+  if (depth > 0)
+    {
+      *start = open;
+      *end = open + 1;
+    }
+}
+
+/* Checks part of the text of a sentence on its own.
+ *  input:
+ *    text - the text of the sentence.
+ *    start - the start of the part.
+ *    len - the length of the part.
+ *  output:
+ *    the same as check_text.
+ */
+static int
+report_check_part (const unsigned char * text, int start, int len)
+{
+  unsigned char * part, * formatted;
+  int ret;
+
+  part = (unsigned char *) calloc (len + 1, sizeof (char));
+  CHECK_ALLOC (part, AEC_MEM);
+  memcpy (part, text + start, len);
+
+  formatted = format_string (part);
+  free (part);
+  if (!formatted)
+    return AEC_MEM;
+
+  ret = check_text (formatted);
+  free (formatted);
+
+  return ret;
+}
+
+/* Narrows a text error to the innermost parenthesized part of a
+ *  sentence that fails on its own.
+ *  input:
+ *    text - the text of the sentence, whose parentheses match.
+ *    start, end - the span of the error, narrowed if a part fails.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+report_group_span (const unsigned char * text, int * start, int * end)
+{
+  int i, j, depth, ret;
+
+  for (i = 0; text[i]; i++)
+    {
+      if (text[i] != '(')
+        continue;
+
+      for (j = i + 1, depth = 1; text[j]; j++)
+        {
+          if (text[j] == '(')
+            depth++;
+          else if (text[j] == ')' && --depth == 0)
+            break;
+        }
+
+      // Only a part smaller than the span found so far can narrow it.
+      if (!text[j] || j + 1 - i >= *end - *start)
+        continue;
+
+      ret = report_check_part (text, i + 1, j - i - 1);
+      if (ret == AEC_MEM)
+        return AEC_MEM;
+
+      if (ret < 0)
+        {
+          *start = i;
+          *end = j + 1;
+        }
+    }
+
+  return 0;
+}
+
+/* Finds the part of a sentence that differs from a reference.
+ *  input:
+ *    text - the text of the sentence.
+ *    ref - the text of the reference.
+ *    start, end - receive the span of the part.
+ *  output:
+ *    none.
+ */
+static void
+report_diff_span (const unsigned char * text, const unsigned char * ref,
+                  int * start, int * end)
+{
+  int len, ref_len, i, j;
+
+  len = strlen ((const char *) text);
+  ref_len = strlen ((const char *) ref);
+
+  for (i = 0; i < len && i < ref_len && text[i] == ref[i]; i++);
+  for (j = 0; j < len - i && j < ref_len - i
+         && text[len - j - 1] == ref[ref_len - j - 1]; j++);
+
+  *start = i;
+  *end = len - j;
+
+  // Nothing was changed, so the whole sentence is at fault.
+  if (*start == *end)
+    {
+      *start = 0;
+      *end = len;
+    }
+}
+
+/* Finds the span of the error in a sentence.
+ *  input:
+ *    lr - the result of evaluating the sentence.
+ *    sd - the sentence.
+ *    lines - the lines of the proof, by line number less one.
+ *    num - the number of lines.
+ *    start, end - receive the span, or -1 if the error isn't in the text.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+report_span (line_result * lr, sen_data * sd, sen_data ** lines, int num,
+             int * start, int * end)
+{
+  int i, ret, r_start, r_end;
+
+  *start = *end = -1;
+
+  if (lr->value == VALUE_TYPE_FALSE)
+    {
+      *start = 0;
+      *end = strlen ((const char *) sd->text);
+
+      for (i = 0; sd->refs && sd->refs[i] != REF_END; i++)
+        {
+          if (sd->refs[i] < 1 || sd->refs[i] > num)
+            continue;
+
+          report_diff_span (sd->text, lines[sd->refs[i] - 1]->text,
+                            &r_start, &r_end);
+          if (r_end - r_start < *end - *start)
+            {
+              *start = r_start;
+              *end = r_end;
+            }
+        }
+
+      return 0;
+    }
+
+  if (lr->value != VALUE_TYPE_ERROR)
+    return 0;
+
+  // Some errors, such as a lemma that can't be opened, aren't in the text.
+  *end = strlen ((const char *) sd->text);
+  ret = (*end > 0) ? report_check_part (sd->text, 0, *end) : -2;
+  if (ret == AEC_MEM)
+    return AEC_MEM;
+
+  if (ret == 0)
+    {
+      *end = -1;
+      return 0;
+    }
+
+  *start = 0;
+  if (ret == -2)
+    {
+      report_paren_span (sd->text, start, end);
+      return 0;
+    }
+
+  return report_group_span (sd->text, start, end);
+}
+
+/* Evaluates the lines of a proof with the messages left untranslated,
+ *  so that their ids are the same in every locale.
+ *  input:
+ *    proof - the proof to evaluate.
+ *    results - receives the result of each line.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+report_eval (proof_t * proof, line_result * results)
+{
+#ifndef WIN32
+  locale_t base, untranslated, old;
+  int ret;
+
+  base = duplocale (uselocale ((locale_t) 0));
+  if (!base)
+    return AEC_MEM;
+
+  untranslated = newlocale (LC_MESSAGES_MASK, "C", base);
+  if (!untranslated)
+    {
+      freelocale (base);
+      return AEC_MEM;
+    }
+
+  old = uselocale (untranslated);
+  ret = eval_proof_lines (proof->everything, NULL, results, 0);
+  uselocale (old);
+  freelocale (untranslated);
+
+  return ret;
+#else
+  return eval_proof_lines (proof->everything, NULL, results, 0);
+#endif
+}
+
+/* Writes a row of a CSV report.
+ *  input:
+ *    rp - the report.
+ *    name - the name of the file.
+ *    record - the kind of row.
+ *    line - the line number, or -1.
+ *    verdict - the verdict.
+ *    rule - the rule, or NULL.
+ *    msg - the untranslated message, or the goal for a goal row, or NULL.
+ *    start, end - the span of the error, or -1.
+ *    usecs - the time taken, or -1.
+ *  output:
+ *    none.
+ */
+static void
+report_csv_row (report * rp, const char * name, const char * record,
+                int line, const char * verdict, const char * rule,
+                const char * msg, int start, int end, long long usecs)
+{
+  report_string (rp, name);
+  fprintf (rp->out, ",%s,", record);
+  if (line != -1)
+    fprintf (rp->out, "%i", line);
+  fprintf (rp->out, ",%s,", verdict);
+  if (rule)
+    fputs (rule, rp->out);
+  fputc (',', rp->out);
+  if (msg)
+    {
+      if (!strcmp (record, "goal"))
+        {
+          fputc (',', rp->out);
+          report_string (rp, msg);
+        }
+      else
+        {
+          fprintf (rp->out, "%08x,", report_msg_id (msg));
+          report_string (rp, _(msg));
+        }
+    }
+  else
+    {
+      fputc (',', rp->out);
+    }
+  fputc (',', rp->out);
+  if (start != -1)
+    fprintf (rp->out, "%i,%i", start, end);
+  else
+    fputc (',', rp->out);
+  fputc (',', rp->out);
+  if (usecs != -1)
+    fprintf (rp->out, "%lli", usecs);
+  fputc ('\n', rp->out);
+}
+
+/* Grades a proof and writes its record to a report.
+ * A proof passes if each of its lines is correct and each of its goals
+ *  is met.
+ *  input:
+ *    rp - the report.
+ *    name - the name to give the proof in the report.
+ *    proof - the proof to grade.
+ *  output:
+ *    1 if the proof passed, 0 if it failed,
+ *    -1 on memory error, -2 on i/o error.
+ */
+int
+report_file (report * rp, const char * name, proof_t * proof)
+{
+  line_result * results = NULL;
+  unsigned char ** texts = NULL;
+  sen_data ** lines = NULL;
+  int * goal_lines = NULL;
+  item_t * itr, * g_itr;
+  long long total = 0;
+  int i, g, num, ret = AEC_MEM, passed = 1;
+
+  num = proof->everything->num_stuff;
+  results = (line_result *) calloc (num + 1, sizeof (line_result));
+  CHECK_ALLOC (results, AEC_MEM);
+
+  if (report_eval (proof, results) == AEC_MEM)
+    goto out;
+
+  // The texts without spaces, to find the goals in.
+  texts = (unsigned char **) calloc (num + 1, sizeof (unsigned char *));
+  CHECK_ALLOC (texts, AEC_MEM);
+
+  lines = (sen_data **) calloc (num + 1, sizeof (sen_data *));
+  CHECK_ALLOC (lines, AEC_MEM);
+
+  for (i = 0, itr = proof->everything->head; itr; i++, itr = itr->next)
+    {
+      lines[i] = itr->value;
+      texts[i] = die_spaces_die (lines[i]->text);
+      if (!texts[i])
+        goto out;
+
+      total += results[i].usecs;
+      if (results[i].value != VALUE_TYPE_TRUE
+          && results[i].value != VALUE_TYPE_BLANK)
+        passed = 0;
+    }
+
+  // Find the goals first, since an unmet goal fails the proof.
+  goal_lines = (int *) calloc (proof->goals->num_stuff + 1, sizeof (int));
+  CHECK_ALLOC (goal_lines, AEC_MEM);
+
+  for (g = 0, g_itr = proof->goals->head; g_itr; g++, g_itr = g_itr->next)
+    {
+      unsigned char * goal;
+
+      goal = die_spaces_die ((unsigned char *) g_itr->value);
+      if (!goal)
+        goto out;
+
+      goal_lines[g] = -1;
+      for (i = 0; i < num; i++)
+        {
+          if (!strcmp ((char *) goal, (char *) texts[i]))
+            {
+              goal_lines[g] = lines[i]->line_num;
+              break;
+            }
+        }
+      free (goal);
+
+      if (goal_lines[g] == -1)
+        passed = 0;
+    }
+
+  if (rp->format == REPORT_JSON)
+    {
+      fputs ("{\"file\":", rp->out);
+      report_string (rp, name);
+      fprintf (rp->out, ",\"passed\":%s,\"usecs\":%lli,\"lines\":[",
+               (passed) ? "true" : "false", total);
+    }
+
+  for (i = 0; i < num; i++)
+    {
+      sen_data * sd = lines[i];
+      const char * rule;
+      int start, end;
+
+      if (sd->premise)
+        rule = "premise";
+      else if (sd->subproof)
+        rule = "assume";
+      else if (sd->rule >= 0 && sd->rule < NUM_RULES)
+        rule = rules_list[sd->rule];
+      else
+        rule = "";
+
+      if (report_span (&results[i], sd, lines, num, &start, &end) == AEC_MEM)
+        goto out;
+
+      if (rp->format == REPORT_CSV)
+        {
+          report_csv_row (rp, name, "line", sd->line_num,
+                          report_verdicts[results[i].value], rule,
+                          results[i].msg, start, end, results[i].usecs);
+          continue;
+        }
+
+      fprintf (rp->out, "%s{\"line\":%i,\"verdict\":\"%s\",\"rule\":\"%s\",\
+\"msg_id\":\"%08x\",\"message\":", (i > 0) ? "," : "", sd->line_num,
+               report_verdicts[results[i].value], rule,
+               report_msg_id (results[i].msg));
+      report_string (rp, _(results[i].msg));
+
+      if (start != -1)
+        fprintf (rp->out, ",\"span\":[%i,%i]", start, end);
+      else
+        fputs (",\"span\":null", rp->out);
+
+      fprintf (rp->out, ",\"usecs\":%lli}", results[i].usecs);
+    }
+
+  if (rp->format == REPORT_JSON)
+    fputs ("],\"goals\":[", rp->out);
+
+  for (g = 0, g_itr = proof->goals->head; g_itr; g++, g_itr = g_itr->next)
+    {
+      int line = goal_lines[g];
+
+      if (rp->format == REPORT_CSV)
+        {
+          report_csv_row (rp, name, "goal", line,
+                          (line != -1) ? "met" : "unmet", NULL,
+                          g_itr->value, -1, -1, -1);
+          continue;
+        }
+
+      fprintf (rp->out, "%s{\"goal\":", (g > 0) ? "," : "");
+      report_string (rp, g_itr->value);
+      fprintf (rp->out, ",\"met\":%s,\"line\":", (line != -1) ? "true" : "false");
+      if (line != -1)
+        fprintf (rp->out, "%i}", line);
+      else
+        fputs ("null}", rp->out);
+    }
+
+  if (rp->format == REPORT_CSV)
+    report_csv_row (rp, name, "file", -1, (passed) ? "passed" : "failed",
+                    NULL, NULL, -1, -1, total);
+  else
+    fputs ("]}\n", rp->out);
+
+  ret = passed;
+  if (fflush (rp->out) || ferror (rp->out))
+    ret = AEC_IO;
+
+ out:
+  if (texts)
+    {
+      for (i = 0; i < num; i++)
+        free (texts[i]);
+      free (texts);
+    }
+  free (lines);
+  free (goal_lines);
+  free (results);
+
+  return ret;
+}
+
+/* Writes the record of a file that couldn't be read to a report.
+ *  input:
+ *    rp - the report.
+ *    name - the name of the file.
+ *  output:
+ *    0 on success, -2 on i/o error.
+ */
+int
+report_unreadable (report * rp, const char * name)
+{
+  if (rp->format == REPORT_CSV)
+    {
+      report_csv_row (rp, name, "file", -1, "unreadable",
+                      NULL, NULL, -1, -1, -1);
+    }
+  else
+    {
+      fputs ("{\"file\":", rp->out);
+      report_string (rp, name);
+      fputs (",\"passed\":false,\"unreadable\":true,\"lines\":[],\"goals\":[]}\n",
+             rp->out);
+    }
+
+  if (fflush (rp->out) || ferror (rp->out))
+    return AEC_IO;
+
+  return 0;
+}
+
+/* Closes a report.
+ *  input:
+ *    rp - the report.
+ *  output:
+ *    0 on success, -2 on i/o error.
+ */
+int
+report_close (report * rp)
+{
+  int ret = 0;
+
+  if (rp->out != stdout && fclose (rp->out))
+    ret = AEC_IO;
+
+  free (rp);
+  return ret;
+}
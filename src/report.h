@@ -0,0 +1,42 @@
+/* Machine readable grading reports.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_REPORT_H
+#define ARIS_REPORT_H
+
+#include <stdio.h>
+#include "typedef.h"
+
+enum REPORT_FORMAT {
+  REPORT_JSON = 0,
+  REPORT_CSV
+};
+
+// A report that graded files are written to as they finish.
+
+struct report {
+  FILE * out;           // The stream the report is written to.
+  int format;           // One of REPORT_FORMAT.
+};
+
+report * report_open (const char * format, const char * file_name);
+int report_file (report * rp, const char * name, proof_t * proof);
+int report_unreadable (report * rp, const char * name);
+int report_close (report * rp);
+
+#endif  /*  ARIS_REPORT_H  */
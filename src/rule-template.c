@@ -0,0 +1,551 @@
+/* Functions for the replacement rule templates.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* A template states a replacement rule as two sentences that may replace
+ *  one another, such as 'A $ B == ~A | B' for Implication.  Single upper
+ *  case letters, and predicates named by one, stand for any sentence, and
+ *  single lower case letters stand for any variable.  Each side is compiled
+ *  once into a formula tree, with the metavariable of each node looked up
+ *  ahead of time.
+ *
+ * A template is applied to a differing pair of subtrees in both directions.
+ *  The first side is matched against one subtree, binding metavariables as
+ *  they are met.  The other side is then matched against the other subtree,
+ *  and each sentence it meets that is already bound is checked against its
+ *  binding by the same rule, so that the rule may be applied again within
+ *  it.
+ */
+
+#include "rule-template.h"
+#include "sexpr-process.h"
+
+// The rules that may be given by templates.
+
+static const char * template_rules[] = {
+  "im", "dm", "as", "co", "id", "dt", "eq", "dn", "ep", "sb",
+  "bi", "bd", "bn", "sn", NULL
+};
+
+// The built in templates.  Rules whose sentences may have any number of
+//  parts, such as Association over any number of conjuncts, also have
+//  their own checks in sexpr-process-equiv.c and sexpr-process-bool.c.
+
+static const char * builtin_templates[][2] = {
+  {"im", "A $ B == ~A | B"},
+  {"dm", "~(A & B) == ~A | ~B"},
+  {"dm", "~(A | B) == ~A & ~B"},
+  {"dm", "~@x(P(x)) == #x(~P(x))"},
+  {"dm", "~#x(P(x)) == @x(~P(x))"},
+  {"as", "(A & B) & C == A & (B & C)"},
+  {"as", "(A | B) | C == A | (B | C)"},
+  {"co", "A & B == B & A"},
+  {"co", "A | B == B | A"},
+  {"id", "A & A == A"},
+  {"id", "A | A == A"},
+  {"dt", "A & (B | C) == (A & B) | (A & C)"},
+  {"dt", "A | (B & C) == (A | B) & (A | C)"},
+  {"dt", "@x(P(x) & Q(x)) == @x(P(x)) & @x(Q(x))"},
+  {"dt", "#x(P(x) | Q(x)) == #x(P(x)) | #x(Q(x))"},
+  {"eq", "A % B == (A $ B) & (B $ A)"},
+  {"dn", "~~A == A"},
+  {"ep", "(A & B) $ C == A $ (B $ C)"},
+  {"sb", "A & (A | B) == A"},
+  {"sb", "A | (A & B) == A"},
+  {"bi", "A & ! == A"},
+  {"bi", "! & A == A"},
+  {"bi", "A | ^ == A"},
+  {"bi", "^ | A == A"},
+  {"bd", "A & ^ == ^"},
+  {"bd", "^ & A == ^"},
+  {"bd", "A | ! == !"},
+  {"bd", "! | A == !"},
+  {"bn", "A & ~A == ^"},
+  {"bn", "A | ~A == !"},
+  {"sn", "~! == ^"},
+  {"sn", "~^ == !"},
+  {NULL, NULL}
+};
+
+static rule_template * templates = NULL;
+static int num_templates = 0;
+static int alloc_templates = 0;
+static int templates_ready = 0;
+static int num_builtin = 0;
+
+/* Determines the metavariable of a template node.
+ *  input:
+ *    node - the node.
+ *  output:
+ *    the index of the metavariable, or -1 if node is not one.
+ */
+static int
+tmpl_slot (const sexpr_node * node)
+{
+  const sexpr_node * atom = node;
+
+  // A predicate named by a metavariable stands for the whole sentence.
+  if (node->num_kids > 0)
+    atom = SEXPR_HEAD (node);
+
+  if (atom->num_kids > 0 || atom->len != 1)
+    return -1;
+
+  if (atom->str[0] >= 'A' && atom->str[0] <= 'Z')
+    return atom->str[0] - 'A';
+
+  if (node == atom && atom->str[0] >= 'a' && atom->str[0] <= 'z')
+    return 26 + atom->str[0] - 'a';
+
+  return -1;
+}
+
+/* Compiles one side of a template.
+ *  input:
+ *    text - the text of the side.
+ *    len - the length of the text.
+ *    tree - receives the formula tree.
+ *    slots - receives the metavariable of each node.
+ *  output:
+ *    0 on success, -2 if the text is not a sentence, -1 on memory error.
+ */
+static int
+tmpl_compile_side (const unsigned char * text, int len, sexpr_tree ** tree,
+		   int ** slots)
+{
+  unsigned char * side, * norm, * fmt, * sexpr;
+  int i, ret;
+
+  side = (unsigned char *) calloc (len + 1, sizeof (char));
+  CHECK_ALLOC (side, AEC_MEM);
+  strncpy ((char *) side, (const char *) text, len);
+
+  norm = normalize_conns (side);
+  free (side);
+  if (!norm)
+    return AEC_MEM;
+
+  fmt = format_string (norm);
+  free (norm);
+  if (!fmt)
+    return AEC_MEM;
+
+  // A template may bind the same variable in two places,
+  //  so the quantifiers are not checked.
+  ret = (fmt[0] == '\0' || !check_parens (fmt)) ? 0 : check_conns (fmt);
+  if (ret != 1)
+    {
+      free (fmt);
+      return (ret == AEC_MEM) ? AEC_MEM : -2;
+    }
+
+  sexpr = convert_sexpr (fmt);
+  free (fmt);
+  if (!sexpr)
+    return AEC_MEM;
+
+  *tree = sexpr_tree_init (sexpr);
+  free (sexpr);
+  if (!*tree)
+    return -2;
+
+  *slots = (int *) calloc ((*tree)->num_nodes, sizeof (int));
+  CHECK_ALLOC (*slots, AEC_MEM);
+
+  for (i = 0; i < (*tree)->num_nodes; i++)
+    (*slots)[i] = tmpl_slot ((*tree)->nodes + i);
+
+  return 0;
+}
+
+/* Adds a template to a rule.
+ *  input:
+ *    rule - the abbreviation of the rule.
+ *    text - the template, two sentences separated by TMPL_SEP.
+ *  output:
+ *    0 on success, -2 if the template is malformed, -1 on memory error.
+ */
+int
+rule_template_add (const char * rule, const unsigned char * text)
+{
+  rule_template * tmpl;
+  const unsigned char * sep;
+  int i, ret;
+
+  for (i = 0; template_rules[i]; i++)
+    if (!strcmp (rule, template_rules[i]))
+      break;
+
+  if (!template_rules[i])
+    return -2;
+
+  sep = (const unsigned char *) strstr ((const char *) text, TMPL_SEP);
+  if (!sep)
+    return -2;
+
+  if (num_templates == alloc_templates)
+    {
+      rule_template * new_templates;
+
+      alloc_templates = (alloc_templates > 0) ? alloc_templates * 2 : 32;
+      new_templates = (rule_template *) realloc (templates,
+						 alloc_templates
+						 * sizeof (rule_template));
+      CHECK_ALLOC (new_templates, AEC_MEM);
+      templates = new_templates;
+    }
+
+  tmpl = templates + num_templates;
+  memset (tmpl, 0, sizeof (rule_template));
+  strcpy (tmpl->rule, rule);
+
+  ret = tmpl_compile_side (text, sep - text, &tmpl->sides[0], &tmpl->slots[0]);
+  if (ret == 0)
+    ret = tmpl_compile_side (sep + strlen (TMPL_SEP),
+			     strlen ((const char *) sep + strlen (TMPL_SEP)),
+			     &tmpl->sides[1], &tmpl->slots[1]);
+
+  if (ret != 0)
+    {
+      if (tmpl->sides[0])
+	sexpr_tree_destroy (tmpl->sides[0]);
+      if (tmpl->slots[0])
+	free (tmpl->slots[0]);
+      return ret;
+    }
+
+  for (i = 0; i < 2; i++)
+    {
+      if (tmpl->slots[i][0] >= 0)
+	tmpl->root_conn[i] = -2;
+      else
+	tmpl->root_conn[i] = tmpl->sides[i]->root->conn;
+    }
+
+  num_templates++;
+  return 0;
+}
+
+/* Compiles the built in templates.
+ *  input:
+ *    none.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+rule_template_init ()
+{
+  int i, ret;
+
+  if (templates_ready)
+    return 0;
+
+  for (i = 0; builtin_templates[i][0]; i++)
+    {
+      ret = rule_template_add (builtin_templates[i][0],
+			       (const unsigned char *) builtin_templates[i][1]);
+      if (ret == AEC_MEM)
+	return AEC_MEM;
+    }
+
+  num_builtin = num_templates;
+  templates_ready = 1;
+  return 0;
+}
+
+/* Destroys every template.
+ *  input:
+ *    none.
+ *  output:
+ *    none.
+ */
+void
+rule_template_destroy ()
+{
+  int i;
+
+  for (i = 0; i < num_templates; i++)
+    {
+      sexpr_tree_destroy (templates[i].sides[0]);
+      sexpr_tree_destroy (templates[i].sides[1]);
+      free (templates[i].slots[0]);
+      free (templates[i].slots[1]);
+    }
+
+  if (templates)
+    free (templates);
+
+  templates = NULL;
+  num_templates = alloc_templates = num_builtin = 0;
+  templates_ready = 0;
+}
+
+/* Loads templates from a file.
+ *  Each line gives the abbreviation of a rule followed by a template,
+ *  such as 'dn ~~A == A'.  Blank lines and lines beginning with '#'
+ *  are skipped, and lines may be at most TMPL_LINE_MAX bytes long.
+ *  input:
+ *    file_name - the name of the file.
+ *  output:
+ *    the number of templates loaded, -2 on an I/O or syntax error,
+ *    or -1 on memory error.
+ */
+int
+rule_template_load (const char * file_name)
+{
+  FILE * file;
+  char line[TMPL_LINE_MAX + 2];
+  int ret, line_num, loaded;
+
+  ret = rule_template_init ();
+  if (ret == AEC_MEM)
+    return AEC_MEM;
+
+  file = fopen (file_name, "r");
+  if (!file)
+    {
+      perror (file_name);
+      return AEC_IO;
+    }
+
+  ret = line_num = loaded = 0;
+  while (ret == 0 && fgets (line, TMPL_LINE_MAX + 2, file))
+    {
+      char rule[3];
+      int pos = 0, len;
+
+      line_num++;
+      len = strlen (line);
+      if (line[len - 1] != '\n' && !feof (file))
+	{
+	  fprintf (stderr, "Template Error - \
+line %i of '%s' is longer than %i bytes.\n", line_num, file_name,
+		   TMPL_LINE_MAX);
+	  ret = -2;
+	  break;
+	}
+
+      while (len > 0 && isspace (line[len - 1]))
+	line[--len] = '\0';
+
+      while (isspace (line[pos]))
+	pos++;
+
+      if (line[pos] == '\0' || line[pos] == '#')
+	continue;
+
+      if (len - pos < 3 || isspace (line[pos + 1]) || !isspace (line[pos + 2]))
+	{
+	  fprintf (stderr, "Template Error - \
+line %i of '%s' must begin with a rule.\n", line_num, file_name);
+	  ret = -2;
+	  break;
+	}
+
+      rule[0] = line[pos];
+      rule[1] = line[pos + 1];
+      rule[2] = '\0';
+
+      ret = rule_template_add (rule, (unsigned char *) line + pos + 2);
+      if (ret == -2)
+	fprintf (stderr, "Template Error - \
+line %i of '%s' is not a valid template.\n", line_num, file_name);
+
+      if (ret == 0)
+	loaded++;
+    }
+
+  if (ret == 0 && ferror (file))
+    {
+      perror (file_name);
+      ret = AEC_IO;
+    }
+
+  fclose (file);
+  return (ret < 0) ? ret : loaded;
+}
+
+/* Counts the templates of a rule.
+ *  input:
+ *    rule - the abbreviation of the rule.
+ *  output:
+ *    the number of templates.
+ */
+int
+rule_template_count (const char * rule)
+{
+  int i, count = 0;
+
+  for (i = 0; i < num_templates; i++)
+    if (!strcmp (templates[i].rule, rule))
+      count++;
+
+  return count;
+}
+
+/* Counts the templates of a rule that were loaded from a file.
+ *  input:
+ *    rule - the abbreviation of the rule.
+ *  output:
+ *    the number of templates that are not built in.
+ */
+int
+rule_template_loaded (const char * rule)
+{
+  int i, count = 0;
+
+  for (i = num_builtin; i < num_templates; i++)
+    if (!strcmp (templates[i].rule, rule))
+      count++;
+
+  return count;
+}
+
+/* Matches one side of a template against a subtree.
+ *  input:
+ *    tmpl - the template.
+ *    side - the side of the template.
+ *    pat - the node of the template to match.
+ *    node - the subtree to match.
+ *    binds - the bindings of the metavariables.
+ *    checked - 1 if sentences that are already bound are to be checked
+ *              by the rule, 0 if they must be the same.
+ *    self - the rule being checked.
+ *  output:
+ *    1 if the subtree matches, 0 if not, -1 on memory error.
+ */
+static int
+tmpl_match (const rule_template * tmpl, int side, const sexpr_node * pat,
+	    sexpr_node * node, sexpr_node ** binds, int checked,
+	    sexpr_rule_func self)
+{
+  int slot, i, ret;
+
+  slot = tmpl->slots[side][pat - tmpl->sides[side]->nodes];
+  if (slot >= 0)
+    {
+      // Variables only stand for variables.
+      if (slot >= 26 && node->num_kids > 0)
+	return 0;
+
+      if (!binds[slot])
+	{
+	  binds[slot] = node;
+	  return 1;
+	}
+
+      if (!checked || slot >= 26)
+	return sexpr_node_equal (binds[slot], node);
+
+      char * ret_str;
+      ret_str = sexpr_tree_equiv (binds[slot], node, self);
+      if (!ret_str)
+	return AEC_MEM;
+
+      return SEXPR_TREE_OK (ret_str);
+    }
+
+  if (pat->num_kids != node->num_kids)
+    return 0;
+
+  if (pat->num_kids == 0)
+    return (pat->len == node->len && !memcmp (pat->str, node->str, pat->len));
+
+  for (i = 0; i < pat->num_kids; i++)
+    {
+      ret = tmpl_match (tmpl, side, pat->kids[i], node->kids[i], binds,
+			checked, self);
+      if (ret != 1)
+	return ret;
+    }
+
+  return 1;
+}
+
+/* Checks whether the root of one side of a template could match a node.
+ *  input:
+ *    tmpl - the template.
+ *    side - the side of the template.
+ *    node - the node.
+ *  output:
+ *    1 if it could, 0 otherwise.
+ */
+static int
+tmpl_root_ok (const rule_template * tmpl, int side, const sexpr_node * node)
+{
+  if (tmpl->root_conn[side] == -2)
+    return 1;
+
+  return (tmpl->root_conn[side] == node->conn
+	  && tmpl->sides[side]->root->num_kids == node->num_kids);
+}
+
+/* Applies the templates of a rule to a differing pair of subtrees.
+ *  input:
+ *    rule - the abbreviation of the rule.
+ *    n0, n1 - the subtrees.
+ *    self - the rule function, used to check the bound sentences.
+ *  output:
+ *    1 if a template matches in either direction, 0 if none does,
+ *    or -1 on memory error.
+ */
+int
+rule_template_apply (const char * rule, sexpr_node * n0, sexpr_node * n1,
+		     sexpr_rule_func self)
+{
+  sexpr_node * binds[TMPL_NUM_VARS];
+  int i, dir, ret;
+
+  if (!templates_ready)
+    {
+      ret = rule_template_init ();
+      if (ret == AEC_MEM)
+	return AEC_MEM;
+    }
+
+  for (i = 0; i < num_templates; i++)
+    {
+      const rule_template * tmpl = templates + i;
+
+      if (tmpl->rule[0] != rule[0] || tmpl->rule[1] != rule[1])
+	continue;
+
+      for (dir = 0; dir < 2; dir++)
+	{
+	  if (!tmpl_root_ok (tmpl, dir, n0) || !tmpl_root_ok (tmpl, !dir, n1))
+	    continue;
+
+	  memset (binds, 0, sizeof (binds));
+
+	  ret = tmpl_match (tmpl, dir, tmpl->sides[dir]->root, n0, binds,
+			    0, self);
+	  if (ret == AEC_MEM)
+	    return AEC_MEM;
+	  if (!ret)
+	    continue;
+
+	  ret = tmpl_match (tmpl, !dir, tmpl->sides[!dir]->root, n1, binds,
+			    1, self);
+	  if (ret == AEC_MEM)
+	    return AEC_MEM;
+	  if (ret)
+	    return 1;
+	}
+    }
+
+  return 0;
+}
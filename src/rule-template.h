@@ -0,0 +1,55 @@
+/* The replacement rule templates.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_RULE_TEMPLATE_H
+#define ARIS_RULE_TEMPLATE_H
+
+#include "typedef.h"
+#include "sexpr-tree.h"
+
+// Single upper case letters stand for sentences,
+//  and single lower case letters for variables.
+#define TMPL_NUM_VARS 52
+
+// The separator between the two sides of a template.
+#define TMPL_SEP "=="
+
+// The longest line allowed in a template file, without its line break.
+#define TMPL_LINE_MAX 1022
+
+// A replacement rule, such as 'A $ B == ~A | B', compiled for matching.
+
+struct rule_template {
+  char rule[3];                 // The abbreviation of the rule.
+  sexpr_tree * sides[2];        // The two sides of the template.
+  int * slots[2];               // The metavariable of each node, or -1.
+  int root_conn[2];             // The connective of each root, or -2 for any.
+};
+
+int rule_template_init ();
+void rule_template_destroy ();
+
+int rule_template_add (const char * rule, const unsigned char * text);
+int rule_template_load (const char * file_name);
+int rule_template_count (const char * rule);
+int rule_template_loaded (const char * rule);
+
+int rule_template_apply (const char * rule, sexpr_node * n0, sexpr_node * n1,
+			 sexpr_rule_func self);
+
+#endif  /*  ARIS_RULE_TEMPLATE_H  */
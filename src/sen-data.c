@@ -24,9 +24,8 @@
 #include "vec.h"
 #include "rules.h"
 #include "var.h"
-#include "aio.h"
 #include "proof.h"
-#include "interop-isar.h"
+#include "lemma-cache.h"
 
 /* Initializes the sentence data.
  *  input:
@@ -117,9 +116,7 @@ sen_data_destroy (sen_data * sd)
     free (sd->refs);
   sd->refs = NULL;
 
-  if (sd->sexpr)
-    free (sd->sexpr);
-  sd->sexpr = NULL;
+  sd_clear_sexpr (sd);
 
   if (sd->indices)
     free (sd->indices);
@@ -162,6 +159,7 @@ sen_data_copy (sen_data * old_sd, sen_data * new_sd)
       new_sd->sexpr = strdup (old_sd->sexpr);
       CHECK_ALLOC (new_sd->sexpr, AEC_MEM);
     }
+  new_sd->sig = old_sd->sig;
 
   new_sd->refs = NULL;
   new_sd->indices = NULL;
@@ -256,6 +254,37 @@ sd_convert_sexpr (sen_data * sd)
   return sen_convert_sexpr (sd->text, &(sd->sexpr));
 }
 
+/* Frees the sexpr of a sentence data object, and its signature with it.
+ *  input:
+ *    sd - the sentence data object whose text has changed.
+ *  output:
+ *    none.
+ */
+void
+sd_clear_sexpr (sen_data * sd)
+{
+  if (sd->sexpr)
+    free (sd->sexpr);
+  sd->sexpr = NULL;
+  sd->sig.num_nodes = 0;
+}
+
+/* Gets the signature of the sexpr of a sentence data object.
+ *  The signature is computed the first time, and kept until the sexpr is
+ *  cleared, so that a line is summarized once however often it is cited.
+ *  input:
+ *    sd - the sentence data object, whose sexpr has been converted.
+ *  output:
+ *    the signature.
+ */
+const sexpr_sig *
+sd_sexpr_sig (sen_data * sd)
+{
+  if (sd->sig.num_nodes == 0)
+    sexpr_sig_init (sd->sexpr, &(sd->sig));
+  return &(sd->sig);
+}
+
 /* Evaluates a sentence given its data.
  *  input:
  *   sd - The sentence data to evaluate.
@@ -297,7 +326,7 @@ sen_data_evaluate (sen_data * sd, int * ret_val, list_t * pf_vars, list_t * line
     case 0:
       break;
     case -2:
-      return _("The sentence has mismatched parenthesis.");
+      return MISMATCHED_PARENS;
     case -3:
       return _("The sentence has invalid connectives.");
     case -4:
@@ -323,12 +352,28 @@ sen_data_evaluate (sen_data * sd, int * ret_val, list_t * pf_vars, list_t * line
   *ret_val = VALUE_TYPE_ERROR;
   const char * rule = rules_list[sd->rule];
 
-  vec_t * refs;
+  char * fin_text;
+  ret = sen_convert_sexpr (sd->text, &(sd->sexpr));
+  if (ret == AEC_MEM)
+    return NULL;
+
+  fin_text = sd->sexpr;
+
+  vec_t * refs, * sigs;
 
   refs = init_vec (sizeof (char *));
   if (!refs)
     return NULL;
 
+  // The signatures are kept with the sexprs, so they are only taken once.
+  sigs = init_vec (sizeof (sexpr_sig));
+  if (!sigs)
+    return NULL;
+
+  ret = vec_add_obj (sigs, sd_sexpr_sig (sd));
+  if (ret == AEC_MEM)
+    return NULL;
+
   int i;
 
   for (i = 0; sd->refs[i] != REF_END; i++)
@@ -352,6 +397,7 @@ sen_data_evaluate (sen_data * sd, int * ret_val, list_t * pf_vars, list_t * line
       if (ret < 0)
         {
           destroy_str_vec (refs);
+          destroy_vec (sigs);
           *ret_val = VALUE_TYPE_REF;
 
           return _("One of the sentence's references has a text error.");
@@ -364,6 +410,10 @@ sen_data_evaluate (sen_data * sd, int * ret_val, list_t * pf_vars, list_t * line
       if (ret == AEC_MEM)
         return NULL;
 
+      ret = vec_add_obj (sigs, sd_sexpr_sig (ref_data));
+      if (ret == AEC_MEM)
+        return NULL;
+
       if (ref_data->subproof)
         {
           ret = sen_data_can_select_as_ref (sd, ref_data);
@@ -395,6 +445,7 @@ sen_data_evaluate (sen_data * sd, int * ret_val, list_t * pf_vars, list_t * line
                 {
                   *ret_val = VALUE_TYPE_REF;
                   destroy_str_vec (refs);
+                  destroy_vec (sigs);
                   return _("One of the sentence's references has a text error.");
                 }
 
@@ -404,9 +455,15 @@ sen_data_evaluate (sen_data * sd, int * ret_val, list_t * pf_vars, list_t * line
               ret = vec_str_add_obj (refs, ref_text);
               if (ret == AEC_MEM)
                 return NULL;
+
+              ret = vec_add_obj (sigs, sd_sexpr_sig (sen_0));
+              if (ret == AEC_MEM)
+                return NULL;
             }
           else if (sd->rule == RULE_SP)
             {
+              destroy_str_vec (refs);
+              destroy_vec (sigs);
               return _("\'sp\' can only be used with a subproof as a reference.");
             }
         }
@@ -426,57 +483,33 @@ sen_data_evaluate (sen_data * sd, int * ret_val, list_t * pf_vars, list_t * line
         return NULL;
     }
 
-  char * fin_text;
-  ret = sen_convert_sexpr (sd->text, &(sd->sexpr));
-  if (ret == AEC_MEM)
-    return NULL;
-
-  fin_text = sd->sexpr;
-
   // Check for a file.
 
+  lemma * lm = NULL;
+
   if (sd->file)
     {
-      // Obtain the extension.
-      int f_len;
-      f_len = strlen (sd->file);
-
-      if (!strncmp (sd->file + f_len - 4, ".thy", 4))
+      lm = lemma_cache_get ((char *) sd->file);
+      if (!lm)
         {
-          proof = proof_init ();
-          if (!proof)
-            return NULL;
-
-          ret = parse_thy (sd->file, proof);
-          if (ret == AEC_MEM)
-            return NULL;
-        }
-      else
-        {
-          struct connectives_list current_conns;
-          current_conns = main_conns;
-
-          proof = aio_open (sd->file);
-          if (!proof)
-            {
-              *ret_val = VALUE_TYPE_ERROR;
-              destroy_str_vec (refs);
-              destroy_vec (vars);
-              return _("Unable to open lemma file.");
-            }
-
-          main_conns = current_conns;
+          *ret_val = VALUE_TYPE_ERROR;
+          destroy_str_vec (refs);
+          destroy_vec (sigs);
+          destroy_vec (vars);
+          return _("Unable to open lemma file.");
         }
+      proof = lm->proof;
     }
 
-  char * proc_ret = process (fin_text, refs, rule, vars, proof);
+  char * proc_ret = process (fin_text, refs, rule, vars, proof, sigs);
   if (!proc_ret)
     return NULL;
 
   destroy_str_vec (refs);
+  destroy_vec (sigs);
   destroy_vec (vars);
-  if (proof)
-    proof_destroy (proof);
+  if (lm)
+    lemma_cache_release (lm);
 
   if (!strcmp (proc_ret, CORRECT))
     *ret_val = VALUE_TYPE_TRUE;
@@ -604,140 +637,52 @@ sen_data_can_select_as_ref (sen_data * sen, sen_data * ref)
   return common_line;
 }
 
-/* Converts sentence data to a LaTeX line.
+/* Appends sentence data to a LaTeX document.
  *  input:
  *   sd - the sentence data to convert.
+ *   out - the document to append to.
  *  output:
- *   The converted text, or NULL on error.
+ *   none.
  */
-char *
-convert_sd_latex (sen_data * sd)
+void
+sen_data_latex (sen_data * sd, GString * out)
 {
-  char * out_str, * text;
-  int out_pos, i;
-
-  // I feel like that isn't necessary either.
-
-  text = sd->text;
-
-  out_str = (char *) calloc (sd->depth * 6 + 1, sizeof (char));
-  CHECK_ALLOC (out_str, NULL);
-
-  out_pos = 0;
+  const struct {
+    const char * conn;
+    int len;
+    const char * latex;
+  } conns[] = {
+    { AND, CL, "\\land " }, { OR, CL, "\\lor " }, { NOT, NL, "\\neg " },
+    { CON, CL, "\\rightarrow " }, { BIC, CL, "\\leftrightarrow " },
+    { UNV, CL, "\\forall " }, { EXL, CL, "\\exists " },
+    { TAU, CL, "\\top " }, { CTR, CL, "\\bot " }, { ELM, CL, "\\in " },
+    { NIL, CL, " \\obslash " }
+  };
+  const int num_conns = sizeof (conns) / sizeof (conns[0]);
+  unsigned char * text;
+  int i, j, run;
 
   for (i = 0; i < sd->depth; i++)
-    out_pos += sprintf (out_str + out_pos, "\\pquad ");
+    g_string_append (out, "\\pquad ");
 
-  for (i = 0; text[i]; i++)
+  // Copy the text up to each connective in one go.
+  text = sd->text;
+  for (i = run = 0; text[i]; i++)
     {
-      if (!strncmp (text + i, AND, CL))
-	{
-	  out_str = (char *) realloc (out_str, out_pos + 8);
-	  CHECK_ALLOC (out_str, NULL);
-	  out_pos += sprintf (out_str + out_pos, "\\land ");
-	  i += CL - 1;
-	  continue;
-	}
-
-      if (!strncmp (text + i, OR, CL))
-	{
-	  out_str = (char *) realloc (out_str, out_pos + 8);
-	  CHECK_ALLOC (out_str, NULL);
-	  out_pos += sprintf (out_str + out_pos, "\\lor ");
-	  i += CL - 1;
-	  continue;
-	}
-
-      if (!strncmp (text + i, NOT, NL))
-	{
-	  out_str = (char *) realloc (out_str, out_pos + 8);
-	  CHECK_ALLOC (out_str, NULL);
-	  out_pos += sprintf (out_str + out_pos, "\\neg ");
-	  i += NL - 1;
-	  continue;
-	}
-
-      if (!strncmp (text + i, CON, CL))
-	{
-	  out_str = (char *) realloc (out_str, out_pos + 16);
-	  CHECK_ALLOC (out_str, NULL);
-	  out_pos += sprintf (out_str + out_pos, "\\rightarrow ");
-	  i += CL - 1;
-	  continue;
-	}
-
-      if (!strncmp (text + i, BIC, CL))
-	{
-	  out_str = (char *) realloc (out_str, out_pos + 18);
-	  CHECK_ALLOC (out_str, NULL);
-	  out_pos += sprintf (out_str + out_pos, "\\leftrightarrow ");
-	  i += CL - 1;
-	  continue;
-	}
-
-      if (!strncmp (text + i, UNV, CL))
-	{
-	  out_str = (char *) realloc (out_str, out_pos + 16);
-	  CHECK_ALLOC (out_str, NULL);
-	  out_pos += sprintf (out_str + out_pos, "\\forall ");
-	  i += CL - 1;
-	  continue;
-	}
-
-      if (!strncmp (text + i, EXL, CL))
-	{
-	  out_str = (char *) realloc (out_str, out_pos + 16);
-	  CHECK_ALLOC (out_str, NULL);
-	  out_pos += sprintf (out_str + out_pos, "\\exists ");
-	  i += CL - 1;
-	  continue;
-	}
-
-      if (!strncmp (text + i, TAU, CL))
-	{
-	  out_str = (char *) realloc (out_str, out_pos + 8);
-	  CHECK_ALLOC (out_str, NULL);
-	  out_pos += sprintf (out_str + out_pos, "\\top ");
-	  i += CL - 1;
-	  continue;
-	}
-
-      if (!strncmp (text + i, CTR, CL))
-	{
-	  out_str = (char *) realloc (out_str, out_pos + 8);
-	  CHECK_ALLOC (out_str, NULL);
-	  out_pos += sprintf (out_str + out_pos, "\\bot ");
-	  i += CL - 1;
-	  continue;
-	}
-
-      if (!strncmp (text + i, ELM, CL))
-	{
-	  out_str = (char *) realloc (out_str, out_pos + 8);
-	  CHECK_ALLOC (out_str, NULL);
-	  out_pos += sprintf (out_str + out_pos, "\\in ");
-	  i += CL - 1;
-	  continue;
-	}
-
-      if (!strncmp (text + i, NIL, CL))
-	{
-	  out_str = (char *) realloc (out_str, out_pos + 8);
-	  CHECK_ALLOC (out_str, NULL);
-	  out_pos += sprintf (out_str + out_pos, " \\obslash ");
-	  i += CL - 1;
-	  continue;
-	}
-
-      out_str = (char *) realloc (out_str, out_pos + 2);
-      CHECK_ALLOC (out_str, NULL);
-      out_str[out_pos++] = text[i];
+      for (j = 0; j < num_conns; j++)
+        {
+          if (!strncmp (text + i, conns[j].conn, conns[j].len))
+            break;
+        }
 
-    }
+      if (j == num_conns)
+        continue;
 
-  out_str = (char *) realloc (out_str, out_pos + 1);
-  CHECK_ALLOC (out_str, NULL);
-  out_str[out_pos] = '\0';
+      g_string_append_len (out, (char *) text + run, i - run);
+      g_string_append (out, conns[j].latex);
+      i += conns[j].len - 1;
+      run = i + 1;
+    }
 
-  return out_str;
+  g_string_append_len (out, (char *) text + run, i - run);
 }
@@ -19,7 +19,9 @@
 #ifndef ARIS_SEN_DATA_H
 #define ARIS_SEN_DATA_H
 
+#include <glib.h>
 #include "typedef.h"
+#include "sexpr-sig.h"
 
 #define SEN_TAB "    "
 #define SEN_COMMENT_CHAR ';'
@@ -44,6 +46,7 @@ struct sen_data {
   int rule;               // Index of the rule of this sentence.
   unsigned char * text;   // Contains the text of this item.
   unsigned char * sexpr;  // Sexpr text.
+  sexpr_sig sig;          // Signature of sexpr, if sig.num_nodes > 0.
 
   short premise;   // Whether or not this sentence is a premise.
   short subproof;  // Whether or not this sentence starts a subproof.
@@ -68,6 +71,8 @@ int sen_data_copy (sen_data * old_sd, sen_data * new_sd);
 
 int sen_convert_sexpr (unsigned char * text, unsigned char ** sexpr);
 int sd_convert_sexpr (sen_data * sd);
+void sd_clear_sexpr (sen_data * sd);
+const sexpr_sig * sd_sexpr_sig (sen_data * sd);
 
 char * sen_data_evaluate (sen_data * sd, int * ret_val,
 			  list_t * vars, list_t * lines);
@@ -76,6 +81,6 @@ int sen_data_can_sel_as_ref (int sen_line, int * sen_indices,
 			     int ref_line, int * ref_indices,
 			     int ref_prem);
 
-char * convert_sd_latex (sen_data * sd);
+void sen_data_latex (sen_data * sd, GString * out);
 
 #endif /* ARIS_SEN_DATA_H */
@@ -17,20 +17,13 @@
 */
 
 #include <stdlib.h>
+#include <stddef.h>
 #include "sen-parent.h"
 #include "sentence.h"
 #include "sen-data.h"
 #include "app.h"
 #include "list.h"
-
-#define INIT_CONN_PIXBUF(s,i,c,f) {			\
-  s->conn_pixbufs[i]					\
-  = gdk_pixbuf_scale_simple (the_app->conn_pixbufs[i],	\
-			     f, f,			\
-			     GDK_INTERP_BILINEAR);	\
-  g_object_set_data (G_OBJECT (s->conn_pixbufs[i]),	\
-		     _("conn"), c);			\
-  }
+#include "callbacks.h"
 
 /* Initializes a sentence parent.
  *  input:
@@ -90,7 +83,8 @@ sen_parent_init (sen_parent * sp, const char * title,
   // Initialize the main container.
   sp->container = gtk_grid_new ();
   gtk_orientable_set_orientation (GTK_ORIENTABLE (sp->container), GTK_ORIENTATION_VERTICAL);
-  gtk_grid_set_row_spacing (GTK_GRID (sp->container), 4);
+  gtk_grid_set_row_spacing (GTK_GRID (sp->container),
+			    SEN_PARENT_ROW_SPACING);
   gtk_container_add (GTK_CONTAINER (sp->viewport), sp->container);
   gtk_container_set_focus_vadjustment (GTK_CONTAINER (sp->container), f_adj);
 
@@ -99,11 +93,41 @@ sen_parent_init (sen_parent * sp, const char * title,
   gtk_grid_attach (GTK_GRID (sp->vbox), sp->statusbar, 0, 2, 1, 1);
 
   sp->everything = init_list ();
+  sp->lines.root = NULL;
+  sp->spare_widgets = init_list ();
+  sp->realized = init_list ();
+
+  // The rows without widgets are stood in for by empty boxes.
+  int i;
+  for (i = 0; i < 3; i++)
+    {
+      sp->spacers[i] = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+      gtk_widget_set_no_show_all (sp->spacers[i], TRUE);
+      gtk_grid_attach (GTK_GRID (sp->container), sp->spacers[i], 0, 0, 1, 1);
+    }
 
   sp->focused = NULL;
 
   sp->type = type;
   sp->undo = 0;
+
+  // Until a sentence has been shown, guess its height from the font.
+  int font;
+  font = pango_font_description_get_size (the_app->fonts[sp->font]);
+  font /= PANGO_SCALE;
+  sp->row_height = 2 * font + 8;
+
+  // Only the sentences in view are given widgets,
+  //  so check which those are whenever the view changes.
+  sp->num_visible = 0;
+  sp->view_first = sp->focus_item = NULL;
+  sp->view_index = sp->focus_index = 0;
+  sp->view_stamp = 0;
+  sp->view_idle = 0;
+  g_signal_connect (G_OBJECT (f_adj), "value-changed",
+		    G_CALLBACK (sen_parent_scrolled), (gpointer) sp);
+  g_signal_connect (G_OBJECT (sp->container), "size-allocate",
+		    G_CALLBACK (sen_parent_allocated), (gpointer) sp);
 }
 
 int
@@ -114,17 +138,9 @@ sen_parent_init_conns (sen_parent * sp)
   font = pango_font_description_get_size (the_app->fonts[sp->font]);
   font /= PANGO_SCALE;
 
-  INIT_CONN_PIXBUF (sp, 0, AND, font);
-  INIT_CONN_PIXBUF (sp, 1, OR, font);
-  INIT_CONN_PIXBUF (sp, 2, NOT, font);
-  INIT_CONN_PIXBUF (sp, 3, CON, font);
-  INIT_CONN_PIXBUF (sp, 4, BIC, font);
-  INIT_CONN_PIXBUF (sp, 5, UNV, font);
-  INIT_CONN_PIXBUF (sp, 6, EXL, font);
-  INIT_CONN_PIXBUF (sp, 7, TAU, font);
-  INIT_CONN_PIXBUF (sp, 8, CTR, font);
-  INIT_CONN_PIXBUF (sp, 9, ELM, font);
-  INIT_CONN_PIXBUF (sp, 10, NIL, font);
+  sp->conn_pixbufs = the_app_get_scaled_conns (font);
+  if (!sp->conn_pixbufs)
+    return AEC_MEM;
 
   return 0;
 }
@@ -150,6 +166,29 @@ sen_parent_destroy (sen_parent * sp)
 
   free (sp->everything);
   sp->everything = NULL;
+  sp->lines.root = NULL;
+
+  if (sp->view_idle)
+    g_source_remove (sp->view_idle);
+  sp->view_idle = 0;
+
+  for (ev_itr = sp->spare_widgets->head; ev_itr; ev_itr = nev_itr)
+    {
+      sen_widgets * gui = ev_itr->value;
+
+      nev_itr = ev_itr->next;
+      gtk_widget_destroy (gui->row);
+      g_object_unref (G_OBJECT (gui->row));
+      free (gui);
+      free (ev_itr);
+    }
+
+  free (sp->spare_widgets);
+  sp->spare_widgets = NULL;
+
+  destroy_list (sp->realized);
+  sp->realized = NULL;
+  sp->view_first = sp->focus_item = NULL;
 
   sp->font = -1;
   sp->focused = NULL;
@@ -176,28 +215,12 @@ sen_parent_set_font (sen_parent * sp, int new_font)
   font = pango_font_description_get_size (the_app->fonts[new_font]);
   font /= PANGO_SCALE;
 
-  int i;
-  double w, h;
-  w = h = 1.0;
+  GdkPixbuf ** pixbufs;
 
-  for (i = 0; i < NUM_CONNS; i++)
-    {
-      // Contradiction and Tautology symbols are sized differently,
-      //  so scale them differently.
-      if (i == 5 || i == 6)
-	{
-	  w = 1.0;
-	  h = 1.5;
-	}
-
-      sp->conn_pixbufs[i] = gdk_pixbuf_scale_simple (the_app->conn_pixbufs[i],
-						     ((double) font) * w,
-						     ((double) font) * h,
-						     GDK_INTERP_BILINEAR);
-
-      g_object_set_data (G_OBJECT (sp->conn_pixbufs[i]),
-			 _("conn"), (gpointer) conn_list[i]);
-    }
+  pixbufs = the_app_get_scaled_conns (font);
+  if (!pixbufs)
+    return;
+  sp->conn_pixbufs = pixbufs;
 
   item_t * ev_itr;
 
@@ -223,18 +246,17 @@ sen_parent_get_conn_by_type (sen_parent * sp, char * type)
   return ret;
 }
 
-/* Inserts a sentence into a sentence parent.
+/* Inserts a sentence into a sentence parent, without focusing it.
+ * The sentence is only given widgets once it is laid out in view.
  *  input:
  *    sp - the sentence parent into which the sentence is being inserted.
  *    sd - the sentence data from which to initialize the sentence.
  *    fcs - the item after which to insert the new sentence.
- *    new_order - the new order in the container in which this sentence will be.
  *  output:
  *    the iterator in sp->everything that the sentence will be, or NULL on error.
  */
 item_t *
-sen_parent_ins_sentence (sen_parent * sp, sen_data * sd,
-			 item_t * fcs, int new_order)
+sen_parent_splice_sentence (sen_parent * sp, sen_data * sd, item_t * fcs)
 {
   item_t * itm;
   sentence * sen;
@@ -243,85 +265,179 @@ sen_parent_ins_sentence (sen_parent * sp, sen_data * sd,
   if (!sen)
     return NULL;
 
-  int new_ord;
-
   itm = ls_ins_obj (sp->everything, sen, fcs);
-  sp->focused = itm;
+  if (!itm)
+    return NULL;
+  sen->itm = itm;
 
-  if (fcs)
-    {
-      GtkWidget * attach_next;
-      if (SEN_PREM (fcs->value) && !sd->premise)
-        attach_next = sp->separator;
-      else
-        attach_next = SENTENCE (fcs->value)->panel;
-
-      gtk_container_child_get (GTK_CONTAINER (sp->container),
-                               attach_next,
-                               "top-attach", &new_ord, NULL);
-      gtk_grid_insert_row (GTK_GRID (sp->container), new_ord + 1);
-      gtk_grid_attach_next_to (GTK_GRID (sp->container), sen->panel,
-                               attach_next, GTK_POS_BOTTOM,
-                               1, 1);
-    }
-  else
-    {
-      gtk_grid_attach (GTK_GRID (sp->container), sen->panel, 0, 0, 1, 1);
-    }
+  // Only the lines of a proof are numbered by their place.
+  if (sp->type == SEN_PARENT_TYPE_PROOF)
+    rank_tree_insert (&sp->lines,
+                      (fcs) ? &SENTENCE (fcs->value)->rank : NULL,
+                      &sen->rank);
 
-  gtk_widget_show_all (sen->panel);
+  sp->focused = itm;
+  sp->num_visible++;
+  sen_parent_lines_changed (sp);
 
   return itm;
 }
 
-/* Removes a sentence from a sentence parent.
+/* Inserts a sentence into a sentence parent.
+ *  input:
+ *    sp - the sentence parent into which the sentence is being inserted.
+ *    sd - the sentence data from which to initialize the sentence.
+ *    fcs - the item after which to insert the new sentence.
+ *    new_order - the new order in the container in which this sentence will be.
+ *  output:
+ *    the iterator in sp->everything that the sentence will be, or NULL on error.
+ */
+item_t *
+sen_parent_ins_sentence (sen_parent * sp, sen_data * sd,
+			 item_t * fcs, int new_order)
+{
+  // Focusing is left to the caller, so that a sentence is only
+  //  shown once it is finished.
+  return sen_parent_splice_sentence (sp, sd, fcs);
+}
+
+/* Unlinks a sentence from a sentence parent and destroys it, without
+ *  focusing another or laying the sentences out again.
  *  input:
  *    sp - the sentence parent from which a sentence is being removed.
  *    sen - the sentence that is being removed.
  *  output:
- *    the item that was removed.
+ *    none.
  */
-item_t *
-sen_parent_rem_sentence (sen_parent * sp, sentence * sen)
+static void
+sen_parent_unlink_sentence (sen_parent * sp, sentence * sen)
 {
-  item_t * ev_itr, * target = NULL;
-  target = ls_find (sp->everything, sen);
-  /*
-  int row_num;
-  row_num = sentence_get_line_no (sen);
-  */
-
-  // Only need to start this past the target sentence.
-  for (ev_itr = target->next; ev_itr; ev_itr = ev_itr->next)
+  item_t * ev_itr, * target = sen->itm;
+
+  // Only the sentences that cite this one need to forget it.
+  while (sen->cited_by->head)
+    sentence_rem_ref (sen->cited_by->head->value, sen);
+
+  // Nor is this one citing anything any more.
+  for (ev_itr = sen->references->head; ev_itr; ev_itr = ev_itr->next)
     {
-      sentence * ev_sen = ev_itr->value;
-      sentence_rem_ref (ev_sen, sen);
+      sentence * ref_sen = ev_itr->value;
+      item_t * c_itr;
+
+      c_itr = ls_find (ref_sen->cited_by, sen);
+      if (c_itr)
+        {
+          ls_rem_obj (ref_sen->cited_by, c_itr);
+          free (c_itr);
+        }
     }
 
-  item_t * new_focus;
-  if (sp->everything->num_stuff == 1)
-    new_focus = NULL;
-  else if (target == sp->everything->head)
-    new_focus = sp->everything->head->next;
-  else if (target == sp->everything->tail)
-    new_focus = sp->everything->tail->prev;
-  else
-    new_focus = target->prev;
-
+  // The focus moves to a neighbor, which may itself be removed next.
   if (target == sp->focused)
+    sp->focused = (target->prev) ? target->prev : target->next;
+
+  // The lines of a subproof whose assumption is removed count from the
+  //  line before it instead.  That line may have been given to them by an
+  //  earlier removal, so this is checked for every sentence, but only the
+  //  lines just after it can be affected.
+  if (target->prev)
     {
-      if (new_focus)
-	sen_parent_set_focus (sp, new_focus);
+      for (ev_itr = target->next; ev_itr; ev_itr = ev_itr->next)
+        {
+          sentence * ev_sen = ev_itr->value;
+          int i, found = 0;
+
+          for (i = 0; i < SEN_DEPTH (ev_sen); i++)
+            {
+              if (ev_sen->heads[i] == sen)
+                {
+                  ev_sen->heads[i] = target->prev->value;
+                  found = 1;
+                }
+            }
+
+          if (!found)
+            break;
+        }
     }
 
+  if (RANK_NODE_LINKED (&sen->rank))
+    rank_tree_remove (&sp->lines, &sen->rank);
+
   ls_rem_obj (sp->everything, target);
+  if (!sen->hidden)
+    sp->num_visible--;
   sentence_destroy (sen);
+}
 
-  //gtk_grid_remove_row (GTK_GRID (sp->container), row_num);
+/* Removes a sentence from a sentence parent.
+ *  input:
+ *    sp - the sentence parent from which a sentence is being removed.
+ *    sen - the sentence that is being removed.
+ *  output:
+ *    the item that is focused instead, or NULL if none is left.
+ */
+item_t *
+sen_parent_rem_sentence (sen_parent * sp, sentence * sen)
+{
+  item_t * new_focus, * target = sen->itm;
+  int focused = (target == sp->focused);
+
+  new_focus = (target->prev) ? target->prev : target->next;
+
+  sen_parent_unlink_sentence (sp, sen);
+  if (focused && new_focus)
+    sen_parent_set_focus (sp, new_focus);
+
+  sen_parent_lines_changed (sp);
 
   return new_focus;
 }
 
+/* Removes several sentences from a sentence parent at once.
+ * Each is unlinked on its own, but the focus is only moved and the
+ *  sentences only laid out again once all of them are gone.
+ *  input:
+ *    sp - the sentence parent from which the sentences are being removed.
+ *    sens - the sentences to remove, each at most once.
+ *  output:
+ *    the item that is focused instead, or NULL if none is left.
+ */
+item_t *
+sen_parent_rem_sentences (sen_parent * sp, list_t * sens)
+{
+  item_t * sen_itr, * old_focus = sp->focused;
+
+  for (sen_itr = sens->head; sen_itr; sen_itr = sen_itr->next)
+    sen_parent_unlink_sentence (sp, sen_itr->value);
+
+  if (sp->focused && sp->focused != old_focus)
+    sen_parent_set_focus (sp, sp->focused);
+
+  sen_parent_lines_changed (sp);
+
+  return sp->focused;
+}
+
+/* Finds a line of a proof by its number.
+ *  input:
+ *    sp - the sentence parent, which must hold a proof.
+ *    line_num - the number of the line.
+ *  output:
+ *    the sentence on that line, or NULL if there is none.
+ */
+sentence *
+sen_parent_nth_line (sen_parent * sp, int line_num)
+{
+  rank_node * node;
+
+  node = rank_tree_nth (&sp->lines, line_num);
+  if (!node)
+    return NULL;
+
+  return (sentence *) ((char *) node - offsetof (sentence, rank));
+}
+
 /* Sets an item as the focus of a sentence parent.
  *  input:
  *    sp - the sentence parent which is having its focus changed.
@@ -333,7 +449,427 @@ void
 sen_parent_set_focus (sen_parent * sp, item_t * focus)
 {
   sp->focused = focus;
-  gtk_widget_grab_focus (((sentence *) focus->value)->entry);
+  sentence_grab_focus (focus->value);
+}
+
+/* Steps from a sentence to the next one that isn't hidden.
+ *  input:
+ *    itm - the sentence to step from.
+ *    forward - 1 to step forward, 0 to step back.
+ *  output:
+ *    the next sentence, or NULL if there is none.
+ */
+static item_t *
+sen_parent_step (item_t * itm, int forward)
+{
+  do
+    itm = (forward) ? itm->next : itm->prev;
+  while (itm && SENTENCE (itm->value)->hidden);
+
+  return itm;
+}
+
+/* Finds a sentence by its position among those that aren't hidden.
+ * The search starts from the first sentence of the last layout when
+ *  the sentences haven't changed since, so that scrolling only walks
+ *  over the sentences scrolled past.
+ *  input:
+ *    sp - the sentence parent to search.
+ *    index - the position of the sentence.
+ *  output:
+ *    the sentence, or NULL if there is none.
+ */
+static item_t *
+sen_parent_nth_visible (sen_parent * sp, int index)
+{
+  item_t * itm;
+  int i;
+
+  if (sp->view_first)
+    {
+      itm = sp->view_first;
+      i = sp->view_index;
+    }
+  else
+    {
+      itm = sp->everything->head;
+      if (itm && SENTENCE (itm->value)->hidden)
+        itm = sen_parent_step (itm, 1);
+      i = 0;
+    }
+
+  for (; itm && i < index; i++)
+    itm = sen_parent_step (itm, 1);
+
+  for (; itm && i > index; i--)
+    itm = sen_parent_step (itm, 0);
+
+  return itm;
+}
+
+/* Counts the sentences before one that aren't hidden.
+ *  input:
+ *    sp - the sentence parent containing the sentence.
+ *    target - the sentence.
+ *  output:
+ *    the position of the sentence among those that aren't hidden.
+ */
+static int
+sen_parent_visible_index (sen_parent * sp, item_t * target)
+{
+  item_t * itm;
+  int index = 0;
+
+  for (itm = sp->everything->head; itm && itm != target; itm = itm->next)
+    {
+      if (!SENTENCE (itm->value)->hidden)
+        index++;
+    }
+
+  return index;
+}
+
+/* Moves a child of a sentence parent's container to a row, only
+ *  disturbing the container if it has to.
+ *  input:
+ *    sp - the sentence parent.
+ *    widget - the child to move.
+ *    row - the row to move it to, which is then advanced.
+ *  output:
+ *    none.
+ */
+static void
+sen_parent_place (sen_parent * sp, GtkWidget * widget, int * row)
+{
+  int cur_row;
+
+  gtk_container_child_get (GTK_CONTAINER (sp->container), widget,
+                           "top-attach", &cur_row, NULL);
+  if (cur_row != *row)
+    gtk_container_child_set (GTK_CONTAINER (sp->container), widget,
+                             "top-attach", *row, NULL);
+  (*row)++;
+}
+
+/* Places a spacer to stand in for a run of sentences without widgets.
+ *  input:
+ *    sp - the sentence parent.
+ *    which - the index of the spacer in sp->spacers.
+ *    rows - the number of sentences that it stands in for.
+ *    row - the row at which to place it, which is then advanced.
+ *  output:
+ *    none.
+ */
+static void
+sen_parent_place_spacer (sen_parent * sp, int which, int rows, int * row)
+{
+  GtkWidget * spacer = sp->spacers[which];
+
+  if (rows <= 0)
+    {
+      gtk_widget_hide (spacer);
+      return;
+    }
+
+  // The spacer takes the spacing after the last row for itself.
+  gtk_widget_set_size_request (spacer, -1,
+                               rows * (sp->row_height + SEN_PARENT_ROW_SPACING)
+                               - SEN_PARENT_ROW_SPACING);
+  sen_parent_place (sp, spacer, row);
+  gtk_widget_show (spacer);
+}
+
+/* Places the row of a sentence, along with the separator after it
+ *  if it is the last premise.
+ *  input:
+ *    sp - the sentence parent.
+ *    itm - the sentence, which must be realized.
+ *    row - the row at which to place it, which is then advanced.
+ *  output:
+ *    1 if the separator was placed, 0 otherwise.
+ */
+static int
+sen_parent_place_sentence (sen_parent * sp, item_t * itm, int * row)
+{
+  sentence * sen = itm->value;
+
+  sen_parent_place (sp, sen->gui->row, row);
+
+  if (!sp->separator || !SEN_PREM (sen)
+      || (itm->next && SEN_PREM (itm->next->value)))
+    return 0;
+
+  sen_parent_place (sp, sp->separator, row);
+  gtk_widget_show (sp->separator);
+  return 1;
+}
+
+/* Lays out the sentences of a sentence parent.
+ * A run of sentences is given widgets, and the rest give theirs back
+ *  and are stood in for by spacers of the same height, so that the
+ *  container only ever holds the rows in view.  The focused sentence
+ *  keeps its widgets wherever it is, so that it keeps the keyboard.
+ *  input:
+ *    sp - the sentence parent to lay out.
+ *    first - the position of the first sentence of the run, among
+ *     those that aren't hidden.
+ *    count - the number of sentences in the run.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+sen_parent_lay_out (sen_parent * sp, int first, int count)
+{
+  item_t * itm, * n_itm, * keep = NULL;
+  int i, last, keep_index = -1, row = 0, sep_placed = 0;
+
+  if (count > sp->num_visible)
+    count = sp->num_visible;
+  if (first > sp->num_visible - count)
+    first = sp->num_visible - count;
+  if (first < 0)
+    first = 0;
+  last = first + count - 1;
+
+  sp->view_first = sen_parent_nth_visible (sp, first);
+  sp->view_index = first;
+  sp->view_stamp++;
+
+  for (i = 0, itm = sp->view_first; i < count && itm;
+       i++, itm = sen_parent_step (itm, 1))
+    {
+      sentence * sen = itm->value;
+
+      if (sentence_realize (sen) == AEC_MEM)
+        return AEC_MEM;
+      sen->view_stamp = sp->view_stamp;
+    }
+
+  if (sp->focused)
+    {
+      sentence * sen = sp->focused->value;
+
+      if (SEN_REALIZED (sen) && !sen->hidden
+          && sen->view_stamp != sp->view_stamp)
+        {
+          keep = sp->focused;
+          if (sp->focus_item != keep)
+            {
+              sp->focus_item = keep;
+              sp->focus_index = sen_parent_visible_index (sp, keep);
+            }
+          keep_index = sp->focus_index;
+          sen->view_stamp = sp->view_stamp;
+        }
+    }
+
+  // Give back the widgets of the sentences that are out of view.
+  for (itm = sp->realized->head; itm; itm = n_itm)
+    {
+      sentence * sen = itm->value;
+
+      n_itm = itm->next;
+      if (sen->view_stamp != sp->view_stamp)
+        sentence_unrealize (sen);
+    }
+
+  if (keep && keep_index < first)
+    {
+      sen_parent_place_spacer (sp, 0, keep_index, &row);
+      sep_placed |= sen_parent_place_sentence (sp, keep, &row);
+      sen_parent_place_spacer (sp, 1, first - keep_index - 1, &row);
+    }
+  else
+    {
+      sen_parent_place_spacer (sp, 0, first, &row);
+      if (!keep)
+        sen_parent_place_spacer (sp, 1, 0, &row);
+    }
+
+  for (i = 0, itm = sp->view_first; i < count && itm;
+       i++, itm = sen_parent_step (itm, 1))
+    sep_placed |= sen_parent_place_sentence (sp, itm, &row);
+
+  if (keep && keep_index > last)
+    {
+      sen_parent_place_spacer (sp, 1, keep_index - last - 1, &row);
+      sep_placed |= sen_parent_place_sentence (sp, keep, &row);
+      last = keep_index;
+    }
+
+  sen_parent_place_spacer (sp, 2, sp->num_visible - last - 1, &row);
+
+  if (sp->separator && !sep_placed)
+    gtk_widget_hide (sp->separator);
+
+  return 0;
+}
+
+/* Determines how many sentences fit in a page of a sentence parent.
+ *  input:
+ *    sp - the sentence parent.
+ *    adj - the vertical adjustment of its scrolled window.
+ *  output:
+ *    the number of sentences.
+ */
+static int
+sen_parent_page_rows (sen_parent * sp, GtkAdjustment * adj)
+{
+  double page;
+  int height;
+
+  page = gtk_adjustment_get_page_size (adj);
+
+  // Before the window is shown, go by the size it asks for.
+  if (page <= 0)
+    {
+      gtk_widget_get_size_request (sp->window, NULL, &height);
+      page = height;
+    }
+
+  return (int) (page / (sp->row_height + SEN_PARENT_ROW_SPACING)) + 1;
+}
+
+/* Gives the sentences in view their widgets, and takes them
+ *  from the rest.
+ *  input:
+ *    data - the sentence parent to update.
+ *  output:
+ *    FALSE, so that the idle source is removed.
+ */
+static gboolean
+sen_parent_update_view (gpointer data)
+{
+  sen_parent * sp = data;
+  GtkAdjustment * adj;
+  GtkAllocation alloc;
+  item_t * itm;
+  int page_rows, first, total = 0, num = 0;
+
+  sp->view_idle = 0;
+
+  adj = gtk_scrolled_window_get_vadjustment
+    (GTK_SCROLLED_WINDOW (sp->scrolledwindow));
+  if (gtk_adjustment_get_page_size (adj) <= 0)
+    return FALSE;
+
+  // Have the spacers match the sentences that are shown,
+  //  so that the scroll bar doesn't jump.
+  for (itm = sp->realized->head; itm; itm = itm->next)
+    {
+      sentence * sen = itm->value;
+
+      gtk_widget_get_allocation (sen->gui->row, &alloc);
+      if (alloc.height > 1)
+        {
+          total += alloc.height;
+          num++;
+        }
+    }
+
+  if (num > 0)
+    sp->row_height = total / num;
+
+  // Keep a page on either side ready, so that scrolling stays smooth.
+  page_rows = sen_parent_page_rows (sp, adj);
+  first = (int) (gtk_adjustment_get_value (adj)
+                 / (sp->row_height + SEN_PARENT_ROW_SPACING)) - page_rows;
+
+  sen_parent_lay_out (sp, first, 3 * page_rows);
+  return FALSE;
+}
+
+/* Queues an update of which sentences of a sentence parent are shown.
+ *  input:
+ *    sp - the sentence parent to update.
+ *  output:
+ *    none.
+ */
+void
+sen_parent_queue_view (sen_parent * sp)
+{
+  if (!sp->view_idle && sp->everything)
+    sp->view_idle = g_idle_add (sen_parent_update_view, (gpointer) sp);
+}
+
+/* Forgets the positions of the sentences of a sentence parent after
+ *  sentences are added, removed, hidden or shown, and queues an update
+ *  of which of them are shown.
+ *  input:
+ *    sp - the sentence parent whose sentences changed.
+ *  output:
+ *    none.
+ */
+void
+sen_parent_lines_changed (sen_parent * sp)
+{
+  sp->view_first = sp->focus_item = NULL;
+  sen_parent_queue_view (sp);
+}
+
+/* Gives a sentence its widgets, along with those around it.
+ *  input:
+ *    sp - the sentence parent containing the sentence.
+ *    sen - the sentence to show, which must not be hidden.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+sen_parent_show_sentence (sen_parent * sp, sentence * sen)
+{
+  GtkAdjustment * adj;
+  item_t * itm;
+  int page_rows, index;
+
+  itm = sen->itm;
+
+  adj = gtk_scrolled_window_get_vadjustment
+    (GTK_SCROLLED_WINDOW (sp->scrolledwindow));
+  page_rows = sen_parent_page_rows (sp, adj);
+  index = sen_parent_visible_index (sp, itm);
+
+  return sen_parent_lay_out (sp, index - page_rows, 3 * page_rows);
+}
+
+/* Takes a set of sentence widgets from a sentence parent's spares.
+ *  input:
+ *    sp - the sentence parent to take the widgets from.
+ *  output:
+ *    the widgets, or NULL if there are no spares.
+ */
+sen_widgets *
+sen_parent_take_widgets (sen_parent * sp)
+{
+  item_t * itm = sp->spare_widgets->tail;
+  sen_widgets * gui;
+
+  if (!itm)
+    return NULL;
+
+  gui = itm->value;
+  ls_rem_obj (sp->spare_widgets, itm);
+  free (itm);
+
+  return gui;
+}
+
+/* Gives a set of sentence widgets to a sentence parent for reuse.
+ *  input:
+ *    sp - the sentence parent to give the widgets to.
+ *    gui - the widgets, which must not be in the container.
+ *  output:
+ *    none.
+ */
+void
+sen_parent_give_widgets (sen_parent * sp, sen_widgets * gui)
+{
+  if (sp->spare_widgets->num_stuff < SEN_PARENT_MAX_SPARE
+      && ls_push_obj (sp->spare_widgets, gui))
+    return;
+
+  gtk_widget_destroy (gui->row);
+  g_object_unref (G_OBJECT (gui->row));
+  free (gui);
 }
 
 /* Sets the status bar message of a sentence parent.
@@ -21,9 +21,16 @@
 
 #include <gtk/gtk.h>
 #include "typedef.h"
+#include "rank-tree.h"
 
 #define SEN_PARENT(o) ((sen_parent *) o)
 
+// The most sets of sentence widgets kept around for reuse.
+#define SEN_PARENT_MAX_SPARE 64
+
+// The space between the rows of sentences.
+#define SEN_PARENT_ROW_SPACING 4
+
 enum SEN_PARENT_TYPE {
   SEN_PARENT_TYPE_PROOF = 0,
   SEN_PARENT_TYPE_GOAL
@@ -44,12 +51,26 @@ struct sen_parent {
   GtkWidget * separator;       // The separator that separates prems from concs.
   GtkAccelGroup * accel;       // The accelerator for the keybindings.
 
-  GdkPixbuf * conn_pixbufs[11];
+  GdkPixbuf ** conn_pixbufs;  // The connective pixbufs for the font,
+                              //  shared with the_app->conn_cache.
   struct list * everything;  // The list of sentences.
+  rank_tree lines;           // Numbers the sentences of a proof.
   struct item * focused;     // The currently focused sentence.
   int font;                  // The index of the font in the_app->fonts.
   int type;                  // The type of sentence parent.
   int undo;
+  struct list * spare_widgets; // Sentence widgets waiting to be reused.
+  struct list * realized;    // The sentences that have widgets.
+  GtkWidget * spacers[3];    // Stand in for the rows without widgets.
+  int row_height;            // The height of a sentence that isn't shown.
+  int num_visible;           // The number of sentences that aren't hidden.
+  struct item * view_first;  // The first sentence laid out, or NULL once
+                             //  the sentences have changed.
+  int view_index;            // Its position among those that aren't hidden.
+  struct item * focus_item;  // The focused sentence when last counted.
+  int focus_index;           // Its position, as with view_index.
+  unsigned int view_stamp;   // Counts the layouts.
+  guint view_idle;           // The source updating the shown sentences.
 };
 
 void sen_parent_init (sen_parent * sp, const char * title,
@@ -61,23 +82,23 @@ int sen_parent_init_conns (sen_parent * sp);
 void sen_parent_destroy (sen_parent * sp);
 void sen_parent_set_font (sen_parent * sp, int new_font);
 void sen_parent_set_sb (sen_parent * sp, char * sb_text);
+item_t * sen_parent_splice_sentence (sen_parent * sp, sen_data * sd,
+				     item_t * fcs);
 item_t * sen_parent_ins_sentence (sen_parent * sp, sen_data * sd,
 				  item_t * fcs, int new_order);
 item_t * sen_parent_rem_sentence (sen_parent * sp, sentence * sen);
+item_t * sen_parent_rem_sentences (sen_parent * sp, list_t * sens);
+sentence * sen_parent_nth_line (sen_parent * sp, int line_num);
 void sen_parent_set_focus (sen_parent * sp, item_t * focus);
+void sen_parent_queue_view (sen_parent * sp);
+void sen_parent_lines_changed (sen_parent * sp);
+int sen_parent_show_sentence (sen_parent * sp, sentence * sen);
+sen_widgets * sen_parent_take_widgets (sen_parent * sp);
+void sen_parent_give_widgets (sen_parent * sp, sen_widgets * gui);
 
 int sen_parent_children_set_bg_color (sen_parent * sp);
 
 GdkPixbuf * sen_parent_get_conn_by_type (sen_parent * sp, char * type);
 
-#define INIT_CONN_PIXBUF_ALT(s,i,c,w,h) {		\
-  s->conn_pixbufs[i]					\
-  = gdk_pixbuf_scale_simple (the_app->conn_pixbufs[i],	\
-			     w, h,			\
-			     GDK_INTERP_BILINEAR);	\
-  g_object_set_data (G_OBJECT (s->conn_pixbufs[i]),	\
-		     _("conn"), c);			\
-  }
-
 
 #endif
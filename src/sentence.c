@@ -32,6 +32,8 @@
 #include "goal.h"
 #include "vec.h"
 #include "conf-file.h"
+#include "live-check.h"
+#include "session-log.h"
 
 //#define LETTERS
 
@@ -71,10 +73,13 @@ sentence_init (sen_data * sd, sen_parent * sp, item_t * fcs)
 
   depth = SD(sen)->depth;
 
-  // Initialize the GUI components.
-  sentence_gui_init (sen);
+  // The widgets are only created once the sentence is laid out in view.
+  sen->gui = NULL;
+  sen->view_stamp = 0;
   sen->parent = sp;
   sen->value_type = VALUE_TYPE_BLANK;
+  sen->bg_color = BG_COLOR_DEFAULT;
+  sen->line_bg = -1;
   sen->selected = 0;
   sen->font_resizing = 0;
 
@@ -82,6 +87,8 @@ sentence_init (sen_data * sd, sen_parent * sp, item_t * fcs)
 
   SD(sen)->indices = (int *) calloc (depth + 1, sizeof (int));
   CHECK_ALLOC (SD(sen)->indices, NULL);
+  sen->heads = (sentence **) calloc (depth + 1, sizeof (sentence *));
+  CHECK_ALLOC (sen->heads, NULL);
 
   if (!SEN_PREM(sen))
     {
@@ -94,13 +101,13 @@ sentence_init (sen_data * sd, sen_parent * sp, item_t * fcs)
         ? SEN_DEPTH(fcs_sen) : depth;
 
       for (i = 0; i < index_copy_end; i++)
-        sentence_set_index (sen,i,SEN_IND(fcs_sen,i));
+        sentence_set_head (sen,i,fcs_sen->heads[i]);
 
       if (sd->subproof)
-        sentence_set_index (sen,i++,ln);
+        sentence_set_head (sen,i++,sen);
     }
 
-  sentence_set_index (sen,i,-1);
+  sentence_set_head (sen,i,NULL);
 
   // Set the data components.
 
@@ -108,29 +115,9 @@ sentence_init (sen_data * sd, sen_parent * sp, item_t * fcs)
   if (ret == AEC_MEM)
     return NULL;
 
-  sentence_set_rule (sen, sd->rule);
-  if (SEN_PREM (sen))
-    {
-      if (sp->type == SEN_PARENT_TYPE_PROOF)
-        gtk_label_set_text (GTK_LABEL (sen->rule_box),
-                            "pr");
-      else
-        gtk_label_set_text (GTK_LABEL (sen->rule_box),
-                            "gl");
-    }
-  else if (SEN_SUB (sen))
-    {
-      gtk_label_set_text (GTK_LABEL (sen->rule_box),
-                          "sf");
-    }
+  SD(sen)->rule = sd->rule;
 
-  if (sd->text)
-    {
-      ret = sentence_paste_text (sen);
-      if (ret == -1 || ret == -2)
-        return NULL;
-    }
-  else
+  if (!sd->text)
     {
       SD(sen)->text = strdup ("");
       CHECK_ALLOC (SD(sen)->text, NULL);
@@ -140,77 +127,69 @@ sentence_init (sen_data * sd, sen_parent * sp, item_t * fcs)
   if (!sen->references)
     return NULL;
 
+  sen->cited_by = init_list ();
+  if (!sen->cited_by)
+    return NULL;
+
   ret = sentence_update_refs (sen);
   if (ret == AEC_MEM)
     return NULL;
 
   sen->reference = 0;
-  sentence_set_font (sen, sen->parent->font);
-  sentence_set_bg_color (sen, BG_COLOR_CONC, GTK_STATE_FLAG_FOCUSED);
-  sentence_set_bg_color (sen, BG_COLOR_DEFAULT, GTK_STATE_FLAG_NORMAL);
-
-  sentence_connect_signals (sen);
 
   return sen;
 }
 
-/* Initializes the gui elements of a sentence.
+/* Initializes a set of widgets for displaying a sentence.
  * input:
- *   sen - the sentence to initialize the gui elements of.
- * output:
  *   none.
+ * output:
+ *   the new widgets, or NULL on memory error.
  */
-void
-sentence_gui_init (sentence * sen)
+sen_widgets *
+sentence_gui_init ()
 {
-  // Initialize the GUI components.
-  sen->panel = gtk_grid_new ();
+  sen_widgets * gui;
 
-  sen->line_no = gtk_label_new (NULL);
-  gtk_label_set_justify (GTK_LABEL (sen->line_no), GTK_JUSTIFY_FILL);
-  gtk_label_set_width_chars (GTK_LABEL (sen->line_no), 3);
+  gui = (sen_widgets *) calloc (1, sizeof (sen_widgets));
+  CHECK_ALLOC (gui, NULL);
 
-  sen->eventbox = gtk_event_box_new ();
-  gtk_container_add (GTK_CONTAINER (sen->eventbox), sen->line_no);
-  gtk_event_box_set_above_child (GTK_EVENT_BOX (sen->eventbox), TRUE);
+  // The row is kept while it is out of the container, so hold onto it.
+  gui->row = gtk_grid_new ();
+  g_object_ref_sink (G_OBJECT (gui->row));
 
-  GtkWidget * widget;
-  if (SEN_DEPTH(sen) > 0)
-    {
-      widget = gtk_label_new (NULL);
-      g_object_set (G_OBJECT (widget), "width-chars", 4 * SEN_DEPTH(sen),
-                    NULL);
-    }
+  gui->line_no = gtk_label_new (NULL);
+  gtk_label_set_justify (GTK_LABEL (gui->line_no), GTK_JUSTIFY_FILL);
+  gtk_label_set_width_chars (GTK_LABEL (gui->line_no), 3);
 
-  sen->entry = gtk_text_view_new ();
-  gtk_widget_set_hexpand (sen->entry, TRUE);
-  gtk_widget_set_halign (sen->entry, GTK_ALIGN_FILL);
+  gui->eventbox = gtk_event_box_new ();
+  gtk_container_add (GTK_CONTAINER (gui->eventbox), gui->line_no);
+  gtk_event_box_set_above_child (GTK_EVENT_BOX (gui->eventbox), TRUE);
 
-  sen->value = gtk_image_new_from_icon_name (sen_values[0], GTK_ICON_SIZE_MENU);
+  gui->indent = gtk_label_new (NULL);
+  gtk_widget_set_no_show_all (gui->indent, TRUE);
 
-  int left = 0;
+  gui->entry = gtk_text_view_new ();
+  gtk_widget_set_hexpand (gui->entry, TRUE);
+  gtk_widget_set_halign (gui->entry, GTK_ALIGN_FILL);
 
-  gtk_grid_attach (GTK_GRID (sen->panel), sen->eventbox, left++, 0, 1, 1);
-  
-  if (SEN_DEPTH(sen) > 0)
-    gtk_grid_attach (GTK_GRID (sen->panel), widget, left++, 0, 1, 1);
+  gui->value = gtk_image_new_from_icon_name (sen_values[0], GTK_ICON_SIZE_MENU);
 
-  gtk_grid_attach (GTK_GRID (sen->panel), sen->entry, left++, 0, 1, 1);
-  gtk_grid_attach (GTK_GRID (sen->panel), sen->value, left++, 0, 1, 1);
+  gui->rule_box = gtk_label_new (NULL);
+  gtk_label_set_justify (GTK_LABEL (gui->rule_box), GTK_JUSTIFY_FILL);
+  gtk_label_set_width_chars (GTK_LABEL (gui->rule_box), 2);
 
-  sen->rule_box = gtk_label_new (NULL);
-  gtk_label_set_justify (GTK_LABEL (sen->rule_box), GTK_JUSTIFY_FILL);
-  gtk_label_set_width_chars (GTK_LABEL (sen->rule_box), 2);
-
-  gtk_grid_attach (GTK_GRID (sen->panel), sen->rule_box, left++, 0, 1, 1);
-
-  sen->mark = NULL;
+  gtk_grid_attach (GTK_GRID (gui->row), gui->eventbox, 0, 0, 1, 1);
+  gtk_grid_attach (GTK_GRID (gui->row), gui->indent, 1, 0, 1, 1);
+  gtk_grid_attach (GTK_GRID (gui->row), gui->entry, 2, 0, 1, 1);
+  gtk_grid_attach (GTK_GRID (gui->row), gui->value, 3, 0, 1, 1);
+  gtk_grid_attach (GTK_GRID (gui->row), gui->rule_box, 4, 0, 1, 1);
 
   GtkTextTag * tag;
   GtkTextTagTable * table;
   GtkTextBuffer * buffer;
 
-  buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry));
+  buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (gui->entry));
 
   table =
     gtk_text_buffer_get_tag_table (buffer);
@@ -229,16 +208,186 @@ sentence_gui_init (sentence * sen)
 
   gtk_text_tag_table_add (table, tag);
 
-  /*
-  tag = gtk_text_tag_new ("comment");
-  g_object_set (G_OBJECT (tag), "foreground-rgba",
-                the_app->bg_colors[BG_COLOR_SEL], NULL);
-  gtk_text_tag_table_add (table, tag);
+  return gui;
+}
 
-  GtkTextIter end;
-  gtk_text_buffer_get_end_iter (buffer, &end);
-  gtk_text_buffer_apply_tag (buffer, tag, &end, &end);
-  */
+/* Shows the line number of a sentence in its label.
+ *  input:
+ *    sen - the sentence, which must be realized.
+ *  output:
+ *    none.
+ */
+static void
+sentence_show_line_no (sentence * sen)
+{
+  char new_label[16];
+  int ln = sentence_get_line_no (sen);
+
+  if (ln < 1)
+    {
+      gtk_label_set_text (GTK_LABEL (sen->line_no), NULL);
+      return;
+    }
+
+  // A folded subproof is marked on its assumption.
+  if (sen->folded)
+    sprintf (new_label, "%i +", ln);
+  else
+    sprintf (new_label, "%i", ln);
+  gtk_label_set_text (GTK_LABEL (sen->line_no), (const char *) new_label);
+}
+
+/* Shows the rule of a sentence in its rule box.
+ *  input:
+ *    sen - the sentence, which must be realized.
+ *  output:
+ *    none.
+ */
+static void
+sentence_show_rule (sentence * sen)
+{
+  const char * rule_text = (SD(sen)->rule == -1)
+    ? NULL : rules_list[SD(sen)->rule];
+
+  if (SEN_PREM (sen))
+    rule_text = (sen->parent->type == SEN_PARENT_TYPE_PROOF) ? "pr" : "gl";
+  else if (SEN_SUB (sen))
+    rule_text = "sf";
+
+  gtk_label_set_text (GTK_LABEL (sen->rule_box), rule_text);
+}
+
+/* Gives a sentence a set of widgets, and fills them from its data.
+ *  input:
+ *    sen - the sentence to realize.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+sentence_realize (sentence * sen)
+{
+  sen_parent * sp = sen->parent;
+  sen_widgets * gui;
+  int bg_color, ret;
+
+  if (sen->gui)
+    return 0;
+
+  gui = sen_parent_take_widgets (sp);
+  if (!gui)
+    {
+      gui = sentence_gui_init ();
+      if (!gui)
+        return AEC_MEM;
+    }
+
+  sen->gui = gui;
+  sen->eventbox = gui->eventbox;
+  sen->line_no = gui->line_no;
+  sen->entry = gui->entry;
+  sen->value = gui->value;
+  sen->rule_box = gui->rule_box;
+  sen->mark = NULL;
+
+  // The row is moved into place by the parent's layout.
+  if (!ls_push_obj (sp->realized, sen))
+    return AEC_MEM;
+  gtk_grid_attach (GTK_GRID (sp->container), gui->row, 0, 0, 1, 1);
+
+  g_object_set (G_OBJECT (gui->indent), "width-chars", 4 * SEN_DEPTH(sen),
+                NULL);
+  gtk_widget_set_visible (gui->indent, SEN_DEPTH(sen) > 0);
+
+  sentence_show_line_no (sen);
+  sentence_show_rule (sen);
+
+  ret = sentence_paste_text (sen);
+  if (ret == AEC_MEM)
+    return AEC_MEM;
+
+  sentence_set_font (sen, sp->font);
+
+  bg_color = sen->bg_color;
+  sentence_set_bg_color (sen, BG_COLOR_CONC, GTK_STATE_FLAG_FOCUSED);
+  sentence_set_bg_color (sen, BG_COLOR_DEFAULT, GTK_STATE_FLAG_NORMAL);
+  sentence_set_bg (sen, bg_color);
+
+  sentence_set_value (sen, sen->value_type);
+  sentence_set_line_bg (sen, sen->line_bg);
+
+  sentence_connect_signals (sen);
+  gtk_widget_show_all (gui->row);
+
+  return 0;
+}
+
+/* Takes the widgets from a sentence and hands them back to its parent.
+ *  input:
+ *    sen - the sentence to unrealize.
+ *  output:
+ *    none.
+ */
+void
+sentence_unrealize (sentence * sen)
+{
+  sen_widgets * gui = sen->gui;
+  sen_parent * sp = sen->parent;
+  GtkTextBuffer * buffer;
+  item_t * itm;
+
+  if (!gui)
+    return;
+
+  // Everything shown is already in the sentence's data.
+  buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (gui->entry));
+  g_signal_handlers_disconnect_by_data (G_OBJECT (gui->entry), sen);
+  g_signal_handlers_disconnect_by_data (G_OBJECT (buffer), sen);
+  gtk_text_buffer_set_text (buffer, "", -1);
+
+  gtk_container_remove (GTK_CONTAINER (sp->container), gui->row);
+
+  itm = ls_find (sp->realized, sen);
+  if (itm)
+    {
+      ls_rem_obj (sp->realized, itm);
+      free (itm);
+    }
+
+  sen->gui = NULL;
+  sen->eventbox = sen->line_no = sen->entry = sen->value = NULL;
+  sen->rule_box = NULL;
+  sen->sig_id = 0;
+
+  sen_parent_give_widgets (sp, gui);
+}
+
+/* Gives a sentence the keyboard focus, realizing it if need be.
+ *  input:
+ *    sen - the sentence to focus.
+ *  output:
+ *    none.
+ */
+void
+sentence_grab_focus (sentence * sen)
+{
+  if (sen->hidden && sen->parent->type == SEN_PARENT_TYPE_PROOF)
+    aris_proof_reveal (ARIS_PROOF (sen->parent), sen);
+
+  if (!SEN_REALIZED (sen))
+    {
+      // Lay out the sentences around it, so that it has a place.
+      if (sen_parent_show_sentence (sen->parent, sen) == AEC_MEM
+          || !SEN_REALIZED (sen))
+        return;
+
+      // The scrolled window can only scroll to the sentence
+      //  once it has been allocated.
+      sen->sig_id = g_signal_connect (G_OBJECT (sen->entry), "size-allocate",
+                                      G_CALLBACK (sentence_mapped),
+                                      (gpointer) sen);
+    }
+
+  gtk_widget_grab_focus (sen->entry);
 }
 
 /* Destroys a sentence.
@@ -254,12 +403,39 @@ sentence_destroy (sentence * sen)
     destroy_list (sen->references);
   sen->references = NULL;
 
+  if (sen->cited_by)
+    destroy_list (sen->cited_by);
+  sen->cited_by = NULL;
+
+  live_check_forget (sen);
+
+  sentence_unrealize (sen);
   sen->parent = NULL;
 
-  gtk_widget_destroy (sen->panel);
+  if (sen->heads)
+    free (sen->heads);
+  sen->heads = NULL;
+
   sen_data_destroy (SD(sen));
 }
 
+/* Brings the line number and indices kept in the data of a sentence up
+ *  to date, for the functions that read its data directly.
+ *  input:
+ *    sen - the sentence.
+ *  output:
+ *    none.
+ */
+static void
+sentence_sync_data (sentence * sen)
+{
+  int i;
+
+  sentence_get_line_no (sen);
+  for (i = 0; i < SEN_DEPTH (sen); i++)
+    sentence_get_index (sen, i);
+}
+
 /* Copies the elements of a sentence into a sen_data structure.
  *  input:
  *    sen - the sentence to copy.
@@ -273,6 +449,7 @@ sentence_copy_to_data (sentence * sen)
   int ret;
 
   sentence_refresh_refs (sen);
+  sentence_sync_data (sen);
   sd = (sen_data *) calloc (1, sizeof (sen_data));
   CHECK_ALLOC (sd, NULL);
   ret = sen_data_copy (SD(sen), sd);
@@ -299,32 +476,12 @@ sentence_set_line_no (sentence * sen, int new_line_no)
       if (cur_line == -1)
         return -2;
 
-      SD(sen)->line_num = -1;
-      gtk_label_set_text (GTK_LABEL (sen->line_no), NULL);
-      return 0;
+      new_line_no = -1;
     }
 
-  char * new_label;
-  double label_len = log10 ((double) new_line_no);
-  int sp_chk = 0;
   SD(sen)->line_num = new_line_no;
-
-  //The length of any number in base 10 will be log10(n) + 1
-  new_label = (char *) calloc ((int)label_len + 2, sizeof (char));
-  CHECK_ALLOC (new_label, AEC_MEM);
-
-  sp_chk = sprintf (new_label, "%i", new_line_no);
-  if (sp_chk != (int) label_len + 1)
-    {
-      //There is an error, so exit the function.
-      fprintf (stderr, "Print Error - \
-Unable to print the correct characters to a string.\n");
-      free (new_label);
-      return -1;
-    }
-
-  gtk_label_set_text (GTK_LABEL (sen->line_no), (const char *) new_label);
-  free (new_label);
+  if (SEN_REALIZED (sen))
+    sentence_show_line_no (sen);
 
   return 0;
 }
@@ -339,75 +496,7 @@ Unable to print the correct characters to a string.\n");
 int
 sentence_update_line_no (sentence * sen, int new)
 {
-  int old, rc;
-  old = SD(sen)->line_num;
-
-  rc = sentence_set_line_no (sen, new);
-  if (rc == AEC_MEM)
-    return AEC_MEM;
-
-  // The next part isn't necessary for a new sentence.
-  if (old == 0)
-    return 0;
-
-  // This next part is only for aris proof sentences, not goal lines.
-  sen_parent * sp;
-  sp = sen->parent;
-  if (sp->type == SEN_PARENT_TYPE_GOAL)
-    return 0;
-
-  if (sentence_get_rule (sen) != RULE_LM)
-    return 0;
-
-  GtkWidget * menu_item, * menu, * submenu;
-  GList * gl;
-
-  gl = gtk_container_get_children (GTK_CONTAINER (sp->menubar));
-  menu = g_list_nth_data (gl, RULES_MENU);
-  submenu = gtk_menu_item_get_submenu (GTK_MENU_ITEM (menu));
-
-  gl = gtk_container_get_children (GTK_CONTAINER (submenu));
-  for (; gl; gl = gl->next)
-    {
-      menu_item = gl->data;
-
-      if (GTK_IS_SEPARATOR_MENU_ITEM (menu_item))
-        continue;
-
-      const char * label =
-        gtk_menu_item_get_label (GTK_MENU_ITEM (gl->data));
-
-      int chk, line_num, lbl_len;
-      char * file_name;
-
-      lbl_len = strlen (label);
-
-      file_name = (char *) calloc (lbl_len, sizeof (char));
-      CHECK_ALLOC (file_name, AEC_MEM);
-
-      chk = sscanf (label, "%i - %s", &line_num, file_name);
-      if (chk != 2)
-        continue;
-
-      if (line_num < old)
-        continue;
-
-      line_num = new;
-
-      char * new_label;
-      int alloc_size;
-
-      alloc_size = log10 (line_num) + strlen (file_name) + 4;
-      new_label = (char *) calloc (alloc_size + 1, sizeof (char));
-      CHECK_ALLOC (new_label, AEC_MEM);
-
-      sprintf (new_label, "%i - %s", line_num, file_name);
-      free (file_name);
-
-      gtk_menu_item_set_label (GTK_MENU_ITEM (gl->data), new_label);
-    }
-
-  return 0;
+  return sentence_set_line_no (sen, new);
 }
 
 /* Update the reference line numbers within the backend sentence data structure.
@@ -430,8 +519,7 @@ sentence_refresh_refs (sentence * sen)
   int i = 0;
   for (itm = sen->references->head; itm; itm = itm->next)
     {
-      sen_data * sd = SD(itm->value);
-      SD(sen)->refs[i++] = sd->line_num;
+      SD(sen)->refs[i++] = sentence_get_line_no (itm->value);
     }
   SD(sen)->refs[i] = REF_END;
 
@@ -453,7 +541,14 @@ sentence_add_ref (sentence * sen, sentence * ref)
   if (!itm)
     return AEC_MEM;
 
+  itm = ls_push_obj (ref->cited_by, sen);
+  if (!itm)
+    return AEC_MEM;
+
+  // Its verdict no longer holds.
+  sentence_set_value (sen, VALUE_TYPE_BLANK);
   sentence_refresh_refs (sen);
+  live_check_mark (sen);
 
   return 0;
 }
@@ -468,10 +563,26 @@ sentence_add_ref (sentence * sen, sentence * ref)
 int
 sentence_rem_ref (sentence * sen, sentence * ref)
 {
-  if (sen->references)
-    ls_rem_obj_value (sen->references, ref);
+  item_t * itm;
+
+  itm = ls_find (sen->references, ref);
+  if (itm)
+    {
+      ls_rem_obj (sen->references, itm);
+      free (itm);
+    }
 
+  itm = ls_find (ref->cited_by, sen);
+  if (itm)
+    {
+      ls_rem_obj (ref->cited_by, itm);
+      free (itm);
+    }
+
+  // Its verdict no longer holds.
+  sentence_set_value (sen, VALUE_TYPE_BLANK);
   sentence_refresh_refs (sen);
+  live_check_mark (sen);
 
   return 0;
 }
@@ -513,6 +624,10 @@ sentence_update_refs (sentence * sen)
                   if (!ret)
                     return AEC_MEM;
 
+                  ret = ls_push_obj (ref_sen->cited_by, sen);
+                  if (!ret)
+                    return AEC_MEM;
+
                   break;
                 }
             }
@@ -531,6 +646,9 @@ sentence_update_refs (sentence * sen)
 void
 sentence_set_font (sentence * sen, int font)
 {
+  if (!SEN_REALIZED (sen))
+    return;
+
   sen->font_resizing = 1;
 
   sentence_resize_text (sen);
@@ -553,6 +671,9 @@ sentence_resize_text (sentence * sen)
   GtkTextIter iter;
   GtkTextBuffer * buffer;
 
+  if (!SEN_REALIZED (sen))
+    return 0;
+
   buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry));
   gtk_text_buffer_get_start_iter (buffer, &iter);
 
@@ -569,6 +690,13 @@ sentence_resize_text (sentence * sen)
           new_pix = sen_parent_get_conn_by_type (sen->parent,
                                                  val);
 
+          // Sentences shown since the font changed already have these.
+          if (new_pix == pix)
+            {
+              gtk_text_iter_forward_char (&iter);
+              continue;
+            }
+
           GtkTextIter next;
           next = iter;
           gtk_text_iter_forward_char (&next);
@@ -588,6 +716,12 @@ sentence_resize_text (sentence * sen)
 void
 sentence_set_bg_color (sentence * sen, int bg_color, int state)
 {
+  if (!SEN_REALIZED (sen))
+    {
+      sen->bg_color = bg_color;
+      return;
+    }
+
   COLOR_TYPE inv;
   INVERT (the_app->bg_colors[bg_color], inv);
   gtk_widget_override_background_color (sen->entry, state,
@@ -626,6 +760,12 @@ sentence_set_bg_color (sentence * sen, int bg_color, int state)
 void
 sentence_set_bg (sentence * sen, int bg_color)
 {
+  if (!SEN_REALIZED (sen))
+    {
+      sen->bg_color = bg_color;
+      return;
+    }
+
   COLOR_TYPE inv;
   INVERT (the_app->bg_colors[bg_color], inv);
   gtk_widget_override_background_color (sen->entry, GTK_STATE_FLAG_NORMAL,
@@ -666,35 +806,83 @@ void
 sentence_set_value (sentence * sen, int value_type)
 {
   sen->value_type = value_type;
+  if (!SEN_REALIZED (sen))
+    return;
+
   gtk_image_set_from_icon_name (GTK_IMAGE (sen->value),
                                 sen_values [value_type],
                                 GTK_ICON_SIZE_MENU);
 }
 
-/* Returns the line number of a sentence.
+/* Sets the background color of the line number of a sentence.
+ *  input:
+ *    sen - the sentence to change the line number of.
+ *    bg_color - the index in the_app->bg_colors, or -1 for none.
+ *  output:
+ *    none.
  */
-int
-sentence_get_line_no (sentence * sen)
+void
+sentence_set_line_bg (sentence * sen, int bg_color)
 {
-  return SD(sen)->line_num;
+  sen->line_bg = bg_color;
+  if (!SEN_REALIZED (sen))
+    return;
+
+  gtk_widget_override_background_color (sen->eventbox, GTK_STATE_NORMAL,
+                                        (bg_color < 0)
+                                        ? NULL : the_app->bg_colors[bg_color]);
+}
+
+/* Sets whether the body of a subproof is folded.
+ * The body itself is hidden by aris_proof_refold.
+ *  input:
+ *    sen - the assumption of the subproof.
+ *    folded - 1 to fold the body, 0 to unfold it.
+ *  output:
+ *    none.
+ */
+void
+sentence_set_folded (sentence * sen, int folded)
+{
+  sen->folded = folded ? 1 : 0;
+  if (SEN_REALIZED (sen))
+    sentence_show_line_no (sen);
 }
 
-/* Returns the position in the containing grid of a sentence.
+/* Hides or shows a sentence that is in the body of a folded subproof.
+ * A hidden sentence gives up its widgets and takes no room.
+ *  input:
+ *    sen - the sentence to hide or show.
+ *    hidden - 1 to hide the sentence, 0 to show it.
+ *  output:
+ *    none.
+ */
+void
+sentence_set_hidden (sentence * sen, int hidden)
+{
+  if (!sen->hidden == !hidden)
+    return;
+
+  sen->hidden = hidden ? 1 : 0;
+  if (hidden)
+    sentence_unrealize (sen);
+
+  sen->parent->num_visible += (hidden) ? -1 : 1;
+  sen_parent_lines_changed (sen->parent);
+}
+
+/* Returns the line number of a sentence.
+ * The line of a sentence in a proof is its place in the proof's tree,
+ *  so inserting or removing lines never has to touch the ones after
+ *  them.  The number kept in its data is brought up to date here.
  */
 int
-sentence_get_grid_no (sentence * sen)
+sentence_get_line_no (sentence * sen)
 {
-  int line_num;
-  sen_parent * sp;
-  GValue val = G_VALUE_INIT;
-  g_value_init (&val, G_TYPE_INT);
-  sp = sen->parent;
-  gtk_container_child_get_property (GTK_CONTAINER (sp->container),
-                                    sen->panel,
-                                    "top-attach",
-                                    &val);
-  line_num = g_value_get_int (&val);
-  return line_num;
+  if (RANK_NODE_LINKED (&sen->rank))
+    SD(sen)->line_num = rank_node_rank (&sen->rank);
+
+  return SD(sen)->line_num;
 }
 
 /* Connects the callback signals to a sentence.
@@ -719,8 +907,6 @@ sentence_connect_signals (sentence * sen)
   g_signal_connect (G_OBJECT (gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry))),
                     "changed",
                     G_CALLBACK (sentence_changed), (gpointer) sen);
-  sen->sig_id = g_signal_connect (G_OBJECT (sen->entry), "size-allocate",
-                                  G_CALLBACK (sentence_mapped), (gpointer) sen);
 }
 
 /* Selects the references and rule of a sentence when it is selected.
@@ -733,8 +919,7 @@ int
 sentence_in (sentence * sen)
 {
   sen_parent * sp = sen->parent;
-  item_t * e_itr = ls_find (sp->everything, sen);
-  // Find the item in everything that corresponds to this sentence.
+  item_t * e_itr = sen->itm;
 
   sp->focused = e_itr;
 
@@ -796,11 +981,14 @@ sentence_out (sentence * sen)
   GtkTextBuffer * buffer;
   GtkTextIter start, end;
 
-  buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry));
+  if (SEN_REALIZED (sen))
+    {
+      buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry));
 
-  gtk_text_buffer_get_bounds (buffer, &start, &end);
-  gtk_text_buffer_remove_tag_by_name (buffer, "hilight", &start, &end);
-  gtk_text_buffer_remove_tag_by_name (buffer, "negative", &start, &end);
+      gtk_text_buffer_get_bounds (buffer, &start, &end);
+      gtk_text_buffer_remove_tag_by_name (buffer, "hilight", &start, &end);
+      gtk_text_buffer_remove_tag_by_name (buffer, "negative", &start, &end);
+    }
 
   if (!SEN_PREM(sen) && !SEN_SUB(sen))
     {
@@ -1018,6 +1206,9 @@ sentence_key (sentence * sen, int key, int ctrl)
   GtkTextBuffer * buffer;
   GtkTextIter start, end;
 
+  if (sp->type == SEN_PARENT_TYPE_PROOF)
+    session_log (SLO_KEY, sentence_get_line_no (sen), "%i %i", key, ctrl);
+
   buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry));
 
   gtk_text_buffer_get_bounds (buffer, &start, &end);
@@ -1116,7 +1307,7 @@ sentence_key (sentence * sen, int key, int ctrl)
             ? sp->everything->tail : sp->focused->prev;
           if (the_app->verbose)
             printf ("Got Key Up\n");
-          gtk_widget_grab_focus (SENTENCE (dst->value)->entry);
+          sentence_grab_focus (SENTENCE (dst->value));
           ret = 0;
           break;
         case GDK_KEY_Down:
@@ -1124,7 +1315,7 @@ sentence_key (sentence * sen, int key, int ctrl)
             ? sp->everything->head : sp->focused->next;
           if (the_app->verbose)
             printf ("Got Key Down\n");
-          gtk_widget_grab_focus (SENTENCE (dst->value)->entry);
+          sentence_grab_focus (SENTENCE (dst->value));
           ret = 0;
           break;
         case GDK_KEY_Left:
@@ -1229,7 +1420,7 @@ sentence_set_reference (sentence * sen, int reference, int entire_subproof)
     {
       item_t * sub_itr;
 
-      sub_itr = ls_find (sen->parent->everything, sen);
+      sub_itr = sen->itm;
 
       for (sub_itr = sub_itr->next; sub_itr; sub_itr = sub_itr->next)
         {
@@ -1268,12 +1459,7 @@ sentence_set_selected (sentence * sen, int selected)
     {
       item_t * sub_itr;
 
-      sub_itr = ls_find (sen->parent->everything, sen);
-      if (!sub_itr)
-        {
-          fprintf (stderr, "sentence_set_selcted: Unable to find a sentence.\n");
-          exit (EXIT_FAILURE);
-        }
+      sub_itr = sen->itm;
 
       for (sub_itr = sub_itr->next; sub_itr; sub_itr = sub_itr->next)
         {
@@ -1315,6 +1501,13 @@ sentence_copy_text (sentence * sen)
   GtkTextIter start, end;
   int i;
 
+  if (!SEN_REALIZED (sen))
+    {
+      ret_str = strdup ((const char *) sentence_get_text (sen));
+      CHECK_ALLOC (ret_str, NULL);
+      return ret_str;
+    }
+
   buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry));
   gtk_text_buffer_get_bounds (buffer, &start, &end);
 
@@ -1363,7 +1556,29 @@ sentence_copy_text (sentence * sen)
   return ret_str;
 }
 
+/* Finds the index of a single byte connective.
+ *  input:
+ *    c - the character to look up.
+ *  output:
+ *    the index of c in conn_list, or -1 if it is not a connective.
+ */
+static int
+sentence_conn_index (unsigned char c)
+{
+  int i;
+
+  for (i = 0; i < NUM_CONNS; i++)
+    {
+      if (c == (unsigned char) conn_list[i][0])
+        return i;
+    }
+
+  return -1;
+}
+
 /* Sets the text of the text view of a sentence from the text.
+ * The text between connectives is inserted in one piece, and the
+ *  connectives themselves come from the parent's shared pixbufs.
  *  input:
  *    sen - the sentence of which to set the text.
  *  output:
@@ -1372,69 +1587,50 @@ sentence_copy_text (sentence * sen)
 int
 sentence_paste_text (sentence * sen)
 {
-  int i, found_comment = 0;
+  int i, start = 0;
 
   GtkTextBuffer * buffer;
   GtkTextIter end;
 
-  unsigned char * sen_text = sentence_get_text (sen);
-  
-  buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry));
-  gtk_text_buffer_get_start_iter (buffer, &end);
+  unsigned char * sen_text;
 
-  for (i = 0; sen_text[i]; i++)
-    {
-      if (sen_text[i] == ';')
-        found_comment = 1;
+  // The text is shown once the sentence comes into view.
+  if (!SEN_REALIZED (sen))
+    return 0;
 
-      if ((IS_TYPE_CONN (sen_text + i, gui_conns)
-           || IS_TYPE_CONN (sen_text + i, cli_conns))
-          && found_comment == 0)
-        {
-          GdkPixbuf * pix;
+  // The text may have been given with the UTF-8 connectives,
+  //  so bring it to the single byte connectives first.
+  sen_text = normalize_conns (sentence_get_text (sen));
+  if (!sen_text)
+    return AEC_MEM;
 
-          unsigned char * conn;
-          int len;
+  buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry));
+  gtk_text_buffer_get_start_iter (buffer, &end);
 
-          if (IS_TYPE_CONN (sen_text + i, gui_conns))
-            {
-              if (!strncmp (sen_text + i, gui_conns.not, gui_conns.nl))
-                len = gui_conns.nl;
-              else
-                len = gui_conns.cl;
-            }
-          else
-            {
-              if (!strncmp (sen_text + i, NOT, NL))
-                len = NL;
-              else
-                len = CL;
-            }
+  // Everything from a comment on is shown as it is.
+  for (i = 0; sen_text[i] && sen_text[i] != ';'; i++)
+    {
+      int conn;
 
-          conn = (unsigned char *) calloc (len + 1, sizeof (char));
-          CHECK_ALLOC (conn, AEC_MEM);
-          
-          strncpy (conn, sen_text + i, len);
-          conn[len] = '\0';
+      conn = sentence_conn_index (sen_text[i]);
+      if (conn == -1)
+        continue;
 
-          pix = sen_parent_get_conn_by_type (sen->parent,
-                                             conn);
-          free (conn);
+      if (i > start)
+        gtk_text_buffer_insert (buffer, &end, (const char *) sen_text + start,
+                                i - start);
 
-          if (!pix)
-            return -2;
+      // No need to resize this, since sentence_set_font
+      // will be called after this, and it handles it instead.
+      gtk_text_buffer_insert_pixbuf (buffer, &end,
+                                     sen->parent->conn_pixbufs[conn]);
+      start = i + 1;
+    }
 
-          // No need to resize this, since sentence_set_font
-          // will be called after this, and it handles it instead.
+  if (sen_text[start])
+    gtk_text_buffer_insert (buffer, &end, (const char *) sen_text + start, -1);
 
-          gtk_text_buffer_insert_pixbuf (buffer, &end, pix);
-          i += len - 1;
-        }
-      else
-        {
-          gtk_text_buffer_insert (buffer, &end, sen_text + i, 1);
-        }
-    }
+  free (sen_text);
 
   return 0;
 }
@@ -1457,27 +1653,13 @@ sentence_text_changed (sentence * sen)
   sen_parent * sp = sen->parent;
   sentence_set_value (sen, VALUE_TYPE_BLANK);
 
-  item_t * e_itr = ls_find (sp->everything, sen);
+  item_t * e_itr;
 
-  for (e_itr = sp->everything->head; e_itr; e_itr = e_itr->next)
-    {
-      list_t * e_refs;
-      e_refs = SENTENCE (e_itr->value)->references;
-      if (e_refs)
-        {
-          item_t * r_itr;
-          r_itr = ls_find (e_refs, sen);
-
-          if (r_itr)
-            sentence_set_value (SENTENCE (e_itr->value), VALUE_TYPE_BLANK);
-        }
-    }
+  // Only the sentences that cite this one depend on its text.
+  for (e_itr = sen->cited_by->head; e_itr; e_itr = e_itr->next)
+    sentence_set_value (SENTENCE (e_itr->value), VALUE_TYPE_BLANK);
 
-  if (SD(sen)->sexpr)
-    {
-      free (SD(sen)->sexpr);
-      SD(sen)->sexpr = NULL;
-    }
+  sd_clear_sexpr (SD(sen));
 
   char * text;
   GtkTextBuffer * buffer;
@@ -1502,7 +1684,9 @@ sentence_text_changed (sentence * sen)
     {
       int ret;
 
-      ui = undo_info_init_one (NULL, sen, UIT_MOD_TEXT);
+      session_log (SLO_TEXT, ln, "%s", text);
+
+      ui = undo_info_init_text (sen, (unsigned char *) text);
       if (ui.type == -1)
         return AEC_MEM;
 
@@ -1510,7 +1694,7 @@ sentence_text_changed (sentence * sen)
       if (ret < 0)
         return AEC_MEM;
 
-      gtk_widget_override_background_color (sen->eventbox, GTK_STATE_NORMAL, NULL);
+      sentence_set_line_bg (sen, -1);
 
       if (SEN_PARENT (ARIS_PROOF (sp)->goal)->everything->num_stuff > 0)
         {
@@ -1546,7 +1730,7 @@ sentence_text_changed (sentence * sen)
       if (mod_itm)
         {
           mod_sen = mod_itm->value;
-          gtk_widget_override_background_color (mod_sen->eventbox, GTK_STATE_NORMAL, NULL);
+          sentence_set_line_bg (mod_sen, -1);
           sentence_set_line_no (sen, -1);
         }
     }
@@ -1557,6 +1741,8 @@ sentence_text_changed (sentence * sen)
 
   sentence_set_text (sen, text);
   free (text);
+
+  live_check_mark (sen);
   return 0;
 }
 
@@ -1627,6 +1813,8 @@ sentence_check_boolean_rule (sentence * sen, int boolean)
 int
 sentence_can_select_as_ref (sentence * sen, sentence * ref)
 {
+  sentence_sync_data (sen);
+  sentence_sync_data (ref);
   return sen_data_can_select_as_ref (SD(sen), SD(ref));
 }
 
@@ -1636,10 +1824,9 @@ int
 sentence_set_rule (sentence * sen, int rule)
 {
   SD(sen)->rule = rule;
-  const char * rule_text = (SD(sen)->rule == -1)
-    ? NULL : rules_list[SD(sen)->rule];
-  gtk_label_set_text (GTK_LABEL (sen->rule_box),
-                      rule_text);
+  if (SEN_REALIZED (sen))
+    sentence_show_rule (sen);
+  live_check_mark (sen);
   return 0;
 }
 
@@ -1698,19 +1885,29 @@ sentence_depth (sentence * sen)
   return SD(sen)->depth;
 }
 
-/* Gets an index of a sentence.
+/* Gets an index of a sentence, the line number of the assumption of
+ *  one of the subproofs that contain it.
  */
 int
 sentence_get_index (sentence * sen, int i)
 {
+  SD(sen)->indices[i] = (sen->heads[i])
+    ? sentence_get_line_no (sen->heads[i]) : -1;
   return SD(sen)->indices[i];
 }
 
-/* Sets an index of a sentence.
+/* Sets the assumption of one of the subproofs that contain a sentence.
+ *  input:
+ *    sen - the sentence.
+ *    i - the depth of the subproof.
+ *    head - its first sentence, or NULL to end the indices.
+ *  output:
+ *    0.
  */
 int
-sentence_set_index (sentence * sen, int i, int index)
+sentence_set_head (sentence * sen, int i, sentence * head)
 {
-  SD(sen)->indices[i] = index;
+  sen->heads[i] = head;
+  SD(sen)->indices[i] = (head) ? sentence_get_line_no (head) : -1;
   return 0;
 }
@@ -22,6 +22,7 @@
 #include "pound.h"
 #include "typedef.h"
 #include "sen-data.h"
+#include "rank-tree.h"
 
 #define SENTENCE(o) ((sentence *) o)
 #define SEMI_NAME "semi"
@@ -31,16 +32,36 @@
 #define SEN_DEPTH(s) sentence_depth ((sentence*)(s))
 #define SEN_IND(s,i) sentence_get_index ((sentence*)(s),i)
 
+// Whether a sentence currently owns a set of widgets.
+#define SEN_REALIZED(s) (((sentence*)(s))->entry != NULL)
+
+// The widgets that display a sentence.  Only the sentences in view own
+//  a set; the rest are kept by their parent to be reused.
+
+struct sen_widgets {
+  GtkWidget * row;		// Contains the other items - GtkGrid
+  GtkWidget * eventbox;		// Contains the line number label
+  GtkWidget * line_no;		// The line number - GtkLabel
+  GtkWidget * indent;		// Indents the sentence by its depth - GtkLabel
+  GtkWidget * entry;		// Actual Text Entry - GtkTextView
+  GtkWidget * value;		// Status indicator - GtkImage
+  GtkWidget * rule_box;		// The rule of the sentence - GtkLabel
+};
+
 struct sentence {
   sen_data sd;			// The data components.
+  rank_node rank;		// Its place among the lines of a proof.
+  sentence ** heads;		// The assumptions of the subproofs containing it.
 
   int reference : 1;		// Whether or not this sentence is a reference.
   list_t * references;		// A list of sentences that are references.
+  list_t * cited_by;		// A list of sentences that reference this one.
 
   proof_t * proof;		// The proof for this sentence, if lemma is used.
 
   // GUI components
-  GtkWidget * panel;		// Contains the other items - GtkGrid
+  sen_widgets * gui;		// The widgets, or NULL if out of view.
+  unsigned int view_stamp;	// The last layout that gave it a row.
   GtkWidget * entry;		// Actual Text Entry - GtkTextView
   GtkWidget * line_no;		// The line number of this sentence - GtkLabel
   GtkWidget * value;		// Status indicator - GtkLabel
@@ -52,18 +73,30 @@ struct sentence {
   int selected : 1;		// Whether or not this sentence is selected.
   int bg_color;			// The index of the background color.
   int value_type;		// The index of the value type of this sentence.
+  int line_bg;			// The background of the line number, or -1.
 
   sen_parent * parent;		// The parent of this sentence.
+  item_t * itm;			// Its item in the parent's list of sentences.
 
   int sig_id;			// The signal id of the mapping signal for this sentence.
 
+  live_job * live;		// The pending live check of this sentence.
+  int live_dirty : 1;		// Whether this sentence needs a live check.
+
   int matching_parens : 1;	// Whether or not parentheses are being matched.
+
+  int folded : 1;		// Whether the body of this subproof is folded.
+  int hidden : 1;		// Whether this sentence is in a folded body.
 };
 
 sentence * sentence_init (sen_data * sd, sen_parent * sp, item_t * fcs);
-void sentence_gui_init (sentence * sen);
+sen_widgets * sentence_gui_init ();
 void sentence_destroy (sentence * sen);
 
+int sentence_realize (sentence * sen);
+void sentence_unrealize (sentence * sen);
+void sentence_grab_focus (sentence * sen);
+
 sen_data * sentence_copy_to_data (sentence * sen);
 
 int sentence_out (sentence * sen);
@@ -74,7 +107,6 @@ int sentence_text_changed (sentence * sen);
 int sentence_set_line_no (sentence * sen, int new_line_no);
 int sentence_get_line_no (sentence * sen);
 int sentence_update_line_no (sentence * sen, int new);
-int sentence_get_grid_no (sentence * sen);
 
 int sentence_set_rule (sentence * sen, int rule);
 int sentence_get_rule (sentence * sen);
@@ -98,6 +130,9 @@ void sentence_set_font (sentence * sen, int font);
 void sentence_set_bg (sentence * sen, int bg_color);
 void sentence_set_bg_color (sentence * sen, int bg_color, int state);
 void sentence_set_value (sentence * sen, int value_type);
+void sentence_set_line_bg (sentence * sen, int bg_color);
+void sentence_set_folded (sentence * sen, int folded);
+void sentence_set_hidden (sentence * sen, int hidden);
 int sentence_collect_variables (sentence * sen);
 void sentence_set_reference (sentence * sen, int reference, int entire_subproof);
 void sentence_set_selected (sentence * sen, int selected);
@@ -112,6 +147,6 @@ int sentence_subproof (sentence * sen);
 int sentence_depth (sentence * sen);
 
 int sentence_get_index (sentence * sen, int i);
-int sentence_set_index (sentence * sen, int i, int index);
+int sentence_set_head (sentence * sen, int i, sentence * head);
 
 #endif  /*  ARIS_SENTENCE_H  */
@@ -0,0 +1,631 @@
+/* Functions for recording and replaying editing sessions.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* A session log has one operation per line:
+ *
+ *    <microseconds since recording began> <op> <line number>[ <argument>]
+ *
+ *  where op is one of the SESSION_OP characters.  In the argument,
+ *  '%' and line breaks are written as %XX.
+ * Replaying a log runs its operations through a proof_editor and times
+ *  each one, so that the cost of the editing model can be measured
+ *  without a display.  Key presses are kept in the log to show where
+ *  time went, but only their effects are replayed.
+ * The replay covers only the model: the line store, references, undo
+ *  history and evaluation.  None of the sentence widgets, the layout,
+ *  the renumbering of labels or the live checks that follow an edit in
+ *  the GUI are run, so the latencies it reports are a lower bound on
+ *  what a user sees, and a stutter that comes from the widgets won't
+ *  show up in them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include "session-log.h"
+#include "proof-edit.h"
+#include "proof.h"
+#include "sen-data.h"
+#include "list.h"
+#include "vec.h"
+
+// The file being recorded to, or NULL if nothing is being recorded.
+static FILE * session_file = NULL;
+static struct timespec session_start;
+
+// The operations that are timed on replay, and their names.
+static const char session_ops[] = {
+  SLO_TEXT, SLO_INS, SLO_REM, SLO_COPY, SLO_KILL, SLO_YANK, SLO_EVAL
+};
+static const char * session_op_names[] = {
+  "text", "insert", "remove", "copy", "kill", "yank", "eval"
+};
+#define SESSION_NUM_OPS \
+  ((int) (sizeof (session_ops) / sizeof (session_ops[0])))
+
+/* Gets the time since a starting point.
+ *  input:
+ *    start - the starting point.
+ *  output:
+ *    the elapsed time in nanoseconds.
+ */
+static long long
+session_elapsed (struct timespec * start)
+{
+  struct timespec now;
+
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) * 1000000000LL
+    + (now.tv_nsec - start->tv_nsec);
+}
+
+/* Starts recording a session.
+ *  input:
+ *    file_name - the name of the file to record to.
+ *  output:
+ *    0 on success, -2 on i/o error.
+ */
+int
+session_log_open (const char * file_name)
+{
+  session_log_close ();
+
+  session_file = fopen (file_name, "w");
+  if (!session_file)
+    {
+      perror (file_name);
+      return AEC_IO;
+    }
+
+  clock_gettime (CLOCK_MONOTONIC, &session_start);
+  return 0;
+}
+
+/* Stops recording a session.
+ *  input:
+ *    none.
+ *  output:
+ *    none.
+ */
+void
+session_log_close ()
+{
+  if (!session_file)
+    return;
+
+  fclose (session_file);
+  session_file = NULL;
+}
+
+/* Determines whether a session is being recorded.
+ *  input:
+ *    none.
+ *  output:
+ *    1 if a session is being recorded, 0 otherwise.
+ */
+int
+session_log_recording ()
+{
+  return session_file != NULL;
+}
+
+/* Writes the start of an entry in the session log.
+ *  input:
+ *    op - the operation.
+ *    ln - the line number the operation applies to.
+ *  output:
+ *    none.
+ */
+static void
+session_log_begin (int op, int ln)
+{
+  fprintf (session_file, "%lli %c %i",
+           session_elapsed (&session_start) / 1000, op, ln);
+}
+
+/* Records an operation in the session log, if one is being recorded.
+ *  input:
+ *    op - the operation.
+ *    ln - the line number the operation applies to.
+ *    fmt - the printf format of the argument, or NULL if there is none.
+ *  output:
+ *    none.
+ */
+void
+session_log (int op, int ln, const char * fmt, ...)
+{
+  va_list args;
+  char * arg;
+  int len, i;
+
+  if (!session_file)
+    return;
+
+  session_log_begin (op, ln);
+
+  if (!fmt)
+    {
+      fputc ('\n', session_file);
+      return;
+    }
+
+  va_start (args, fmt);
+  len = vsnprintf (NULL, 0, fmt, args);
+  va_end (args);
+
+  arg = (char *) calloc (len + 1, sizeof (char));
+  if (!arg)
+    {
+      fputc ('\n', session_file);
+      return;
+    }
+
+  va_start (args, fmt);
+  vsnprintf (arg, len + 1, fmt, args);
+  va_end (args);
+
+  fputc (' ', session_file);
+  for (i = 0; i < len; i++)
+    {
+      if (arg[i] == '%' || arg[i] == '\n' || arg[i] == '\r')
+        fprintf (session_file, "%%%02X", (unsigned char) arg[i]);
+      else
+        fputc (arg[i], session_file);
+    }
+  fputc ('\n', session_file);
+
+  free (arg);
+}
+
+/* Records an operation on several lines in the session log, if one
+ *  is being recorded.
+ *  input:
+ *    op - the operation.
+ *    ln - the line number the operation applies to.
+ *    sds - the data of the lines, whose line numbers are recorded.
+ *  output:
+ *    none.
+ */
+void
+session_log_lines (int op, int ln, list_t * sds)
+{
+  item_t * sd_itr;
+
+  if (!session_file)
+    return;
+
+  session_log_begin (op, ln);
+  for (sd_itr = sds->head; sd_itr; sd_itr = sd_itr->next)
+    fprintf (session_file, " %i", ((sen_data *) sd_itr->value)->line_num);
+  fputc ('\n', session_file);
+}
+
+/* Reads a line of any length from a file.
+ *  input:
+ *    file - the file from which to read.
+ *  output:
+ *    the line without its line break, or NULL at the end of the file
+ *    or on memory error.
+ */
+static char *
+session_read_line (FILE * file)
+{
+  char * line;
+  int len = 0, alloc = 256;
+
+  line = (char *) calloc (alloc, sizeof (char));
+  CHECK_ALLOC (line, NULL);
+
+  while (fgets (line + len, alloc - len, file))
+    {
+      len += strlen (line + len);
+      if (len > 0 && line[len - 1] == '\n')
+        {
+          line[--len] = '\0';
+          return line;
+        }
+
+      alloc *= 2;
+      line = (char *) realloc (line, alloc);
+      CHECK_ALLOC (line, NULL);
+    }
+
+  if (len > 0)
+    return line;
+
+  free (line);
+  return NULL;
+}
+
+/* Undoes the escapes of a session log argument in place.
+ *  input:
+ *    arg - the argument.
+ *  output:
+ *    none.
+ */
+static void
+session_unescape (char * arg)
+{
+  int i, j;
+
+  for (i = j = 0; arg[i]; i++, j++)
+    {
+      unsigned int c;
+
+      if (arg[i] == '%' && sscanf (arg + i + 1, "%2X", &c) == 1)
+        {
+          arg[j] = (char) c;
+          i += 2;
+        }
+      else
+        {
+          arg[j] = arg[i];
+        }
+    }
+  arg[j] = '\0';
+}
+
+/* Reads the line numbers from a session log argument.
+ *  input:
+ *    arg - the argument.
+ *    num - receives the number of line numbers.
+ *  output:
+ *    the line numbers, or NULL on memory error.
+ */
+static int *
+session_read_lines (const char * arg, int * num)
+{
+  int * lines, alloc = 8, pos = 0, used, ln;
+
+  lines = (int *) calloc (alloc, sizeof (int));
+  CHECK_ALLOC (lines, NULL);
+
+  *num = 0;
+  while (sscanf (arg + pos, "%i%n", &ln, &used) == 1)
+    {
+      if (*num == alloc)
+        {
+          alloc *= 2;
+          lines = (int *) realloc (lines, alloc * sizeof (int));
+          CHECK_ALLOC (lines, NULL);
+        }
+
+      lines[(*num)++] = ln;
+      pos += used;
+    }
+
+  return lines;
+}
+
+/* Replaces the lines kept for yanking with copies of lines of a proof.
+ * References are dropped from the copies, since the GUI makes them
+ *  relative and they would otherwise point past the yanked lines.
+ *  input:
+ *    proof - the proof from which to copy the lines.
+ *    yanked - the list of lines kept for yanking.
+ *    lines - the line numbers to copy.
+ *    num - the number of entries in lines.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+session_copy (proof_t * proof, list_t * yanked, const int * lines, int num)
+{
+  item_t * itm;
+  int i;
+
+  for (itm = yanked->head; itm; itm = itm->next)
+    sen_data_destroy (itm->value);
+  ls_clear (yanked);
+
+  for (i = 0; i < num; i++)
+    {
+      sen_data * sd;
+
+      itm = ls_nth (proof->everything, lines[i] - 1);
+      if (!itm)
+        continue;
+
+      sd = (sen_data *) calloc (1, sizeof (sen_data));
+      CHECK_ALLOC (sd, AEC_MEM);
+
+      if (sen_data_copy (itm->value, sd) == AEC_MEM)
+        return AEC_MEM;
+
+      if (sd->refs)
+        sd->refs[0] = REF_END;
+
+      if (!ls_push_obj (yanked, sd))
+        return AEC_MEM;
+    }
+
+  return 0;
+}
+
+/* Evaluates a proof up to a line, as the evaluation menu items do.
+ *  input:
+ *    proof - the proof to evaluate.
+ *    ln - the last line to evaluate, or 0 for the whole proof.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+session_eval (proof_t * proof, int ln)
+{
+  list_t * lines;
+  item_t * itm;
+  int ret;
+
+  if (ln == 0)
+    return proof_eval (proof, NULL, 0);
+
+  lines = init_list ();
+  if (!lines)
+    return AEC_MEM;
+
+  for (itm = proof->everything->head; itm && ln > 0; itm = itm->next, ln--)
+    {
+      if (!ls_push_obj (lines, itm->value))
+        return AEC_MEM;
+    }
+
+  ret = eval_proof (lines, NULL, 0);
+  destroy_list (lines);
+
+  return ret;
+}
+
+/* Replays one operation of a session log on the editing model alone.
+ *  input:
+ *    ed - the editor over the proof.
+ *    yanked - the lines kept for yanking.
+ *    op - the operation.
+ *    ln - the line number the operation applies to.
+ *    arg - the argument of the operation.
+ *  output:
+ *    0 on success, -1 on memory error, 1 if the operation doesn't fit
+ *    the proof.
+ */
+static int
+session_replay_op (proof_editor * ed, list_t * yanked, int op, int ln,
+                   char * arg)
+{
+  int ret, * lines, num;
+
+  switch (op)
+    {
+    case SLO_TEXT:
+      session_unescape (arg);
+      return proof_editor_set_text (ed, ln, (unsigned char *) arg);
+
+    case SLO_INS:
+      {
+        sen_data * sd;
+        list_t * sds;
+        int premise = 0, subproof = 0, depth = 0;
+
+        sscanf (arg, "%i %i %i", &premise, &subproof, &depth);
+        sd = sen_data_init (-1, -1, (unsigned char *) "", NULL, premise,
+                            NULL, subproof, depth, NULL);
+        if (!sd)
+          return AEC_MEM;
+
+        sds = init_list ();
+        if (!sds || !ls_push_obj (sds, sd))
+          return AEC_MEM;
+
+        ret = proof_editor_insert (ed, ln - 1, sds);
+        sen_data_destroy (sd);
+        destroy_list (sds);
+        return ret;
+      }
+
+    case SLO_REM:
+      return proof_editor_remove (ed, &ln, 1);
+
+    case SLO_COPY:
+    case SLO_KILL:
+      lines = session_read_lines (arg, &num);
+      if (!lines)
+        return AEC_MEM;
+
+      ret = session_copy (ed->proof, yanked, lines, num);
+      if (ret == 0 && op == SLO_KILL)
+        ret = proof_editor_remove (ed, lines, num);
+
+      free (lines);
+      return ret;
+
+    case SLO_YANK:
+      return proof_editor_insert (ed, ln, yanked);
+
+    case SLO_EVAL:
+      return session_eval (ed->proof, ln);
+    }
+
+  return 1;
+}
+
+/* Compares two timings, for qsort.
+ *  input:
+ *    a, b - the timings to compare.
+ *  output:
+ *    -1, 0 or 1 as a is less than, equal to or greater than b.
+ */
+static int
+session_cmp_times (const void * a, const void * b)
+{
+  long long ta = *((const long long *) a), tb = *((const long long *) b);
+
+  return (ta > tb) - (ta < tb);
+}
+
+/* Prints the latency percentiles of each kind of operation.
+ *  input:
+ *    times - the timings of each kind of operation, in nanoseconds.
+ *  output:
+ *    none.
+ */
+static void
+session_report (vec_t ** times)
+{
+  int i;
+
+  printf ("%-8s %8s %10s %10s %10s %10s\n",
+          "op", "count", "p50 (us)", "p90 (us)", "p99 (us)", "max (us)");
+
+  for (i = 0; i < SESSION_NUM_OPS; i++)
+    {
+      long long * t = times[i]->stuff;
+      int n = times[i]->num_stuff;
+
+      if (n == 0)
+        continue;
+
+      qsort (t, n, sizeof (long long), session_cmp_times);
+      printf ("%-8s %8i %10.1f %10.1f %10.1f %10.1f\n",
+              session_op_names[i], n,
+              t[(n - 1) * 50 / 100] / 1000.0,
+              t[(n - 1) * 90 / 100] / 1000.0,
+              t[(n - 1) * 99 / 100] / 1000.0,
+              t[n - 1] / 1000.0);
+    }
+}
+
+/* Replays a session log against a proof, and prints how long each
+ *  kind of operation took in the editing model, without the GUI.
+ *  input:
+ *    proof - the proof on which to replay the log.
+ *    file_name - the name of the session log.
+ *  output:
+ *    0 on success, -1 on memory error, -2 on i/o error.
+ */
+int
+session_replay (proof_t * proof, const char * file_name)
+{
+  FILE * file;
+  proof_editor * ed;
+  list_t * yanked;
+  item_t * itm;
+  vec_t * times[SESSION_NUM_OPS];
+  char * line;
+  int i, ret, line_num = 0, keys = 0, skipped = 0;
+
+  file = fopen (file_name, "r");
+  if (!file)
+    {
+      perror (file_name);
+      return AEC_IO;
+    }
+
+  ed = proof_editor_init (proof);
+  if (!ed)
+    return AEC_MEM;
+
+  yanked = init_list ();
+  if (!yanked)
+    return AEC_MEM;
+
+  for (i = 0; i < SESSION_NUM_OPS; i++)
+    {
+      times[i] = init_vec (sizeof (long long));
+      if (!times[i])
+        return AEC_MEM;
+    }
+
+  while ((line = session_read_line (file)))
+    {
+      struct timespec start;
+      long long stamp, elapsed;
+      char op;
+      int ln, used = 0;
+
+      line_num++;
+
+      if (sscanf (line, "%lli %c %i%n", &stamp, &op, &ln, &used) != 3)
+        {
+          fprintf (stderr, "Replay Warning - \
+line %i of '%s' is not a session entry, ignoring it.\n", line_num, file_name);
+          free (line);
+          continue;
+        }
+
+      if (op == SLO_KEY)
+        {
+          keys++;
+          free (line);
+          continue;
+        }
+
+      for (i = 0; i < SESSION_NUM_OPS; i++)
+        if (session_ops[i] == op)
+          break;
+
+      if (i == SESSION_NUM_OPS)
+        {
+          fprintf (stderr, "Replay Warning - \
+line %i of '%s' has an unknown operation '%c', ignoring it.\n",
+                   line_num, file_name, op);
+          free (line);
+          continue;
+        }
+
+      if (line[used] == ' ')
+        used++;
+
+      clock_gettime (CLOCK_MONOTONIC, &start);
+      ret = session_replay_op (ed, yanked, op, ln, line + used);
+      elapsed = session_elapsed (&start);
+      free (line);
+
+      if (ret == AEC_MEM)
+        return AEC_MEM;
+
+      if (ret != 0)
+        {
+          skipped++;
+          continue;
+        }
+
+      if (vec_add_obj (times[i], &elapsed) < 0)
+        return AEC_MEM;
+    }
+
+  fclose (file);
+
+  printf ("Replayed on the editing model; the GUI's time is not included.\n");
+  session_report (times);
+  if (keys > 0)
+    printf ("%i key presses were logged; only their effects are replayed.\n",
+            keys);
+  if (skipped > 0)
+    printf ("%i operations did not fit the proof and were skipped.\n",
+            skipped);
+
+  for (i = 0; i < SESSION_NUM_OPS; i++)
+    destroy_vec (times[i]);
+
+  for (itm = yanked->head; itm; itm = itm->next)
+    sen_data_destroy (itm->value);
+  destroy_list (yanked);
+  proof_editor_destroy (ed);
+
+  return 0;
+}
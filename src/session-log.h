@@ -0,0 +1,46 @@
+/* Recording and replay of editing sessions.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_SESSION_LOG_H
+#define ARIS_SESSION_LOG_H
+
+#include "typedef.h"
+
+// The operations kept in a session log, by the character that marks them.
+
+enum SESSION_OP {
+  SLO_KEY = 'k',    // A key was pressed in a sentence.
+  SLO_TEXT = 't',   // The text of a sentence changed.
+  SLO_INS = 'i',    // A sentence was created.
+  SLO_REM = 'r',    // A sentence was removed.
+  SLO_COPY = 'c',   // Lines were copied.
+  SLO_KILL = 'x',   // Lines were killed.
+  SLO_YANK = 'y',   // The copied or killed lines were yanked.
+  SLO_EVAL = 'e'    // A line, or the whole proof if line 0, was evaluated.
+};
+
+int session_log_open (const char * file_name);
+void session_log_close ();
+int session_log_recording ();
+
+void session_log (int op, int ln, const char * fmt, ...);
+void session_log_lines (int op, int ln, list_t * sds);
+
+int session_replay (proof_t * proof, const char * file_name);
+
+#endif  /*  ARIS_SESSION_LOG_H  */
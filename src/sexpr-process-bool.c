@@ -17,10 +17,14 @@
 */
 
 #include "sexpr-process.h"
+#include "sexpr-tree.h"
+#include "rule-template.h"
 #include "vec.h"
 
 // Boolean rules follow the same structure as equivalence rules.
 
+static char * bi_rule (sexpr_node * n0, sexpr_node * n1);
+
 char *
 process_bool (unsigned char * conc, vec_t * prems, const char * rule)
 {
@@ -74,422 +78,233 @@ process_bool (unsigned char * conc, vec_t * prems, const char * rule)
   return ret;
 }
 
-char *
-proc_bi (unsigned char * prem, unsigned char * conc)
+/* Checks one side of Boolean Identity.
+ *  input:
+ *    ln - the longer sentence, such as (<a> A <t>).
+ *    sh - the shorter sentence.
+ *  output:
+ *    CORRECT if they agree, an error message otherwise, or NULL on error.
+ */
+static char *
+bi_check (sexpr_node * ln, sexpr_node * sh)
 {
-  // Standard long-short sentence setup.
-
-  unsigned char * ln_sen, * sh_sen;
-  int l_len;
-
-  sen_put_len (prem, conc, &sh_sen, &ln_sen);
-  l_len = strlen (ln_sen);
-
-  int i;
-  i = find_difference (ln_sen, sh_sen);
-  if (i == -1)
-    return NO_DIFFERENCE;
-
-  int li, si;
-
-  // Rollback sh_sen to just before the first o-paren.
-  si = li = i;
-  if (sh_sen[si] == '(')
-    {
-      si--;
-      if (si < 0)
-	return _("Boolean Identity constructed incorrectly.");
-    }
-  else if (si > 0
-	   && (!strncmp (sh_sen + si - 1, S_AND, S_CL)
-	       || !strncmp (sh_sen + si - 1, S_OR, S_CL)
-	       || !strncmp (sh_sen + si - 1, S_CON, S_CL)
-	       || !strncmp (sh_sen + si - 1, S_BIC, S_CL)
-	       || !strncmp (sh_sen + si - 1, S_NOT, S_NL)))
-    {
-      while (sh_sen[si] != '(')
-	si--;
-      si--;
-    }
-
-  si = find_unmatched_o_paren (sh_sen, si);
-  if (si == -1)
-    {
-      // This is the entire sentence.
-      li = 0;
-    }
-  else
-    {
-      if (ln_sen[li] != '(')
-	{
-	  li = find_unmatched_o_paren (ln_sen, li);
-	  if (li == -1)
-	    return _("There must be a connective in the longer sentence.");
-	}
-
-      int ret_chk;
-      ret_chk = sexpr_find_unmatched (ln_sen, sh_sen, &li, &si);
-      if (ret_chk == AEC_MEM)
-	return NULL;
-
-      if (li < 0)
-	return _("Boolean Identity constructed incorrectly.");
-
-      if (si < 0)
-	{
-	  // The equivalence uses all of sh_sen.
-	  // this means that li needs to be zero.
-	  li = 0;
-	}
-    }
-
-  if (ln_sen[li] != '(')
-    return _("Boolean Identity constructed incorrectly.");
-
-  int tmp_pos;
-  unsigned char * tmp_str;
-
-  tmp_pos = parse_parens (ln_sen, li, &tmp_str);
-  if (tmp_pos == AEC_MEM)
-    return NULL;
-
-  int ftc;
-  unsigned char * lsen, * rsen, conn[S_CL + 1];
-
-  conn[0] = '\0';
-  lsen = rsen = NULL;
-
-  ftc = sexpr_find_top_connective (tmp_str, conn, &lsen, &rsen);
-  if (ftc == AEC_MEM)
-    return NULL;
-  free (tmp_str);
-
-  if (ftc < 0)
-    {
-      if (lsen)  free (lsen);
-      if (rsen)  free (rsen);
-
-      return _("There must be generalities at the difference.");
-    }
+  sexpr_node * bad_side;
+  int sym;
+  char * ret;
 
-  if (strcmp (conn, S_AND) && strcmp (conn, S_OR))
-    {
-      free (lsen);
-      free (rsen);
+  if (ln->num_kids != 3)
+    return _("There must be generalities at the difference.");
 
-      return _("There must be a conjunction or a disjunction in one sentence.");
-    }
+  if (ln->conn != AND_CONN && ln->conn != OR_CONN)
+    return _("There must be a conjunction or a disjunction in one sentence.");
 
-  unsigned char * good_side, * bad_side;
+  sym = (ln->conn == AND_CONN) ? TAU_CONN : CTR_CONN;
 
-  if (ISSBOOL(lsen))
-    {
-      good_side = lsen;
-      bad_side = rsen;
-    }
-  else if (ISSBOOL(rsen))
-    {
-      good_side = rsen;
-      bad_side = lsen;
-    }
-  else
-    {
-      free (rsen);
-      free (lsen);
-      return _("There must be a tautology or a contradiction in the generalities.");
-    }
-
-  if ((strcmp (conn, S_AND) || strcmp (good_side, S_TAU))
-      && (strcmp (conn, S_OR) || strcmp (good_side, S_CTR)))
-    {
-      free (lsen);
-      free (rsen);
-
-      return _("A tautology must be matched with a conjunction, and a contradiction \
+  if (ln->kids[2]->conn == sym)
+    bad_side = ln->kids[1];
+  else if (ln->kids[1]->conn == sym)
+    bad_side = ln->kids[2];
+  else if (SEXPR_IS_BOOL (ln->kids[1]) || SEXPR_IS_BOOL (ln->kids[2]))
+    return _("A tautology must be matched with a conjunction, and a contradiction \
 with a disjunction.");
-    }
-  free (good_side);
-
-  unsigned char * oth_sen;
-  int alloc_size;
-
-  alloc_size = l_len - 2 * S_CL - 4;
-  oth_sen = construct_other (ln_sen, li, tmp_pos + 1, alloc_size, "%s", bad_side);
-  if (!oth_sen)
-    return NULL;
-
-  char * ret_str;
-
-  if (ln_sen == conc)
-    ret_str = proc_bi (sh_sen, oth_sen);
   else
-    ret_str = proc_bi (oth_sen, sh_sen);
+    return _("There must be a tautology or a contradiction in the generalities.");
 
-  if (!ret_str)
+  ret = sexpr_tree_equiv (bad_side, sh, bi_rule);
+  if (!ret)
     return NULL;
-  free (oth_sen);
 
-  if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
+  if (SEXPR_TREE_OK (ret))
     return CORRECT;
 
   return _("Boolean Identity constructed incorrectly.");
 }
 
-char *
-proc_bd (unsigned char * prem, unsigned char * conc)
+static char *
+bi_rule (sexpr_node * n0, sexpr_node * n1)
 {
-  unsigned char * ln_sen, * sh_sen;
-  int l_len;
-
-  sen_put_len (prem, conc, &sh_sen, &ln_sen);
-  l_len = strlen (ln_sen);
+  int ret;
 
-  int i;
-  i = find_difference (ln_sen, sh_sen);
-  if (i == -1)
-    return NO_DIFFERENCE;
-
-  if (ln_sen[i] != '(')
-    return _("There must be a connective at the difference.");
+  ret = rule_template_apply ("bi", n0, n1, bi_rule);
+  if (ret == AEC_MEM)
+    return NULL;
 
-  int tmp_pos, t_len;
-  unsigned char * tmp_str;
+  if (ret)
+    return CORRECT;
 
-  tmp_pos = parse_parens (ln_sen, i, &tmp_str);
-  if (tmp_pos == AEC_MEM)
-    return NULL;
-  t_len = strlen (tmp_str);
+  // Otherwise, find what is wrong with the sentences.
+  if (n1->len > n0->len)
+    return sexpr_tree_either (n1, n0, bi_check);
 
-  int gg;
-  vec_t * gens;
-  unsigned char conn[S_CL + 1];
+  return sexpr_tree_either (n0, n1, bi_check);
+}
 
-  conn[0] = '\0';
-  gens = init_vec (sizeof (char *));
-  if (!gens)
-    return NULL;
+char *
+proc_bi (unsigned char * prem, unsigned char * conc)
+{
+  return sexpr_tree_process (prem, conc, bi_rule);
+}
 
-  gg = sexpr_get_generalities (tmp_str, conn, gens);
-  if (gg == AEC_MEM)
-    return NULL;
-  free (tmp_str);
+/* Checks one side of Boolean Dominance.
+ *  input:
+ *    ln - the longer sentence, such as (<a> A <c>).
+ *    sh - the shorter sentence.
+ *  output:
+ *    CORRECT if they agree, or an error message otherwise.
+ */
+static char *
+bd_check (sexpr_node * ln, sexpr_node * sh)
+{
+  int sym, i;
 
-  if (gg == 1)
-    {
-      destroy_str_vec (gens);
-      return _("There must be a connective at the difference.");
-    }
+  if (ln->num_kids < 3)
+    return _("There must be a connective at the difference.");
 
-  if (strcmp (conn, S_AND) && strcmp (conn, S_OR))
-    {
-      destroy_str_vec (gens);
-      return _("There must be a conjunction or a disjunction at the difference.");
-    }
+  if (ln->conn != AND_CONN && ln->conn != OR_CONN)
+    return _("There must be a conjunction or a disjunction at the difference.");
 
-  unsigned char sym[S_CL + 1];
-  int j;
+  sym = (ln->conn == AND_CONN) ? CTR_CONN : TAU_CONN;
 
-  for (j = 0; j < gens->num_stuff; j++)
+  for (i = 1; i < ln->num_kids; i++)
     {
-      unsigned char ** cur_gen;
-      cur_gen = vec_nth (gens, j);
-
-      if (!strcmp (*cur_gen, S_CTR) && !strcmp (conn, S_AND))
-	{
-	  strncpy (sym, S_CTR, S_CL);
-	  sym[S_CL] = '\0';
-	  break;
-	}
-
-      if (!strcmp (*cur_gen, S_TAU) && !strcmp (conn, S_OR))
-	{
-	  strncpy (sym, S_TAU, S_CL);
-	  sym[S_CL] = '\0';
-	  break;
-	}
+      if (ln->kids[i]->conn == sym)
+	break;
     }
 
-  destroy_str_vec (gens);
-
-  if (j == gg)
+  if (i == ln->num_kids)
     return _("There must be a tautology or a contradiction within the difference.");
 
-  unsigned char * oth_sen;
-  int alloc_size;
-  alloc_size = l_len - t_len + S_CL;
-
-  oth_sen = construct_other (ln_sen, i, tmp_pos + 1, alloc_size, "%s", sym);
-  if (!oth_sen)
-    return NULL;
+  if (sh->conn != sym)
+    return _("Boolean Dominance constructed incorrectly.");
 
-  char * ret_str;
+  return CORRECT;
+}
 
-  if (ln_sen == conc)
-    ret_str = proc_bd (sh_sen, oth_sen);
-  else
-    ret_str = proc_bd (oth_sen, sh_sen);
+static char *
+bd_rule (sexpr_node * n0, sexpr_node * n1)
+{
+  int ret;
 
-  if (!ret_str)
+  ret = rule_template_apply ("bd", n0, n1, bd_rule);
+  if (ret == AEC_MEM)
     return NULL;
-  free (oth_sen);
 
-  if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
+  if (ret)
     return CORRECT;
 
-  return _("Boolean Dominance constructed incorrectly.");
+  // A dominating symbol may be among any number of parts.
+  if (n1->len > n0->len)
+    return sexpr_tree_either (n1, n0, bd_check);
+
+  return sexpr_tree_either (n0, n1, bd_check);
 }
 
 char *
-proc_bn (unsigned char * prem, unsigned char * conc)
+proc_bd (unsigned char * prem, unsigned char * conc)
 {
-  unsigned char * ln_sen, * sh_sen;
-  int l_len;
-
-  sen_put_len (prem, conc, &sh_sen, &ln_sen);
-  l_len = strlen (ln_sen);
+  return sexpr_tree_process (prem, conc, bd_rule);
+}
 
-  int i;
-  i = find_difference (ln_sen, sh_sen);
-  if (i == -1)
-    return NO_DIFFERENCE;
+/* Checks one side of Boolean Negation.
+ *  input:
+ *    ln - the longer sentence, such as (<a> A (<n> A)).
+ *    sh - the shorter sentence.
+ *  output:
+ *    CORRECT if they agree, or an error message otherwise.
+ */
+static char *
+bn_check (sexpr_node * ln, sexpr_node * sh)
+{
+  int sym;
 
-  if (ln_sen[i] != '(' ||
-      (strncmp (ln_sen + i + 1, S_AND, S_CL) && strncmp (ln_sen + i + 1, S_OR, S_CL)))
+  if (!SEXPR_IS_BINARY (ln, AND_CONN) && !SEXPR_IS_BINARY (ln, OR_CONN))
     return _("There must be a connective at the difference.");
 
-  int tmp_pos;
-  unsigned char * tmp_str;
-
-  tmp_pos = parse_parens (ln_sen, i, &tmp_str);
-  if (tmp_pos == AEC_MEM)
-    return NULL;
-
-  int ftc;
-  unsigned char * lsen, * rsen;
-  unsigned char conn[S_CL + 1];
-  conn[0] = '\0';
-
-  ftc = sexpr_find_top_connective (tmp_str, conn, &lsen, &rsen);
-  if (ftc == AEC_MEM)
-    return NULL;
-  free (tmp_str);
-
-  if (ftc < 0)
-    {
-      if (lsen)  free (lsen);
-      if (rsen)  free (rsen);
-
-      return _("There must be only two connected parts.");
-    }
-
-  if (!sexpr_not_check (rsen) || strcmp (sexpr_add_not (lsen), rsen))
-    {
-      free (lsen);
-      free (rsen);
-
-      return _("The second part must be the negation of the first.");
-    }
-
-  unsigned char sym[S_CL + 1];
-  if (!strcmp (conn, S_AND))
-    strncpy (sym, S_CTR, S_CL);
-  else
-    strncpy (sym, S_TAU, S_CL);
-  sym[S_CL] = '\0';
+  if (!SEXPR_IS_NOT (ln->kids[2])
+      || !sexpr_node_equal (ln->kids[1], ln->kids[2]->kids[1]))
+    return _("The second part must be the negation of the first.");
 
-  free (rsen);
+  sym = (ln->conn == AND_CONN) ? CTR_CONN : TAU_CONN;
+  if (sh->conn != sym)
+    return _("Boolean Negation constructed incorrectly.");
 
-  unsigned char * oth_sen;
-  int alloc_size;
-
-  alloc_size = l_len - 2 * strlen (lsen) - S_NL - 7;
-  free (lsen);
-
-  oth_sen = construct_other (ln_sen, i, tmp_pos + 1, alloc_size, "%s", sym);
-  if (!oth_sen)
-    return NULL;
-
-  char * ret_str;
+  return CORRECT;
+}
 
-  if (ln_sen == conc)
-    ret_str = proc_bn (sh_sen, oth_sen);
-  else
-    ret_str = proc_bn (oth_sen, sh_sen);
+static char *
+bn_rule (sexpr_node * n0, sexpr_node * n1)
+{
+  int ret;
 
-  if (!ret_str)
+  ret = rule_template_apply ("bn", n0, n1, bn_rule);
+  if (ret == AEC_MEM)
     return NULL;
 
-  free (oth_sen);
-  if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
+  if (ret)
     return CORRECT;
 
-  return _("Boolean Negation constructed incorrectly.");
+  // Otherwise, find what is wrong with the sentences.
+  if (n1->len > n0->len)
+    return sexpr_tree_either (n1, n0, bn_check);
+
+  return sexpr_tree_either (n0, n1, bn_check);
 }
 
 char *
-proc_sn (unsigned char * prem, unsigned char * conc)
+proc_bn (unsigned char * prem, unsigned char * conc)
 {
-  unsigned char * ln_sen, * sh_sen;
-  int l_len;
-
-  sen_put_len (prem, conc, &sh_sen, &ln_sen);
-  l_len = strlen (ln_sen);
+  return sexpr_tree_process (prem, conc, bn_rule);
+}
 
-  int i;
-  i = find_difference (ln_sen, sh_sen);
-  if (i == -1)
-    return NO_DIFFERENCE;
+/* Checks one side of Symbol Negation.
+ *  input:
+ *    ln - the longer sentence, such as (<n> <t>).
+ *    sh - the shorter sentence.
+ *  output:
+ *    CORRECT if they agree, or an error message otherwise.
+ */
+static char *
+sn_check (sexpr_node * ln, sexpr_node * sh)
+{
+  int sym;
 
-  if (ln_sen[i] != '(' || strncmp (ln_sen + i + 1, S_NOT, S_NL))
+  if (!SEXPR_IS_NOT (ln))
     return _("There must be a negation in one sentence.");
 
-  int tmp_pos;
-  unsigned char * tmp_str, * elm_str;
-
-  tmp_pos = parse_parens (ln_sen, i, &tmp_str);
-  if (tmp_pos == AEC_MEM)
-    return NULL;
-
-  elm_str = sexpr_elim_not (tmp_str);
-  if (!elm_str)
-    return NULL;
-  free (tmp_str);
-
-  if (strcmp (elm_str, S_CTR) && strcmp (elm_str, S_TAU))
-    {
-      free (elm_str);
-      return _("There must be a negated symbol in one sentence.");
-    }
-
-  unsigned char sym[S_CL + 1];
-  if (!strcmp (elm_str, S_CTR))
-    strncpy (sym, S_TAU, S_CL);
+  if (ln->kids[1]->conn == TAU_CONN)
+    sym = CTR_CONN;
+  else if (ln->kids[1]->conn == CTR_CONN)
+    sym = TAU_CONN;
   else
-    strncpy (sym, S_CTR, S_CL);
-  sym[S_CL] = '\0';
-  free (elm_str);
-
-  unsigned char * oth_sen;
-  int alloc_size;
+    return _("There must be a negated symbol in one sentence.");
 
-  alloc_size = l_len - S_NL - 3;
-  oth_sen = construct_other (ln_sen, i, tmp_pos + 1, alloc_size, "%s", sym);
-  if (!oth_sen)
-    return NULL;
+  if (sh->conn != sym)
+    return _("Symbol Negation constructed incorrectly.");
 
-  char * ret_str;
+  return CORRECT;
+}
 
-  if (ln_sen == conc)
-    ret_str = proc_sn (sh_sen, oth_sen);
-  else
-    ret_str = proc_sn (oth_sen, sh_sen);
-  free (oth_sen);
+static char *
+sn_rule (sexpr_node * n0, sexpr_node * n1)
+{
+  int ret;
 
-  if (!ret_str)
+  ret = rule_template_apply ("sn", n0, n1, sn_rule);
+  if (ret == AEC_MEM)
     return NULL;
 
-  if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
+  if (ret)
     return CORRECT;
 
-  return _("Symbol Negation constructed incorrectly.");
+  // Otherwise, find what is wrong with the sentences.
+  if (n1->len > n0->len)
+    return sexpr_tree_either (n1, n0, sn_check);
+
+  return sexpr_tree_either (n0, n1, sn_check);
+}
+
+char *
+proc_sn (unsigned char * prem, unsigned char * conc)
+{
+  return sexpr_tree_process (prem, conc, sn_rule);
 }
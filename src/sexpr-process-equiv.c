@@ -23,214 +23,27 @@
  *    CORRECT if the evaluation checks out, or an error message otherwise.
  */
 
-/* All equivalence functions (except proc_co and proc_id) have a similar structure:
- *  First, determine some values based on the premise and conclusion (usually strlen).
- *  Use these values to determine which sentence is which.
- *  Find difference (i set to this difference), returning NO_DIFFERENCE if i == -1.
- *  Calculate the desired offset.
- *  Parse parens to get the working scope.
- *  From this, get the necessary parts.
- *  Using these, construct what should be the other sentence.
- *  run recursion, check for NO_DIFFERENCE or CORRECT.
- *  return generic error otherwise.
+/* The equivalence functions are checked over formula trees by
+ *  sexpr_tree_process, which walks the premise and the conclusion
+ *  together and calls the rule on each pair of subtrees that
+ *  differ.  Each rule first applies its templates from rule-template.c.
+ *  When none match, the rule falls back on a check of its own, which
+ *  covers sentences with any number of parts and says what is wrong.
+ *  The checks compare the parts with sexpr_tree_equiv, so that the rule
+ *  may be applied again within them.
  */
 
 #include "sexpr-process.h"
+#include "sexpr-tree.h"
+#include "rule-template.h"
 #include "vec.h"
 
-enum {
-  MODE_CO = 0,
-  MODE_ID
-};
-
-/*
- * mode - 0 for commutativity, 1 for idempotence.
- * In Idempotence, sen_0 is the larger sentence, sen_1 the shorter.
- */
-int
-recurse_mode (unsigned char * sen_0, unsigned char * sen_1, int mode)
-{
-  if (!strcmp (sen_0, sen_1))
-    return -3;
-
-  int gg_0, gg_1;
-  vec_t * gens_0, * gens_1;
-  int con_0, con_1;
-
-  gens_0 = init_vec (sizeof (char *));
-  if (!gens_0)
-    return AEC_MEM;
-
-  gens_1 = init_vec (sizeof (char *));
-  if (!gens_1)
-    return AEC_MEM;
-
-  unsigned char conn_0[S_CL + 1], conn_1[S_CL + 1];
-
-  conn_0[0] = '\0';
-  conn_1[0] = '\0';
-
-  gg_0 = sexpr_get_generalities (sen_0, conn_0, gens_0);
-  if (gg_0 == AEC_MEM)
-    return AEC_MEM;
-
-  gg_1 = sexpr_get_generalities (sen_1, conn_1, gens_1);
-  if (gg_1 == AEC_MEM)
-    return AEC_MEM;
-
-  if (mode == MODE_CO)
-    {
-      if (gg_0 != gg_1)
-	{
-	  destroy_str_vec (gens_0); destroy_str_vec (gens_1);
-	  return -2;
-	}
-    }
-  else
-    {
-      if (gg_0 < gg_1)
-	{
-	  destroy_str_vec (gens_0); destroy_str_vec (gens_1);
-	  return -2;
-	}
-    }
-
-  // If the larger sentence has no top connective.
-  if (gg_0 == 1)
-    {
-      destroy_str_vec (gens_0); destroy_str_vec (gens_1);
-
-      // If only one generality, there is either a negation or quantifier.
-
-      if (sen_0[0] != '(' || sen_1[0] != '(')
-	return -2;
-
-      int pos0, pos1;
-      unsigned char * car_0, * car_1, * cdr_0, * cdr_1;
-
-      pos0 = sexpr_str_car_cdr (sen_0, &car_0, &cdr_0);
-      if (pos0 == AEC_MEM)
-	return AEC_MEM;
-
-      pos1 = sexpr_str_car_cdr (sen_1, &car_1, &cdr_1);
-      if (pos1 == AEC_MEM)
-	return AEC_MEM;
-
-      // Check for a negation.
-      if (!strcmp (car_0, S_NOT) && !strcmp (car_1, S_NOT))
-	{
-	  free (car_0); free (car_1);
-	  // Eliminate the negation, and continue.
-
-	  int ret;
-	  ret = recurse_mode (cdr_0, cdr_1, mode);
-	  if (ret == AEC_MEM)
-	    return AEC_MEM;
-
-	  free (cdr_0); free(cdr_1);
-
-	  return ret;
-	}
-
-      // Check for a quantifier.
-      if (!strcmp (car_0, car_1))
-	{
-	  // Eliminate the quantifier and continue.
-	  if (strncmp (car_0 + 1, S_UNV, S_CL)
-	      && strncmp (car_0 + 1, S_EXL, S_CL))
-	    {
-	      free (car_0); free (car_1);
-	      free (cdr_0); free(cdr_1);
-	      return -2;
-	    }
-
-	  free (car_0); free (car_1);
-
-	  int cmp;
-	  cmp = recurse_mode (cdr_0, cdr_1, mode);
-	  if (cmp == AEC_MEM)
-	    return AEC_MEM;
-
-	  free (cdr_0); free(cdr_1);
-
-	  return cmp;
-	}
-
-      free (car_0); free(car_1);
-      free (cdr_0); free(cdr_1);
-
-      return -2;
-    }
-
-  /* The connectives only need to be the same if mode == 1 */
-
-  con_0 = 1;
-  if (strcmp (conn_0, S_AND) && strcmp (conn_0, S_OR))
-    con_0 = 0;
-
-  con_1 = 1;
-  if (strcmp (conn_1, S_AND) && strcmp (conn_1, S_OR))
-    {
-      if (!(mode == MODE_ID && conn_1[0] == '\0'))
-	con_1 = 0;
-    }
-
-  if ((con_0 && !con_1) || (!con_0 && con_1))
-    {
-      destroy_str_vec (gens_0); destroy_str_vec (gens_1);
-      return -2;
-    }
-
-  if (con_0 && con_1)
-    {
-      int cmp;
-      if (mode == MODE_CO)
-	cmp = vec_str_cmp (gens_0, gens_1);
-      else
-	cmp = vec_str_sub (gens_1, gens_0);
-
-      if (cmp == AEC_MEM)
-	return AEC_MEM;
-
-      if (cmp == 0)
-	{
-	  destroy_str_vec (gens_0); destroy_str_vec (gens_1);
-	  return 0;
-	}
-      else if (mode == MODE_ID && gg_0 != gg_1)
-	{
-	  destroy_str_vec (gens_0); destroy_str_vec (gens_1);
-	  return -2;
-	}
-    }
-
-  int ret, i;
-
-  for (i = 0; i < gens_0->num_stuff; i++)
-    {
-      unsigned char * cur_0, * cur_1;
-
-      cur_0 = vec_str_nth (gens_0, i);
-      cur_1 = vec_str_nth (gens_1, i);
-
-      if (!strcmp (cur_0, cur_1))
-	continue;
-
-      ret = recurse_mode (cur_0, cur_1, mode);
-      if (ret == AEC_MEM)
-	return AEC_MEM;
-
-      if (ret != 0)
-	{
-	  destroy_str_vec (gens_0); destroy_str_vec (gens_1);
-	  return ret;
-	}
-    }
-
-  destroy_str_vec (gens_0); destroy_str_vec (gens_1);
-
-  return 0;
-}
+static char * im_rule (sexpr_node * n0, sexpr_node * n1);
+static char * dm_rule (sexpr_node * n0, sexpr_node * n1);
+static char * dt_rule (sexpr_node * n0, sexpr_node * n1);
+static char * eq_rule (sexpr_node * n0, sexpr_node * n1);
+static char * dn_rule (sexpr_node * n0, sexpr_node * n1);
+static char * sb_rule (sexpr_node * n0, sexpr_node * n1);
 
 char *
 process_equivalence (unsigned char * conc, vec_t * prems, const char * rule)
@@ -254,7 +67,7 @@ process_equivalence (unsigned char * conc, vec_t * prems, const char * rule)
       if (prems->num_stuff != 1)
 	return _("DeMorgan requires one (1) reference.");
 
-      ret = proc_dm (prem, conc, -1);
+      ret = proc_dm (prem, conc);
       if (!ret)
 	return NULL;
     }
@@ -294,7 +107,7 @@ process_equivalence (unsigned char * conc, vec_t * prems, const char * rule)
       if (prems->num_stuff != 1)
 	return _("Distribution requires one (1) reference.");
 
-      ret = proc_dt (prem, conc, -1);
+      ret = proc_dt (prem, conc);
       if (!ret)
 	return NULL;
     } /* End of distribution. */
@@ -342,1168 +155,792 @@ process_equivalence (unsigned char * conc, vec_t * prems, const char * rule)
   return ret;
 }
 
-char *
-proc_im (unsigned char * prem, unsigned char * conc)
+/* Checks one side of Implication.
+ *  input:
+ *    dis - the disjunction, such as (<o> (<n> A) B).
+ *    con - the conditional, such as (<i> A B).
+ *  output:
+ *    CORRECT if they agree, an error message otherwise, or NULL on error.
+ */
+static char *
+im_check (sexpr_node * dis, sexpr_node * con)
 {
-  unsigned char * dis_sen, * con_sen;
-  int d_len;
-
-  sen_put_len (prem, conc, &con_sen, &dis_sen);
-  d_len = strlen (dis_sen);
-
-  int i;
-
-  i = find_difference (dis_sen, con_sen);
-  if (i == -1)
-    return NO_DIFFERENCE;
+  sexpr_node * l0[2], * l1[2];
+  char * ret;
 
-  // i might be zero if this is an incorrect usage of im.
-  // same with i == 1.
-  // Only occurs if there is no top connective on one, or a quantifier.
+  if (dis->conn != OR_CONN)
+    return _("One sentence must contain a disjunction.");
 
-  if (i < 2)
+  if (!SEXPR_IS_BINARY (dis, OR_CONN) || !SEXPR_IS_BINARY (con, CON_CONN))
     return _("Implication constructed incorrectly.");
 
-  int tmp_pos;
-  unsigned char * tmp_str;
-
-  tmp_pos = parse_parens (dis_sen, i - 2, &tmp_str);
-  if (tmp_pos == AEC_MEM)
-    return NULL;
-  if (!tmp_str)
-    return _("Implication constructed incorrectly.");
-
-  int ftc;
-  unsigned char * lsen, * rsen, * n_lsen;
-
-  ftc = sexpr_find_top_connective (tmp_str, S_OR, &lsen, &rsen);
-  if (ftc == AEC_MEM)
-    return NULL;
-
-  free (tmp_str);
-
-  if (ftc < 0)
-    {
-      if (lsen)  free (lsen);
-      if (rsen)  free (rsen);
-
-      return _("One sentence must contain a disjunction.");
-    }
+  if (!SEXPR_IS_NOT (dis->kids[1]))
+    return _("The left disjunct must have a negation.");
 
-  if (!sexpr_not_check (lsen))
-    {
-      free (lsen); free (rsen);
-      return _("The left disjunct must have a negation.");
-    }
+  l0[0] = dis->kids[1]->kids[1];  l1[0] = con->kids[1];
+  l0[1] = dis->kids[2];           l1[1] = con->kids[2];
 
-  n_lsen = sexpr_elim_not (lsen);
-  if (!n_lsen)
+  ret = sexpr_tree_equiv_list (l0, l1, 2, im_rule);
+  if (!ret)
     return NULL;
 
-  free (lsen);
-
-  // Construct what should be the other sentence.
+  if (SEXPR_TREE_OK (ret))
+    return CORRECT;
 
-  unsigned char * oth_sen;
-  oth_sen = construct_other (dis_sen, i - 1, tmp_pos, d_len - 3 - S_NL,
-			     "%s %s %s", S_CON, n_lsen, rsen);
-  if (!oth_sen)
-    return NULL;
+  return _("Implication constructed incorrectly.");
+}
 
-  free (n_lsen);
-  free (rsen);
+static char *
+im_rule (sexpr_node * n0, sexpr_node * n1)
+{
+  int ret;
 
-  char * ret_str;
-  if (dis_sen == conc)
-    ret_str = proc_im (con_sen, oth_sen);
-  else
-    ret_str = proc_im (oth_sen, con_sen);
-  if (!ret_str)
+  ret = rule_template_apply ("im", n0, n1, im_rule);
+  if (ret == AEC_MEM)
     return NULL;
 
-  free (oth_sen);
-  if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
+  if (ret)
     return CORRECT;
 
-  return _("Implication constructed incorrectly.");
+  // Otherwise, find what is wrong with the sentences.
+  if (n1->conn == OR_CONN && n0->conn != OR_CONN)
+    return im_check (n1, n0);
+
+  return sexpr_tree_either (n0, n1, im_check);
 }
 
 char *
-proc_dm (unsigned char * prem, unsigned char * conc, int mode_guess)
+proc_im (unsigned char * prem, unsigned char * conc)
 {
-  int i;
-  i = find_difference (prem, conc);
-  if (i == -1)
-    return NO_DIFFERENCE;
+  return sexpr_tree_process (prem, conc, im_rule);
+}
 
-  int p_len, c_len, mode;
+/* Determines whether one sentence is the negation of another by DeMorgan.
+ *  input:
+ *    pos - the sentence being negated.
+ *    neg - the sentence that should be its negation.
+ *  output:
+ *    CORRECT if neg negates pos, an error message otherwise,
+ *    or NULL on error.
+ */
+static char *
+dm_negates (sexpr_node * pos, sexpr_node * neg)
+{
+  char * ret;
+  int i;
 
-  if (mode_guess == -1)
-    {
-      p_len = strlen (prem);
-      c_len = strlen (conc);
-      if (p_len != c_len)
-	mode = 0;
-      else
-	mode = 1;
-    }
-  else
-    {
-      mode = mode_guess;
-    }
+  if (SEXPR_IS_NOT (neg))
+    return sexpr_tree_equiv (pos, neg->kids[1], dm_rule);
 
-  if (mode == 0)
+  if ((pos->conn == AND_CONN && neg->conn == OR_CONN)
+      || (pos->conn == OR_CONN && neg->conn == AND_CONN))
     {
-      // Determine which sentence has the negation on it.
-
-      unsigned char * not_sen, * oth_sen;
-      int n_len;
-
-      if (i == 0)
+      if (pos->num_kids != neg->num_kids)
 	return _("DeMorgan constructed incorrectly.");
 
-      if (!strncmp (prem + i - 1, S_NOT, S_NL))
-	{
-	  not_sen = prem;  n_len = p_len;
-	  oth_sen = conc;
-	}
-      else if (!strncmp (conc + i - 1, S_NOT, S_NL))
-	{
-	  not_sen = conc;  n_len = c_len;
-	  oth_sen = prem;
-	}
-      else
+      for (i = 1; i < pos->num_kids; i++)
 	{
-	  return _("There must be a negation at the difference.");
-	}
+	  ret = dm_negates (pos->kids[i], neg->kids[i]);
+	  if (!ret)
+	    return NULL;
 
-      // Determine the scope, and remove the negation.
+	  if (!SEXPR_TREE_OK (ret))
+	    return ret;
+	}
 
-      int tmp_pos;
-      unsigned char * tmp_str;
+      return CORRECT;
+    }
 
-      tmp_pos = parse_parens (not_sen, i - 2, &tmp_str);
-      if (tmp_pos == AEC_MEM)
-	return NULL;
-      if (!tmp_str)
+  if (SEXPR_IS_QUANT (pos) && SEXPR_IS_QUANT (neg) && pos->conn != neg->conn)
+    {
+      if (!sexpr_node_equal (SEXPR_QUANT_VAR (pos), SEXPR_QUANT_VAR (neg)))
 	return _("DeMorgan constructed incorrectly.");
 
-      unsigned char * elim_sen;
-
-      elim_sen = sexpr_elim_not (tmp_str);
-      if (!elim_sen)
-	return NULL;
-      free (tmp_str);
-
-      int gg;
-      vec_t * gg_vec;
-      unsigned char conn[S_CL + 1];
-
-      gg_vec = init_vec (sizeof (char *));
-      if (!gg_vec)
-	return NULL;
-
-      conn[0] = '\0';
-      gg = sexpr_get_generalities (elim_sen, conn, gg_vec);
-      if (gg == AEC_MEM)
-	return NULL;
-      free (elim_sen);
+      return dm_negates (pos->kids[1], neg->kids[1]);
+    }
 
-      if (gg == 1)
-	{
-	  destroy_str_vec (gg_vec);
-	  return _("There must be generalities on the negation sentence.");
-	}
+  if (SEXPR_IS_QUANT (pos))
+    return _("DeMorgan constructed incorrectly.");
 
-      if (strcmp (conn, S_AND) && strcmp (conn, S_OR))
-	{
-	  destroy_str_vec (gg_vec);
-	  return _("The negation sentence must be negating either a conjunction or a disjunction.");
-	}
+  return _("The negation sentence must be negating either a conjunction or a disjunction.");
+}
 
-      unsigned char oth_conn[S_CL + 1];
-      int j;
+static char *
+dm_rule (sexpr_node * n0, sexpr_node * n1)
+{
+  char * ret = _("There must be a negation at the difference.");
+  int tmpl;
 
-      if (!strcmp (conn, S_AND))
-	strcpy (oth_conn, S_OR);
-      else
-	strcpy (oth_conn, S_AND);
+  tmpl = rule_template_apply ("dm", n0, n1, dm_rule);
+  if (tmpl == AEC_MEM)
+    return NULL;
 
-      // Construct what should be the other sentence.
+  if (tmpl)
+    return CORRECT;
 
-      unsigned char * cons_sen;
-      int cons_pos, alloc_size;
+  // Negations of more than two parts are not covered by the templates.
 
-      alloc_size = n_len + (gg_vec->num_stuff - 1) * (S_NL + 3);
-      cons_sen = (unsigned char *) calloc (alloc_size + 1, sizeof (char));
-      CHECK_ALLOC (cons_sen, NULL);
-      strncpy (cons_sen, not_sen, i - 1);
-      cons_pos = i - 1;
+  if (SEXPR_IS_NOT (n0))
+    {
+      ret = dm_negates (n0->kids[1], n1);
+      if (!ret)
+	return NULL;
 
-      cons_pos += sprintf (cons_sen + cons_pos, "%s", oth_conn);
+      if (SEXPR_TREE_OK (ret))
+	return CORRECT;
+    }
 
-      for (j = 0; j < gg_vec->num_stuff; j++)
-	{
-	  cons_pos += sprintf (cons_sen + cons_pos, " (%s %s)",
-			       S_NOT, vec_str_nth (gg_vec, j));
-	}
+  if (SEXPR_IS_NOT (n1))
+    {
+      ret = dm_negates (n1->kids[1], n0);
+      if (!ret)
+	return NULL;
 
-      strcpy (cons_sen + cons_pos, not_sen + tmp_pos);
+      if (SEXPR_TREE_OK (ret))
+	return CORRECT;
+    }
 
-      destroy_str_vec (gg_vec);
+  return ret;
+}
 
-      char * ret_str;
-      if (not_sen == conc)
-	ret_str = proc_dm (oth_sen, cons_sen, 0);
-      else
-	ret_str = proc_dm (cons_sen, oth_sen, 0);
-      if (!ret_str)
-	return NULL;
+char *
+proc_dm (unsigned char * prem, unsigned char * conc)
+{
+  return sexpr_tree_process (prem, conc, dm_rule);
+}
 
-      free (cons_sen);
-      if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
-	return CORRECT;
+/* Collects the arguments of a conjunction or disjunction, along with
+ *  the arguments of any like conjunctions or disjunctions within it.
+ *  input:
+ *    node - the conjunction or disjunction.
+ *    out - receives the arguments, or NULL to only count them.
+ *  output:
+ *    the number of arguments.
+ */
+static int
+as_flatten (sexpr_node * node, sexpr_node ** out)
+{
+  int i, num = 0;
 
-      return _("DeMorgan constructed incorrectly.");
-    }
-  else
+  for (i = 1; i < node->num_kids; i++)
     {
-      unsigned char * not_sen, * oth_sen;
-      int n_len;
+      sexpr_node * kid = node->kids[i];
 
-      if (!strncmp (prem + i, S_NOT, S_NL))
-	{
-	  not_sen = prem;  n_len = p_len;
-	  oth_sen = conc;
-	}
-      else if (!strncmp (conc + i, S_NOT, S_NL))
+      if (kid->conn == node->conn && kid->num_kids > 2)
 	{
-	  not_sen = conc;  n_len = c_len;
-	  oth_sen = prem;
+	  num += as_flatten (kid, out ? out + num : NULL);
 	}
       else
 	{
-	  return _("There must be a negation at the difference.");
+	  if (out)
+	    out[num] = kid;
+	  num++;
 	}
+    }
 
-      int tmp_pos;
-      unsigned char * tmp_str, * elim_sen;
-
-      tmp_pos = parse_parens (not_sen, i - 1, &tmp_str);
-      if (tmp_pos == AEC_MEM)
-	return NULL;
-      if (!tmp_str)
-	return _("DeMorgan constructed incorrectly.");
-
-      elim_sen = sexpr_elim_not (tmp_str);
-      if (!elim_sen)
-	return NULL;
-      free (tmp_str);
-
-      if (elim_sen[1] != '(')
-	return _("There must be a quantifier after the negation.");
+  return num;
+}
 
-      unsigned char * cmp_str;
-      unsigned char quant[S_CL + 1], oth_quant[S_CL + 1];
-      unsigned char * var;
+static char *
+as_rule (sexpr_node * n0, sexpr_node * n1)
+{
+  sexpr_node ** l0, ** l1;
+  int num;
+  char * ret;
 
-      cmp_str = sexpr_elim_quant (elim_sen, quant, &var);
-      if (!cmp_str)
-	return NULL;
+  num = rule_template_apply ("as", n0, n1, as_rule);
+  if (num == AEC_MEM)
+    return NULL;
 
-      if (cmp_str[0] == '\0')
-	return _("DeMorgan constructed incorrectly.");
+  if (num)
+    return CORRECT;
 
-      if (!strncmp (quant, S_UNV, S_CL))
-	strcpy (oth_quant, S_EXL);
-      else if (!strncmp (quant, S_EXL, S_CL))
-	strcpy (oth_quant, S_UNV);
-      else
-	return _("There must be a quantifier after the negation.");
+  // Otherwise, compare the parts of each side once they are regrouped.
+  if ((n0->conn != AND_CONN && n0->conn != OR_CONN) || n0->conn != n1->conn)
+    return _("Association must be done on a conjunction or disjunction.");
 
-      // Construct what should be the other sentence.
+  num = as_flatten (n0, NULL);
+  if (num != as_flatten (n1, NULL))
+    return _("Association constructed incorrectly.");
 
-      unsigned char * cons_sen;
-      int alloc_size;
+  l0 = (sexpr_node **) calloc (num, sizeof (sexpr_node *));
+  CHECK_ALLOC (l0, NULL);
 
-      alloc_size = n_len;
-      cons_sen = construct_other (not_sen, i - 1, tmp_pos + 1, alloc_size,
-				  "((%s %s) (%s %s))",
-				  oth_quant, var, S_NOT, cmp_str);
-      free (cmp_str);
-      free (var);
+  l1 = (sexpr_node **) calloc (num, sizeof (sexpr_node *));
+  CHECK_ALLOC (l1, NULL);
 
-      char * ret_str;
+  as_flatten (n0, l0);
+  as_flatten (n1, l1);
 
-      if (not_sen == conc)
-	ret_str = proc_dm (oth_sen, cons_sen, 1);
-      else
-	ret_str = proc_dm (cons_sen, oth_sen, 1);
-      if (!ret_str)
-	return NULL;
+  ret = sexpr_tree_equiv_list (l0, l1, num, as_rule);
+  free (l0);
+  free (l1);
 
-      free (cons_sen);
+  if (!ret)
+    return NULL;
 
-      if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
-	return CORRECT;
+  if (SEXPR_TREE_OK (ret))
+    return CORRECT;
 
-      return _("DeMorgan constructed incorrectly.");
-    }
+  return _("Association constructed incorrectly.");
 }
 
 char *
 proc_as (unsigned char * prem, unsigned char * conc)
 {
-  // At the difference:
-  // rollback sh_sen;
-  // sexpr_find_unmatched
-  // run checks on the larger sentence.
-  // strip the connective and recurse.
-
-  unsigned char * ln_sen, * sh_sen;
-  int l_len;
-
-  sen_put_len (prem, conc, &sh_sen, &ln_sen);
-  l_len = strlen (ln_sen);
-
-  int i;
-  i = find_difference (ln_sen, sh_sen);
-  if (i == -1)
-    return NO_DIFFERENCE;
-
-  int li, si;
-
-  si = li = i;
-  if (sh_sen[si] == '(')
-    si--;
+  return sexpr_tree_process (prem, conc, as_rule);
+}
 
-  if (si < 0)
-    return _("There must be a connective in both sentences.");
+/* Pairs each part of one conjunction or disjunction with a part of another.
+ *  input:
+ *    l0, l1 - the parts of each.
+ *    num - the number of parts in each.
+ *    rule - the rule by which the paired parts must agree.
+ *  output:
+ *    1 if every part of l0 agrees with a part of l1 by rule, 0 if not,
+ *    or -1 on memory error.
+ */
+static int
+co_pair (sexpr_node ** l0, sexpr_node ** l1, int num, sexpr_rule_func rule)
+{
+  char * used, * ret;
+  int i, j;
 
-  si = find_unmatched_o_paren (sh_sen, si);
-  if (si == -1)
-    return _("There must be a connective in both sentences.");
+  used = (char *) calloc (num, sizeof (char));
+  CHECK_ALLOC (used, AEC_MEM);
 
-  if (ln_sen[li] != '(')
+  for (i = 0; i < num; i++)
     {
-      li = find_unmatched_o_paren (ln_sen, li);
-      if (li == -1)
-	return _("There must be a connective in both sentences.");
-    }
-
-  int ret_chk;
-  ret_chk = sexpr_find_unmatched (ln_sen, sh_sen, &li, &si);
-  if (ret_chk == AEC_MEM)
-    return NULL;
+      for (j = 0; j < num; j++)
+	{
+	  if (used[j])
+	    continue;
 
-  int tmp_pos;
-  unsigned char * tmp_str;
-  tmp_pos = parse_parens (ln_sen, li, &tmp_str);
-  if (tmp_pos == AEC_MEM)
-    return NULL;
-  if (!tmp_str || tmp_pos < 0)
-    {
-      if (tmp_str) free (tmp_str);
-      return _("Association constructed incorrectly.");
-    }
-  free (tmp_str);
+	  ret = sexpr_tree_equiv (l0[i], l1[j], rule);
+	  if (!ret)
+	    {
+	      free (used);
+	      return AEC_MEM;
+	    }
 
-  int ti;
-  ti = li - 1;
-  if (ti < 0)
-    return _("Association constructed incorrectly.");
+	  if (SEXPR_TREE_OK (ret))
+	    break;
+	}
 
-  ti = find_unmatched_o_paren (ln_sen, ti);
+      if (j == num)
+	{
+	  free (used);
+	  return 0;
+	}
 
-  if (strncmp (ln_sen + ti + 1, S_AND, S_CL)
-      && strncmp (ln_sen + ti + 1, S_OR, S_CL)
-      && strncmp (ln_sen + ti + 1, ln_sen + li + 1, S_CL))
-    {
-      return _("Association must be done on a conjunction or disjunction.");
+      used[j] = 1;
     }
 
-  unsigned char * oth_sen;
-  int oth_pos;
-
-  oth_sen = (unsigned char *) calloc (l_len - 2 - S_CL, sizeof (char));
-  CHECK_ALLOC (oth_sen, NULL);
-  strncpy (oth_sen, ln_sen, li);
-  oth_pos = li;
-
-  strncpy (oth_sen + oth_pos, ln_sen + li + S_CL + 2, tmp_pos - li - 2 - S_CL);
-  oth_pos += tmp_pos - li - 2 - S_CL;
-
-  strcpy (oth_sen + oth_pos, ln_sen + tmp_pos + 1);
+  free (used);
+  return 1;
+}
 
-  char * ret_str;
+static char *
+co_rule (sexpr_node * n0, sexpr_node * n1)
+{
+  int ret;
 
-  if (ln_sen == conc)
-    ret_str = proc_as (sh_sen, oth_sen);
-  else
-    ret_str = proc_as (oth_sen, sh_sen);
-  if (!ret_str)
+  ret = rule_template_apply ("co", n0, n1, co_rule);
+  if (ret == AEC_MEM)
     return NULL;
 
-  free (oth_sen);
-  if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
+  if (ret)
     return CORRECT;
 
-  return _("Association constructed incorrectly.");
-}
+  // Otherwise, the parts of one side must be those of the other, reordered.
+  if ((n0->conn != AND_CONN && n0->conn != OR_CONN) || n0->conn != n1->conn)
+    return _("Commutativity must be done on a conjunction or disjunction.");
 
-char *
-proc_co (unsigned char * prem, unsigned char * conc)
-{
-  int ret_chk;
-  ret_chk = recurse_mode (prem, conc, MODE_CO);
-  if (ret_chk == AEC_MEM)
-    return NULL;
+  if (n0->num_kids != n1->num_kids)
+    return _("Commutativity constructed incorrectly.");
 
-  switch (ret_chk)
-    {
-    case 0:
-      return CORRECT;
-    case -3:
-      return NO_DIFFERENCE;
-    default:
-      return _("Commutativity constructed incorrectly.");
-    }
-}
-
-char *
-proc_id (unsigned char * prem, unsigned char * conc)
-{
-  unsigned char * ln_sen, * sh_sen;
-  sen_put_len (prem, conc, &sh_sen, &ln_sen);
-
-  int ret_chk;
-  ret_chk = recurse_mode (ln_sen, sh_sen, MODE_ID);
-  if (ret_chk == AEC_MEM)
+  ret = co_pair (n0->kids + 1, n1->kids + 1, n0->num_kids - 1, co_rule);
+  if (ret == AEC_MEM)
     return NULL;
 
-  switch (ret_chk)
-    {
-    case 0:
-      return CORRECT;
-    case -3:
-      return NO_DIFFERENCE;
-    default:
-      return _("Idempotence constructed incorrectly.");
-    }
+  return (ret) ? CORRECT : _("Commutativity constructed incorrectly.");
 }
 
 char *
-proc_dt (unsigned char * prem, unsigned char * conc, int mode_guess)
+proc_co (unsigned char * prem, unsigned char * conc)
 {
-  unsigned char * ln_sen, * sh_sen;
-  int s_len, l_len;
-
-  sen_put_len (prem, conc, &sh_sen, &ln_sen);
-  s_len = strlen (sh_sen);
-  l_len = strlen (ln_sen);
-
-  int mode, i;
+  return sexpr_tree_process (prem, conc, co_rule);
+}
 
-  i = find_difference (ln_sen, sh_sen);
-  if (i == -1)
-    return NO_DIFFERENCE;
+static char * id_rule (sexpr_node * n0, sexpr_node * n1);
 
-  if (l_len == s_len)
-    return _("The two sentences must be of different lengths.");
+/* Checks one side of Idempotence.
+ *  input:
+ *    ln - the longer sentence, such as (<a> A A B).
+ *    sh - the shorter sentence, such as (<a> A B) or A.
+ *  output:
+ *    CORRECT if they agree, an error message otherwise, or NULL on error.
+ */
+static char *
+id_check (sexpr_node * ln, sexpr_node * sh)
+{
+  char * ret;
+  int i, j;
 
-  if (mode_guess == -1)
-    mode = (sh_sen[i] == '(') ? 1 : 0;
-  else
-    mode = mode_guess;
+  if (ln->conn != AND_CONN && ln->conn != OR_CONN)
+    return _("Idempotence must be done on a conjunction or disjunction.");
 
-  if (mode == 0)
+  if (sh->conn != ln->conn)
     {
-      int tmp_pos;
-      unsigned char * tmp_str;
-
-      if (i < 2
-	  || (strncmp (sh_sen + i - 1, S_AND, S_CL)
-	      &&  strncmp (sh_sen + i - 1, S_OR, S_CL)))
+      // Each part of the longer sentence is the shorter one.
+      for (i = 1; i < ln->num_kids; i++)
 	{
-	  return _("The top connective must change between sentences.");
-	}
-
-      tmp_pos = parse_parens (sh_sen, i - S_CL + 1, &tmp_str);
-      if (tmp_pos == -2)
-	return NULL;
-      if (!tmp_str)
-	return _("Distribution constructed incorrectly.");
+	  ret = sexpr_tree_equiv (ln->kids[i], sh, id_rule);
+	  if (!ret)
+	    return NULL;
 
-      int ftc;
-      unsigned char * lsen, * rsen, mc[S_CL + 1];
-      
-      mc[0] = '\0';
-
-      ftc = sexpr_find_top_connective (tmp_str, mc, &lsen, &rsen);
-      if (ftc == AEC_MEM)
-	return NULL;
-      free (tmp_str);
+	  if (!SEXPR_TREE_OK (ret))
+	    return _("Idempotence constructed incorrectly.");
+	}
 
-      if (ftc < 0)
-	{
-	  if (lsen)  free (lsen);
-	  if (rsen)  free (rsen);
+      return CORRECT;
+    }
 
-	  return _("There must be only two parts for distribution.");
-	}
+  // Each part of the longer sentence is a part of the shorter one.
+  if (sh->num_kids > ln->num_kids)
+    return _("Idempotence constructed incorrectly.");
 
-      if (strcmp (mc, S_AND) && strcmp (mc, S_OR))
+  for (i = 1; i < ln->num_kids; i++)
+    {
+      for (j = 1; j < sh->num_kids; j++)
 	{
-	  free (lsen); free (rsen);
+	  ret = sexpr_tree_equiv (ln->kids[i], sh->kids[j], id_rule);
+	  if (!ret)
+	    return NULL;
 
-	  return _("Distribution must be done around a conjunction or a disjunction.");
+	  if (SEXPR_TREE_OK (ret))
+	    break;
 	}
 
-      int r_gg, r_len;
-      unsigned char rc[S_CL + 1];
-      vec_t * rsens;
-
-      r_len = strlen (rsen);
-      rsens = init_vec (sizeof (char *));
-      if (!rsens)
-	return NULL;
-
-      rc[0] = '\0';
-      r_gg = sexpr_get_generalities (rsen, rc, rsens);
-      if (r_gg == AEC_MEM)
-	return NULL;
-      free (rsen);
+      if (j == sh->num_kids)
+	return _("Idempotence constructed incorrectly.");
+    }
 
-      if (r_gg == 1)
+  // And each part of the shorter one is still there.
+  for (j = 1; j < sh->num_kids; j++)
+    {
+      for (i = 1; i < ln->num_kids; i++)
 	{
-	  free (lsen);
-	  destroy_str_vec (rsens);
+	  ret = sexpr_tree_equiv (ln->kids[i], sh->kids[j], id_rule);
+	  if (!ret)
+	    return NULL;
 
-	  return _("There must be more than one generality for distribution.");
+	  if (SEXPR_TREE_OK (ret))
+	    break;
 	}
 
-      unsigned char * oth_sen;
-      int oth_pos, j, alloc_size;
-
-      // length of lsen + S_CL (mc) + 4 (two spaces, two parens)
-      // r_len - 1 (both of the parentheses, plus one for the null byte).
-      alloc_size = s_len + (strlen (lsen) + S_CL + 4) * rsens->num_stuff + r_len - 1;
-      oth_sen = (unsigned char *) calloc (alloc_size,  sizeof (char));
-      CHECK_ALLOC (oth_sen, NULL);
-      strncpy (oth_sen, sh_sen, i - 1);
-      oth_pos = i - 1;
-
-      oth_pos += sprintf (oth_sen + oth_pos, "%s", rc);
+      if (i == ln->num_kids)
+	return _("Idempotence constructed incorrectly.");
+    }
 
-      for (j = 0; j < rsens->num_stuff; j++)
-	{
-	  oth_pos += sprintf (oth_sen + oth_pos, " (%s %s %s)",
-			      mc, lsen, vec_str_nth (rsens, j));
-	}
+  return CORRECT;
+}
 
-      strcpy (oth_sen + oth_pos, sh_sen + tmp_pos);
+static char *
+id_rule (sexpr_node * n0, sexpr_node * n1)
+{
+  int ret;
 
-      free (lsen);
-      destroy_str_vec (rsens);
+  ret = rule_template_apply ("id", n0, n1, id_rule);
+  if (ret == AEC_MEM)
+    return NULL;
 
-      char * ret_str;
+  if (ret)
+    return CORRECT;
 
-      if (sh_sen == conc)
-	ret_str = proc_dt (ln_sen, oth_sen, 0);
-      else
-	ret_str = proc_dt (oth_sen, ln_sen, 0);
+  return sexpr_tree_either (n0, n1, id_check);
+}
 
-      if (!ret_str)
-	return NULL;
+char *
+proc_id (unsigned char * prem, unsigned char * conc)
+{
+  return sexpr_tree_process (prem, conc, id_rule);
+}
 
-      free (oth_sen);
-      if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
-	return CORRECT;
+/* Checks one side of Distribution.
+ *  input:
+ *    fac - the factored sentence, such as (<a> A (<o> B C))
+ *          or ((<u> x) (<a> P Q)).
+ *    dis - the distributed sentence, such as (<o> (<a> A B) (<a> A C))
+ *          or (<a> ((<u> x) P) ((<u> x) Q)).
+ *  output:
+ *    CORRECT if they agree, an error message otherwise, or NULL on error.
+ */
+static char *
+dt_check (sexpr_node * fac, sexpr_node * dis)
+{
+  sexpr_node * inner, * l0[2], * l1[2];
+  char * ret;
+  int i;
 
-      return _("Distribution constructed incorrectly.");
-    }
-  else
+  if (SEXPR_IS_QUANT (fac))
     {
-      unsigned char * tmp_str;
-      int tmp_pos;
+      inner = fac->kids[1];
 
-      if (mode_guess != -1)
-	{
-	  if (sh_sen[i] != '(')
-	    return _("The difference must be a quantifier.");
-	}
+      if ((fac->conn != UNV_CONN || inner->conn != AND_CONN)
+	  && (fac->conn != EXL_CONN || inner->conn != OR_CONN))
+	return _("A universal is distributed over a conjnction, and an existential is distributed over a disjunction.");
 
-      tmp_pos = parse_parens (sh_sen, i - 1, &tmp_str);
-      if (tmp_pos == AEC_MEM)
-	return NULL;
-      if (!tmp_str)
+      if (dis->conn != inner->conn || dis->num_kids != inner->num_kids)
 	return _("Distribution constructed incorrectly.");
 
-      unsigned char * scope, * var, quant[S_CL + 1];
-      int v_len;
-
-      scope = sexpr_elim_quant (tmp_str, quant, &var);
-      if (!scope)
-	return NULL;
-      if (scope[0] == '\0')
-	return _("Distribution constructed incorrectly.");
-      v_len = strlen (var);
-      free (tmp_str);
+      for (i = 1; i < dis->num_kids; i++)
+	{
+	  sexpr_node * kid = dis->kids[i];
 
-      int gg;
-      vec_t * gg_vec;
-      unsigned char conn[S_CL + 1];
+	  if (!SEXPR_IS_QUANT (kid)
+	      || !sexpr_node_equal (SEXPR_HEAD (kid), SEXPR_HEAD (fac)))
+	    return _("Distribution constructed incorrectly.");
 
-      conn[0] = '\0';
-      gg_vec = init_vec (sizeof (char *));
-      if (!gg_vec)
-	return NULL;
+	  ret = sexpr_tree_equiv (inner->kids[i], kid->kids[1], dt_rule);
+	  if (!ret)
+	    return NULL;
 
-      gg = sexpr_get_generalities (scope, conn, gg_vec);
-      if (gg == AEC_MEM)
-	return NULL;
-      free (scope);
-
-      if (gg == 1)
-	{
-	  destroy_str_vec (gg_vec);
-	  return _("Distribution constructed incorrectly.");
+	  if (!SEXPR_TREE_OK (ret))
+	    return _("Distribution constructed incorrectly.");
 	}
 
-      if ((strcmp (quant, S_UNV) || strcmp (conn, S_AND))
-	  && (strcmp (quant, S_EXL) || strcmp (conn, S_OR)))
-	{
-	  destroy_str_vec (gg_vec);
-	  return _("A universal is distributed over a conjnction, and an existential is distributed over a disjunction.");
-	}
+      return CORRECT;
+    }
 
-      unsigned char * oth_sen;
-      int oth_pos, j, alloc_size;
+  if (!SEXPR_IS_BINARY (fac, AND_CONN) && !SEXPR_IS_BINARY (fac, OR_CONN))
+    return _("Distribution must be done around a conjunction or a disjunction.");
 
-      alloc_size = s_len + (gg_vec->num_stuff * (6 + S_CL + v_len));
-      oth_sen = (unsigned char *) calloc (alloc_size + 1, sizeof (char));
-      CHECK_ALLOC (oth_sen, NULL);
-      strncpy (oth_sen, sh_sen, i - 1);
-      oth_pos = i - 1;
+  inner = fac->kids[2];
+  if ((inner->conn != AND_CONN && inner->conn != OR_CONN)
+      || inner->num_kids < 3)
+    return _("There must be more than one generality for distribution.");
 
-      oth_pos += sprintf (oth_sen + oth_pos, "(%s", conn);
+  if (dis->conn != inner->conn || dis->num_kids != inner->num_kids)
+    return _("The top connective must change between sentences.");
 
-      for (j = 0; j < gg_vec->num_stuff; j++)
-	{
-	  unsigned char * cur_gen;
-	  cur_gen = vec_str_nth (gg_vec, j);
-	  oth_pos += sprintf (oth_sen + oth_pos, " ((%s %s) %s)",
-			      quant, var, cur_gen);
-	}
-
-      oth_pos += sprintf (oth_sen + oth_pos, ")");
+  for (i = 1; i < dis->num_kids; i++)
+    {
+      sexpr_node * kid = dis->kids[i];
 
-      strcpy (oth_sen + oth_pos, sh_sen + tmp_pos + 1);
+      if (kid->num_kids != 3
+	  || !sexpr_node_equal (SEXPR_HEAD (kid), SEXPR_HEAD (fac)))
+	return _("Distribution constructed incorrectly.");
 
-      free (var);
-      destroy_str_vec (gg_vec);
+      l0[0] = fac->kids[1];    l1[0] = kid->kids[1];
+      l0[1] = inner->kids[i];  l1[1] = kid->kids[2];
 
-      char * ret_str;
-      if (sh_sen == conc)
-	ret_str = proc_dt (ln_sen, oth_sen, 1);
-      else
-	ret_str = proc_dt (oth_sen, ln_sen, 1);
-      if (!ret_str)
+      ret = sexpr_tree_equiv_list (l0, l1, 2, dt_rule);
+      if (!ret)
 	return NULL;
 
-      free (oth_sen);
-      if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
-	return CORRECT;
-
-      return _("Distribution constructed incorrectly.");      
+      if (!SEXPR_TREE_OK (ret))
+	return _("Distribution constructed incorrectly.");
     }
+
+  return CORRECT;
 }
 
-char *
-proc_eq (unsigned char * prem, unsigned char * conc)
+static char *
+dt_rule (sexpr_node * n0, sexpr_node * n1)
 {
-  unsigned char * bic_sen, * oth_sen;
-  int b_len;
+  int ret;
 
-  sen_put_len (prem, conc, &bic_sen, &oth_sen);
-  b_len = strlen (bic_sen);
-
-  int i;
-  i = find_difference (bic_sen, oth_sen);
-  if (i == -1)
-    return NO_DIFFERENCE;
-
-  if (i < 2)
-    return _("Equivalence constructed incorrectly.");
-
-  int tmp_pos;
-  unsigned char * tmp_str;
-
-  tmp_pos = parse_parens (bic_sen, i - 2, &tmp_str);
-  if (tmp_pos == AEC_MEM)
+  ret = rule_template_apply ("dt", n0, n1, dt_rule);
+  if (ret == AEC_MEM)
     return NULL;
-  if (!tmp_str)
-    return _("Equivalence constructed incorrectly.");
-
-  int ftc;
-  unsigned char * lsen, * rsen;
 
-  lsen = rsen = NULL;
-  ftc = sexpr_find_top_connective (tmp_str, S_BIC, &lsen, &rsen);
-  if (ftc == AEC_MEM)
-    return NULL;
-  free (tmp_str);
+  if (ret)
+    return CORRECT;
 
-  if (ftc < 0)
-    {
-      if (lsen)  free (lsen);
-      if (rsen)  free (rsen);
+  // The factored sentence is the shorter one.
+  if (n1->len < n0->len)
+    return sexpr_tree_either (n1, n0, dt_check);
 
-      return _("There must be a biconditional in one sentence.");
-    }
-
-  unsigned char * cons_sen;
-  int alloc_size;
+  return sexpr_tree_either (n0, n1, dt_check);
+}
 
-  alloc_size = b_len + (tmp_pos - (i - 2) + 1) + S_CL + 4;
-  cons_sen = construct_other (bic_sen, i - 1, tmp_pos, alloc_size,
-			      "%s (%s %s %s) (%s %s %s)",
-			      S_AND, S_CON, lsen, rsen, S_CON, rsen, lsen);
+char *
+proc_dt (unsigned char * prem, unsigned char * conc)
+{
+  return sexpr_tree_process (prem, conc, dt_rule);
+}
 
-  if (!cons_sen)
-    return NULL;
+/* Checks one side of Equivalence.
+ *  input:
+ *    bic - the biconditional, such as (<b> A B).
+ *    oth - the other sentence, such as (<a> (<i> A B) (<i> B A)).
+ *  output:
+ *    CORRECT if they agree, an error message otherwise, or NULL on error.
+ */
+static char *
+eq_check (sexpr_node * bic, sexpr_node * oth)
+{
+  sexpr_node * l0[4], * l1[4];
+  char * ret;
 
-  free (lsen);
-  free (rsen);
+  if (!SEXPR_IS_BINARY (bic, BIC_CONN))
+    return _("There must be a biconditional in one sentence.");
 
-  char * ret_str;
+  if (!SEXPR_IS_BINARY (oth, AND_CONN)
+      || !SEXPR_IS_BINARY (oth->kids[1], CON_CONN)
+      || !SEXPR_IS_BINARY (oth->kids[2], CON_CONN))
+    return _("Equivalence constructed incorrectly.");
 
-  if (bic_sen == conc)
-    ret_str = proc_eq (oth_sen, cons_sen);
-  else
-    ret_str = proc_eq (cons_sen, oth_sen);
+  l0[0] = bic->kids[1];  l1[0] = oth->kids[1]->kids[1];
+  l0[1] = bic->kids[2];  l1[1] = oth->kids[1]->kids[2];
+  l0[2] = bic->kids[2];  l1[2] = oth->kids[2]->kids[1];
+  l0[3] = bic->kids[1];  l1[3] = oth->kids[2]->kids[2];
 
-  free (cons_sen);
+  ret = sexpr_tree_equiv_list (l0, l1, 4, eq_rule);
+  if (!ret)
+    return NULL;
 
-  if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
+  if (SEXPR_TREE_OK (ret))
     return CORRECT;
 
   return _("Equivalence constructed incorrectly.");
 }
 
-char *
-proc_dn (unsigned char * prem, unsigned char * conc)
+static char *
+eq_rule (sexpr_node * n0, sexpr_node * n1)
 {
-  // Standard long-short setup.
-
-  unsigned char * ln_sen, * sh_sen;
-  int l_len;
+  int ret;
 
-  sen_put_len (prem, conc, &sh_sen, &ln_sen);
-  l_len = strlen (ln_sen);
-
-  int i;
-  i = find_difference (ln_sen, sh_sen);
-  if (i == -1)
-    return NO_DIFFERENCE;
-
-  if (ln_sen[i] != '(' && strncmp (ln_sen + i, S_NOT, S_NL)
-      && (i > 0 && l_len > S_NL && strncmp (ln_sen + i - 1, S_NOT, S_NL)))
-    {
-      return _("Double Negation must be used to eliminate negations.");
-    }
-
-  if (ln_sen[i] != '(')
-    {
-      if (!strncmp (ln_sen + i, S_NOT, S_NL))
-	i--;
-      else
-	i -= 2;
-    }
-
-  int tmp_pos;
-  unsigned char * tmp_str;
-  tmp_pos = parse_parens (ln_sen, i, &tmp_str);
-  if (tmp_pos == AEC_MEM)
+  ret = rule_template_apply ("eq", n0, n1, eq_rule);
+  if (ret == AEC_MEM)
     return NULL;
-  if (!tmp_str)
-    return _("Double Negation constructed incorrectly.");
-
-  int pos;
-  int oth_pos;
-
-  pos = i;
-  if (!sexpr_not_check (tmp_str) || strncmp (tmp_str + S_NL + 3, S_NOT, S_NL))
-    {
-      free (tmp_str);
-      return _("Double Negation removes negations in pairs.");
-    }
 
-  free (tmp_str);
-  pos = i + 4 + 2 * S_NL;
-  // Begin removing pairs of negations, until there are no more pairs.
+  if (ret)
+    return CORRECT;
 
-  unsigned char * oth_sen;
-  int alloc_size;
+  // Otherwise, find what is wrong with the sentences.
+  if (n1->conn == BIC_CONN && n0->conn != BIC_CONN)
+    return eq_check (n1, n0);
 
-  alloc_size = l_len - S_NL * 2 - 6;
-  oth_sen = (unsigned char *) calloc (alloc_size + 1, sizeof (char));
-  CHECK_ALLOC (oth_sen, NULL);
-  strncpy (oth_sen, ln_sen, i);
-  oth_pos = i;
+  return sexpr_tree_either (n0, n1, eq_check);
+}
 
-  strncpy (oth_sen + oth_pos, ln_sen + pos, tmp_pos - pos - 1);
-  oth_pos += tmp_pos - pos - 1;
+char *
+proc_eq (unsigned char * prem, unsigned char * conc)
+{
+  return sexpr_tree_process (prem, conc, eq_rule);
+}
 
-  strcpy (oth_sen + oth_pos, ln_sen + tmp_pos + 1);
+/* Checks one side of Double Negation.
+ *  input:
+ *    dbl - the sentence with the negations, such as (<n> (<n> A)).
+ *    oth - the other sentence.
+ *  output:
+ *    CORRECT if they agree, an error message otherwise, or NULL on error.
+ */
+static char *
+dn_check (sexpr_node * dbl, sexpr_node * oth)
+{
+  char * ret;
 
-  char * ret_str;
+  if (!SEXPR_IS_NOT (dbl))
+    return _("Double Negation must be used to eliminate negations.");
 
-  if (ln_sen == conc)
-    ret_str = proc_dn (sh_sen, oth_sen);
-  else
-    ret_str = proc_dn (oth_sen, sh_sen);
+  if (!SEXPR_IS_NOT (dbl->kids[1]))
+    return _("Double Negation removes negations in pairs.");
 
-  if (!ret_str)
+  ret = sexpr_tree_equiv (dbl->kids[1]->kids[1], oth, dn_rule);
+  if (!ret)
     return NULL;
 
-  free (oth_sen);
-  if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
+  if (SEXPR_TREE_OK (ret))
     return CORRECT;
 
   return _("Double Negation constructed incorrectly.");
 }
 
-char *
-proc_ep (unsigned char * prem, unsigned char * conc)
+static char *
+dn_rule (sexpr_node * n0, sexpr_node * n1)
 {
-  /* First, determine which sentence is which. */
-
-  unsigned char * and_sen, * con_sen;
-  int p_len, c_len, a_len;
-
-  p_len = strlen (prem);
-  c_len = strlen (conc);
-
-  // Count number of conditionals in each sentence.
-
-  int i, c_cons = 0, p_cons = 0;
-
-  for (i = 0; i < p_len; i++)
-    {
-      if (!strncmp (prem + i, S_CON, S_CL))
-	p_cons++;
-
-      if (!strncmp (conc + i, S_CON, S_CL))
-	c_cons++;
-    }
-
-  if (c_cons > p_cons)
-    {
-      and_sen = prem;  a_len = p_len;
-      con_sen = conc;
-    }
-  else
-    {
-      and_sen = conc;  a_len = c_len;
-      con_sen = prem;
-    }
+  int ret;
 
-  /* Then, find the difference. */
-
-  i = find_difference (and_sen, con_sen);
-  if (i == -1)
-    return NO_DIFFERENCE;
-
-  /* Roll back to the start of the difference. */
-
-  int ai, ci;
-
-  ai = ci = i;
-
-  if (con_sen[ci] == '(')
-    {
-      ci--;
-      if (ci == -1)
-	return _("Exportation constructed incorrectly.");
-    }
-
-  ci = find_unmatched_o_paren (con_sen, ci);
-  if (ci == -1)
-    return _("There must be connectives on both sentences.");
-
-  if (and_sen[ai] != '(')
-    {
-      ai = find_unmatched_o_paren (and_sen, ai);
-      if (ai == -1)
-	return _("There must be connectives on both sentences.");
-    }
-
-  int ret_chk;
-  ret_chk = sexpr_find_unmatched (and_sen, con_sen, &ai, &ci);
-  if (ret_chk == AEC_MEM)
+  ret = rule_template_apply ("dn", n0, n1, dn_rule);
+  if (ret == AEC_MEM)
     return NULL;
 
-  ai--;
-  if (ai < 0)
-    return _("Exportation constructed incorrectly.");
-
-  ai = find_unmatched_o_paren (and_sen, ai);
-  if (ai == -1)
-    return _("Exportation constructed incorrectly.");
+  if (ret)
+    return CORRECT;
 
-  /* Get the sentence parts. */
-  
-  int tmp_pos;
-  unsigned char * tmp_str;
+  // Otherwise, find what is wrong with the sentences.
+  if (n1->len > n0->len)
+    return sexpr_tree_either (n1, n0, dn_check);
 
-  tmp_pos = parse_parens (and_sen, ai, &tmp_str);
-  if (tmp_pos == AEC_MEM)
-    return NULL;
+  return sexpr_tree_either (n0, n1, dn_check);
+}
 
-  int ftc;
-  unsigned char * lsen, * rsen;
+char *
+proc_dn (unsigned char * prem, unsigned char * conc)
+{
+  return sexpr_tree_process (prem, conc, dn_rule);
+}
 
-  lsen = rsen = NULL;
-  ftc = sexpr_find_top_connective (tmp_str, S_CON, &lsen, &rsen);
-  if (ftc == AEC_MEM)
-    return NULL;
-  free (tmp_str);
+/* Collects the antecedents of a chain of conditionals, splitting any
+ *  conjunction of antecedents into its parts.
+ *  input:
+ *    node - the first conditional of the chain.
+ *    ants - receives the antecedents, or NULL to only count them.
+ *    num - receives the number of antecedents.
+ *  output:
+ *    the consequent at the end of the chain.
+ */
+static sexpr_node *
+ep_chain (sexpr_node * node, sexpr_node ** ants, int * num)
+{
+  int i;
 
-  if (ftc < 0)
+  *num = 0;
+  while (SEXPR_IS_BINARY (node, CON_CONN))
     {
-      if (lsen)  free (lsen);
-      if (rsen)  free (rsen);
+      sexpr_node * ant = node->kids[1];
 
-      return _("There must be a conditional in both sentences.");
+      if (ant->conn == AND_CONN)
+	{
+	  for (i = 1; i < ant->num_kids; i++)
+	    {
+	      if (ants)
+		ants[*num] = ant->kids[i];
+	      (*num)++;
+	    }
+	}
+      else
+	{
+	  if (ants)
+	    ants[*num] = ant;
+	  (*num)++;
+	}
+
+      node = node->kids[2];
     }
 
-  vec_t * a_sens;
+  return node;
+}
 
-  a_sens = init_vec (sizeof (char *));
-  if (!a_sens)
-    return NULL;
+static char *
+ep_rule (sexpr_node * n0, sexpr_node * n1)
+{
+  sexpr_node ** l0, ** l1, * cons_0, * cons_1;
+  int num_0, num_1;
+  char * ret;
 
-  ftc = sexpr_get_generalities (lsen, S_AND, a_sens);
-  if (ftc == AEC_MEM)
+  num_0 = rule_template_apply ("ep", n0, n1, ep_rule);
+  if (num_0 == AEC_MEM)
     return NULL;
-  free (lsen);
 
-  if (ftc == 1)
-    {
-      destroy_str_vec (a_sens);
-      free (rsen);
-      return _("Exportation constructed incorrectly.");
-    }
-
-  /* Construct what should be the other sentence. */
+  if (num_0)
+    return CORRECT;
 
-  unsigned char * oth_sen;
-  int oth_pos, alloc_size;
+  // Otherwise, compare the chains of antecedents.
+  if (!SEXPR_IS_BINARY (n0, CON_CONN) || !SEXPR_IS_BINARY (n1, CON_CONN))
+    return _("There must be a conditional in both sentences.");
 
-  alloc_size = a_len + (3 + S_CL) * a_sens->num_stuff;
-  oth_sen = (unsigned char *) calloc (alloc_size + 1, sizeof (char));
-  CHECK_ALLOC (oth_sen, NULL);
-  strncpy (oth_sen, and_sen, ai);
-  oth_pos = ai;
+  ep_chain (n0, NULL, &num_0);
+  ep_chain (n1, NULL, &num_1);
+  if (num_0 != num_1)
+    return _("Exportation constructed incorrectly.");
 
-  for (i = 0; i < a_sens->num_stuff; i++)
-    {
-      oth_pos += sprintf (oth_sen + oth_pos, "(%s %s ",
-			  S_CON, vec_str_nth (a_sens, i));
-    }
+  // The consequent is compared along with the antecedents.
+  l0 = (sexpr_node **) calloc (num_0 + 1, sizeof (sexpr_node *));
+  CHECK_ALLOC (l0, NULL);
 
-  oth_pos += sprintf (oth_sen + oth_pos, "%s", rsen);
-  for (i = 0; i < a_sens->num_stuff; i++)
-    oth_pos += sprintf (oth_sen + oth_pos, ")");
+  l1 = (sexpr_node **) calloc (num_1 + 1, sizeof (sexpr_node *));
+  CHECK_ALLOC (l1, NULL);
 
-  destroy_str_vec (a_sens);
-  free (rsen);
+  cons_0 = ep_chain (n0, l0, &num_0);
+  cons_1 = ep_chain (n1, l1, &num_1);
+  l0[num_0] = cons_0;
+  l1[num_1] = cons_1;
 
-  strcpy (oth_sen + oth_pos, and_sen + tmp_pos + 1);
+  ret = sexpr_tree_equiv_list (l0, l1, num_0 + 1, ep_rule);
+  free (l0);
+  free (l1);
 
-  char * ret_str;
-  if (and_sen == conc)
-    ret_str = proc_ep (con_sen, oth_sen);
-  else
-    ret_str = proc_ep (oth_sen, con_sen);
-  if (!ret_str)
+  if (!ret)
     return NULL;
-  free (oth_sen);
 
-  if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
+  if (SEXPR_TREE_OK (ret))
     return CORRECT;
 
   return _("Exportation constructed incorrectly.");
 }
 
 char *
-proc_sb (unsigned char * prem, unsigned char * conc)
+proc_ep (unsigned char * prem, unsigned char * conc)
 {
-  // Standard long-short setup.
-
-  unsigned char * ln_sen, * sh_sen;
-  int l_len;
-
-  sen_put_len (prem, conc, &sh_sen, &ln_sen);
-  l_len = strlen (ln_sen);
-
-  int i;
-  i = find_difference (ln_sen, sh_sen);
-  if (i == -1)
-    return NO_DIFFERENCE;
-
-  // Standard find_unmatched setup.
-
-  int li, si;
-
-  si = li = i;
-  if (sh_sen[si] == '(')
-    {
-      si--;
-      if (si < 0)
-	return _("Subsumption constructed incorrectly.");
-    }
-  else if (si > 0
-	   && (!strncmp (sh_sen + si - 1, S_AND, S_CL)
-	       || !strncmp (sh_sen + si - 1, S_OR, S_CL)
-	       || !strncmp (sh_sen + si - 1, S_CON, S_CL)
-	       || !strncmp (sh_sen + si - 1, S_BIC, S_CL)))
-    {
-      while (sh_sen[si] != '(')
-	si--;
-      si--;
-    }
+  return sexpr_tree_process (prem, conc, ep_rule);
+}
 
-  si = find_unmatched_o_paren (sh_sen, si);
-  if (si == -1)
-    {
-      // This is the entire sentence.
-      li = 0;
-    }
-  else
-    {
-      if (ln_sen[li] != '(')
-	li = find_unmatched_o_paren (ln_sen, li);
-      if (li < 0)
-	return _("Subsumption constructed incorrectly.");
-
-      int ret_chk;
-      ret_chk = sexpr_find_unmatched (ln_sen, sh_sen, &li, &si);
-      if (ret_chk == AEC_MEM)
-	return NULL;
+/* Checks one side of Subsumption.
+ *  input:
+ *    ln - the longer sentence, such as (<a> A (<o> A B)).
+ *    sh - the shorter sentence.
+ *  output:
+ *    CORRECT if they agree, an error message otherwise, or NULL on error.
+ */
+static char *
+sb_check (sexpr_node * ln, sexpr_node * sh)
+{
+  sexpr_node * rsen;
+  char * ret;
 
-      if (li < 0)
-	return _("Subsumption constructed incorrectly.");
-    }
+  if (ln->conn != AND_CONN && ln->conn != OR_CONN)
+    return _("Subsumption must be done around a disjunction or a conjunction.");
 
-  if (ln_sen[li] != '(')
-    return _("There must be a connective in one sentence.");
+  if (ln->num_kids != 3)
+    return _("Subsumption must be done around a connective.");
 
-  int tmp_pos;
-  unsigned char * tmp_str;
+  rsen = ln->kids[2];
+  if (rsen->num_kids != 3
+      || (rsen->conn != AND_CONN && rsen->conn != OR_CONN))
+    return _("Subsumption must be done around two connectives.");
 
-  tmp_pos = parse_parens (ln_sen, li, &tmp_str);
-  if (tmp_pos == AEC_MEM)
-    return NULL;
-  if (!tmp_str)
-    return _("Subsumption constructed incorrectly.");
+  if (rsen->conn == ln->conn)
+    return _("The two connectives must be complementary to one another.");
 
-  int ftc;
-  unsigned char * t_lsen, * t_rsen, tconn[S_CL + 1];
+  if (!sexpr_node_equal (ln->kids[1], rsen->kids[1]))
+    return _("Both of the left sentences must be the same.");
 
-  tconn[0] = '\0';
-  t_lsen = t_rsen = NULL;
-  ftc = sexpr_find_top_connective (tmp_str, tconn, &t_lsen, &t_rsen);
-  if (ftc == AEC_MEM)
+  ret = sexpr_tree_equiv (ln->kids[1], sh, sb_rule);
+  if (!ret)
     return NULL;
 
-  free (tmp_str);
-
-  if (ftc < 0)
-    {
-      if (t_lsen)  free (t_lsen);
-      if (t_rsen)  free (t_rsen);
-
-      return _("Subsumption must be done around a connective.");
-    }
-
-  if (strcmp (tconn, S_AND) && strcmp (tconn, S_OR))
-    {
-      free (t_lsen); free (t_rsen);
+  if (SEXPR_TREE_OK (ret))
+    return CORRECT;
 
-      return _("Subsumption must be done around a disjunction or a conjunction.");
-    }
+  return _("Subsumption constructed incorrectly.");
+}
 
-  int r_len;
-  unsigned char * lsen, * rsen, conn[S_CL + 1];
+static char *
+sb_rule (sexpr_node * n0, sexpr_node * n1)
+{
+  int ret;
 
-  r_len = strlen (t_rsen);
-  conn[0] = '\0';
-  lsen = rsen = NULL;
-  ftc = sexpr_find_top_connective (t_rsen, conn, &lsen, &rsen);
-  if (ftc == AEC_MEM)
+  ret = rule_template_apply ("sb", n0, n1, sb_rule);
+  if (ret == AEC_MEM)
     return NULL;
-  free (t_rsen);
-  if (rsen)  free (rsen);
-
-  if (ftc < 0)
-    {
-      free (t_lsen);
-      if (lsen)  free (lsen);
-
-      return _("Subsumption must be done around two connectives.");
-    }
-
-  if ((strcmp (tconn, S_AND) || strcmp (conn, S_OR))
-      && (strcmp (tconn, S_OR) || strcmp (conn, S_AND)))
-    {
-      free (t_lsen);
-      free (lsen);
-
-      return _("The two connectives must be complementary to one another.");
-    }
-
-  if (strcmp (t_lsen, lsen))
-    {
-      free (t_lsen);
-      free (lsen);
-
-      return _("Both of the left sentences must be the same.");
-    }
-  free (lsen);
 
-  /* Construct what should be the other sentence. */
-
-  unsigned char * oth_sen;
-  int oth_pos, alloc_size;
-
-  alloc_size = l_len - r_len - S_CL - 4;
-
-  oth_sen = (unsigned char *) calloc (alloc_size + 1, sizeof (char));
-  CHECK_ALLOC (oth_sen, NULL);
-  strncpy (oth_sen, ln_sen, li);
-  oth_pos = li;
-
-  strcpy (oth_sen + oth_pos, t_lsen);
-  oth_pos += strlen (t_lsen);
-  free (t_lsen);
-
-  strcpy (oth_sen + oth_pos, ln_sen + tmp_pos + 1);
-
-  char * ret_str;
+  if (ret)
+    return CORRECT;
 
-  if (ln_sen == conc)
-    ret_str = proc_sb (sh_sen, oth_sen);
-  else
-    ret_str = proc_sb (oth_sen, sh_sen);
+  // Otherwise, find what is wrong with the sentences.
+  if (n1->len > n0->len)
+    return sexpr_tree_either (n1, n0, sb_check);
 
-  if (!ret_str)
-    return NULL;
-
-  free (oth_sen);
-  if (ret_str == NO_DIFFERENCE || ret_str == CORRECT)
-    return CORRECT;
+  return sexpr_tree_either (n0, n1, sb_check);
+}
 
-  return _("Subsumption constructed incorrectly.");
+char *
+proc_sb (unsigned char * prem, unsigned char * conc)
+{
+  return sexpr_tree_process (prem, conc, sb_rule);
 }
@@ -126,6 +126,18 @@ sexpr_id_chk (unsigned char * cur_ref, int * pf_id, vec_t * cur_sen_ids)
 	  l += S_CL;
 	  break;
 
+	case SEN_ID_TAU:
+	  if (strncmp (cur_ref + l, S_TAU, S_CL))
+	    valid = 0;
+	  l += S_CL;
+	  break;
+
+	case SEN_ID_CTR:
+	  if (strncmp (cur_ref + l, S_CTR, S_CL))
+	    valid = 0;
+	  l += S_CL;
+	  break;
+
 	default:
 	  ret_chk = sexpr_get_part (cur_ref, l, &new_sen);
 	  if (ret_chk == AEC_MEM)
@@ -459,8 +459,6 @@ proc_nq (unsigned char * prem, unsigned char * conc)
   if (!scope)
     return NULL;
 
-  free (var);
-
   int gqv;
   vec_t * offsets;
 
@@ -476,6 +474,7 @@ proc_nq (unsigned char * prem, unsigned char * conc)
 
   if (gqv != 0)
     {
+      free (var);
       free (scope);
       return _("The variables must not appear in the scope.");
     }
@@ -484,6 +483,7 @@ proc_nq (unsigned char * prem, unsigned char * conc)
   int oth_pos, alloc_size;
 
   alloc_size = l_len - strlen (var) - S_CL - 5;
+  free (var);
   oth_sen = (unsigned char *) calloc (alloc_size + 1, sizeof (char));
   CHECK_ALLOC (oth_sen, NULL);
 
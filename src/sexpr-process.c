@@ -21,7 +21,7 @@
 #include "vec.h"
 #include "var.h"
 #include "list.h"
-#include <stdarg.h>
+#include "tokenize.h"
 
 /* Gets a sentence part from a sexpr.
  *  input:
@@ -91,7 +91,9 @@ sexpr_car_cdr (unsigned char * in_str,
   if (pos == AEC_MEM)
     return AEC_MEM;
 
-  pos++;
+  // An atom has no cdr.
+  if (in_str[pos] != '\0')
+    pos++;
 
   while (in_str[pos] != '\0')
     {
@@ -178,47 +180,6 @@ sen_put_len (unsigned char * in0,
     }
 }
 
-/* A helper function to construct another sentence.
- * This is implemented in the equivalence functions, to construct what
- *  the other sentence should be.
- *  input:
- *    main_str - the original string.
- *    init_pos - the initial position in main_str from which to begin copying.
- *                This is usually the position returned from find_difference. 
- *    fin_pos  - the final position from which to copy.
- *    alloc_size - the estimated size of the returned string.
- *    template - the template to use to construct the new sentence.
- *    rest     - the strings to use to construct the new sentence.
- *  output:
- *    the constructed sentence on success, NULL on memory error.
- */
-unsigned char *
-construct_other (unsigned char * main_str,
-		 int init_pos,
-		 int fin_pos,
-		 int alloc_size,
-		 char * template,
-		 ...)
-{
-  unsigned char * oth_sen;
-  int oth_pos = init_pos;
-  va_list args;
-
-  va_start (args, template);
-
-  oth_sen = (unsigned char *) calloc (alloc_size + 1, sizeof (char));
-  CHECK_ALLOC (oth_sen, NULL);
-  strncpy (oth_sen, main_str, oth_pos);
-
-  oth_pos += vsprintf (oth_sen + oth_pos, template, args);
-
-  strcpy (oth_sen + oth_pos, main_str + fin_pos);
-
-  va_end (args);
-
-  return oth_sen;
-}
-
 /* Checks for a negation on a sexpr string.
  *  input:
  *    in_str - the sexpr text on which to check for a negation.
@@ -250,9 +211,9 @@ sexpr_add_not (unsigned char * in_str)
 {
   unsigned char * not_in_str;
 
-  not_in_str = (unsigned char *) calloc (strlen (in_str) + S_NL + 3, sizeof (char));
+  not_in_str = (unsigned char *) calloc (strlen (in_str) + S_NL + 4, sizeof (char));
   CHECK_ALLOC (not_in_str, NULL);
-  sprintf (not_in_str, "(%s %s)\0", S_NOT, in_str);
+  sprintf (not_in_str, "(%s %s)", S_NOT, in_str);
 
   return not_in_str;
 }
@@ -383,88 +344,6 @@ sexpr_find_top_connective (unsigned char * in_str, unsigned char * conn,
   return 0;
 }
 
-/* Finds an unmatched opening parenthesis.
- *  input:
- *    in_str - the string on which to check for an unmatched opening parenthesis.
- *    in_pos - the initial position.
- *  output:
- *    The position of the unmatched opening parenthesis, or -1 on memory error.
- */
-int
-find_unmatched_o_paren (unsigned char * in_str, int in_pos)
-{
-  int pos = in_pos;
-
-  while (pos >= 0)
-    {
-      if (in_str[pos] == ')')
-	{
-	  unsigned char * tmp_str;
-	  pos = reverse_parse_parens (in_str, pos, &tmp_str);
-	  if (pos == AEC_MEM)
-	    return AEC_MEM;
-	  free (tmp_str);
-	}
-      else if (in_str[pos] == '(')
-	break;
-
-      pos--;
-    }
-
-  return pos;
-}
-
-/* Find unmatched sentence parts from an opening parenthesis.
- *  input:
- *    sen_a, sen_b - the sentences to check.
- *    ai, bi - integer pointers that receive the positions.
- *      These both must start on an opening parenthesis.
- *  output:
- *    0 on success, -1 on memory error.
- */
-int
-sexpr_find_unmatched (unsigned char * sen_a, unsigned char * sen_b,
-		      int * ai, int * bi)
-{
-  int a, b, tmp_a, tmp_b;
-  unsigned char * a_str, * b_str;
-
-  a = *ai;  b = *bi;
-
-  tmp_a = parse_parens (sen_a, a, &a_str);
-  if (tmp_a == AEC_MEM)
-    return AEC_MEM;
-
-  tmp_b = parse_parens (sen_b, b, &b_str);
-  if (tmp_b == AEC_MEM)
-    return AEC_MEM;
-
-  while (!strcmp (a_str, b_str))
-    {
-      free (a_str);
-      free (b_str);
-
-      a = find_unmatched_o_paren (sen_a, a - 1);
-      b = find_unmatched_o_paren (sen_b, b - 1);
-
-      if (a < 0 || b < 0)
-	break;
-
-      tmp_a = parse_parens (sen_a, a, &a_str);
-      if (tmp_a == AEC_MEM)
-	return AEC_MEM;
-
-      tmp_b = parse_parens (sen_b, b, &b_str);
-      if (tmp_b == AEC_MEM)
-	return AEC_MEM;
-    }
-
-  *ai = a;
-  *bi = b;
-
-  return 0;
-}
-
 /* Get the predicate arguments from a sexpr string.
  *  input:
  *    in_str - the sexpr text from which to get the predicate arguments.
@@ -987,11 +866,13 @@ sexpr_collect_vars_to_proof (list_t * vars, unsigned char * text, int arb)
 int
 sexpr_get_ids (unsigned char * sen, int ** ids, vec_t * sen_ids)
 {
-  int i, j;
+  static const int conn_ids[NUM_CONNS] = {
+    SEN_ID_AND, SEN_ID_OR, SEN_ID_NOT, SEN_ID_CON, SEN_ID_BIC, SEN_ID_UNV,
+    SEN_ID_EXL, SEN_ID_TAU, SEN_ID_CTR, SEN_ID_ELM, SEN_ID_NIL
+  };
+  token_t * toks;
+  int i, j, num_toks;
   int sen_start_id;
-  int sen_len;
-
-  sen_len = strlen (sen);
 
   sen_start_id = SEN_ID_START;
 
@@ -1005,158 +886,98 @@ sexpr_get_ids (unsigned char * sen, int ** ids, vec_t * sen_ids)
 	}
     }
 
-  *ids = (int *) calloc (sen_len, sizeof (int));
+  num_toks = tokenize (sen, &sexpr_conns, &toks);
+  if (num_toks < 0)
+    return AEC_MEM;
+
+  *ids = (int *) calloc (num_toks + 1, sizeof (int));
   CHECK_ALLOC (*ids, AEC_MEM);
 
   j = 0;
-  for (i = 0; i < sen_len; i++)
+  for (i = 0; i < num_toks; i++)
     {
-      if (sen[i] == '(')
+      token_t * tok = toks + i;
+
+      switch (tok->type)
 	{
+	case TOK_OPAREN:
 	  (*ids)[j++] = SEN_ID_OPAREN;
-	  continue;
-	}
+	  break;
 
-      if (sen[i] == ')')
-	{
+	case TOK_CPAREN:
 	  (*ids)[j++] = SEN_ID_CPAREN;
-	  continue;
-	}
+	  break;
 
-      if (sen[i] == ' ')
-	{
+	case TOK_SPACE:
 	  (*ids)[j++] = SEN_ID_SPACE;
-	  continue;
-	}
-
-      if (!strncmp (sen + i, S_NOT, S_NL))
-	{
-	  (*ids)[j++] = SEN_ID_NOT;
-	  i += (S_NL - 1);
-	  continue;
-	}
-
-      if (!strncmp (sen + i, S_AND, S_CL))
-	{
-	  (*ids)[j++] = SEN_ID_AND;
-	  i += (S_CL - 1);
-	  continue;
-	}
-
-      if (!strncmp (sen + i, S_OR, S_CL))
-	{
-	  (*ids)[j++] = SEN_ID_OR;
-	  i += (S_CL - 1);
-	  continue;
-	}
-
-      if (!strncmp (sen + i, S_CON, S_CL))
-	{
-	  (*ids)[j++] = SEN_ID_CON;
-	  i += (S_CL - 1);
-	  continue;
-	}
-
-      if (!strncmp (sen + i, S_BIC, S_CL))
-	{
-	  (*ids)[j++] = SEN_ID_BIC;
-	  i += (S_CL - 1);
-	  continue;
-	}
-
-      if (!strncmp (sen + i, S_UNV, S_CL))
-	{
-	  (*ids)[j++] = SEN_ID_UNV;
-	  i += (S_CL - 1);
-	  continue;
-	}
-
-      if (!strncmp (sen + i, S_EXL, S_CL))
-	{
-	  (*ids)[j++] = SEN_ID_EXL;
-	  i += (S_CL - 1);
-	  continue;
-	}
-
-      if (sen[i] == '=')
-	{
-	  (*ids)[j++] = SEN_ID_EQ;
-	  continue;
-	}
-
-      if (sen[i] == '<')
-	{
-	  (*ids)[j++] = SEN_ID_LT;
-	  continue;
-	}
-
-      if (!strncmp (sen + i, S_ELM, S_CL))
-	{
-	  (*ids)[j++] = SEN_ID_ELM;
-	  i += (S_CL - 1);
-	  continue;
-	}
-
-      if (!strncmp (sen + i, S_NIL, S_CL))
-	{
-	  (*ids)[j++] = SEN_ID_NIL;
-	  i += (S_CL - 1);
-	  continue;
-	}
-
-      if (isalnum (sen[i]))
-	{
-	  int k = 0;
-	  int start, end;
-	  int new_id;
-
-	  start = end = i;
-	  end++;
-	  while (ISLEGIT (sen[end]))
-	    end++;
-
-	  if (sen_ids)
-	    {
-	      for (k = 0; k < sen_ids->num_stuff; k++)
-		{
-		  sen_id * cur_sen;
-		  cur_sen = vec_nth (sen_ids, k);
-
-		  if (!strncmp (cur_sen->sen, sen + start, end - start))
-		    {
-		      if (cur_sen->sen[end - start] == '\0')
-			{
-			  new_id = cur_sen->id;
-			  break;
-			}
-		    }
-		}
-	    }
-
-	  if (!sen_ids || k == sen_ids->num_stuff)
-	    {
-	      sen_id new_sen_id;
+	  break;
 
-	      new_sen_id.sen = (unsigned char *) calloc (end - start + 1,
-							 sizeof (char));
-	      CHECK_ALLOC (new_sen_id.sen, AEC_MEM);
-	      strncpy (new_sen_id.sen, sen + start, end - start);
-	      new_sen_id.sen[end - start] = '\0';
+	case TOK_CONN:
+	  (*ids)[j++] = conn_ids[tok->conn];
+	  break;
 
-	      new_sen_id.id = sen_start_id++;
-	      new_id = new_sen_id.id;
+	case TOK_SEP:
+	  if (sen[tok->pos] == '=')
+	    (*ids)[j++] = SEN_ID_EQ;
+	  else if (sen[tok->pos] == '<')
+	    (*ids)[j++] = SEN_ID_LT;
+	  break;
 
-	      if (sen_ids)
-		vec_add_obj (sen_ids, &new_sen_id);
-	    }
+	case TOK_IDENT:
+	  {
+	    int k = 0;
+	    int start, end;
+	    int new_id;
+
+	    start = tok->pos;
+	    end = tok->pos + tok->len;
+
+	    if (sen_ids)
+	      {
+		for (k = 0; k < sen_ids->num_stuff; k++)
+		  {
+		    sen_id * cur_sen;
+		    cur_sen = vec_nth (sen_ids, k);
+
+		    if (!strncmp (cur_sen->sen, sen + start, end - start))
+		      {
+			if (cur_sen->sen[end - start] == '\0')
+			  {
+			    new_id = cur_sen->id;
+			    break;
+			  }
+		      }
+		  }
+	      }
+
+	    if (!sen_ids || k == sen_ids->num_stuff)
+	      {
+		sen_id new_sen_id;
+
+		new_sen_id.sen = (unsigned char *) calloc (end - start + 1,
+							   sizeof (char));
+		CHECK_ALLOC (new_sen_id.sen, AEC_MEM);
+		strncpy (new_sen_id.sen, sen + start, end - start);
+		new_sen_id.sen[end - start] = '\0';
+
+		new_sen_id.id = sen_start_id++;
+		new_id = new_sen_id.id;
+
+		if (sen_ids)
+		  vec_add_obj (sen_ids, &new_sen_id);
+	      }
+
+	    (*ids)[j++] = new_id;
+	  }
+	  break;
 
-	  (*ids)[j++] = new_id;
-	  i = end - 1;
-	  continue;
+	default:
+	  break;
 	}
     }
 
   (*ids)[j] = SEN_ID_END;
+  free (toks);
 
   return 0;
 }
@@ -55,14 +55,6 @@ int sexpr_str_car_cdr (unsigned char * in_str,
 void sen_put_len (unsigned char * in0, unsigned char * in1,
 		  unsigned char ** sh_sen, unsigned char ** ln_sen);
 
-unsigned char *
-construct_other (unsigned char * main_str,
-		 int init_pos,
-		 int fin_pos,
-		 int alloc_size,
-		 char * template,
-		 ...);
-
 int sexpr_not_check (unsigned char * in_str);
 
 unsigned char * sexpr_add_not (unsigned char * in_str);
@@ -74,10 +66,6 @@ int sexpr_get_generalities (unsigned char * in_str, unsigned char * conn, vec_t
 int sexpr_find_top_connective (unsigned char * in_str, unsigned char * conn,
 			       unsigned char ** lsen, unsigned char ** rsen);
 
-int find_unmatched_o_paren (unsigned char * in_str, int in_pos);
-
-int sexpr_find_unmatched (unsigned char * sen_a, unsigned char * sen_b, int * ai, int * bi);
-
 int sexpr_get_pred_args (unsigned char * in_str, unsigned char ** pred, vec_t * args);
 
 unsigned char * sexpr_elim_quant (unsigned char * in_str, unsigned char * quant,
@@ -122,7 +110,7 @@ char * proc_cd (vec_t * prems, unsigned char * conc);
 
 char * proc_im (unsigned char * prem, unsigned char * conc);
 
-char * proc_dm (unsigned char * prem, unsigned char * conc, int mode_guess);
+char * proc_dm (unsigned char * prem, unsigned char * conc);
 
 char * proc_as (unsigned char * prem, unsigned char * conc);
 
@@ -130,7 +118,7 @@ char * proc_co (unsigned char * prem, unsigned char * conc);
 
 char * proc_id (unsigned char * prem, unsigned char * conc);
 
-char * proc_dt (unsigned char * prem, unsigned char * conc, int mode_guess);
+char * proc_dt (unsigned char * prem, unsigned char * conc);
 
 char * proc_eq (unsigned char * prem, unsigned char * conc);
 
@@ -0,0 +1,570 @@
+/* Functions for sentence signatures.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* A signature summarizes a sentence in a single pass over its sexpr.
+ *  Before a rule does any real work, its condition is checked against the
+ *  signatures of the references and the conclusion.  The conditions are
+ *  only necessary ones, such as a conditional being the top connective of
+ *  a reference for Modus Ponens, or a replacement rule leaving the atoms
+ *  untouched, so a line that passes may still be wrong, but a line that
+ *  fails is rejected without entering the rule.
+ */
+
+#include "sexpr-sig.h"
+#include "sexpr-process.h"
+#include "rule-template.h"
+#include "vec.h"
+
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME 16777619u
+
+// The connectives that a replacement rule may add or remove.
+
+#define SIG_ANDOR (SIG_BIT (AND_CONN) | SIG_BIT (OR_CONN))
+#define SIG_QUANTS (SIG_BIT (UNV_CONN) | SIG_BIT (EXL_CONN))
+#define SIG_BOOLS (SIG_BIT (TAU_CONN) | SIG_BIT (CTR_CONN))
+
+/* Determines the connective of an atom.
+ *  input:
+ *    atom - the atom.
+ *    len - the length of the atom.
+ *  output:
+ *    the CONN_ORDER of the atom, or -1 if it is not a connective.
+ */
+static int
+sig_atom_conn (const unsigned char * atom, int len)
+{
+  const char * conns[NUM_CONNS] = {
+    S_AND, S_OR, S_NOT, S_CON, S_BIC, S_UNV, S_EXL, S_TAU, S_CTR, S_ELM, S_NIL
+  };
+  int i;
+
+  if (len != S_CL || atom[0] != '<')
+    return -1;
+
+  for (i = 0; i < NUM_CONNS; i++)
+    {
+      if (!strncmp ((const char *) atom, conns[i], len))
+	return i;
+    }
+
+  return -1;
+}
+
+/* Computes the signature of a sexpr.
+ *  input:
+ *    sexpr - the sexpr.
+ *    sig - receives the signature.
+ *  output:
+ *    none.
+ */
+void
+sexpr_sig_init (const unsigned char * sexpr, sexpr_sig * sig)
+{
+  int pos = 0, top_pos;
+
+  memset (sig, 0, sizeof (sexpr_sig));
+  sig->top_conn = -1;
+
+  // The root's connective is the first atom of the list, or the first atom
+  //  of its head if it is a quantifier.  A lone atom may be a symbol.
+  top_pos = 0;
+  while (sexpr[top_pos] == '(' && top_pos < 2)
+    top_pos++;
+
+  while (sexpr[pos] != '\0')
+    {
+      int start, conn;
+      unsigned int hash;
+
+      if (sexpr[pos] == '(')
+	{
+	  sig->num_nodes++;
+	  pos++;
+	  continue;
+	}
+
+      if (sexpr[pos] == ')' || sexpr[pos] == ' ')
+	{
+	  pos++;
+	  continue;
+	}
+
+      start = pos;
+      hash = FNV_OFFSET;
+      while (sexpr[pos] != '\0' && sexpr[pos] != ' '
+	     && sexpr[pos] != '(' && sexpr[pos] != ')')
+	{
+	  hash = (hash ^ sexpr[pos]) * FNV_PRIME;
+	  pos++;
+	}
+
+      sig->num_nodes++;
+      conn = sig_atom_conn (sexpr + start, pos - start);
+      if (conn >= 0)
+	{
+	  sig->conns |= SIG_BIT (conn);
+	  if (conn == UNV_CONN || conn == EXL_CONN)
+	    sig->num_quants++;
+
+	  if (start == top_pos)
+	    sig->top_conn = conn;
+	  continue;
+	}
+
+      // The hashes are mixed, then added, so that the order of the atoms
+      //  does not matter but their number does.
+      hash ^= hash >> 16;
+      hash *= 0x85ebca6bu;
+      hash ^= hash >> 13;
+      hash *= 0xc2b2ae35u;
+      hash ^= hash >> 16;
+      sig->atoms += hash;
+    }
+
+  // Only a quantifier may head the root's head.
+  if (top_pos == 2 && sig->top_conn != UNV_CONN && sig->top_conn != EXL_CONN)
+    sig->top_conn = -1;
+  if (top_pos == 1 && (sig->top_conn == UNV_CONN || sig->top_conn == EXL_CONN))
+    sig->top_conn = -1;
+}
+
+/* The conditions of each rule.
+ *  input:
+ *    conc - the signature of the conclusion.
+ *    prems - the signatures of the references.
+ *    num_prems - the number of references.
+ *  output:
+ *    NULL if the rule may apply, its error message otherwise.
+ *  A condition casts away whichever of these it does not look at.
+ */
+
+typedef char * (* sig_cond_func) (const sexpr_sig * conc,
+				  const sexpr_sig * prems, int num_prems);
+
+/* Checks that a replacement rule only changed some of the connectives.
+ *  input:
+ *    s0, s1 - the signatures of the two sentences.
+ *    changed - the connectives that the rule may add or remove.
+ *    same_atoms - whether the rule keeps every atom.
+ *  output:
+ *    1 if the signatures agree, 0 otherwise.
+ */
+static int
+sig_replaced (const sexpr_sig * s0, const sexpr_sig * s1,
+	      unsigned int changed, int same_atoms)
+{
+  if ((s0->conns & ~changed) != (s1->conns & ~changed))
+    return 0;
+
+  if (same_atoms && s0->atoms != s1->atoms)
+    return 0;
+
+  if (!(changed & SIG_QUANTS) && s0->num_quants != s1->num_quants)
+    return 0;
+
+  return 1;
+}
+
+static char *
+sig_mp (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  int i;
+
+  (void) num_prems;
+
+  for (i = 0; i < 2; i++)
+    {
+      if (prems[i].top_conn == CON_CONN
+	  && prems[i].atoms == prems[!i].atoms + conc->atoms)
+	return NULL;
+    }
+
+  if (prems[0].top_conn != CON_CONN && prems[1].top_conn != CON_CONN)
+    return _("The top connective must be a conditional.");
+
+  return _("Modus Ponens constructed incorrectly.");
+}
+
+static char *
+sig_ad (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) prems;
+  (void) num_prems;
+
+  if (conc->top_conn != OR_CONN)
+    return _("There must be a disjunction in the conclusion.");
+  return NULL;
+}
+
+static char *
+sig_sm (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) conc;
+  (void) num_prems;
+
+  if (prems[0].top_conn != AND_CONN)
+    return _("There must be a conjunction in the reference.");
+  return NULL;
+}
+
+static char *
+sig_cn (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) prems;
+  (void) num_prems;
+
+  if (conc->top_conn != AND_CONN)
+    return _("There must be a conjunction in the conclusion.");
+  return NULL;
+}
+
+static char *
+sig_hs (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  int i;
+
+  if (conc->top_conn != CON_CONN)
+    return _("There must be a conditional in the conclusion.");
+
+  for (i = 0; i < num_prems; i++)
+    {
+      if (prems[i].top_conn != CON_CONN)
+	return _("All of the references must contain a conditional.");
+    }
+
+  return NULL;
+}
+
+static char *
+sig_ds (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  int i;
+
+  (void) conc;
+
+  for (i = 0; i < num_prems; i++)
+    {
+      if (prems[i].top_conn == OR_CONN)
+	return NULL;
+    }
+
+  return _("There must be a disjunction in the longest reference.");
+}
+
+static char *
+sig_ex (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) prems;
+  (void) num_prems;
+
+  if (conc->top_conn != OR_CONN)
+    return _("There must be a disjunction in the conclusion.");
+
+  if (!SIG_HAS (conc, NOT_CONN))
+    return _("The left disjunct must be the negation of the right disjunct.");
+
+  return NULL;
+}
+
+static char *
+sig_cd (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  int i, num_cons = 0;
+
+  if (conc->top_conn != OR_CONN)
+    return _("There must be a disjunction in the conclusion.");
+
+  for (i = 0; i < num_prems; i++)
+    {
+      if (prems[i].top_conn == CON_CONN)
+	num_cons++;
+    }
+
+  if (num_cons < num_prems - 1)
+    return _("All of the references except the disjunction reference must contain a conditional.");
+
+  return NULL;
+}
+
+static char *
+sig_im (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  if (!sig_replaced (prems, conc, SIG_BIT (CON_CONN) | SIG_BIT (OR_CONN)
+		     | SIG_BIT (NOT_CONN), 1))
+    return _("Implication constructed incorrectly.");
+  return NULL;
+}
+
+static char *
+sig_dm (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  // De Morgan swaps quantifiers, but never adds or removes them.
+  if (!sig_replaced (prems, conc, SIG_ANDOR | SIG_BIT (NOT_CONN)
+		     | SIG_QUANTS, 1)
+      || prems[0].num_quants != conc->num_quants)
+    return _("De Morgan constructed incorrectly.");
+  return NULL;
+}
+
+static char *
+sig_as (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  if (!sig_replaced (prems, conc, 0, 1))
+    return _("Association constructed incorrectly.");
+  return NULL;
+}
+
+static char *
+sig_co (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  if (!sig_replaced (prems, conc, 0, 1)
+      || prems[0].num_nodes != conc->num_nodes
+      || prems[0].top_conn != conc->top_conn)
+    return _("Commutativity constructed incorrectly.");
+  return NULL;
+}
+
+static char *
+sig_dt (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  if (!sig_replaced (prems, conc, SIG_ANDOR | SIG_QUANTS, 0))
+    return _("Distribution constructed incorrectly.");
+  return NULL;
+}
+
+static char *
+sig_eq (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  if (!sig_replaced (prems, conc, SIG_BIT (BIC_CONN) | SIG_BIT (CON_CONN)
+		     | SIG_BIT (AND_CONN), 0))
+    return _("Equivalence constructed incorrectly.");
+  return NULL;
+}
+
+static char *
+sig_dn (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  if (!sig_replaced (prems, conc, SIG_BIT (NOT_CONN), 1))
+    return _("Double Negation constructed incorrectly.");
+  return NULL;
+}
+
+static char *
+sig_ep (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  if (!sig_replaced (prems, conc, SIG_BIT (CON_CONN) | SIG_BIT (AND_CONN), 1))
+    return _("Exportation constructed incorrectly.");
+  return NULL;
+}
+
+static char *
+sig_bi (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  if (!sig_replaced (prems, conc, SIG_ANDOR | SIG_BOOLS, 0))
+    return _("Boolean Identity constructed incorrectly.");
+  return NULL;
+}
+
+static char *
+sig_bd (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  // The dominating symbol is on both sides.
+  if (!(prems[0].conns & SIG_BOOLS) || !(conc->conns & SIG_BOOLS))
+    return _("Boolean Dominance constructed incorrectly.");
+  return NULL;
+}
+
+static char *
+sig_bn (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  // One side has the symbol, and the other the negation.
+  if (!((prems[0].conns & SIG_BOOLS) && SIG_HAS (conc, NOT_CONN))
+      && !((conc->conns & SIG_BOOLS) && SIG_HAS (prems, NOT_CONN)))
+    return _("Boolean Negation constructed incorrectly.");
+  return NULL;
+}
+
+static char *
+sig_sn (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  if (!sig_replaced (prems, conc, SIG_BIT (NOT_CONN) | SIG_BOOLS, 1)
+      || !(prems[0].conns & SIG_BOOLS) || !(conc->conns & SIG_BOOLS))
+    return _("Symbol Negation constructed incorrectly.");
+  return NULL;
+}
+
+static char *
+sig_ug (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  if (conc->top_conn != UNV_CONN || conc->num_quants != prems[0].num_quants + 1)
+    return _("Universal Generalization constructed incorrectly.");
+  return NULL;
+}
+
+static char *
+sig_ui (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  if (prems[0].top_conn != UNV_CONN || prems[0].num_quants != conc->num_quants + 1)
+    return _("Universal Instantiation constructed incorrectly.");
+  return NULL;
+}
+
+static char *
+sig_eg (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  if (conc->top_conn != EXL_CONN || conc->num_quants != prems[0].num_quants + 1)
+    return _("Existential Generalization constructed incorrectly.");
+  return NULL;
+}
+
+static char *
+sig_ei (const sexpr_sig * conc, const sexpr_sig * prems, int num_prems)
+{
+  (void) num_prems;
+
+  if (prems[0].top_conn != EXL_CONN || prems[0].num_quants != conc->num_quants + 1)
+    return _("Existential Instantiation constructed incorrectly.");
+  return NULL;
+}
+
+// The rules with conditions.  The references are only checked once
+//  their number is right, so that the rule still reports a wrong number.
+
+static struct sig_rule {
+  const char * rule;            // The abbreviation of the rule.
+  int min_prems, max_prems;     // The bounds on the number of references.
+  int replace;                  // Whether the rule is a replacement rule.
+  sig_cond_func cond;           // The condition of the rule.
+} const sig_rules[] = {
+  {"mp", 2, 2, 0, sig_mp},
+  {"ad", 1, 1, 0, sig_ad},
+  {"sm", 1, 1, 0, sig_sm},
+  {"cn", 2, -1, 0, sig_cn},
+  {"hs", 2, -1, 0, sig_hs},
+  {"ds", 2, -1, 0, sig_ds},
+  {"ex", 0, 0, 0, sig_ex},
+  {"cd", 3, -1, 0, sig_cd},
+  {"im", 1, 1, 1, sig_im},
+  {"dm", 1, 1, 1, sig_dm},
+  {"as", 1, 1, 1, sig_as},
+  {"co", 1, 1, 1, sig_co},
+  {"dt", 1, 1, 1, sig_dt},
+  {"eq", 1, 1, 1, sig_eq},
+  {"dn", 1, 1, 1, sig_dn},
+  {"ep", 1, 1, 1, sig_ep},
+  {"bi", 1, 1, 1, sig_bi},
+  {"bd", 1, 1, 1, sig_bd},
+  {"bn", 1, 1, 1, sig_bn},
+  {"sn", 1, 1, 1, sig_sn},
+  {"ug", 1, 1, 0, sig_ug},
+  {"ui", 1, 1, 0, sig_ui},
+  {"eg", 1, 1, 0, sig_eg},
+  {"ei", 1, 1, 0, sig_ei},
+  {NULL, 0, 0, 0, NULL}
+};
+
+/* Checks the condition of a rule against the signatures of its sentences.
+ *  input:
+ *    conc - the sexpr of the conclusion.
+ *    prems - the sexprs of the references.
+ *    sigs - the signatures of the conclusion and then of each reference,
+ *           as cached with their sexprs, or NULL to compute them here.
+ *    rule - the abbreviation of the rule.
+ *  output:
+ *    NULL if the rule may apply, or the rule's error message if it cannot.
+ */
+char *
+sexpr_sig_check (unsigned char * conc, vec_t * prems, vec_t * sigs,
+		 const char * rule)
+{
+  const struct sig_rule * sr;
+  sexpr_sig conc_sig, * prem_sigs;
+  char * ret;
+  int i;
+
+  for (sr = sig_rules; sr->rule; sr++)
+    {
+      if (!strcmp (sr->rule, rule))
+	break;
+    }
+
+  if (!sr->rule || prems->num_stuff < sr->min_prems
+      || (sr->max_prems >= 0 && prems->num_stuff > sr->max_prems))
+    return NULL;
+
+  if (sr->replace)
+    {
+      // Loaded templates may change anything, and an unchanged line
+      //  is reported by the rule itself.
+      if (rule_template_loaded (rule) > 0
+	  || !strcmp ((char *) vec_str_nth (prems, 0), (char *) conc))
+	return NULL;
+    }
+
+  if (sigs && sigs->num_stuff == prems->num_stuff + 1)
+    {
+      // The references' signatures follow the conclusion's in the vector.
+      prem_sigs = (sexpr_sig *) sigs->stuff;
+      return sr->cond (prem_sigs, prem_sigs + 1, prems->num_stuff);
+    }
+
+  // Without the signatures, the rule is left to decide for itself.
+  prem_sigs = (sexpr_sig *) calloc (prems->num_stuff + 1, sizeof (sexpr_sig));
+  if (!prem_sigs)
+    return NULL;
+
+  sexpr_sig_init (conc, &conc_sig);
+  for (i = 0; i < prems->num_stuff; i++)
+    sexpr_sig_init (vec_str_nth (prems, i), prem_sigs + i);
+
+  ret = sr->cond (&conc_sig, prem_sigs, prems->num_stuff);
+  free (prem_sigs);
+
+  return ret;
+}
@@ -0,0 +1,44 @@
+/* Sentence signatures.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_SEXPR_SIG_H
+#define ARIS_SEXPR_SIG_H
+
+#include "typedef.h"
+#include "process.h"
+
+// A summary of a sexpr, cheap enough to compute for every sentence.
+
+struct sexpr_sig {
+  unsigned int conns;           // A bit for each CONN_ORDER that appears.
+  int top_conn;                 // The CONN_ORDER of the root, or -1.
+  int num_quants;               // The number of quantifiers.
+  int num_nodes;                // The number of atoms and lists.
+  unsigned int atoms;           // A hash of the multiset of non-connective atoms.
+};
+
+#define SIG_BIT(c) (1u << (c))
+
+// Determines whether a connective appears in a signature.
+#define SIG_HAS(s,c) (((s)->conns & SIG_BIT (c)) != 0)
+
+void sexpr_sig_init (const unsigned char * sexpr, sexpr_sig * sig);
+char * sexpr_sig_check (unsigned char * conc, vec_t * prems, vec_t * sigs,
+			 const char * rule);
+
+#endif  /*  ARIS_SEXPR_SIG_H  */
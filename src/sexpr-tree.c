@@ -0,0 +1,390 @@
+/* Functions for the sexpr formula tree.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Every node carries a hash of its subtree, built from the hashes of its
+ *  kids, so two subtrees are compared in constant time unless the hashes
+ *  agree.  The replacement rules are checked by walking the premise and the
+ *  conclusion together: equal subtrees are skipped, and where both sides
+ *  have the same head and the same number of kids, each pair of kids is
+ *  compared in turn.  What is left are the smallest pairs of subtrees that
+ *  differ, and only those are handed to the rule.  Since every such pair is
+ *  checked, a rule may be applied at several places in one line.
+ */
+
+#include "sexpr-tree.h"
+#include "sexpr-process.h"
+
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME 16777619u
+
+/* Determines the connective of a node.
+ *  input:
+ *    node - the node, whose kids have already been set.
+ *  output:
+ *    the CONN_ORDER of the node, or -1 if it has none.
+ */
+static int
+sexpr_node_get_conn (const sexpr_node * node)
+{
+  const char * conns[NUM_CONNS] = {
+    S_AND, S_OR, S_NOT, S_CON, S_BIC, S_UNV, S_EXL, S_TAU, S_CTR, S_ELM, S_NIL
+  };
+  const sexpr_node * head;
+  int i;
+
+  if (node->num_kids == 0)
+    {
+      if (sexpr_node_is (node, S_TAU))
+	return TAU_CONN;
+      if (sexpr_node_is (node, S_CTR))
+	return CTR_CONN;
+      if (sexpr_node_is (node, S_NIL))
+	return NIL_CONN;
+      return -1;
+    }
+
+  head = SEXPR_HEAD (node);
+
+  // A quantifier is a list headed by the quantifier and its variable.
+  if (head->num_kids > 0)
+    {
+      if (sexpr_node_is (SEXPR_HEAD (head), S_UNV))
+	return UNV_CONN;
+      if (sexpr_node_is (SEXPR_HEAD (head), S_EXL))
+	return EXL_CONN;
+      return -1;
+    }
+
+  for (i = 0; i < NUM_CONNS; i++)
+    {
+      if (i == UNV_CONN || i == EXL_CONN || i == TAU_CONN || i == CTR_CONN
+	  || i == NIL_CONN)
+	continue;
+
+      if (sexpr_node_is (head, conns[i]))
+	return i;
+    }
+
+  return -1;
+}
+
+/* Parses a single node of a sexpr.
+ *  input:
+ *    tree - the tree being built.
+ *    pos - the position of the node in the tree's text.
+ *    stack - scratch space for the kids of unfinished lists.
+ *    sp - the top of stack.
+ *    kid_pos - the next free position in the tree's kid storage.
+ *  output:
+ *    the new node, or NULL if the sexpr is malformed.
+ */
+static sexpr_node *
+sexpr_tree_parse (sexpr_tree * tree, int * pos, sexpr_node ** stack,
+		  int sp, int * kid_pos)
+{
+  sexpr_node * node;
+  const unsigned char * str = tree->str;
+  int start = *pos, base = sp;
+  unsigned int hash = FNV_OFFSET;
+
+  node = tree->nodes + tree->num_nodes++;
+  node->str = str + start;
+  node->num_kids = 0;
+  node->kids = NULL;
+
+  if (str[*pos] != '(')
+    {
+      while (str[*pos] != '\0' && str[*pos] != ' '
+	     && str[*pos] != '(' && str[*pos] != ')')
+	{
+	  hash = (hash ^ str[*pos]) * FNV_PRIME;
+	  (*pos)++;
+	}
+
+      if (*pos == start)
+	return NULL;
+
+      node->len = *pos - start;
+      node->hash = hash;
+      node->conn = sexpr_node_get_conn (node);
+      return node;
+    }
+
+  (*pos)++;
+  while (str[*pos] != ')')
+    {
+      sexpr_node * kid;
+
+      kid = sexpr_tree_parse (tree, pos, stack, sp, kid_pos);
+      if (!kid)
+	return NULL;
+
+      stack[sp++] = kid;
+      hash = (hash ^ kid->hash) * FNV_PRIME;
+      hash = (hash << 5) | (hash >> 27);
+
+      if (str[*pos] == ' ')
+	(*pos)++;
+      else if (str[*pos] != ')')
+	return NULL;
+    }
+  (*pos)++;
+
+  if (sp == base)
+    return NULL;
+
+  node->num_kids = sp - base;
+  node->kids = tree->kids + *kid_pos;
+  memcpy (node->kids, stack + base, node->num_kids * sizeof (sexpr_node *));
+  *kid_pos += node->num_kids;
+
+  node->len = *pos - start;
+  node->hash = (hash ^ node->num_kids) * FNV_PRIME;
+  node->conn = sexpr_node_get_conn (node);
+
+  return node;
+}
+
+/* Initializes a formula tree from a sexpr.
+ *  input:
+ *    in_str - the sexpr text.
+ *  output:
+ *    the new tree, or NULL if in_str is not a well formed sexpr.
+ */
+sexpr_tree *
+sexpr_tree_init (const unsigned char * in_str)
+{
+  sexpr_tree * tree;
+  sexpr_node ** stack;
+  int len, pos, kid_pos;
+
+  len = strlen ((const char *) in_str);
+
+  tree = (sexpr_tree *) calloc (1, sizeof (sexpr_tree));
+  CHECK_ALLOC (tree, NULL);
+
+  tree->str = (unsigned char *) strdup ((const char *) in_str);
+  CHECK_ALLOC (tree->str, NULL);
+
+  // There can be no more nodes than bytes.
+  tree->nodes = (sexpr_node *) calloc (len + 1, sizeof (sexpr_node));
+  CHECK_ALLOC (tree->nodes, NULL);
+
+  tree->kids = (sexpr_node **) calloc (len + 1, sizeof (sexpr_node *));
+  CHECK_ALLOC (tree->kids, NULL);
+
+  stack = (sexpr_node **) calloc (len + 1, sizeof (sexpr_node *));
+  CHECK_ALLOC (stack, NULL);
+
+  pos = kid_pos = 0;
+  tree->num_nodes = 0;
+  tree->root = sexpr_tree_parse (tree, &pos, stack, 0, &kid_pos);
+  free (stack);
+
+  if (!tree->root || tree->str[pos] != '\0')
+    {
+      sexpr_tree_destroy (tree);
+      return NULL;
+    }
+
+  return tree;
+}
+
+/* Destroys a formula tree.
+ *  input:
+ *    tree - the tree to destroy.
+ *  output:
+ *    none.
+ */
+void
+sexpr_tree_destroy (sexpr_tree * tree)
+{
+  if (tree->str)
+    free (tree->str);
+  if (tree->nodes)
+    free (tree->nodes);
+  if (tree->kids)
+    free (tree->kids);
+  free (tree);
+}
+
+/* Determines whether two subtrees are the same.
+ *  input:
+ *    n0, n1 - the subtrees to compare.
+ *  output:
+ *    1 if they are the same, 0 otherwise.
+ */
+int
+sexpr_node_equal (const sexpr_node * n0, const sexpr_node * n1)
+{
+  if (n0->hash != n1->hash || n0->len != n1->len)
+    return 0;
+
+  return !memcmp (n0->str, n1->str, n0->len);
+}
+
+/* Determines whether a node is a given atom.
+ *  input:
+ *    node - the node to check.
+ *    atom - the text of the atom.
+ *  output:
+ *    1 if node is the atom, 0 otherwise.
+ */
+int
+sexpr_node_is (const sexpr_node * node, const char * atom)
+{
+  return (node->num_kids == 0
+	  && !strncmp ((const char *) node->str, atom, node->len)
+	  && atom[node->len] == '\0');
+}
+
+/* Checks that two subtrees follow from one another by a rule.
+ *  input:
+ *    n0, n1 - the subtrees to check.
+ *    rule - the rule to apply at each differing pair of subtrees.
+ *  output:
+ *    NO_DIFFERENCE if the subtrees are the same, CORRECT if they follow
+ *    by the rule, an error message otherwise, or NULL on memory error.
+ */
+char *
+sexpr_tree_equiv (sexpr_node * n0, sexpr_node * n1, sexpr_rule_func rule)
+{
+  char * ret, * kid_ret = NULL;
+
+  if (sexpr_node_equal (n0, n1))
+    return NO_DIFFERENCE;
+
+  if (n0->num_kids > 1 && n0->num_kids == n1->num_kids
+      && sexpr_node_equal (SEXPR_HEAD (n0), SEXPR_HEAD (n1)))
+    {
+      ret = sexpr_tree_equiv_list (n0->kids + 1, n1->kids + 1,
+				   n0->num_kids - 1, rule);
+      if (!ret)
+	return NULL;
+
+      if (SEXPR_TREE_OK (ret))
+	return CORRECT;
+
+      kid_ret = ret;
+    }
+
+  // Either this is a differing pair, or the rule did not hold for the kids,
+  //  in which case it may still hold for the pair as a whole.
+  ret = rule (n0, n1);
+  if (!ret)
+    return NULL;
+
+  if (SEXPR_TREE_OK (ret))
+    return CORRECT;
+
+  return (kid_ret) ? kid_ret : ret;
+}
+
+/* Checks two lists of subtrees against a rule, pair by pair.
+ *  input:
+ *    l0, l1 - the lists to check.
+ *    num - the number of subtrees in each list.
+ *    rule - the rule to apply at each differing pair of subtrees.
+ *  output:
+ *    CORRECT if every pair follows by the rule, the first error message
+ *    otherwise, or NULL on memory error.
+ */
+char *
+sexpr_tree_equiv_list (sexpr_node ** l0, sexpr_node ** l1, int num,
+		       sexpr_rule_func rule)
+{
+  char * ret;
+  int i;
+
+  for (i = 0; i < num; i++)
+    {
+      ret = sexpr_tree_equiv (l0[i], l1[i], rule);
+      if (!ret)
+	return NULL;
+
+      if (!SEXPR_TREE_OK (ret))
+	return ret;
+    }
+
+  return CORRECT;
+}
+
+/* Checks a rule that is stated in one direction in both directions.
+ *  input:
+ *    n0, n1 - the subtrees to check.
+ *    check - the one-directional check, which is tried on n0 and n1 first,
+ *            then on n1 and n0.
+ *  output:
+ *    CORRECT if either direction holds, the message of the first direction
+ *    otherwise, or NULL on memory error.
+ */
+char *
+sexpr_tree_either (sexpr_node * n0, sexpr_node * n1, sexpr_rule_func check)
+{
+  char * ret, * oth_ret;
+
+  ret = check (n0, n1);
+  if (!ret)
+    return NULL;
+
+  if (SEXPR_TREE_OK (ret))
+    return CORRECT;
+
+  oth_ret = check (n1, n0);
+  if (!oth_ret)
+    return NULL;
+
+  if (SEXPR_TREE_OK (oth_ret))
+    return CORRECT;
+
+  return ret;
+}
+
+/* Checks a premise and conclusion against a rule.
+ *  input:
+ *    prem - the sexpr of the premise.
+ *    conc - the sexpr of the conclusion.
+ *    rule - the rule to check.
+ *  output:
+ *    the same as sexpr_tree_equiv.
+ */
+char *
+sexpr_tree_process (unsigned char * prem, unsigned char * conc,
+		    sexpr_rule_func rule)
+{
+  sexpr_tree * t_prem, * t_conc;
+  char * ret;
+
+  t_prem = sexpr_tree_init (prem);
+  if (!t_prem)
+    return _("The sentences could not be read.");
+
+  t_conc = sexpr_tree_init (conc);
+  if (!t_conc)
+    {
+      sexpr_tree_destroy (t_prem);
+      return _("The sentences could not be read.");
+    }
+
+  ret = sexpr_tree_equiv (t_prem->root, t_conc->root, rule);
+
+  sexpr_tree_destroy (t_prem);
+  sexpr_tree_destroy (t_conc);
+
+  return ret;
+}
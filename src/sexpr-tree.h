@@ -0,0 +1,88 @@
+/* The sexpr formula tree.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_SEXPR_TREE_H
+#define ARIS_SEXPR_TREE_H
+
+#include "typedef.h"
+#include "process.h"
+
+// A single node of a formula tree.  Atoms have no kids; the first kid
+//  of a list is its head, either a connective, a quantifier or a symbol.
+
+struct sexpr_node {
+  unsigned int hash;            // The hash of the subtree.
+  int conn;                     // The CONN_ORDER of the node, or -1.
+  const unsigned char * str;    // The text of the subtree.
+  int len;                      // The length of the text.
+  int num_kids;                 // The number of kids.
+  sexpr_node ** kids;           // The kids.
+};
+
+// A formula tree.  The nodes point into the tree's copy of the sexpr.
+
+struct sexpr_tree {
+  unsigned char * str;          // The sexpr text.
+  sexpr_node * root;            // The root node.
+  sexpr_node * nodes;           // Storage for the nodes.
+  sexpr_node ** kids;           // Storage for the kid pointers.
+  int num_nodes;                // The number of nodes.
+};
+
+#define SEXPR_HEAD(n) (((n)->num_kids > 0) ? (n)->kids[0] : NULL)
+
+// A list with a connective and exactly two arguments.
+#define SEXPR_IS_BINARY(n,c) ((n)->conn == (c) && (n)->num_kids == 3)
+
+// A negation, such as (<n> P).
+#define SEXPR_IS_NOT(n) ((n)->conn == NOT_CONN && (n)->num_kids == 2)
+
+// A tautology or a contradiction.
+#define SEXPR_IS_BOOL(n) ((n)->conn == TAU_CONN || (n)->conn == CTR_CONN)
+
+// A quantifier, such as ((<u> x) P).  Its variable is SEXPR_QUANT_VAR.
+#define SEXPR_IS_QUANT(n) (((n)->conn == UNV_CONN || (n)->conn == EXL_CONN) \
+			   && (n)->num_kids == 2 && (n)->kids[0]->num_kids == 2)
+#define SEXPR_QUANT_VAR(n) ((n)->kids[0]->kids[1])
+
+// The messages may come from different files, so compare the text.
+#define SEXPR_TREE_OK(r) (!strcmp ((r), CORRECT) || !strcmp ((r), NO_DIFFERENCE))
+
+// Rules that are checked over formula trees.
+//  n0 and n1 are a differing pair of subtrees, and the rule returns
+//  CORRECT if one follows from the other, an error message otherwise,
+//  or NULL on memory error.
+
+typedef char * (* sexpr_rule_func) (sexpr_node * n0, sexpr_node * n1);
+
+sexpr_tree * sexpr_tree_init (const unsigned char * in_str);
+void sexpr_tree_destroy (sexpr_tree * tree);
+
+int sexpr_node_equal (const sexpr_node * n0, const sexpr_node * n1);
+int sexpr_node_is (const sexpr_node * node, const char * atom);
+
+char * sexpr_tree_equiv (sexpr_node * n0, sexpr_node * n1,
+			 sexpr_rule_func rule);
+char * sexpr_tree_equiv_list (sexpr_node ** l0, sexpr_node ** l1, int num,
+			      sexpr_rule_func rule);
+char * sexpr_tree_either (sexpr_node * n0, sexpr_node * n1,
+			  sexpr_rule_func check);
+char * sexpr_tree_process (unsigned char * prem, unsigned char * conc,
+			   sexpr_rule_func rule);
+
+#endif  /*  ARIS_SEXPR_TREE_H  */
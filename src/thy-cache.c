@@ -0,0 +1,441 @@
+/* Functions for caching translated Isabelle theories.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* A translated theory is kept beside its source, as 'Foo.thyc' for
+ *  'Foo.thy'.  The first line of the cache holds a hash of the theory
+ *  and of every import that can be found next to it; each following
+ *  line holds one translated line:
+ *
+ *    p <text>    a premise, from a definition or function.
+ *    l <text>    a line for a lemma or theorem.
+ *    g <text>    a goal.
+ *
+ *  In the text, '%' and line breaks are written as %XX.
+ * If the hash doesn't match, the theory is translated again and the
+ *  cache replaced.  A cache that can't be written is not an error.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+
+#ifndef WIN32
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+#include <glib.h>
+#include "thy-cache.h"
+#include "isar-lex.h"
+#include "interop-isar.h"
+#include "proof.h"
+#include "sen-data.h"
+#include "list.h"
+
+#define THY_CACHE_MAGIC "aris-thy-cache 1"
+
+// The most imports that will be followed from one theory to the next.
+#define THY_CACHE_DEPTH 16
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+/* Adds bytes to a hash.
+ *  input:
+ *    hash - the hash so far.
+ *    str - the bytes to add.
+ *    len - the number of bytes.
+ *  output:
+ *    the new hash.
+ */
+static unsigned long long
+thy_hash_bytes (unsigned long long hash, const char * str, size_t len)
+{
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    {
+      hash ^= (unsigned char) str[i];
+      hash *= FNV_PRIME;
+    }
+
+  return hash;
+}
+
+/* Hashes a theory and the imports of it that are beside it.
+ *  input:
+ *    file_name - the name of the theory file.
+ *    hash - the hash so far, which receives the new hash.
+ *    depth - the number of imports followed to get here.
+ *  output:
+ *    0 on success, -1 on memory error, -2 on i/o error.
+ */
+static int
+thy_hash (const char * file_name, unsigned long long * hash, int depth)
+{
+  isar_lexer lx;
+  const char * slash, * name;
+  int ret, dir_len, len;
+
+  ret = isar_lex_open (file_name, &lx);
+  if (ret < 0)
+    return ret;
+
+  *hash = thy_hash_bytes (*hash, lx.buf, lx.size);
+
+  slash = strrchr (file_name, '/');
+  dir_len = slash ? slash - file_name + 1 : 0;
+
+  if (isar_lex_imports (&lx) == -1)
+    {
+      isar_lex_close (&lx);
+      return 0;
+    }
+
+  while (isar_lex_import (&lx, &name, &len))
+    {
+      char * path;
+      FILE * file;
+
+      // Imports from the library, such as Main, only add their names.
+      *hash = thy_hash_bytes (*hash, name, len);
+
+      if (depth >= THY_CACHE_DEPTH)
+        continue;
+
+      path = (char *) calloc (dir_len + len + 5, sizeof (char));
+      if (!path)
+        {
+          PERROR (NULL);
+          isar_lex_close (&lx);
+          return AEC_MEM;
+        }
+
+      sprintf (path, "%.*s%.*s.thy", dir_len, file_name, len, name);
+
+      file = fopen (path, "r");
+      if (file)
+        {
+          fclose (file);
+          ret = thy_hash (path, hash, depth + 1);
+          if (ret == AEC_MEM)
+            {
+              free (path);
+              isar_lex_close (&lx);
+              return AEC_MEM;
+            }
+        }
+
+      free (path);
+    }
+
+  isar_lex_close (&lx);
+  return 0;
+}
+
+/* Reads a line of any length from a file.
+ *  input:
+ *    file - the file from which to read.
+ *  output:
+ *    the line without its line break, or NULL at the end of the file
+ *    or on memory error.
+ */
+static char *
+thy_cache_read_line (FILE * file)
+{
+  char * line;
+  int len = 0, alloc = 256;
+
+  line = (char *) calloc (alloc, sizeof (char));
+  CHECK_ALLOC (line, NULL);
+
+  while (fgets (line + len, alloc - len, file))
+    {
+      len += strlen (line + len);
+      if (len > 0 && line[len - 1] == '\n')
+        {
+          line[--len] = '\0';
+          return line;
+        }
+
+      alloc *= 2;
+      line = (char *) realloc (line, alloc);
+      CHECK_ALLOC (line, NULL);
+    }
+
+  if (len > 0)
+    return line;
+
+  free (line);
+  return NULL;
+}
+
+/* Undoes the escapes of cached text in place.
+ *  input:
+ *    text - the text.
+ *  output:
+ *    none.
+ */
+static void
+thy_cache_unescape (char * text)
+{
+  int i, j;
+
+  for (i = j = 0; text[i]; i++, j++)
+    {
+      unsigned int c;
+
+      if (text[i] == '%' && sscanf (text + i + 1, "%2X", &c) == 1)
+        {
+          text[j] = (char) c;
+          i += 2;
+        }
+      else
+        {
+          text[j] = text[i];
+        }
+    }
+  text[j] = '\0';
+}
+
+/* Writes escaped text to a cache.
+ *  input:
+ *    file - the cache.
+ *    kind - the character that marks the kind of line.
+ *    text - the text.
+ *  output:
+ *    none.
+ */
+static void
+thy_cache_write_line (FILE * file, char kind, const char * text)
+{
+  fprintf (file, "%c ", kind);
+  for (; *text; text++)
+    {
+      if (*text == '%' || *text == '\n' || *text == '\r')
+        fprintf (file, "%%%02X", (unsigned char) *text);
+      else
+        fputc (*text, file);
+    }
+  fputc ('\n', file);
+}
+
+/* Reads a cached translation into a proof.
+ *  input:
+ *    cache_name - the name of the cache.
+ *    hash - the hash the cache must have.
+ *    proof - the proof to read into, which must be empty.
+ *  output:
+ *    0 on success, 1 if the cache is missing or out of date,
+ *    -1 on memory error.
+ */
+static int
+thy_cache_read (const char * cache_name, unsigned long long hash,
+                proof_t * proof)
+{
+  FILE * file;
+  char * line;
+  unsigned long long file_hash;
+  int ln = 0;
+
+  file = fopen (cache_name, "r");
+  if (!file)
+    return 1;
+
+  line = thy_cache_read_line (file);
+  if (!line
+      || strncmp (line, THY_CACHE_MAGIC " ", strlen (THY_CACHE_MAGIC) + 1)
+      || sscanf (line + strlen (THY_CACHE_MAGIC) + 1, "%llx", &file_hash) != 1
+      || file_hash != hash)
+    {
+      free (line);
+      fclose (file);
+      return 1;
+    }
+  free (line);
+
+  while ((line = thy_cache_read_line (file)) != NULL)
+    {
+      item_t * itm;
+
+      if (strlen (line) < 2 || line[1] != ' ')
+        {
+          free (line);
+          continue;
+        }
+
+      thy_cache_unescape (line + 2);
+
+      if (line[0] == 'g')
+        {
+          char * goal;
+
+          goal = strdup (line + 2);
+          if (!goal)
+            {
+              PERROR (NULL);
+              free (line);
+              fclose (file);
+              return AEC_MEM;
+            }
+
+          itm = ls_push_obj (proof->goals, goal);
+        }
+      else
+        {
+          sen_data * sd;
+
+          sd = sen_data_init (ln++, -1, (unsigned char *) line + 2, NULL,
+                              line[0] == 'p', NULL, 0, 0, NULL);
+          if (!sd)
+            {
+              free (line);
+              fclose (file);
+              return AEC_MEM;
+            }
+
+          itm = ls_push_obj (proof->everything, sd);
+        }
+
+      free (line);
+      if (!itm)
+        {
+          fclose (file);
+          return AEC_MEM;
+        }
+    }
+
+  fclose (file);
+  return 0;
+}
+
+/* Writes the translation of a theory to its cache.
+ * The cache is written to a uniquely named file beside it and renamed
+ *  into place, so that a grader running at the same time never reads
+ *  half a cache, and two graders never write the same temporary.
+ *  input:
+ *    cache_name - the name of the cache.
+ *    hash - the hash of the theory.
+ *    proof - the translated theory.
+ *  output:
+ *    none.
+ */
+static void
+thy_cache_write (const char * cache_name, unsigned long long hash,
+                 proof_t * proof)
+{
+  FILE * file;
+  item_t * itm;
+  char * tmp_name;
+  int fd, err;
+
+  tmp_name = (char *) calloc (strlen (cache_name) + 8, sizeof (char));
+  if (!tmp_name)
+    return;
+  sprintf (tmp_name, "%s.XXXXXX", cache_name);
+
+  fd = g_mkstemp_full (tmp_name, O_WRONLY, 0666);
+  if (fd == -1)
+    {
+      free (tmp_name);
+      return;
+    }
+
+  file = fdopen (fd, "w");
+  if (!file)
+    {
+      close (fd);
+      remove (tmp_name);
+      free (tmp_name);
+      return;
+    }
+
+  fprintf (file, "%s %016llx\n", THY_CACHE_MAGIC, hash);
+
+  for (itm = proof->everything->head; itm; itm = itm->next)
+    {
+      sen_data * sd = itm->value;
+      thy_cache_write_line (file, sd->premise ? 'p' : 'l',
+                            (const char *) sd->text);
+    }
+
+  for (itm = proof->goals->head; itm; itm = itm->next)
+    thy_cache_write_line (file, 'g', (const char *) itm->value);
+
+  // A cache that wasn't written whole is dropped.
+  err = ferror (file);
+  if (fclose (file) || err)
+    {
+      remove (tmp_name);
+      free (tmp_name);
+      return;
+    }
+
+#ifdef WIN32
+  remove (cache_name);
+#endif
+  if (rename (tmp_name, cache_name))
+    remove (tmp_name);
+
+  free (tmp_name);
+}
+
+/* Reads a theory into a proof, translating it only if its cache is out
+ *  of date.
+ *  input:
+ *    file_name - the name of the theory file.
+ *    proof - the proof to read into, which must be empty.
+ *  output:
+ *    0 on success, -1 on memory error, -2 on an invalid theory.
+ */
+int
+thy_cache_parse (char * file_name, proof_t * proof)
+{
+  unsigned long long hash = FNV_OFFSET;
+  char * cache_name;
+  int ret;
+
+  hash = thy_hash_bytes (hash, THY_CACHE_MAGIC, strlen (THY_CACHE_MAGIC));
+  ret = thy_hash (file_name, &hash, 0);
+  if (ret == AEC_MEM)
+    return AEC_MEM;
+
+  // A theory that can't be read can't be cached either.
+  if (ret < 0)
+    return parse_thy (file_name, proof);
+
+  cache_name = (char *) calloc (strlen (file_name) + 2, sizeof (char));
+  CHECK_ALLOC (cache_name, AEC_MEM);
+  sprintf (cache_name, "%sc", file_name);
+
+  ret = thy_cache_read (cache_name, hash, proof);
+  if (ret != 1)
+    {
+      free (cache_name);
+      return ret;
+    }
+
+  ret = parse_thy (file_name, proof);
+  if (ret == 0)
+    thy_cache_write (cache_name, hash, proof);
+
+  free (cache_name);
+  return ret;
+}
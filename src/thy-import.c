@@ -0,0 +1,425 @@
+/* Functions for importing directories of Isabelle theories.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Every theory under a directory is translated to a proof file beside
+ *  it, 'Foo.tle' for 'Foo.thy'.  A theory is only translated once the
+ *  theories it imports from the same directory are, so independent
+ *  theories are translated at the same time by forked processes.  The
+ *  standard sequences are built once, before forking, and so are
+ *  shared by all of them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+#include "thy-import.h"
+#include "thy-cache.h"
+#include "isar-lex.h"
+#include "interop-isar.h"
+#include "aio.h"
+#include "proof.h"
+#include "vec.h"
+
+struct thy_node {
+  char * path;          // The path of the theory.
+  int waiting;          // The number of its imports not yet translated.
+  vec_t * dependents;   // The theories that import it.
+  int queued;           // Whether it has been queued for translation.
+};
+
+/* Collects the theories under a directory.
+ *  input:
+ *    dir_name - the directory.
+ *    paths - receives the path of each theory.
+ *  output:
+ *    0 on success, -1 on memory error, -2 on i/o error.
+ */
+static int
+thy_import_collect (const char * dir_name, vec_t * paths)
+{
+  DIR * dir;
+  struct dirent * ent;
+  int ret = 0;
+
+  dir = opendir (dir_name);
+  if (!dir)
+    {
+      perror (dir_name);
+      return AEC_IO;
+    }
+
+  while (ret == 0 && (ent = readdir (dir)) != NULL)
+    {
+      struct stat st;
+      char * path;
+      int len;
+
+      if (ent->d_name[0] == '.')
+        continue;
+
+      path = (char *) calloc (strlen (dir_name) + strlen (ent->d_name) + 2,
+                              sizeof (char));
+      if (!path)
+        {
+          PERROR (NULL);
+          ret = AEC_MEM;
+          break;
+        }
+      sprintf (path, "%s/%s", dir_name, ent->d_name);
+
+      len = strlen (path);
+      if (stat (path, &st) == 0)
+        {
+          if (S_ISDIR (st.st_mode))
+            ret = thy_import_collect (path, paths);
+          else if (len > 4 && !strcmp (path + len - 4, ".thy"))
+            ret = (vec_str_add_obj (paths, (unsigned char *) path) < 0) ? AEC_MEM : 0;
+        }
+
+      free (path);
+    }
+
+  closedir (dir);
+  return ret;
+}
+
+/* Finds which of the theories each theory imports.
+ *  input:
+ *    nodes - the theories.
+ *    num - the number of theories.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+static int
+thy_import_deps (struct thy_node * nodes, int num)
+{
+  int i, j;
+
+  for (i = 0; i < num; i++)
+    {
+      isar_lexer lx;
+      const char * slash, * name;
+      int dir_len, len;
+
+      if (isar_lex_open (nodes[i].path, &lx) < 0)
+        continue;
+
+      slash = strrchr (nodes[i].path, '/');
+      dir_len = slash ? slash - nodes[i].path + 1 : 0;
+
+      if (isar_lex_imports (&lx) == -1)
+        {
+          isar_lex_close (&lx);
+          continue;
+        }
+
+      while (isar_lex_import (&lx, &name, &len))
+        {
+          for (j = 0; j < num; j++)
+            {
+              const char * path = nodes[j].path;
+
+              if (j != i && !strncmp (path, nodes[i].path, dir_len)
+                  && !strncmp (path + dir_len, name, len)
+                  && !strcmp (path + dir_len + len, ".thy"))
+                break;
+            }
+
+          if (j == num)
+            continue;
+
+          if (vec_add_obj (nodes[j].dependents, &i) < 0)
+            {
+              isar_lex_close (&lx);
+              return AEC_MEM;
+            }
+          nodes[i].waiting++;
+        }
+
+      isar_lex_close (&lx);
+    }
+
+  return 0;
+}
+
+/* Translates a theory to a proof file beside it.
+ *  input:
+ *    path - the path of the theory.
+ *  output:
+ *    0 on success, -1 on memory error, -2 if it couldn't be translated
+ *    or saved.
+ */
+static int
+thy_import_one (const char * path)
+{
+  proof_t * proof;
+  char * out_name;
+  int ret, len;
+
+  proof = proof_init ();
+  if (!proof)
+    return AEC_MEM;
+
+  ret = thy_cache_parse ((char *) path, proof);
+  if (ret == 0)
+    {
+      len = strlen (path);
+      out_name = strdup (path);
+      if (!out_name)
+        {
+          PERROR (NULL);
+          ret = AEC_MEM;
+        }
+      else
+        {
+          strcpy (out_name + len - 3, "tle");
+          if (aio_save (proof, out_name) < 0)
+            ret = AEC_IO;
+          free (out_name);
+        }
+    }
+
+  proof_destroy (proof);
+  free (proof);
+
+  return (ret == AEC_MEM) ? AEC_MEM : (ret < 0) ? AEC_IO : 0;
+}
+
+/* Records that a theory has been translated, and queues the theories
+ *  that were waiting only on it.
+ *  input:
+ *    nodes - the theories.
+ *    i - the index of the theory.
+ *    ret - the result of translating it.
+ *    ready - the queue of theories ready to be translated.
+ *    tail - the end of the queue.
+ *  output:
+ *    1 if the theory failed, 0 if it didn't.
+ */
+static int
+thy_import_finish (struct thy_node * nodes, int i, int ret,
+                   int * ready, int * tail)
+{
+  int j;
+
+  if (ret < 0)
+    fprintf (stderr, "Import Error - unable to translate \"%s\".\n",
+             nodes[i].path);
+
+  // A failed import is still released, since its dependents don't
+  //  read its translation.
+  for (j = 0; j < (int) nodes[i].dependents->num_stuff; j++)
+    {
+      int dep = *((int *) vec_nth (nodes[i].dependents, j));
+
+      nodes[dep].waiting--;
+      if (nodes[dep].waiting == 0 && !nodes[dep].queued)
+        {
+          nodes[dep].queued = 1;
+          ready[(*tail)++] = dep;
+        }
+    }
+
+  return (ret < 0);
+}
+
+/* Translates every theory under a directory.
+ *  input:
+ *    dir_name - the directory.
+ *    jobs - the most theories to translate at the same time.
+ *  output:
+ *    the number of theories that couldn't be translated,
+ *    -1 on memory error, -2 if the directory couldn't be read.
+ */
+int
+thy_import_dir (const char * dir_name, int jobs)
+{
+  vec_t * paths;
+  struct thy_node * nodes;
+  int * ready;
+  int num, i, ret, head = 0, tail = 0, done = 0, failed = 0;
+  int running = 0;
+#ifndef WIN32
+  pid_t * pids;     // The process translating in each slot, or 0.
+  int * slots;      // The theory being translated in each slot.
+#else
+  jobs = 1;
+#endif
+
+  if (jobs < 1)
+    jobs = 1;
+
+  paths = init_vec (sizeof (char *));
+  if (!paths)
+    return AEC_MEM;
+
+  ret = thy_import_collect (dir_name, paths);
+  if (ret < 0)
+    {
+      destroy_str_vec (paths);
+      return ret;
+    }
+
+  num = paths->num_stuff;
+  nodes = (struct thy_node *) calloc (num + 1, sizeof (struct thy_node));
+  CHECK_ALLOC (nodes, AEC_MEM);
+
+  ready = (int *) calloc (num + 1, sizeof (int));
+  CHECK_ALLOC (ready, AEC_MEM);
+
+#ifndef WIN32
+  pids = (pid_t *) calloc (jobs, sizeof (pid_t));
+  CHECK_ALLOC (pids, AEC_MEM);
+
+  slots = (int *) calloc (jobs, sizeof (int));
+  CHECK_ALLOC (slots, AEC_MEM);
+#endif
+
+  for (i = 0; i < num; i++)
+    {
+      nodes[i].path = (char *) vec_str_nth (paths, i);
+      nodes[i].dependents = init_vec (sizeof (int));
+      if (!nodes[i].dependents)
+        return AEC_MEM;
+    }
+
+  ret = thy_import_deps (nodes, num);
+  if (ret < 0)
+    return ret;
+
+  ret = get_std_seqs ();
+  if (ret < 0)
+    return ret;
+
+  for (i = 0; i < num; i++)
+    {
+      if (nodes[i].waiting == 0)
+        {
+          nodes[i].queued = 1;
+          ready[tail++] = i;
+        }
+    }
+
+  while (done < num)
+    {
+      if (head == tail && running == 0)
+        {
+          // Whatever is left imports itself somehow, so order is moot.
+          fprintf (stderr, "Import Warning - \
+the remaining theories import each other in a cycle.\n");
+          for (i = 0; i < num; i++)
+            {
+              if (!nodes[i].queued)
+                {
+                  nodes[i].queued = 1;
+                  ready[tail++] = i;
+                }
+            }
+        }
+
+      while (running < jobs && head < tail)
+        {
+          i = ready[head++];
+
+#ifndef WIN32
+          if (jobs > 1)
+            {
+              pid_t pid;
+              int slot;
+
+              fflush (stdout);
+              fflush (stderr);
+
+              pid = fork ();
+              if (pid == 0)
+                {
+                  ret = thy_import_one (nodes[i].path);
+                  fflush (stdout);
+                  _exit ((ret < 0) ? EXIT_FAILURE : EXIT_SUCCESS);
+                }
+
+              if (pid > 0)
+                {
+                  for (slot = 0; pids[slot]; slot++);
+                  pids[slot] = pid;
+                  slots[slot] = i;
+                  running++;
+                  continue;
+                }
+
+              // Translate it here if it can't be forked.
+              perror (NULL);
+            }
+#endif
+
+          ret = thy_import_one (nodes[i].path);
+          if (ret == AEC_MEM)
+            return AEC_MEM;
+
+          failed += thy_import_finish (nodes, i, ret, ready, &tail);
+          done++;
+        }
+
+#ifndef WIN32
+      if (running > 0)
+        {
+          pid_t pid;
+          int status, slot;
+
+          pid = wait (&status);
+          if (pid < 0)
+            {
+              perror (NULL);
+              return AEC_IO;
+            }
+
+          for (slot = 0; slot < jobs && pids[slot] != pid; slot++);
+          if (slot == jobs)
+            continue;
+
+          pids[slot] = 0;
+          running--;
+          i = slots[slot];
+
+          ret = (WIFEXITED (status) && WEXITSTATUS (status) == EXIT_SUCCESS)
+            ? 0 : AEC_IO;
+          failed += thy_import_finish (nodes, i, ret, ready, &tail);
+          done++;
+        }
+#endif
+    }
+
+  for (i = 0; i < num; i++)
+    destroy_vec (nodes[i].dependents);
+
+  free (nodes);
+  free (ready);
+#ifndef WIN32
+  free (pids);
+  free (slots);
+#endif
+  destroy_str_vec (paths);
+
+  return failed;
+}
@@ -0,0 +1,26 @@
+/* Importing directories of Isabelle theories.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_THY_IMPORT_H
+#define ARIS_THY_IMPORT_H
+
+#include "typedef.h"
+
+int thy_import_dir (const char * dir_name, int jobs);
+
+#endif  /*  ARIS_THY_IMPORT_H  */
@@ -0,0 +1,366 @@
+/* The sentence tokenizer.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* The checking and conversion functions used to walk a sentence one byte at
+   a time, running strncmp against every connective at every position.
+   Instead, a sentence is classified once into a bitmap of identifier bytes
+   (letters, digits and underscores) and a bitmap of upper case letters.
+   These bitmaps are built sixteen or thirty-two bytes at a time when SSE2 or
+   AVX2 is available, and one byte at a time otherwise.  The tokens are then
+   read off the bitmaps, so only the bytes between identifiers are ever
+   compared against the connectives.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined (__AVX2__)
+#include <immintrin.h>
+#elif defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "tokenize.h"
+#include "process.h"
+
+#define TOK_BIT(m,i) (((m)[(i) >> 6] >> ((i) & 63)) & 1)
+
+/* Classifies a range of bytes, one byte at a time.
+ *  input:
+ *    str - the string to classify.
+ *    start - the first byte to classify.
+ *    len - the length of str.
+ *    word - the identifier byte bitmap.
+ *    upper - the upper case letter bitmap.
+ *  output:
+ *    none.
+ */
+static void
+tok_classify_bytes (const unsigned char * str, int start, int len,
+		    uint64_t * word, uint64_t * upper)
+{
+  int i;
+
+  for (i = start; i < len; i++)
+    {
+      unsigned char c = str[i];
+      uint64_t bit = (uint64_t) 1 << (i & 63);
+
+      if (c >= 'A' && c <= 'Z')
+	{
+	  word[i >> 6] |= bit;
+	  upper[i >> 6] |= bit;
+	}
+      else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_')
+	{
+	  word[i >> 6] |= bit;
+	}
+    }
+}
+
+#if defined (__AVX2__)
+
+#define TOK_BLOCK 32
+
+static inline __m256i
+tok_in_range (__m256i v, char lo, char hi)
+{
+  return _mm256_and_si256 (_mm256_cmpgt_epi8 (v, _mm256_set1_epi8 (lo - 1)),
+			   _mm256_cmpgt_epi8 (_mm256_set1_epi8 (hi + 1), v));
+}
+
+/* Classifies a block of thirty-two bytes.
+ *  input:
+ *    str - the block to classify.
+ *    word - receives the identifier byte mask.
+ *    upper - receives the upper case letter mask.
+ *  output:
+ *    none.
+ */
+static inline void
+tok_classify_block (const unsigned char * str, uint64_t * word,
+		    uint64_t * upper)
+{
+  __m256i v, up, wd;
+
+  v = _mm256_loadu_si256 ((const __m256i *) str);
+  up = tok_in_range (v, 'A', 'Z');
+  wd = _mm256_or_si256 (up, tok_in_range (v, 'a', 'z'));
+  wd = _mm256_or_si256 (wd, tok_in_range (v, '0', '9'));
+  wd = _mm256_or_si256 (wd, _mm256_cmpeq_epi8 (v, _mm256_set1_epi8 ('_')));
+
+  *word = (uint32_t) _mm256_movemask_epi8 (wd);
+  *upper = (uint32_t) _mm256_movemask_epi8 (up);
+}
+
+#elif defined (__SSE2__)
+
+#define TOK_BLOCK 16
+
+static inline __m128i
+tok_in_range (__m128i v, char lo, char hi)
+{
+  return _mm_and_si128 (_mm_cmpgt_epi8 (v, _mm_set1_epi8 (lo - 1)),
+			_mm_cmplt_epi8 (v, _mm_set1_epi8 (hi + 1)));
+}
+
+/* Classifies a block of sixteen bytes.
+ *  input:
+ *    str - the block to classify.
+ *    word - receives the identifier byte mask.
+ *    upper - receives the upper case letter mask.
+ *  output:
+ *    none.
+ */
+static inline void
+tok_classify_block (const unsigned char * str, uint64_t * word,
+		    uint64_t * upper)
+{
+  __m128i v, up, wd;
+
+  v = _mm_loadu_si128 ((const __m128i *) str);
+  up = tok_in_range (v, 'A', 'Z');
+  wd = _mm_or_si128 (up, tok_in_range (v, 'a', 'z'));
+  wd = _mm_or_si128 (wd, tok_in_range (v, '0', '9'));
+  wd = _mm_or_si128 (wd, _mm_cmpeq_epi8 (v, _mm_set1_epi8 ('_')));
+
+  *word = (uint16_t) _mm_movemask_epi8 (wd);
+  *upper = (uint16_t) _mm_movemask_epi8 (up);
+}
+
+#endif
+
+/* Builds the identifier and upper case bitmaps of a string.
+ *  input:
+ *    str - the string to classify.
+ *    len - the length of str.
+ *    word - the identifier byte bitmap, which must be zeroed.
+ *    upper - the upper case letter bitmap, which must be zeroed.
+ *  output:
+ *    none.
+ */
+static void
+tok_classify (const unsigned char * str, int len,
+	      uint64_t * word, uint64_t * upper)
+{
+  int i = 0;
+
+#ifdef TOK_BLOCK
+  for (; i + TOK_BLOCK <= len; i += TOK_BLOCK)
+    {
+      uint64_t w, u;
+
+      tok_classify_block (str + i, &w, &u);
+      word[i >> 6] |= w << (i & 63);
+      upper[i >> 6] |= u << (i & 63);
+    }
+#endif
+
+  tok_classify_bytes (str, i, len, word, upper);
+}
+
+/* Finds the next bit of a bitmap with a given value.
+ *  input:
+ *    map - the bitmap to search.
+ *    len - the number of bits in the bitmap.
+ *    pos - the position at which to begin searching.
+ *    set - 1 to search for a set bit, 0 for a clear bit.
+ *  output:
+ *    the position of the bit, or len if there is none.
+ */
+static int
+tok_next_bit (const uint64_t * map, int len, int pos, int set)
+{
+  int w;
+  uint64_t cur;
+
+  if (pos >= len)
+    return len;
+
+  w = pos >> 6;
+  cur = set ? map[w] : ~map[w];
+  cur &= ~(uint64_t) 0 << (pos & 63);
+
+  while (!cur)
+    {
+      w++;
+      if ((w << 6) >= len)
+	return len;
+      cur = set ? map[w] : ~map[w];
+    }
+
+  pos = (w << 6) + __builtin_ctzll (cur);
+  return (pos < len) ? pos : len;
+}
+
+/* Splits a sentence into tokens.
+ *  input:
+ *    str - the sentence to tokenize.
+ *    conns - the connectives in which the sentence is written.
+ *    toks - receives the tokens, terminated by a TOK_END token.
+ *  output:
+ *    the number of tokens, not counting the TOK_END token,
+ *    or -1 on memory error, in which case toks receives NULL.
+ */
+int
+tokenize (const unsigned char * str,
+	  const struct connectives_list * conns,
+	  token_t ** toks)
+{
+  const char * conn_strs[NUM_CONNS] = {
+    conns->and, conns->or, conns->not, conns->con, conns->bic, conns->unv,
+    conns->exl, conns->tau, conns->ctr, conns->elm, conns->nil
+  };
+  int conn_lens[NUM_CONNS];
+  signed char conn_bytes[256];
+  int single_byte;
+  uint64_t * word, * upper;
+  int * parens;
+  int len, num_words, num_toks, num_parens, pos, i;
+
+  // The internal connectives are a single byte each, so they are
+  //  looked up directly rather than compared.
+  single_byte = (conns->cl == 1 && conns->nl == 1);
+  if (single_byte)
+    memset (conn_bytes, -1, sizeof (conn_bytes));
+
+  for (i = 0; i < NUM_CONNS; i++)
+    {
+      conn_lens[i] = strlen (conn_strs[i]);
+      if (single_byte)
+	conn_bytes[(unsigned char) conn_strs[i][0]] = i;
+    }
+
+  len = strlen ((const char *) str);
+  num_words = (len >> 6) + 1;
+
+  word = (uint64_t *) calloc (num_words, sizeof (uint64_t));
+  upper = (uint64_t *) calloc (num_words, sizeof (uint64_t));
+  *toks = (token_t *) calloc (len + 1, sizeof (token_t));
+  parens = (int *) calloc (len + 1, sizeof (int));
+  if (!word || !upper || !*toks || !parens)
+    {
+      PERROR (NULL);
+      free (word);
+      free (upper);
+      free (*toks);
+      free (parens);
+      *toks = NULL;
+      return AEC_MEM;
+    }
+
+  tok_classify (str, len, word, upper);
+
+  num_toks = num_parens = 0;
+  pos = 0;
+  while (pos < len)
+    {
+      token_t * tok = *toks + num_toks;
+      unsigned char c = str[pos];
+
+      tok->pos = pos;
+      tok->len = 1;
+      tok->conn = -1;
+      tok->match = -1;
+
+      if (TOK_BIT (word, pos) && c != '_')
+	{
+	  // An identifier is an alphanumeric character followed by lower
+	  //  case letters, digits and underscores.
+	  int end, up;
+
+	  end = tok_next_bit (word, len, pos, 0);
+	  up = tok_next_bit (upper, len, pos + 1, 1);
+
+	  tok->type = TOK_IDENT;
+	  tok->len = ((up < end) ? up : end) - pos;
+	}
+      else
+	{
+	  tok->type = TOK_OTHER;
+
+	  if (single_byte && conn_bytes[c] >= 0)
+	    {
+	      tok->type = TOK_CONN;
+	      tok->conn = conn_bytes[c];
+	    }
+
+	  for (i = 0; !single_byte && i < NUM_CONNS; i++)
+	    {
+	      if (c == (unsigned char) conn_strs[i][0]
+		  && !strncmp ((const char *) str + pos, conn_strs[i],
+			       conn_lens[i]))
+		{
+		  tok->type = TOK_CONN;
+		  tok->conn = i;
+		  tok->len = conn_lens[i];
+		  break;
+		}
+	    }
+
+	  if (tok->type != TOK_CONN)
+	    {
+	      switch (c)
+		{
+		case '(':
+		  tok->type = TOK_OPAREN;
+		  parens[num_parens++] = num_toks;
+		  break;
+
+		case ')':
+		  tok->type = TOK_CPAREN;
+		  if (num_parens > 0)
+		    {
+		      num_parens--;
+		      tok->match = parens[num_parens];
+		      (*toks)[tok->match].match = num_toks;
+		    }
+		  break;
+
+		case ' ':
+		  tok->type = TOK_SPACE;
+		  break;
+
+		case ',':
+		case '+':
+		case '*':
+		case '=':
+		case '<':
+		  tok->type = TOK_SEP;
+		  break;
+		}
+	    }
+	}
+
+      pos += tok->len;
+      num_toks++;
+    }
+
+  (*toks)[num_toks].type = TOK_END;
+  (*toks)[num_toks].conn = -1;
+  (*toks)[num_toks].pos = len;
+  (*toks)[num_toks].len = 0;
+  (*toks)[num_toks].match = -1;
+
+  free (word);
+  free (upper);
+  free (parens);
+
+  return num_toks;
+}
@@ -0,0 +1,59 @@
+/* The sentence tokenizer.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ARIS_TOKENIZE_H
+#define ARIS_TOKENIZE_H
+
+#include "typedef.h"
+
+struct connectives_list;
+
+enum TOKEN_TYPES {
+  TOK_END = 0,
+  TOK_OPAREN,
+  TOK_CPAREN,
+  TOK_SPACE,
+  TOK_CONN,
+  TOK_IDENT,
+  TOK_SEP,
+  TOK_OTHER
+};
+
+// A single token of a sentence.
+
+struct token {
+  int type;     // One of TOKEN_TYPES.
+  int conn;     // The CONN_ORDER index of a connective, -1 otherwise.
+  int pos;      // The byte offset of the token in the sentence.
+  int len;      // The length of the token in bytes.
+  int match;    // The index of the matching parenthesis, -1 otherwise.
+};
+
+#define TOK_IS_CONN(t,c) ((t)->type == TOK_CONN && (t)->conn == (c))
+
+#define TOK_IS_BIN_CONN(t) ((t)->type == TOK_CONN		\
+			    && ((t)->conn == AND_CONN		\
+				|| (t)->conn == OR_CONN		\
+				|| (t)->conn == CON_CONN	\
+				|| (t)->conn == BIC_CONN))
+
+int tokenize (const unsigned char * str,
+	      const struct connectives_list * conns,
+	      token_t ** toks);
+
+#endif  /*  ARIS_TOKENIZE_H  */
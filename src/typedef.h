@@ -38,6 +38,27 @@ typedef struct rules_group rules_group;
 typedef struct conf_object conf_obj;
 typedef struct menu_item_data mid_t;
 typedef struct undo_info undo_info;
+typedef struct undo_ring undo_ring;
+typedef struct token token_t;
+typedef struct sexpr_node sexpr_node;
+typedef struct sexpr_tree sexpr_tree;
+typedef struct rule_template rule_template;
+typedef struct sexpr_sig sexpr_sig;
+typedef struct sen_widgets sen_widgets;
+typedef struct live_job live_job;
+typedef struct live_snapshot live_snapshot;
+typedef struct proof_editor proof_editor;
+typedef struct isar_token isar_token;
+typedef struct isar_lexer isar_lexer;
+typedef struct corpus_reader corpus_reader;
+typedef struct corpus_entry corpus_entry;
+typedef struct lemma lemma;
+typedef struct autosave_job autosave_job;
+typedef struct autosave_line autosave_line;
+typedef struct line_result line_result;
+typedef struct report report;
+typedef struct rank_node rank_node;
+typedef struct rank_tree rank_tree;
 
 typedef void * (* conf_obj_value_func) (conf_obj * obj, int get);
 
@@ -26,6 +26,37 @@
 #include "vec.h"
 #include "sen-data.h"
 #include "sentence.h"
+#include "process.h"
+
+/* Determines the memory used by a sentence data object.
+ *  input:
+ *    sd - the sentence data.
+ *  output:
+ *    the approximate number of bytes used by sd.
+ */
+static size_t
+undo_sd_size (sen_data * sd)
+{
+  size_t size = sizeof (sen_data) + sizeof (item_t);
+  int i;
+
+  if (sd->text)
+    size += strlen ((const char *) sd->text) + 1;
+  if (sd->sexpr)
+    size += strlen ((const char *) sd->sexpr) + 1;
+  if (sd->file)
+    size += strlen ((const char *) sd->file) + 1;
+
+  if (sd->refs)
+    {
+      for (i = 0; sd->refs[i] != REF_END; i++);
+      size += (i + 1) * sizeof (short);
+    }
+
+  size += (sd->depth + 1) * sizeof (int);
+
+  return size;
+}
 
 /* Initialize and undo information object.
  *  input:
@@ -40,17 +71,22 @@ undo_info_init (aris_proof * ap, list_t * sens, int type)
 {
   undo_info ret;
   ret.type = -1;
+  ret.removed = ret.inserted = NULL;
+  ret.line_num = ret.offset = -1;
 
   item_t * it, * nit;
   ret.ls = init_list ();
   if (!ret.ls)
     return ret;
 
+  ret.size = sizeof (undo_info) + sizeof (list_t);
+
   for (it = sens->head; it;)
     {
       nit = it->next;
       sen_data * sd = it->value;
       ls_push_obj (ret.ls, sd);
+      ret.size += undo_sd_size (sd);
       free (it);
       it = nit;
     }
@@ -108,6 +144,168 @@ undo_info_init_one (aris_proof * ap, sentence * sen, int type)
   return ret;
 }
 
+/* Initialize an undo information object from a change to the text
+ *  of a line.
+ * Only the part of the text that changed is kept.
+ *  input:
+ *    line_num - the line whose text is being modified.
+ *    old_text - the text of the line.
+ *    new_text - the text that it is being changed to.
+ *  output:
+ *    A newly initialized undo information object.
+ */
+undo_info
+undo_info_init_diff (int line_num, unsigned char * old_text,
+                     unsigned char * new_text)
+{
+  undo_info ret = { 0 };
+  int old_len, new_len, start, end;
+
+  ret.type = -1;
+  ret.ls = NULL;
+
+  old_len = strlen ((const char *) old_text);
+  new_len = strlen ((const char *) new_text);
+
+  // Find the span that differs, from both ends.
+  start = find_difference (old_text, new_text);
+  if (start == -1)
+    start = (old_len < new_len) ? old_len : new_len;
+
+  for (end = 0; end < old_len - start && end < new_len - start; end++)
+    {
+      if (old_text[old_len - end - 1] != new_text[new_len - end - 1])
+        break;
+    }
+
+  ret.removed = (unsigned char *) calloc (old_len - start - end + 1,
+                                          sizeof (char));
+  CHECK_ALLOC (ret.removed, ret);
+  memcpy (ret.removed, old_text + start, old_len - start - end);
+
+  ret.inserted = (unsigned char *) calloc (new_len - start - end + 1,
+                                           sizeof (char));
+  CHECK_ALLOC (ret.inserted, ret);
+  memcpy (ret.inserted, new_text + start, new_len - start - end);
+
+  ret.line_num = line_num;
+  ret.offset = start;
+  ret.size = sizeof (undo_info) + old_len + new_len - 2 * (start + end) + 2;
+  ret.stamp = time (NULL);
+  ret.type = UIT_MOD_TEXT;
+
+  return ret;
+}
+
+/* Initialize an undo information object from a text modification.
+ *  input:
+ *    sen - the sentence whose text is being modified.
+ *    new_text - the text that it is being changed to.
+ *  output:
+ *    A newly initialized undo information object.
+ */
+undo_info
+undo_info_init_text (sentence * sen, unsigned char * new_text)
+{
+  return undo_info_init_diff (sentence_get_line_no (sen),
+                              sentence_get_text (sen), new_text);
+}
+
+/* Takes a text modification back out of the current text of its line.
+ * The removed and inserted text are swapped afterward,
+ *  so the same object serves for both undo and redo.
+ *  input:
+ *    ui - the text modification.
+ *    text - the current text of the line.
+ *    new_text - receives the text with the modification taken back.
+ *  output:
+ *    0 on success, -1 on memory error, 1 if the text no longer matches.
+ */
+int
+undo_info_revert_text (undo_info * ui, unsigned char * text,
+                       unsigned char ** new_text)
+{
+  unsigned char * tmp;
+  int old_len, ins_len, rem_len;
+
+  old_len = strlen ((const char *) text);
+  ins_len = strlen ((const char *) ui->inserted);
+  rem_len = strlen ((const char *) ui->removed);
+
+  if (ui->offset + ins_len > old_len
+      || strncmp ((const char *) text + ui->offset,
+                  (const char *) ui->inserted, ins_len))
+    return 1;
+
+  *new_text = (unsigned char *) calloc (old_len - ins_len + rem_len + 1,
+                                        sizeof (char));
+  CHECK_ALLOC (*new_text, AEC_MEM);
+
+  memcpy (*new_text, text, ui->offset);
+  memcpy (*new_text + ui->offset, ui->removed, rem_len);
+  strcpy ((char *) *new_text + ui->offset + rem_len,
+          (const char *) text + ui->offset + ins_len);
+
+  tmp = ui->removed;
+  ui->removed = ui->inserted;
+  ui->inserted = tmp;
+
+  return 0;
+}
+
+/* Merges a text modification into the one before it, if it continues it.
+ *  input:
+ *    last - the previous text modification.
+ *    ui - the new text modification.
+ *  output:
+ *    1 if ui was merged into last, 0 if not, -1 on memory error.
+ */
+int
+undo_info_merge (undo_info * last, undo_info * ui)
+{
+  int last_ins, last_rem, ui_ins, ui_rem;
+  unsigned char * joined;
+
+  if (last->type != UIT_MOD_TEXT || ui->type != UIT_MOD_TEXT
+      || last->line_num != ui->line_num
+      || ui->stamp - last->stamp > UNDO_INT)
+    return 0;
+
+  last_ins = strlen ((const char *) last->inserted);
+  last_rem = strlen ((const char *) last->removed);
+  ui_ins = strlen ((const char *) ui->inserted);
+  ui_rem = strlen ((const char *) ui->removed);
+
+  if (ui_rem == 0 && ui->offset == last->offset + last_ins)
+    {
+      // Typing onward from the last change.
+      joined = (unsigned char *) realloc (last->inserted, last_ins + ui_ins + 1);
+      CHECK_ALLOC (joined, AEC_MEM);
+      memcpy (joined + last_ins, ui->inserted, ui_ins + 1);
+      last->inserted = joined;
+    }
+  else if (ui_ins == 0 && last_ins == 0
+           && ui->offset + ui_rem == last->offset)
+    {
+      // Deleting backward from the last change.
+      joined = (unsigned char *) calloc (ui_rem + last_rem + 1, sizeof (char));
+      CHECK_ALLOC (joined, AEC_MEM);
+      memcpy (joined, ui->removed, ui_rem);
+      memcpy (joined + ui_rem, last->removed, last_rem);
+      free (last->removed);
+      last->removed = joined;
+      last->offset = ui->offset;
+    }
+  else
+    {
+      return 0;
+    }
+
+  last->size += ui->size - sizeof (undo_info);
+  last->stamp = ui->stamp;
+  return 1;
+}
+
 /* Destroy an undo information object.
  *  input:
  *    ui - the undo information object to destroy.
@@ -133,6 +331,197 @@ undo_info_destroy (undo_info ui)
       free (ui.ls);
     }
   ui.ls = NULL;
+
+  if (ui.removed)
+    free (ui.removed);
+  if (ui.inserted)
+    free (ui.inserted);
+}
+
+/* Initializes an undo ring.
+ *  input:
+ *    none.
+ *  output:
+ *    the new undo ring, or NULL on memory error.
+ */
+undo_ring *
+undo_ring_init ()
+{
+  undo_ring * ring;
+
+  ring = (undo_ring *) calloc (1, sizeof (undo_ring));
+  CHECK_ALLOC (ring, NULL);
+
+  ring->alloc = 16;
+  ring->infos = (undo_info *) calloc (ring->alloc, sizeof (undo_info));
+  CHECK_ALLOC (ring->infos, NULL);
+
+  ring->start = ring->num_stuff = 0;
+  ring->size = 0;
+
+  return ring;
+}
+
+/* Destroys an undo ring and its objects.
+ *  input:
+ *    ring - the undo ring to destroy.
+ *  output:
+ *    none.
+ */
+void
+undo_ring_destroy (undo_ring * ring)
+{
+  while (ring->num_stuff > 0)
+    undo_ring_pop (ring);
+
+  free (ring->infos);
+  free (ring);
+}
+
+/* Returns the nth oldest object of an undo ring.
+ */
+undo_info *
+undo_ring_nth (undo_ring * ring, int n)
+{
+  if (n < 0 || n >= ring->num_stuff)
+    return NULL;
+
+  return ring->infos + (ring->start + n) % ring->alloc;
+}
+
+/* Pushes an undo information object onto an undo ring.
+ *  input:
+ *    ring - the undo ring.
+ *    ui - the undo information object, which the ring takes over.
+ *  output:
+ *    0 on success, -1 on memory error.
+ */
+int
+undo_ring_push (undo_ring * ring, undo_info ui)
+{
+  if (ring->num_stuff == ring->alloc)
+    {
+      undo_info * infos;
+      int i;
+
+      // Unwrap the ring into the larger space.
+      infos = (undo_info *) calloc (ring->alloc * 2, sizeof (undo_info));
+      CHECK_ALLOC (infos, AEC_MEM);
+
+      for (i = 0; i < ring->num_stuff; i++)
+        infos[i] = *undo_ring_nth (ring, i);
+
+      free (ring->infos);
+      ring->infos = infos;
+      ring->alloc *= 2;
+      ring->start = 0;
+    }
+
+  ring->infos[(ring->start + ring->num_stuff) % ring->alloc] = ui;
+  ring->num_stuff++;
+  ring->size += ui.size;
+
+  return 0;
+}
+
+/* Destroys the newest object of an undo ring.
+ *  input:
+ *    ring - the undo ring.
+ *  output:
+ *    none.
+ */
+void
+undo_ring_pop (undo_ring * ring)
+{
+  undo_info * ui;
+
+  if (ring->num_stuff == 0)
+    return;
+
+  ui = undo_ring_nth (ring, ring->num_stuff - 1);
+  ring->size -= ui->size;
+  undo_info_destroy (*ui);
+  ring->num_stuff--;
+}
+
+/* Destroys the oldest objects of an undo ring until it fits its budget.
+ * The newest object is always kept.
+ *  input:
+ *    ring - the undo ring.
+ *    budget - the most memory that the objects may use, in bytes.
+ *  output:
+ *    the number of objects destroyed.
+ */
+int
+undo_ring_trim (undo_ring * ring, size_t budget)
+{
+  int dropped = 0;
+
+  while (ring->size > budget && ring->num_stuff > 1)
+    {
+      undo_info * ui = ring->infos + ring->start;
+
+      ring->size -= ui->size;
+      undo_info_destroy (*ui);
+      ring->start = (ring->start + 1) % ring->alloc;
+      ring->num_stuff--;
+      dropped++;
+    }
+
+  return dropped;
+}
+
+/* Records an undo information object as the newest in an undo ring,
+ *  forgetting anything that had been undone.
+ * Typing in one line is kept as a single action, so long as nothing
+ *  has been undone in between.
+ *  input:
+ *    ring - the undo ring.
+ *    pt - the position of the last action in effect, or -1, which is
+ *         moved to the new object.
+ *    ui - the undo information object, which the ring takes over.
+ *    budget - the most memory that the objects may use, in bytes.
+ *  output:
+ *    0 on success, 1 if ui is empty, -1 on memory error.
+ */
+int
+undo_ring_record (undo_ring * ring, int * pt, undo_info ui, size_t budget)
+{
+  int rc;
+
+  if (ui.type == -1)
+    return 1;
+
+  if (*pt >= 0 && *pt + 1 == ring->num_stuff)
+    {
+      undo_info * last;
+      last = undo_ring_nth (ring, *pt);
+
+      rc = undo_info_merge (last, &ui);
+      if (rc == AEC_MEM)
+        return AEC_MEM;
+
+      if (rc == 1)
+        {
+          ring->size += ui.size - sizeof (undo_info);
+          undo_info_destroy (ui);
+          return 0;
+        }
+    }
+
+  while (ring->num_stuff > *pt + 1)
+    undo_ring_pop (ring);
+
+  rc = undo_ring_push (ring, ui);
+  if (rc == AEC_MEM)
+    return AEC_MEM;
+
+  (*pt)++;
+
+  // Forget the oldest actions once the history grows too large.
+  *pt -= undo_ring_trim (ring, budget);
+
+  return 0;
 }
 
 /* Determines the required operation based on the initial operation and undo/redo.
@@ -180,29 +569,26 @@ undo_op_remove (aris_proof * ap, undo_info * ui)
   if (!ls)
     return AEC_MEM;
 
-  item_t * itm, * ui_itr;
-  int ln;
+  item_t * ui_itr;
+  sentence * sen;
 
   for (ui_itr = ui->ls->head; ui_itr; ui_itr = ui_itr->next)
     {
       sen_data * sd = ui_itr->value;
-      for (itm = SEN_PARENT (ap)->everything->head; itm; itm = itm->next)
+
+      sen = sen_parent_nth_line (SEN_PARENT (ap), sd->line_num);
+      if (sen && !ls_push_obj (ls, sen))
         {
-          sentence * sen = (sentence*) itm->value;
-          ln = sentence_get_line_no (sen);
-          if (ln == sd->line_num)
-            {
-              ls_push_obj (ls, sen);
-              continue;
-            }
+          destroy_list (ls);
+          return AEC_MEM;
         }
     }
 
-  for (itm = ls->head; itm; itm = itm->next)
-    {
-      sentence * sen = itm->value;
-      aris_proof_remove_sentence (ap, sen);
-    }
+  int ret;
+  ret = aris_proof_remove_sentences (ap, ls);
+  destroy_list (ls);
+  if (ret == AEC_MEM)
+    return AEC_MEM;
 
   return 0;
 }
@@ -212,14 +598,20 @@ undo_op_remove (aris_proof * ap, undo_info * ui)
  *    ap - the aris proof on which to operate.
  *    ui - the undo info object that contains the undo information.
  *  output:
- *    0 on success.
+ *    0 on success, -1 on memory error.
  */
 int
 undo_op_add (aris_proof * ap, undo_info * ui)
 {
   item_t * ui_itr, * itm;
+  list_t * run;
 
-  for (ui_itr = ui->ls->head; ui_itr; ui_itr = ui_itr->next)
+  run = init_list ();
+  if (!run)
+    return AEC_MEM;
+
+  // Each run of consecutive lines goes back in at once.
+  for (ui_itr = ui->ls->head; ui_itr;)
     {
       sen_data * sd;
       int ln;
@@ -227,73 +619,73 @@ undo_op_add (aris_proof * ap, undo_info * ui)
 
       sd = (sen_data *) ui_itr->value;
 
-      for (itm = SEN_PARENT (ap)->everything->head; itm; itm = itm->next)
+      // The run goes after the line before it, or at the end.
+      sen = sen_parent_nth_line (SEN_PARENT (ap), sd->line_num - 1);
+      if (sen)
+        itm = sen->itm;
+      else if (sd->line_num > 1)
+        itm = SEN_PARENT (ap)->everything->tail;
+      else
+        itm = NULL;
+
+      ln = sd->line_num;
+      for (; ui_itr && ((sen_data *) ui_itr->value)->line_num == ln;
+           ui_itr = ui_itr->next, ln++)
         {
-          sen = (sentence *) itm->value;
-          ln = sentence_get_line_no (sen);
-          if (ln >= sd->line_num)
-            break;
+          if (!ls_push_obj (run, ui_itr->value))
+            return AEC_MEM;
         }
 
-      if (itm)
-        itm = itm->prev;
-      else
-        itm = SEN_PARENT (ap)->everything->tail;
-      SEN_PARENT (ap)->focused = itm;
-      aris_proof_create_sentence (ap, sd, 0);
+      if (!aris_proof_insert_sentences (ap, run, itm, 0))
+        return AEC_MEM;
+
+      ls_clear (run);
     }
 
+  free (run);
   return 0;
 }
 
 /* Undo operation for text modification.
+ * The removed and inserted text are swapped afterward,
+ *  so the same object serves for both undo and redo.
  *  input:
  *    ap - the aris proof on which to operate.
  *    ui - the undo information object that contains the undo information.
  *  output:
- *    0 on success.
+ *    0 on success, -1 on memory error, 1 if the text no longer matches.
  */
 int
 undo_op_mod (aris_proof * ap, undo_info * ui)
 {
-  item_t * ui_itr, * itm;
-
-  for (ui_itr = ui->ls->head; ui_itr; ui_itr = ui_itr->next)
-    {
-      sen_data * sd;
-      GtkTextBuffer * buffer;
-      int ln;
-      sentence * sen = 0;
-
-      sd = (sen_data *) ui_itr->value;
-
-      for (itm = SEN_PARENT (ap)->everything->head; itm; itm = itm->next)
-        {
-          sen = (sentence *) itm->value;
-          ln = sentence_get_line_no (sen);
-          if (ln >= sd->line_num)
-            break;
-        }
-
-
-      unsigned char * old_text = strdup (sentence_get_text (sen));
-      CHECK_ALLOC (old_text, AEC_MEM);
-      SEN_PARENT(ap)->undo = 1;
-      int ret = sentence_set_text (sen, sd->text);
-      if (ret == -1)
-        return -1;
+  GtkTextBuffer * buffer;
+  item_t * itm;
+  sentence * sen = NULL;
+  unsigned char * new_text;
+  int ret;
+
+  itm = ls_nth (SEN_PARENT (ap)->everything, ui->line_num - 1);
+  if (!itm)
+    return 1;
+  sen = itm->value;
+
+  ret = undo_info_revert_text (ui, sentence_get_text (sen), &new_text);
+  if (ret != 0)
+    return ret;
 
-      free (sd->text);
-      sd->text = strdup (old_text);
-      CHECK_ALLOC (sd->text, AEC_MEM);
-      free (old_text);
+  SEN_PARENT(ap)->undo = 1;
+  ret = sentence_set_text (sen, new_text);
+  free (new_text);
+  if (ret == AEC_MEM)
+    return AEC_MEM;
 
+  if (SEN_REALIZED (sen))
+    {
       buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (sen->entry));
       gtk_text_buffer_set_text (buffer, "", -1);
       sentence_paste_text (sen);
-      SEN_PARENT(ap)->undo = 0;
     }
+  SEN_PARENT(ap)->undo = 0;
 
   return 0;
 }
-
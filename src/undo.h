@@ -30,17 +30,54 @@ enum UNDO_INFO_TYPE {
 
 #define UNDO_INT 1
 
+// The default memory budget for the undo history of a proof, in bytes.
+#define UNDO_BUDGET (4 * 1024 * 1024)
+
 struct undo_info {
   int type;
   time_t stamp;
-  list_t * ls;
+  list_t * ls;                  // The sentences that were added or removed.
+
+  // Text modifications only record what changed.
+  int line_num;                 // The line that was modified.
+  int offset;                   // The position at which the change starts.
+  unsigned char * removed;      // The text that was removed there.
+  unsigned char * inserted;     // The text that was inserted there.
+
+  size_t size;                  // The memory used by this object.
+};
+
+// The undo history of a proof, oldest first, kept in a ring so that
+//  the oldest objects can be dropped once the budget is exceeded.
+
+struct undo_ring {
+  undo_info * infos;            // The slots of the ring.
+  int alloc;                    // The number of slots.
+  int start;                    // The slot of the oldest object.
+  int num_stuff;                // The number of objects.
+  size_t size;                  // The memory used by the objects.
 };
 
 typedef int (*undo_op) (aris_proof *, undo_info *);
 
 undo_info undo_info_init (aris_proof * ap, list_t * sens, int type);
 undo_info undo_info_init_one (aris_proof * ap, sentence * sen, int type);
+undo_info undo_info_init_diff (int line_num, unsigned char * old_text,
+                               unsigned char * new_text);
+undo_info undo_info_init_text (sentence * sen, unsigned char * new_text);
+int undo_info_revert_text (undo_info * ui, unsigned char * text,
+                           unsigned char ** new_text);
 void undo_info_destroy (undo_info ui);
+int undo_info_merge (undo_info * last, undo_info * ui);
+
+undo_ring * undo_ring_init ();
+void undo_ring_destroy (undo_ring * ring);
+undo_info * undo_ring_nth (undo_ring * ring, int n);
+int undo_ring_push (undo_ring * ring, undo_info ui);
+void undo_ring_pop (undo_ring * ring);
+int undo_ring_trim (undo_ring * ring, size_t budget);
+int undo_ring_record (undo_ring * ring, int * pt, undo_info ui,
+                      size_t budget);
 
 undo_op undo_determine_op (int undo, int type);
 int undo_op_remove (aris_proof * ap, undo_info * ui);
@@ -0,0 +1,350 @@
+/* Tests reading and writing proof files.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Most files are read by the streaming loader, and anything it doesn't
+ *  expect is read through libxml2 instead.  The streaming loader only
+ *  reads UTF-8, so each file that is read here is read again declared
+ *  as US-ASCII, which only libxml2 takes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "aio.h"
+#include "list.h"
+#include "proof.h"
+#include "rules.h"
+#include "sen-data.h"
+
+#define SAVE_NAME "aio-test.tle"
+#define RESAVE_NAME "aio-test-2.tle"
+
+static int failed = 0;
+
+#define CHECK(c, what) if (!(c)) {                      \
+    fprintf (stderr, "FAIL: %s (%s:%i)\n",              \
+             what, __FILE__, __LINE__);                 \
+    failed++;                                           \
+  }
+
+// A file that uses the long attribute names, an attribute that neither
+//  loader knows, character references, a UTF-8 connective and a line
+//  break within a value.
+
+static const char * hand_file =
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+  "<proof mode=\"boolean\" version=\"1.0\">\n"
+  " <goals>\n"
+  "  <goal text=\"A &#x2227; B\"/>\n"
+  " </goals>\n"
+  " <premises>\n"
+  "  <entry line=\"1\" text=\"A\n&amp; B\"/>\n"
+  " </premises>\n"
+  " <conclusions>\n"
+  "  <entry line=\"2\" rule=\"2\" ref=\"1\" depth=\"0\" text=\"A&#10;\"/>\n"
+  " </conclusions>\n"
+  "</proof>\n";
+
+/* Adds a line to a proof.
+ *  input:
+ *    proof - the proof.
+ *    text - the text of the line.
+ *    rule - the rule of the line, or -1.
+ *    refs - the references of the line, ending with REF_END, or NULL.
+ *    premise - whether the line is a premise.
+ *    file - the lemma file of the line, or NULL.
+ *    subproof - whether the line starts a subproof.
+ *    depth - the depth of the line.
+ *  output:
+ *    none.
+ */
+static void
+add_line (proof_t * proof, const char * text, int rule, short * refs,
+          int premise, const char * file, int subproof, int depth)
+{
+  sen_data * sd;
+
+  sd = sen_data_init (proof->everything->num_stuff + 1, rule,
+                      (unsigned char *) text, refs, premise,
+                      (unsigned char *) file, subproof, depth, NULL);
+  if (!sd || !ls_push_obj (proof->everything, sd))
+    exit (EXIT_FAILURE);
+}
+
+/* Builds a proof that uses every part of the file format.
+ *  input:
+ *    none.
+ *  output:
+ *    the proof.
+ */
+static proof_t *
+build_proof ()
+{
+  proof_t * proof;
+  short one[] = { 1, REF_END }, both[] = { 1, 2, REF_END };
+  short sub[] = { 3, 4, REF_END }, none[] = { REF_END };
+
+  proof = proof_init ();
+  if (!proof)
+    exit (EXIT_FAILURE);
+
+  ls_push_obj (proof->goals, strdup ("A & \"B\""));
+  ls_push_obj (proof->goals, strdup ("C | ~D"));
+
+  add_line (proof, "A & B", -1, NULL, 1, NULL, 0, 0);
+  add_line (proof, "P(x) & <Q>\t'R'", -1, NULL, 1, NULL, 0, 0);
+  add_line (proof, "A", RULE_SM, one, 0, NULL, 0, 0);
+  add_line (proof, "C", -1, none, 0, NULL, 1, 1);
+  add_line (proof, "A & C", RULE_CN, sub, 0, NULL, 0, 1);
+  add_line (proof, "C | ~D", RULE_LM, both, 0, "a&b <c>.tle", 0, 0);
+
+  return proof;
+}
+
+/* Compares two lists of references.
+ */
+static int
+same_refs (short * refs_0, short * refs_1)
+{
+  int i;
+
+  if (!refs_0 || !refs_1)
+    return (!refs_0 || refs_0[0] == REF_END)
+      && (!refs_1 || refs_1[0] == REF_END);
+
+  for (i = 0; refs_0[i] != REF_END; i++)
+    {
+      if (refs_0[i] != refs_1[i])
+        return 0;
+    }
+
+  return refs_1[i] == REF_END;
+}
+
+/* Compares two proofs, reporting the first difference.
+ *  input:
+ *    what - what the proofs are.
+ *    got - the proof that was read.
+ *    want - the proof expected.
+ *  output:
+ *    none.
+ */
+static void
+check_same (const char * what, proof_t * got, proof_t * want)
+{
+  item_t * itr_0, * itr_1;
+  int i;
+
+  if (!got)
+    {
+      fprintf (stderr, "FAIL: %s couldn't be read.\n", what);
+      failed++;
+      return;
+    }
+
+  if (got->boolean != want->boolean
+      || got->goals->num_stuff != want->goals->num_stuff
+      || got->everything->num_stuff != want->everything->num_stuff)
+    {
+      fprintf (stderr, "FAIL: %s has the wrong mode or number of lines.\n",
+               what);
+      failed++;
+      return;
+    }
+
+  for (itr_0 = got->goals->head, itr_1 = want->goals->head; itr_0;
+       itr_0 = itr_0->next, itr_1 = itr_1->next)
+    {
+      if (strcmp (itr_0->value, itr_1->value))
+        {
+          fprintf (stderr, "FAIL: %s has goal \"%s\", not \"%s\".\n",
+                   what, (char *) itr_0->value, (char *) itr_1->value);
+          failed++;
+        }
+    }
+
+  i = 1;
+  for (itr_0 = got->everything->head, itr_1 = want->everything->head; itr_0;
+       itr_0 = itr_0->next, itr_1 = itr_1->next, i++)
+    {
+      sen_data * sd_0 = itr_0->value, * sd_1 = itr_1->value;
+
+      if (sd_0->line_num != i
+          || strcmp ((char *) sd_0->text, (char *) sd_1->text)
+          || sd_0->rule != sd_1->rule
+          || sd_0->premise != sd_1->premise
+          || sd_0->subproof != sd_1->subproof
+          || sd_0->depth != sd_1->depth
+          || !same_refs (sd_0->refs, sd_1->refs)
+          || (!sd_0->file != !sd_1->file)
+          || (sd_0->file && strcmp ((char *) sd_0->file, (char *) sd_1->file)))
+        {
+          fprintf (stderr, "FAIL: %s differs at line %i, \"%s\".\n",
+                   what, i, (char *) sd_0->text);
+          failed++;
+        }
+    }
+}
+
+/* Reads a whole file.
+ *  input:
+ *    file_name - the name of the file.
+ *    size - receives the length of the file.
+ *  output:
+ *    the text of the file, or NULL on error.
+ */
+static char *
+read_file (const char * file_name, size_t * size)
+{
+  FILE * file;
+  char * buf;
+  long len;
+
+  file = fopen (file_name, "rb");
+  if (!file)
+    return NULL;
+
+  fseek (file, 0, SEEK_END);
+  len = ftell (file);
+  rewind (file);
+
+  buf = (char *) calloc (len + 1, sizeof (char));
+  if (buf)
+    *size = fread (buf, 1, len, file);
+
+  fclose (file);
+  return buf;
+}
+
+/* Replaces the XML declaration at the start of a file's text
+ *  with one that declares the file as US-ASCII.
+ *  input:
+ *    buf - the text of the file, which must be ASCII.
+ *    size - its length, which is updated.
+ *  output:
+ *    the new text.
+ */
+static char *
+declare_ascii (const char * buf, size_t * size)
+{
+  static const char decl[] = "<?xml version=\"1.0\" encoding=\"US-ASCII\"?>";
+  const char * end;
+  char * ret;
+  size_t first;
+
+  end = strstr (buf, "?>");
+  first = end ? (size_t) (end + 2 - buf) : 0;
+
+  ret = (char *) calloc (*size - first + sizeof (decl), sizeof (char));
+  if (!ret)
+    exit (EXIT_FAILURE);
+
+  memcpy (ret, decl, sizeof (decl) - 1);
+  memcpy (ret + sizeof (decl) - 1, buf + first, *size - first);
+  *size += sizeof (decl) - 1 - first;
+
+  return ret;
+}
+
+/* Checks that a proof is read back as it was saved,
+ *  and saved again as the same file.
+ */
+static void
+test_round_trip ()
+{
+  proof_t * proof, * opened, * from_xml;
+  char * saved, * resaved, * declared;
+  size_t size, resize;
+
+  proof = build_proof ();
+  CHECK (aio_save (proof, SAVE_NAME) == 0, "saving a proof");
+
+  opened = aio_open (SAVE_NAME);
+  check_same ("the saved proof", opened, proof);
+
+  saved = read_file (SAVE_NAME, &size);
+  CHECK (saved != NULL, "reading the saved file");
+  if (!saved)
+    return;
+
+  if (opened)
+    {
+      CHECK (aio_save (opened, RESAVE_NAME) == 0, "saving an opened proof");
+      resaved = read_file (RESAVE_NAME, &resize);
+      CHECK (resaved && resize == size && !memcmp (saved, resaved, size),
+             "a proof is saved the same way after it is opened");
+      free (resaved);
+      proof_destroy (opened);
+    }
+
+  declared = declare_ascii (saved, &size);
+  from_xml = aio_open_buffer (declared, size);
+  check_same ("the saved proof read through libxml2", from_xml, proof);
+  if (from_xml)
+    proof_destroy (from_xml);
+
+  free (declared);
+  free (saved);
+  proof_destroy (proof);
+  remove (SAVE_NAME);
+  remove (RESAVE_NAME);
+}
+
+/* Checks that values are decoded as XML requires.
+ */
+static void
+test_values ()
+{
+  proof_t * want, * got;
+  char * declared;
+  short one[] = { 1, REF_END };
+  size_t size;
+
+  want = proof_init ();
+  if (!want)
+    exit (EXIT_FAILURE);
+
+  want->boolean = 1;
+  ls_push_obj (want->goals, strdup ("A & B"));
+  add_line (want, "A & B", -1, NULL, 1, NULL, 0, 0);
+  add_line (want, "A\n", RULE_SM, one, 0, NULL, 0, 0);
+
+  size = strlen (hand_file);
+  got = aio_open_buffer (hand_file, size);
+  check_same ("the written file", got, want);
+  if (got)
+    proof_destroy (got);
+
+  declared = declare_ascii (hand_file, &size);
+  got = aio_open_buffer (declared, size);
+  check_same ("the written file read through libxml2", got, want);
+  if (got)
+    proof_destroy (got);
+
+  free (declared);
+  proof_destroy (want);
+}
+
+int
+main ()
+{
+  test_round_trip ();
+  test_values ();
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,335 @@
+/* Tests packing proofs into a corpus and reading them back.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef WIN32
+#include <direct.h>
+#define mkdir(d,m) _mkdir (d)
+#endif
+
+#include "aio.h"
+#include "corpus.h"
+#include "list.h"
+#include "proof.h"
+#include "sen-data.h"
+#include "vec.h"
+
+#define TEST_DIR "corpus-test.d"
+#define NUM_FILES 4
+
+static int failed = 0;
+
+#define CHECK(c, what) if (!(c)) {                      \
+    fprintf (stderr, "FAIL: %s (%s:%i)\n",              \
+             what, __FILE__, __LINE__);                 \
+    failed++;                                           \
+  }
+
+// The files to pack.  The first is a proof that is saved by aio_save.
+
+static struct {
+  const char * dir;             // The student's directory.
+  const char * name;            // The file name, within the directory.
+  const char * assignment;      // The assignment that it is for.
+  const char * data;            // The contents of the file.
+} files[NUM_FILES] = {
+  { "alice", "hw1.tle", "hw1", NULL },
+  { "bob smith", "hw 100%.tle", "hw 100%", "not a proof\ne 5 x y z\n" },
+  { "carol", "hw1.tle", "hw1", "" },
+  { "carol", "notes", "notes", "i 3\n\0\n-" }
+};
+
+// The length of each file's contents.
+static size_t sizes[NUM_FILES] = { 0, 22, 0, 7 };
+
+/* Writes a file.
+ *  input:
+ *    file_name - the name of the file.
+ *    data - the contents.
+ *    size - the length of the contents.
+ *  output:
+ *    none.
+ */
+static void
+write_file (const char * file_name, const char * data, size_t size)
+{
+  FILE * file;
+
+  file = fopen (file_name, "wb");
+  if (!file || fwrite (data, 1, size, file) != size || fclose (file))
+    {
+      perror (file_name);
+      exit (EXIT_FAILURE);
+    }
+}
+
+/* Makes the files to pack.
+ *  input:
+ *    names - receives the names of the files.
+ *  output:
+ *    the saved proof that is the first file.
+ */
+static proof_t *
+make_files (vec_t * names)
+{
+  proof_t * proof;
+  sen_data * sd;
+  char name[256];
+  int i;
+
+  mkdir (TEST_DIR, 0777);
+
+  proof = proof_init ();
+  if (!proof)
+    exit (EXIT_FAILURE);
+
+  ls_push_obj (proof->goals, strdup ("B"));
+  sd = sen_data_init (1, -1, (unsigned char *) "A & B", NULL, 1, NULL,
+                      0, 0, NULL);
+  if (!sd || !ls_push_obj (proof->everything, sd))
+    exit (EXIT_FAILURE);
+
+  for (i = 0; i < NUM_FILES; i++)
+    {
+      sprintf (name, "%s/%s", TEST_DIR, files[i].dir);
+      mkdir (name, 0777);
+
+      sprintf (name, "%s/%s/%s", TEST_DIR, files[i].dir, files[i].name);
+      if (i == 0)
+        {
+          if (aio_save (proof, name) != 0)
+            exit (EXIT_FAILURE);
+        }
+      else
+        {
+          write_file (name, files[i].data, sizes[i]);
+        }
+
+      if (vec_str_add_obj (names, (unsigned char *) name) < 0)
+        exit (EXIT_FAILURE);
+    }
+
+  return proof;
+}
+
+/* Removes the files that were packed.
+ *  input:
+ *    names - the names of the files.
+ *  output:
+ *    none.
+ */
+static void
+remove_files (vec_t * names)
+{
+  char name[256];
+  int i;
+
+  for (i = 0; i < NUM_FILES; i++)
+    {
+      remove ((char *) vec_str_nth (names, i));
+      sprintf (name, "%s/%s", TEST_DIR, files[i].dir);
+      remove (name);
+    }
+
+  remove (TEST_DIR);
+}
+
+/* Checks that a corpus holds the files that were packed into it.
+ *  input:
+ *    corpus_name - the name of the corpus.
+ *    names - the names of the files.
+ *    proof - the proof that is the first file.
+ *  output:
+ *    none.
+ */
+static void
+check_corpus (const char * corpus_name, vec_t * names, proof_t * proof)
+{
+  corpus_reader * cr;
+  corpus_entry ce;
+  proof_t * opened;
+  int i, ret;
+
+  cr = corpus_open (corpus_name);
+  CHECK (cr != NULL, "opening a corpus");
+  if (!cr)
+    return;
+
+  for (i = 0; i < NUM_FILES; i++)
+    {
+      ret = corpus_next (cr, &ce);
+      CHECK (ret == 1, "reading an entry");
+      if (ret != 1)
+        break;
+
+      CHECK (!strcmp (ce.id, (char *) vec_str_nth (names, i)),
+             "an entry is named by its file");
+      CHECK (!strcmp (ce.student, files[i].dir),
+             "an entry is from the student named by its directory");
+      CHECK (!strcmp (ce.assignment, files[i].assignment),
+             "an entry is for the assignment named by its file");
+
+      if (i == 0)
+        {
+          // The saved proof opens straight from the entry.
+          opened = aio_open_buffer (ce.data, ce.size);
+          CHECK (opened
+                 && opened->everything->num_stuff
+                 == proof->everything->num_stuff
+                 && opened->goals->num_stuff == proof->goals->num_stuff,
+                 "a proof opens from its entry");
+          if (opened)
+            proof_destroy (opened);
+        }
+      else
+        {
+          CHECK (ce.size == sizes[i] && !memcmp (ce.data, files[i].data,
+                                                 sizes[i]),
+                 "an entry holds its file");
+        }
+
+      corpus_entry_clear (&ce);
+    }
+
+  CHECK (corpus_next (cr, &ce) == 0, "the corpus ends after its entries");
+  corpus_close (cr);
+}
+
+/* Checks that a corpus cut short is reported as damaged.
+ *  input:
+ *    corpus_name - the name of the corpus.
+ *  output:
+ *    none.
+ */
+static void
+check_damaged (const char * corpus_name)
+{
+  corpus_reader * cr;
+  corpus_entry ce;
+  FILE * file;
+  char buf[64];
+  size_t size;
+  int ret;
+
+  // Keep the magic line and part of the first header.
+  file = fopen (corpus_name, "rb");
+  if (!file)
+    exit (EXIT_FAILURE);
+  size = fread (buf, 1, strlen (CORPUS_MAGIC) + 5, file);
+  fclose (file);
+
+  write_file (corpus_name, buf, size);
+
+  cr = corpus_open (corpus_name);
+  CHECK (cr != NULL, "opening a corpus that was cut short");
+  if (!cr)
+    return;
+
+  ret = corpus_next (cr, &ce);
+  CHECK (ret == AEC_IO, "a corpus that was cut short is damaged");
+  if (ret == 1)
+    corpus_entry_clear (&ce);
+
+  corpus_close (cr);
+
+  write_file (corpus_name, "not a corpus\n", 13);
+  cr = corpus_open (corpus_name);
+  CHECK (cr == NULL, "a file that isn't a corpus isn't opened");
+  if (cr)
+    corpus_close (cr);
+}
+
+/* Checks that entries whose sizes can't be right are reported as damaged,
+ *  rather than read.
+ *  input:
+ *    corpus_name - the name of the corpus to write them to.
+ *  output:
+ *    none.
+ */
+static void
+check_bad_sizes (const char * corpus_name)
+{
+  static const char * headers[] = {
+    "e -1 a b c\n",
+    "e 18446744073709551615 a b c\n",
+    "e 4294967297 a b c\n",
+    "e 100 a b c\n",
+    NULL
+  };
+  corpus_reader * cr;
+  corpus_entry ce;
+  char buf[128];
+  int i, ret;
+
+  for (i = 0; headers[i]; i++)
+    {
+      sprintf (buf, "%s\n%sxyz\n", CORPUS_MAGIC, headers[i]);
+      write_file (corpus_name, buf, strlen (buf));
+
+      cr = corpus_open (corpus_name);
+      CHECK (cr != NULL, "opening a corpus with a bad size");
+      if (!cr)
+        continue;
+
+      ret = corpus_next (cr, &ce);
+      if (ret != AEC_IO)
+        fprintf (stderr, "FAIL: \"%.*s\" is read as %i.\n",
+                 (int) strlen (headers[i]) - 1, headers[i], ret);
+      CHECK (ret == AEC_IO, "an entry with a bad size is damaged");
+      if (ret == 1)
+        corpus_entry_clear (&ce);
+
+      corpus_close (cr);
+    }
+}
+
+int
+main ()
+{
+  vec_t * names;
+  proof_t * proof;
+
+  names = init_vec (sizeof (char *));
+  if (!names)
+    return EXIT_FAILURE;
+
+  proof = make_files (names);
+
+  CHECK (corpus_pack ("corpus-test.corpus", names) == 0, "packing a corpus");
+  check_corpus ("corpus-test.corpus", names, proof);
+  check_damaged ("corpus-test.corpus");
+  check_bad_sizes ("corpus-test.corpus");
+
+  CHECK (corpus_pack ("corpus-test.corpus.gz", names) == 0,
+         "packing a compressed corpus");
+  check_corpus ("corpus-test.corpus.gz", names, proof);
+
+  remove ("corpus-test.corpus");
+  remove ("corpus-test.corpus.gz");
+  remove_files (names);
+
+  proof_destroy (proof);
+  destroy_str_vec (names);
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,147 @@
+/* Tests that folded lines are checked again once they may have changed.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* The proof is
+ *    1  P
+ *    2  A & B
+ *    3  | C
+ *    4  | A          sm 2
+ *    5  | A & C      cn 3, 4
+ *  with the subproof folded, so that line 4 is hidden.  The test needs a
+ *  display, and is skipped without one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gtk/gtk.h>
+#include "app.h"
+#include "aris-proof.h"
+#include "callbacks.h"
+#include "list.h"
+#include "process.h"
+#include "proof.h"
+#include "rules.h"
+#include "sen-data.h"
+#include "sen-parent.h"
+#include "sentence.h"
+
+// The exit status that tells automake a test was skipped.
+#define TEST_SKIP 77
+
+static int failed = 0;
+
+#define CHECK(c, what) if (!(c)) {                      \
+    fprintf (stderr, "FAIL: %s (%s:%i)\n",              \
+             what, __FILE__, __LINE__);                 \
+    failed++;                                           \
+  }
+
+/* Adds a line to a proof.
+ *  input:
+ *    proof - the proof.
+ *    text - the text of the line.
+ *    rule - the rule of the line, or -1.
+ *    refs - the references of the line, ending with REF_END, or NULL.
+ *    premise - whether the line is a premise.
+ *    subproof - whether the line starts a subproof.
+ *    depth - the depth of the line.
+ *  output:
+ *    none.
+ */
+static void
+add_line (proof_t * proof, const char * text, int rule, short * refs,
+          int premise, int subproof, int depth)
+{
+  sen_data * sd;
+  unsigned char * norm;
+
+  norm = normalize_conns ((const unsigned char *) text);
+  if (!norm)
+    exit (EXIT_FAILURE);
+
+  sd = sen_data_init (proof->everything->num_stuff + 1, rule, norm, refs,
+                      premise, NULL, subproof, depth, NULL);
+  free (norm);
+  if (!sd || !ls_push_obj (proof->everything, sd))
+    exit (EXIT_FAILURE);
+}
+
+int
+main (int argc, char * argv[])
+{
+  proof_t * proof;
+  aris_proof * ap;
+  sen_parent * sp;
+  sentence * hidden;
+  short two[] = { 2, REF_END }, three_four[] = { 3, 4, REF_END };
+  short none[] = { REF_END };
+
+  if (!gtk_init_check (&argc, &argv))
+    {
+      fprintf (stderr, "There is no display; skipping.\n");
+      return TEST_SKIP;
+    }
+
+  main_conns = cli_conns;
+  the_app = init_app (0, 0);
+  if (!the_app)
+    return EXIT_FAILURE;
+
+  proof = proof_init ();
+  if (!proof)
+    return EXIT_FAILURE;
+
+  add_line (proof, "P", -1, NULL, 1, 0, 0);
+  add_line (proof, "A & B", -1, NULL, 1, 0, 0);
+  add_line (proof, "C", -1, none, 0, 1, 1);
+  add_line (proof, "A", RULE_SM, two, 0, 0, 1);
+  add_line (proof, "A & C", RULE_CN, three_four, 0, 0, 1);
+
+  ap = aris_proof_init_from_proof (proof);
+  if (!ap)
+    return EXIT_FAILURE;
+  sp = SEN_PARENT (ap);
+
+  // Fold the subproof from its last line.
+  sp->focused = sp->everything->tail;
+  CHECK (aris_proof_toggle_fold (ap) == 0, "folding a subproof");
+
+  hidden = sen_parent_nth_line (sp, 4);
+  CHECK (hidden && hidden->hidden, "the body of a folded subproof is hidden");
+  if (!hidden)
+    return EXIT_FAILURE;
+
+  CHECK (evaluate_proof (ap) == 0, "evaluating the folded proof");
+  CHECK (hidden->value_type == VALUE_TYPE_TRUE,
+         "a hidden line is checked once");
+
+  // Line 4 no longer has anything to simplify.
+  CHECK (aris_proof_remove_sentence (ap, sen_parent_nth_line (sp, 2)) == 0,
+         "removing the cited line");
+  CHECK (hidden == sen_parent_nth_line (sp, 3) && hidden->hidden,
+         "the line stays hidden");
+
+  CHECK (evaluate_proof (ap) == 0, "evaluating the proof again");
+  CHECK (hidden->value_type != VALUE_TYPE_TRUE
+         && hidden->value_type != VALUE_TYPE_BLANK,
+         "a hidden line whose reference was removed is checked again");
+
+  proof_destroy (proof);
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+/* Tests the framing of responses from the pool of provers.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* The prover is the stand-in in isar-standin.sh, named by ARIS_ISABELLE.
+ *  It splits each end mark between two writes, puts other text before
+ *  it on its line, and prints a line after it, which the pool keeps as
+ *  the start of the process's next response.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "isar-pool.h"
+
+// The exit status that tells automake a test was skipped.
+#define TEST_SKIP 77
+
+static int failed = 0;
+
+/* Checks a response against the one expected.
+ *  input:
+ *    what - what the response was to.
+ *    got - the response.
+ *    want - the expected response.
+ *  output:
+ *    none.
+ */
+static void
+check_output (const char * what, unsigned char * got, const char * want)
+{
+  if (got && !strcmp ((char *) got, want))
+    return;
+
+  fprintf (stderr, "FAIL: %s\n  expected \"%s\"\n  got \"%s\"\n",
+           what, want, got ? (char *) got : "(null)");
+  failed++;
+}
+
+/* Runs one request with a single command on the pool.
+ *  input:
+ *    cmd - the command.
+ *    output - receives the response.
+ *  output:
+ *    the return value of isar_pool_run.
+ */
+static int
+run_one (const char * cmd, unsigned char ** output)
+{
+  unsigned char * cmds[2], ** inputs[1];
+
+  cmds[0] = (unsigned char *) cmd;
+  cmds[1] = NULL;
+  inputs[0] = cmds;
+
+  return isar_pool_run (inputs, 1, output);
+}
+
+int
+main ()
+{
+  unsigned char * out, * outs[4], * cmds[4][2], ** inputs[4];
+  char * big;
+  int ret, i;
+
+  if (!getenv (ISAR_POOL_ENV))
+    {
+      fprintf (stderr, "%s is not set; skipping.\n", ISAR_POOL_ENV);
+      return TEST_SKIP;
+    }
+
+  // The mark arrives in two reads, after text on its line.
+  ret = run_one ("echo one", &out);
+  if (ret < 0)
+    {
+      fprintf (stderr, "FAIL: the stand-in couldn't be run.\n");
+      return EXIT_FAILURE;
+    }
+  check_output ("a split mark", out, "one\n");
+  free (out);
+
+  // What followed the last mark starts the next response.
+  ret = run_one ("echo two", &out);
+  check_output ("the leftover line", (ret < 0) ? NULL : out, "tail\ntwo\n");
+  if (ret == 0)
+    free (out);
+
+  // A response longer than a block is read whole.
+  big = (char *) calloc (10000 + 7, sizeof (char));
+  if (!big)
+    return EXIT_FAILURE;
+  strcpy (big, "tail\n");
+  memset (big + 5, 'x', 10000);
+  big[10005] = '\n';
+
+  ret = run_one ("big 10000", &out);
+  check_output ("a response of several blocks", (ret < 0) ? NULL : out, big);
+  if (ret == 0)
+    free (out);
+  free (big);
+
+  // Each of several requests is answered by its own response, however
+  //  the processes take them.  Every process has a leftover line once it
+  //  has answered a request.
+  ret = isar_pool_start (2);
+  if (ret < 0)
+    {
+      fprintf (stderr, "FAIL: the pool couldn't be started.\n");
+      return EXIT_FAILURE;
+    }
+
+  cmds[0][0] = (unsigned char *) "echo a";
+  cmds[1][0] = (unsigned char *) "echo b";
+  cmds[2][0] = (unsigned char *) "echo c";
+  cmds[3][0] = (unsigned char *) "echo d";
+  for (i = 0; i < 4; i++)
+    {
+      cmds[i][1] = NULL;
+      inputs[i] = cmds[i];
+    }
+
+  ret = isar_pool_run (inputs, 4, outs);
+  if (ret < 0)
+    {
+      fprintf (stderr, "FAIL: the pool didn't answer.\n");
+      return EXIT_FAILURE;
+    }
+
+  check_output ("the first request", outs[0], "a\n");
+  check_output ("the second request", outs[1], "b\n");
+  check_output ("the third request", outs[2], "tail\nc\n");
+  check_output ("the fourth request", outs[3], "tail\nd\n");
+  for (i = 0; i < 4; i++)
+    free (outs[i]);
+
+  isar_pool_stop ();
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,46 @@
+#!/bin/sh
+
+# A scripted stand-in for Isabelle, named by ARIS_ISABELLE in the tests.
+
+#  Copyright (C) 2026 agent.
+
+#  This program is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# "echo TEXT" prints TEXT, and "big N" prints a line of N x's.  The end
+#  mark is printed after other text on its line, in two writes, and a
+#  line follows it, so that the reader has to find a mark that is split
+#  between reads and keep what comes after it.
+
+while IFS= read -r line
+do
+  line=`printf '%s' "$line" | tr -d '\r'`
+  line=${line%;}
+
+  case $line in
+    "echo "*)
+      printf '%s\n' "${line#echo }"
+      ;;
+    "big "*)
+      head -c "${line#big }" /dev/zero | tr '\0' x
+      printf '\n'
+      ;;
+    'writeln "'*)
+      mark=${line#writeln \"}
+      mark=${mark%\"}
+      printf '### %.6s' "$mark"
+      sleep 0.2 2>/dev/null || sleep 1
+      printf '%s\ntail\n' "${mark#??????}"
+      ;;
+  esac
+done
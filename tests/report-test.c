@@ -0,0 +1,266 @@
+/* Tests the grading reports.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Each report is compared whole against the one expected, except that
+ *  the timings, which differ from run to run, are read as zero.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "list.h"
+#include "process.h"
+#include "proof.h"
+#include "report.h"
+#include "rules.h"
+#include "sen-data.h"
+
+#define REPORT_NAME "report-test.out"
+
+static int failed = 0;
+
+static const char * want_json =
+  "{\"file\":\"wrong \\\"one\\\".tle\",\"passed\":false,\"usecs\":0,"
+  "\"lines\":["
+  "{\"line\":1,\"verdict\":\"correct\",\"rule\":\"premise\","
+  "\"msg_id\":\"eb5de810\",\"message\":\"Correct!\",\"span\":null,\"usecs\":0},"
+  "{\"line\":2,\"verdict\":\"correct\",\"rule\":\"sm\","
+  "\"msg_id\":\"eb5de810\",\"message\":\"Correct!\",\"span\":null,\"usecs\":0},"
+  "{\"line\":3,\"verdict\":\"correct\",\"rule\":\"ad\","
+  "\"msg_id\":\"eb5de810\",\"message\":\"Correct!\",\"span\":null,\"usecs\":0},"
+  "{\"line\":4,\"verdict\":\"error\",\"rule\":\"sm\","
+  "\"msg_id\":\"5710b12c\","
+  "\"message\":\"The sentence has mismatched parenthesis.\","
+  "\"span\":[5,6],\"usecs\":0},"
+  "{\"line\":5,\"verdict\":\"rule-missing\",\"rule\":\"\","
+  "\"msg_id\":\"95151e6c\",\"message\":\"The sentence is missing a rule.\","
+  "\"span\":null,\"usecs\":0},"
+  "{\"line\":6,\"verdict\":\"incorrect\",\"rule\":\"dm\","
+  "\"msg_id\":\"e5b48694\","
+  "\"message\":\"There must be a negation at the difference.\","
+  "\"span\":[0,6],\"usecs\":0}],"
+  "\"goals\":[{\"goal\":\"A | C\",\"met\":true,\"line\":3},"
+  "{\"goal\":\"Q\",\"met\":false,\"line\":null}]}\n"
+  "{\"file\":\"right.tle\",\"passed\":true,\"usecs\":0,"
+  "\"lines\":["
+  "{\"line\":1,\"verdict\":\"correct\",\"rule\":\"premise\","
+  "\"msg_id\":\"eb5de810\",\"message\":\"Correct!\",\"span\":null,\"usecs\":0},"
+  "{\"line\":2,\"verdict\":\"correct\",\"rule\":\"sm\","
+  "\"msg_id\":\"eb5de810\",\"message\":\"Correct!\",\"span\":null,\"usecs\":0}],"
+  "\"goals\":[{\"goal\":\"A\",\"met\":true,\"line\":2}]}\n";
+
+static const char * want_csv =
+  "file,record,line,verdict,rule,msg_id,message,span_start,span_end,usecs\n"
+  "\"wrong \"\"one\"\".tle\",line,1,correct,premise,eb5de810,\"Correct!\",,,0\n"
+  "\"wrong \"\"one\"\".tle\",line,2,correct,sm,eb5de810,\"Correct!\",,,0\n"
+  "\"wrong \"\"one\"\".tle\",line,3,correct,ad,eb5de810,\"Correct!\",,,0\n"
+  "\"wrong \"\"one\"\".tle\",line,4,error,sm,5710b12c,"
+  "\"The sentence has mismatched parenthesis.\",5,6,0\n"
+  "\"wrong \"\"one\"\".tle\",line,5,rule-missing,,95151e6c,"
+  "\"The sentence is missing a rule.\",,,0\n"
+  "\"wrong \"\"one\"\".tle\",line,6,incorrect,dm,e5b48694,"
+  "\"There must be a negation at the difference.\",0,6,0\n"
+  "\"wrong \"\"one\"\".tle\",goal,3,met,,,\"A | C\",,,\n"
+  "\"wrong \"\"one\"\".tle\",goal,,unmet,,,\"Q\",,,\n"
+  "\"wrong \"\"one\"\".tle\",file,,failed,,,,,,0\n"
+  "\"right.tle\",line,1,correct,premise,eb5de810,\"Correct!\",,,0\n"
+  "\"right.tle\",line,2,correct,sm,eb5de810,\"Correct!\",,,0\n"
+  "\"right.tle\",goal,2,met,,,\"A\",,,\n"
+  "\"right.tle\",file,,passed,,,,,,0\n";
+
+/* Adds a line to a proof.
+ *  input:
+ *    proof - the proof.
+ *    text - the text of the line.
+ *    premise - whether the line is a premise.
+ *    rule - the rule of the line, or -1.
+ *    ref - the line that it refers to, or 0.
+ *  output:
+ *    none.
+ */
+static void
+add_line (proof_t * proof, const char * text, int premise, int rule, short ref)
+{
+  sen_data * sd;
+  short refs[2] = { ref, REF_END };
+
+  sd = sen_data_init (proof->everything->num_stuff + 1, rule,
+                      (unsigned char *) text, premise ? NULL : refs, premise,
+                      NULL, 0, 0, NULL);
+  if (!sd || !ls_push_obj (proof->everything, sd))
+    exit (EXIT_FAILURE);
+}
+
+/* Builds the proofs that are graded.
+ *  input:
+ *    wrong - receives a proof with a mistake of each kind.
+ *    right - receives a proof without mistakes.
+ *  output:
+ *    none.
+ */
+static void
+build_proofs (proof_t ** wrong, proof_t ** right)
+{
+  *wrong = proof_init ();
+  *right = proof_init ();
+  if (!*wrong || !*right)
+    exit (EXIT_FAILURE);
+
+  add_line (*wrong, "A & B", 1, -1, 0);
+  add_line (*wrong, "A", 0, RULE_SM, 1);
+  add_line (*wrong, "A | C", 0, RULE_AD, 2);
+  add_line (*wrong, "A & B)", 0, RULE_SM, 1);
+  add_line (*wrong, "C", 0, -1, 0);
+  add_line (*wrong, "~A | ~B", 0, RULE_DM, 1);
+  ls_push_obj ((*wrong)->goals, strdup ("A | C"));
+  ls_push_obj ((*wrong)->goals, strdup ("Q"));
+
+  add_line (*right, "A & B", 1, -1, 0);
+  add_line (*right, "A", 0, RULE_SM, 1);
+  ls_push_obj ((*right)->goals, strdup ("A"));
+}
+
+/* Checks whether text is a CSV timing: digits that end a record.
+ *  input:
+ *    text - the text, after a comma.
+ *  output:
+ *    the length of the timing, or 0 if it isn't one.
+ */
+static int
+csv_timing (const char * text)
+{
+  int i;
+
+  for (i = 0; isdigit (text[i]); i++);
+
+  return (i > 0 && text[i] == '\n') ? i : 0;
+}
+
+/* Reads a report back, with every timing read as zero.
+ *  input:
+ *    none.
+ *  output:
+ *    the text of the report, or NULL on error.
+ */
+static char *
+read_report ()
+{
+  FILE * file;
+  char * text, * ret;
+  long len;
+  int i, j, tlen;
+
+  file = fopen (REPORT_NAME, "rb");
+  if (!file)
+    return NULL;
+
+  fseek (file, 0, SEEK_END);
+  len = ftell (file);
+  rewind (file);
+
+  text = (char *) calloc (len + 1, sizeof (char));
+  ret = (char *) calloc (len + 1, sizeof (char));
+  if (!text || !ret || fread (text, 1, len, file) != (size_t) len)
+    {
+      fclose (file);
+      free (text);
+      free (ret);
+      return NULL;
+    }
+  fclose (file);
+
+  // A JSON timing follows "usecs":, and a CSV timing ends a record.
+  for (i = j = 0; i < len;)
+    {
+      if (!strncmp (text + i, "\"usecs\":", 8) && isdigit (text[i + 8]))
+        {
+          memcpy (ret + j, text + i, 8);
+          j += 8;
+          i += 8;
+          for (; isdigit (text[i]); i++);
+          ret[j++] = '0';
+          continue;
+        }
+
+      if (text[i] == ',' && (tlen = csv_timing (text + i + 1)) > 0)
+        {
+          ret[j++] = ',';
+          ret[j++] = '0';
+          i += tlen + 1;
+          continue;
+        }
+
+      ret[j++] = text[i++];
+    }
+
+  free (text);
+  return ret;
+}
+
+/* Grades the proofs into a report, and compares it with the one expected.
+ *  input:
+ *    format - the format of the report.
+ *    want - the report expected.
+ *  output:
+ *    none.
+ */
+static void
+check_report (const char * format, const char * want)
+{
+  report * rp;
+  proof_t * wrong, * right;
+  char * got;
+
+  build_proofs (&wrong, &right);
+
+  rp = report_open (format, REPORT_NAME);
+  if (!rp)
+    exit (EXIT_FAILURE);
+
+  if (report_file (rp, "wrong \"one\".tle", wrong) < 0
+      || report_file (rp, "right.tle", right) < 0)
+    exit (EXIT_FAILURE);
+
+  if (report_close (rp) != 0)
+    exit (EXIT_FAILURE);
+
+  got = read_report ();
+  if (!got || strcmp (got, want))
+    {
+      fprintf (stderr, "FAIL: the %s report is\n%s\nnot\n%s\n",
+               format, got ? got : "(unreadable)", want);
+      failed++;
+    }
+
+  free (got);
+  proof_destroy (wrong);
+  proof_destroy (right);
+  remove (REPORT_NAME);
+}
+
+int
+main ()
+{
+  main_conns = cli_conns;
+
+  check_report ("json", want_json);
+  check_report ("csv", want_csv);
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,239 @@
+/* Tests the rules against steps that they should and shouldn't accept.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "process.h"
+#include "vec.h"
+#include "var.h"
+#include "rule-template.h"
+
+// A step of a proof: the references and the sentence that a rule makes of them.
+
+struct rule_case {
+  const char * rule;
+  const char * prems[4];        // The references, ending with NULL.
+  const char * conc;
+  int correct;                  // Whether the rule should accept the step.
+};
+
+static struct rule_case cases[] = {
+  // Inference rules.
+  { "mp", { "A $ B", "A", NULL }, "B", 1 },
+  { "mp", { "A $ B", "B", NULL }, "A", 0 },
+  { "mp", { "A $ B", "C", NULL }, "B", 0 },
+  { "ad", { "A", NULL }, "A | B", 1 },
+  { "ad", { "A", NULL }, "A & B", 0 },
+  { "sm", { "A & B", NULL }, "A", 1 },
+  { "sm", { "A | B", NULL }, "A", 0 },
+  { "cn", { "A", "B", NULL }, "A & B", 1 },
+  { "cn", { "A", "B", NULL }, "A & C", 0 },
+  { "hs", { "A $ B", "B $ C", NULL }, "A $ C", 1 },
+  { "hs", { "A $ B", "B $ C", NULL }, "C $ A", 0 },
+  { "ds", { "A | B", "~A", NULL }, "B", 1 },
+  { "ds", { "A | B", "A", NULL }, "B", 0 },
+  { "ex", { NULL }, "A | ~A", 1 },
+  { "ex", { NULL }, "A | ~B", 0 },
+  { "cd", { "A | B", "A $ C", "B $ D", NULL }, "C | D", 1 },
+  { "cd", { "A | B", "A $ C", "B $ D", NULL }, "C & D", 0 },
+
+  // Equivalence rules, including steps that apply a rule in more than
+  //  one place of a sentence.
+  { "im", { "A $ B", NULL }, "~A | B", 1 },
+  { "im", { "(A $ B) & (C $ D)", NULL }, "(~A | B) & (~C | D)", 1 },
+  { "im", { "A $ B", NULL }, "A | ~B", 0 },
+  { "im", { "A $ B", NULL }, "~B $ ~A", 0 },
+  { "dm", { "~(A & B)", NULL }, "~A | ~B", 1 },
+  { "dm", { "~(A | B) & ~(C & D)", NULL }, "(~A & ~B) & (~C | ~D)", 1 },
+  { "dm", { "~(A & B)", NULL }, "~A & ~B", 0 },
+  { "as", { "A & (B & C)", NULL }, "(A & B) & C", 1 },
+  { "as", { "A | (B & C)", NULL }, "(A | B) & C", 0 },
+  { "as", { "D & N", NULL }, "~~D & ~~~~~~N", 0 },
+  { "co", { "A & B", NULL }, "B & A", 1 },
+  { "co", { "A $ B", NULL }, "B $ A", 0 },
+  { "co", { "A | B | C", NULL }, "C | A | B", 1 },
+  { "co", { "A & B", NULL }, "B | A", 0 },
+  { "id", { "A", NULL }, "A & A", 1 },
+  { "id", { "A & B", NULL }, "A & B & A", 1 },
+  { "id", { "A", NULL }, "A & B", 0 },
+  { "id", { "A | B", NULL }, "A & B", 0 },
+  { "dt", { "A & (B | C)", NULL }, "(A & B) | (A & C)", 1 },
+  { "dt", { "A & (B | C)", NULL }, "(A & B) | C", 0 },
+  { "eq", { "A % B", NULL }, "(A $ B) & (B $ A)", 1 },
+  { "eq", { "A % B", NULL }, "(A $ B) & (A $ B)", 0 },
+  { "dn", { "~~A", NULL }, "A", 1 },
+  { "dn", { "~~A & ~~B", NULL }, "A & B", 1 },
+  { "dn", { "~A", NULL }, "A", 0 },
+  { "ep", { "(A & B) $ C", NULL }, "A $ (B $ C)", 1 },
+  { "ep", { "(A & B) $ C", NULL }, "A $ (C $ B)", 0 },
+  { "sb", { "A & (A | B)", NULL }, "A", 1 },
+  { "sb", { "A & (B | C)", NULL }, "A", 0 },
+
+  // Boolean rules.
+  { "bi", { "A & !", NULL }, "A", 1 },
+  { "bi", { "A & ^", NULL }, "A", 0 },
+  { "bn", { "A & ~A", NULL }, "^", 1 },
+  { "bn", { "A & ~B", NULL }, "^", 0 },
+  { "bd", { "A | !", NULL }, "!", 1 },
+  { "bd", { "A & !", NULL }, "!", 0 },
+  { "sn", { "~!", NULL }, "^", 1 },
+  { "sn", { "~!", NULL }, "!", 0 },
+
+  // Quantifier rules.
+  { "ui", { "@x(P(x))", NULL }, "P(a)", 1 },
+  { "ui", { "#x(P(x))", NULL }, "P(a)", 0 },
+  { "eg", { "P(a)", NULL }, "#x(P(x))", 1 },
+  { "eg", { "P(a)", NULL }, "@x(P(x))", 0 },
+  { "nq", { "@x(A)", NULL }, "A", 1 },
+  { "nq", { "@x(P(x))", NULL }, "P(x)", 0 },
+  { "dm", { "~@x(P(x))", NULL }, "#x(~P(x))", 1 },
+  { "dm", { "~@x(P(x))", NULL }, "@x(~P(x))", 0 },
+  { NULL }
+};
+
+// Steps that Implication only allows once contraposition is loaded
+//  as one of its templates.
+
+static struct rule_case template_cases[] = {
+  { "im", { "A $ B", NULL }, "~B $ ~A", 1 },
+  { "im", { "(A $ B) & C", NULL }, "(~B $ ~A) & C", 1 },
+  { "im", { "A $ B", NULL }, "~A $ ~B", 0 },
+  { NULL }
+};
+
+/* Converts a sentence to the form that the rules read.
+ *  input:
+ *    text - the sentence, with the command line connectives.
+ *  output:
+ *    the sexpr of the sentence, or NULL on error.
+ */
+static unsigned char *
+to_sexpr (const char * text)
+{
+  unsigned char * norm, * formatted, * sexpr;
+
+  norm = normalize_conns ((const unsigned char *) text);
+  if (!norm)
+    return NULL;
+
+  formatted = format_string (norm);
+  free (norm);
+  if (!formatted)
+    return NULL;
+
+  if (check_text (formatted) != 0)
+    {
+      free (formatted);
+      return NULL;
+    }
+
+  sexpr = convert_sexpr (formatted);
+  free (formatted);
+
+  return sexpr;
+}
+
+/* Checks one step against its rule.
+ *  input:
+ *    rc - the step.
+ *  output:
+ *    0 if the rule judged it as expected, 1 if it didn't, -1 on error.
+ */
+static int
+check_case (struct rule_case * rc)
+{
+  unsigned char * conc, * prem;
+  vec_t * prems, * vars;
+  char * msg;
+  int i, ret_chk, correct, ret = -1;
+
+  prems = init_vec (sizeof (char *));
+  vars = init_vec (sizeof (variable));
+  if (!prems || !vars)
+    return -1;
+
+  conc = to_sexpr (rc->conc);
+  if (!conc)
+    goto out;
+
+  for (i = 0; rc->prems[i]; i++)
+    {
+      prem = to_sexpr (rc->prems[i]);
+      if (!prem)
+        goto out;
+
+      ret_chk = vec_str_add_obj (prems, prem);
+      free (prem);
+      if (ret_chk < 0)
+        goto out;
+    }
+
+  msg = process (conc, prems, rc->rule, vars, NULL, NULL);
+  if (!msg)
+    goto out;
+
+  correct = !strcmp (msg, CORRECT);
+  ret = (correct == rc->correct) ? 0 : 1;
+  if (ret)
+    fprintf (stderr, "FAIL: %s should %s \"%s\" from \"%s\"%s\n  got \"%s\"\n",
+             rc->rule, rc->correct ? "accept" : "reject", rc->conc,
+             rc->prems[0] ? rc->prems[0] : "",
+             (rc->prems[0] && rc->prems[1]) ? " and the rest" : "", msg);
+
+ out:
+  if (ret < 0)
+    fprintf (stderr, "FAIL: \"%s\" couldn't be checked.\n", rc->conc);
+  if (conc)
+    free (conc);
+  destroy_str_vec (prems);
+  destroy_vec (vars);
+  return ret;
+}
+
+int
+main ()
+{
+  int i, failed = 0;
+
+  main_conns = cli_conns;
+  if (rule_template_init () == AEC_MEM)
+    return EXIT_FAILURE;
+
+  for (i = 0; cases[i].rule; i++)
+    {
+      if (check_case (cases + i))
+        failed++;
+    }
+
+  if (rule_template_add ("im", (const unsigned char *) "A $ B == ~B $ ~A") != 0)
+    {
+      fprintf (stderr, "FAIL: the template couldn't be added.\n");
+      return EXIT_FAILURE;
+    }
+
+  for (i = 0; template_cases[i].rule; i++)
+    {
+      if (check_case (template_cases + i))
+        failed++;
+    }
+
+  rule_template_destroy ();
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
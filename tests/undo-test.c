@@ -0,0 +1,250 @@
+/* Tests the undo ring and the text modifications kept in it.
+
+   Copyright (C) 2026 agent.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "undo.h"
+
+static int failed = 0;
+
+#define CHECK(c, what) if (!(c)) {                      \
+    fprintf (stderr, "FAIL: %s (%s:%i)\n",              \
+             what, __FILE__, __LINE__);                 \
+    failed++;                                           \
+  }
+
+/* Makes a text modification at a given time.
+ *  input:
+ *    line_num - the line being modified.
+ *    old_text - the text of the line.
+ *    new_text - the text that it is being changed to.
+ *    stamp - the time of the modification.
+ *  output:
+ *    the undo information object.
+ */
+static undo_info
+edit (int line_num, const char * old_text, const char * new_text,
+      time_t stamp)
+{
+  undo_info ui;
+
+  ui = undo_info_init_diff (line_num, (unsigned char *) old_text,
+                            (unsigned char *) new_text);
+  ui.stamp = stamp;
+  return ui;
+}
+
+/* Checks that the objects of a ring are for the lines expected.
+ *  input:
+ *    ring - the undo ring.
+ *    first - the line of the oldest object.
+ *    num - the number of objects.
+ *  output:
+ *    1 if the ring holds lines first to first + num - 1, oldest first.
+ */
+static int
+ring_holds (undo_ring * ring, int first, int num)
+{
+  int i;
+
+  if (ring->num_stuff != num)
+    return 0;
+
+  for (i = 0; i < num; i++)
+    {
+      if (undo_ring_nth (ring, i)->line_num != first + i)
+        return 0;
+    }
+
+  return 1;
+}
+
+/* Checks the span that a text modification records.
+ */
+static void
+test_diff ()
+{
+  undo_info ui;
+
+  ui = undo_info_init_diff (3, (unsigned char *) "A & B",
+                            (unsigned char *) "A | B");
+  CHECK (ui.type == UIT_MOD_TEXT, "a change is a text modification");
+  CHECK (ui.line_num == 3 && ui.offset == 2, "a change starts where it differs");
+  CHECK (!strcmp ((char *) ui.removed, "&")
+         && !strcmp ((char *) ui.inserted, "|"),
+         "a change only keeps the text that differs");
+  undo_info_destroy (ui);
+
+  ui = undo_info_init_diff (1, (unsigned char *) "A", (unsigned char *) "AB");
+  CHECK (ui.offset == 1 && !strcmp ((char *) ui.removed, "")
+         && !strcmp ((char *) ui.inserted, "B"), "an insertion at the end");
+  undo_info_destroy (ui);
+}
+
+/* Checks that a text modification can be taken back and put back.
+ */
+static void
+test_revert ()
+{
+  undo_info ui;
+  unsigned char * text;
+  int ret;
+
+  ui = undo_info_init_diff (1, (unsigned char *) "P & Q",
+                            (unsigned char *) "P & (Q | R)");
+
+  ret = undo_info_revert_text (&ui, (unsigned char *) "P & (Q | R)", &text);
+  CHECK (ret == 0 && !strcmp ((char *) text, "P & Q"), "undoing a change");
+  free (text);
+
+  // The same object now redoes the change.
+  ret = undo_info_revert_text (&ui, (unsigned char *) "P & Q", &text);
+  CHECK (ret == 0 && !strcmp ((char *) text, "P & (Q | R)"),
+         "redoing a change");
+  free (text);
+
+  ret = undo_info_revert_text (&ui, (unsigned char *) "P", &text);
+  CHECK (ret == 1, "a change doesn't apply to text that no longer has it");
+
+  undo_info_destroy (ui);
+}
+
+/* Checks that typing and deleting are merged into single actions.
+ */
+static void
+test_merge ()
+{
+  undo_ring * ring;
+  undo_info * ui;
+  unsigned char * text;
+  int pt = -1, ret;
+
+  ring = undo_ring_init ();
+  if (!ring)
+    exit (EXIT_FAILURE);
+
+  // Typing onward.
+  undo_ring_record (ring, &pt, edit (1, "", "A", 100), UNDO_BUDGET);
+  undo_ring_record (ring, &pt, edit (1, "A", "A ", 100), UNDO_BUDGET);
+  undo_ring_record (ring, &pt, edit (1, "A ", "A &", 101), UNDO_BUDGET);
+  CHECK (ring->num_stuff == 1 && pt == 0, "typing is one action");
+
+  ui = undo_ring_nth (ring, 0);
+  CHECK (ui->offset == 0 && !strcmp ((char *) ui->inserted, "A &"),
+         "typing keeps everything typed");
+
+  ret = undo_info_revert_text (ui, (unsigned char *) "A &", &text);
+  CHECK (ret == 0 && !strcmp ((char *) text, ""), "undoing typing");
+  free (text);
+  undo_info_revert_text (ui, (unsigned char *) "", &text);
+  free (text);
+
+  // Deleting backward.
+  undo_ring_record (ring, &pt, edit (1, "A &", "A ", 101), UNDO_BUDGET);
+  undo_ring_record (ring, &pt, edit (1, "A ", "A", 101), UNDO_BUDGET);
+  CHECK (ring->num_stuff == 2 && pt == 1, "deleting is another action");
+
+  ui = undo_ring_nth (ring, 1);
+  CHECK (ui->offset == 1 && !strcmp ((char *) ui->removed, " &"),
+         "deleting keeps everything deleted");
+
+  // Neither merges across lines, or after a pause.
+  undo_ring_record (ring, &pt, edit (2, "", "B", 101), UNDO_BUDGET);
+  undo_ring_record (ring, &pt, edit (2, "B", "BC", 110), UNDO_BUDGET);
+  CHECK (ring->num_stuff == 4 && pt == 3, "lines and pauses split actions");
+
+  // Nor after an undo.
+  pt--;
+  undo_ring_record (ring, &pt, edit (2, "B", "BD", 110), UNDO_BUDGET);
+  CHECK (ring->num_stuff == 4 && pt == 3, "recording forgets what was undone");
+  CHECK (!strcmp ((char *) undo_ring_nth (ring, 3)->inserted, "D"),
+         "the new action replaces the undone one");
+
+  undo_ring_destroy (ring);
+}
+
+/* Checks that the ring keeps its order as it wraps and grows,
+ *  and that it keeps to its budget.
+ */
+static void
+test_ring ()
+{
+  undo_ring * ring;
+  size_t one;
+  int i, pt = -1, first;
+
+  ring = undo_ring_init ();
+  if (!ring)
+    exit (EXIT_FAILURE);
+
+  for (i = 0; i < 10; i++)
+    undo_ring_record (ring, &pt, edit (i, "A", "B", i * 10), UNDO_BUDGET);
+  CHECK (ring_holds (ring, 0, 10) && pt == 9, "records are kept in order");
+
+  one = undo_ring_nth (ring, 0)->size;
+  CHECK (ring->size == 10 * one, "the ring counts its memory");
+
+  // Dropping the oldest moves the start of the ring, so the next
+  //  records wrap around its end.
+  CHECK (undo_ring_trim (ring, 6 * one) == 4, "trimming drops the oldest");
+  pt -= 4;
+  CHECK (ring_holds (ring, 4, 6) && ring->size == 6 * one,
+         "trimming keeps the newest");
+
+  for (i = 10; i < 20; i++)
+    undo_ring_record (ring, &pt, edit (i, "A", "B", i * 10), UNDO_BUDGET);
+  CHECK (ring_holds (ring, 4, 16) && pt == 15, "records wrap around the ring");
+
+  // The ring is full, so this one makes it grow.
+  undo_ring_record (ring, &pt, edit (20, "A", "B", 200), UNDO_BUDGET);
+  CHECK (ring_holds (ring, 4, 17) && pt == 16, "the ring grows in order");
+
+  // A record over the budget drops the oldest until it fits.
+  first = 4;
+  for (i = 21; i < 60; i++)
+    {
+      undo_ring_record (ring, &pt, edit (i, "A", "B", i * 10), 8 * one);
+      if (ring->num_stuff == 8)
+        first = i - 7;
+    }
+  CHECK (ring_holds (ring, first, 8) && first == 52 && pt == 7,
+         "recording keeps to the budget");
+  CHECK (ring->size <= 8 * one, "the ring stays under its budget");
+
+  // The newest record is kept, however small the budget.
+  undo_ring_trim (ring, 0);
+  CHECK (ring_holds (ring, 59, 1), "the newest record is always kept");
+
+  undo_ring_pop (ring);
+  CHECK (ring->num_stuff == 0 && ring->size == 0, "popping the last record");
+
+  undo_ring_destroy (ring);
+}
+
+int
+main ()
+{
+  test_diff ();
+  test_revert ();
+  test_merge ();
+  test_ring ();
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}